@@ -6,6 +6,7 @@ class benchmark_integrate_nmc:
     def __init__(self, filename, label):
         self.label = label
         self.data = {}
+        self.data_variants = {}  # e.g. 'static' (StaticMCI) or 'fixed' (fixed-dim moves) results
 
         with open(filename) as bmfile:
             for line in bmfile:
@@ -17,6 +18,9 @@ class benchmark_integrate_nmc:
 
                 if lsplit[0][0:6] == 't/step':
                     self.data[lsplit[1][1:]] = (float(lsplit[3]), float(lsplit[5]))
+                elif lsplit[0].find('_t/step') > 0:
+                    variant = lsplit[0].split('_t/step')[0]
+                    self.data_variants.setdefault(variant, {})[lsplit[1][1:]] = (float(lsplit[3]), float(lsplit[5]))
 
 
 def plot_compare_nmc(benchmark_list, **kwargs):
@@ -30,13 +34,20 @@ def plot_compare_nmc(benchmark_list, **kwargs):
     fig.suptitle('MCIntegrate benchmark, comparing different Nmc', fontsize=14)
     ax = fig.add_subplot(1, 1, 1)
 
+    legend = []
     for benchmark in benchmark_list:
         values = [benchmark.data[key][0] for key in benchmark.data.keys()]
         errors = [benchmark.data[key][1] for key in benchmark.data.keys()]
         ax.errorbar(xlabels, values, xerr=None, yerr=errors, **kwargs)
+        legend.append(benchmark.label)
+        for variant, data in benchmark.data_variants.items():
+            values = [data[key][0] for key in data.keys()]
+            errors = [data[key][1] for key in data.keys()]
+            ax.errorbar(xlabels, values, xerr=None, yerr=errors, **kwargs)
+            legend.append(benchmark.label + ' (' + variant + ')')
 
     ax.set_ylabel('Time per sample [$\mu s$]')
-    ax.legend([bench.label for bench in benchmark_list])
+    ax.legend(legend)
 
     return fig
 
@@ -2,7 +2,9 @@
 #include <iostream>
 #include <memory>
 
+#include "mci/FixedSRRDAllMove.hpp"
 #include "mci/MCIntegrator.hpp"
+#include "mci/SRRDAllMove.hpp"
 
 #include "../../test/common/TestMCIFunctions.hpp"
 #include "../common/MCIBenchmarks.hpp"
@@ -20,6 +22,13 @@ void run_single_benchmark(const string &label, MCI &mci, const int nruns, const
     cout << label << ":" << setw(max(1, 20 - static_cast<int>(label.length()))) << setfill(' ') << " " << result.first*full_scale << " +- " << result.second*full_scale << " microseconds" << endl;
 }
 
+// fixed-dim move for the benchmarked dimensions
+template <int ND>
+std::unique_ptr<TrialMoveInterface> createFixedMove(const double mrt2step)
+{
+    return std::unique_ptr<TrialMoveInterface>(new FixedUniformAllMove<ND>(mrt2step));
+}
+
 int main()
 {
     // benchmark settings
@@ -29,13 +38,25 @@ int main()
     const int nruns[nset] = {5120, 1280, 320, 80, 20, 5};
     const double mrt2steps[nset] = {3.0, 1.35, 0.6, 0.3, 0.15, 0.07};
 
-    std::vector<std::unique_ptr<MCI> > mcis;
-    for (int nd : ndims) {
-        mcis.push_back(std::make_unique<MCI>(nd));
-    }
+    std::unique_ptr<TrialMoveInterface> (* const createFixedMoves[nset])(double) = {
+            &createFixedMove<1>, &createFixedMove<4>, &createFixedMove<16>,
+            &createFixedMove<64>, &createFixedMove<256>, &createFixedMove<1024>};
 
+    std::vector<std::unique_ptr<MCI> > mcis; // runtime-dim moves
+    std::vector<std::unique_ptr<MCI> > mcis_fixed; // fixed-dim moves
+    std::vector<std::unique_ptr<MCI> > mcis_pooled; // runtime-dim moves and acceptance, drawing from random pools
     for (int i = 0; i < nset; ++i) {
-        MCI * mci = mcis[i].get();
+        mcis.push_back(std::make_unique<MCI>(ndims[i]));
+        mcis[i]->setTrialMove(UniformAllMove(ndims[i], mrt2steps[i])); // avoid automatic fixed-dim dispatch
+        mcis_fixed.push_back(std::make_unique<MCI>(ndims[i]));
+        mcis_fixed[i]->setTrialMove(createFixedMoves[i](mrt2steps[i]));
+        mcis_pooled.push_back(std::make_unique<MCI>(ndims[i]));
+        mcis_pooled[i]->setTrialMove(PooledUniformAllMove(ndims[i], mrt2steps[i]));
+        mcis_pooled[i]->setUseRandomPool(true);
+    }
+
+    for (int i = 0; i < 3*nset; ++i) {
+        MCI * mci = (i < nset) ? mcis[i].get() : (i < 2*nset ? mcis_fixed[i - nset].get() : mcis_pooled[i - 2*nset].get());
         int nd = mci->getNDim();
         ExpNDPDF pdf(nd);
         XND obs(nd);
@@ -46,7 +67,7 @@ int main()
 
         double avg[nd], err[nd];
         for (int j = 0; j < nd; ++j) { mci->setX(j, j%2 == 0 ? 0.1 : -0.05); }
-        mci->setMRT2Step(mrt2steps[i]);
+        mci->setMRT2Step(mrt2steps[i%nset]);
 
         mci->setNdecorrelationSteps(500000);
         mci->integrate(0, avg, err, false, true); // warmup&decorrelate
@@ -60,6 +81,12 @@ int main()
     for (int inmc = 0; inmc < nset; ++inmc) {
         run_single_benchmark("t/step (" + std::to_string(ndims[inmc]) + " dim)", *(mcis[inmc]), nruns[inmc], NMC);
     }
+    for (int inmc = 0; inmc < nset; ++inmc) {
+        run_single_benchmark("fixed_t/step (" + std::to_string(ndims[inmc]) + " dim)", *(mcis_fixed[inmc]), nruns[inmc], NMC);
+    }
+    for (int inmc = 0; inmc < nset; ++inmc) {
+        run_single_benchmark("pooled_t/step (" + std::to_string(ndims[inmc]) + " dim)", *(mcis_pooled[inmc]), nruns[inmc], NMC);
+    }
     cout << "=========================================================================================" << endl << endl << endl;
 
     return 0;
@@ -3,6 +3,7 @@
 #include <memory>
 
 #include "mci/MCIntegrator.hpp"
+#include "mci/SRRDVecMove.hpp"
 
 #include "../../test/common/TestMCIFunctions.hpp"
 #include "../common/MCIBenchmarks.hpp"
@@ -29,26 +30,28 @@ int main()
     const int nruns[nset] = {5120, 1280, 320, 80, 20, 5};
     const double mrt2steps[nset] = {3.0, 3.0, 3.0, 3.0, 3.0, 3.0};
 
-    std::vector<std::unique_ptr<MCI> > mcis;
-    for (int nd : ndims) {
-        mcis.push_back(std::make_unique<MCI>(nd));
+    std::vector<std::unique_ptr<MCI> > mcis; // runtime-veclen moves
+    std::vector<std::unique_ptr<MCI> > mcis_fixed; // fixed-veclen moves
+    for (int i = 0; i < nset; ++i) {
+        mcis.push_back(std::make_unique<MCI>(ndims[i]));
+        mcis[i]->setTrialMove(UniformVecMove(ndims[i], 1, mrt2steps[i])); // avoid automatic fixed-veclen dispatch
+        mcis_fixed.push_back(std::make_unique<MCI>(ndims[i]));
+        mcis_fixed[i]->setTrialMove(MoveType::Vec); // default (i.e. uniform) single-index move, uses FixedUniformVecMove<1>
     }
 
-    for (int i = 0; i < nset; ++i) {
-        MCI * mci = mcis[i].get();
+    for (int i = 0; i < 2*nset; ++i) {
+        MCI * mci = (i < nset) ? mcis[i].get() : mcis_fixed[i - nset].get();
         int nd = mci->getNDim();
         ExpNDPDF pdf(nd);
         XND obs(nd); // use non-updateable XND, because the observable is not expensive enough for selective updates
 
-        mci->setTrialMove(MoveType::Vec); // default (i.e. uniform) single-index move
-
         mci->setSeed(1337);
         mci->addSamplingFunction(pdf);
         mci->addObservable(obs, 0, 1); // use simple accu (i.e. no error), no skipping
 
         double avg[nd], err[nd];
         for (int j = 0; j < nd; ++j) { mci->setX(j, j%2 == 0 ? 0.1 : -0.05); }
-        mci->setMRT2Step(mrt2steps[i]);
+        mci->setMRT2Step(mrt2steps[i%nset]);
 
         mci->setNdecorrelationSteps(500000);
         mci->integrate(0, avg, err, false, true); // warmup&decorrelate
@@ -62,6 +65,9 @@ int main()
     for (int inmc = 0; inmc < nset; ++inmc) {
         run_single_benchmark("t/step (" + std::to_string(ndims[inmc]) + " dim)", *(mcis[inmc]), nruns[inmc], NMC[inmc]);
     }
+    for (int inmc = 0; inmc < nset; ++inmc) {
+        run_single_benchmark("fixed_t/step (" + std::to_string(ndims[inmc]) + " dim)", *(mcis_fixed[inmc]), nruns[inmc], NMC[inmc]);
+    }
     cout << "=========================================================================================" << endl << endl << endl;
 
     return 0;
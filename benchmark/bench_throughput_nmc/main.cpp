@@ -2,6 +2,9 @@
 #include <iostream>
 
 #include "mci/MCIntegrator.hpp"
+#include "mci/SRRDAllMove.hpp"
+#include "mci/StaticMCI.hpp"
+#include "mci/UnboundDomain.hpp"
 
 #include "../../test/common/TestMCIFunctions.hpp"
 #include "../common/MCIBenchmarks.hpp"
@@ -9,7 +12,8 @@
 using namespace std;
 using namespace mci;
 
-void run_single_benchmark(const string &label, MCI &mci, const int nruns, const int NMC)
+template <class MCIType>
+void run_single_benchmark(const string &label, MCIType &mci, const int nruns, const int NMC)
 {
     pair<double, double> result;
     const double time_scale = 1000000.; //microseconds
@@ -53,5 +57,21 @@ int main()
     }
     cout << "=========================================================================================" << endl << endl << endl;
 
+    // Same with compile-time composed StaticMCI
+    StaticMCI<UnboundDomain, UniformAllMove, tuple<Exp1DPDF>, tuple<X1D> > smci(UnboundDomain(1), UniformAllMove(1, mrt2step), tie(pdf), tie(obs));
+    smci.setSeed(1337);
+    smci.setObservableOptions(0, 0, 1); // no error, no skipping
+    smci.integrate(100000, &avg, &err, false, false); // warmup&decorrelate
+    cout << "StaticMCI avg " << avg << ", err " << err << endl;
+    cout << "StaticMCI acceptance rate " << smci.getAcceptanceRate() << endl;
+
+    cout << "=========================================================================================" << endl << endl;
+    cout << "StaticMCI benchmark results (time per sample):" << endl;
+
+    for (int inmc = 0; inmc < 5; ++inmc) {
+        run_single_benchmark("static_t/step (" + std::to_string(NMC[inmc]) + " steps)", smci, nruns[inmc], NMC[inmc]);
+    }
+    cout << "=========================================================================================" << endl << endl << endl;
+
     return 0;
 }
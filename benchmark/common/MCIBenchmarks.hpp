@@ -31,7 +31,8 @@ inline std::pair<double, double> sample_benchmark(const std::function<double()>
     return std::pair<double, double>(mean, err);
 }
 
-inline double benchmark_MCIntegrate(mci::MCI &mci, const int64_t NMC)
+template <class MCIType /*MCI or StaticMCI<...>*/>
+inline double benchmark_MCIntegrate(MCIType &mci, const int64_t NMC)
 {
     Timer timer(1.);
     double average[mci.getNObsDim()];
@@ -44,7 +45,8 @@ inline double benchmark_MCIntegrate(mci::MCI &mci, const int64_t NMC)
     return timer.elapsed();
 }
 
-inline std::pair<double, double> sample_benchmark_MCIntegrate(mci::MCI &mci, const int nruns, const int64_t NMC)
+template <class MCIType /*MCI or StaticMCI<...>*/>
+inline std::pair<double, double> sample_benchmark_MCIntegrate(MCIType &mci, const int nruns, const int64_t NMC)
 {
     return sample_benchmark([&] { return benchmark_MCIntegrate(mci, NMC); }, nruns);
 }
@@ -6,6 +6,9 @@ CXX_COMPILER="g++"
 # C++ flags
 CXX_FLAGS="-O3 -flto -march=native -Wall -Wno-unused-function"
 
+# random number engine (mt19937_64, xoshiro256pp or pcg64)
+RANDOM_GENERATOR="mt19937_64"
+
 # compile with MPI
 USE_MPI=0
 
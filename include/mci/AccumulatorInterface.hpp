@@ -2,10 +2,17 @@
 #define MCI_ACCUMULATORINTERFACE_HPP
 
 #include "mci/ObservableFunctionInterface.hpp"
+#include "mci/ReducedStorage.hpp"
+#include "mci/RunLengthStorage.hpp"
+#include "mci/StorageArena.hpp"
+#include "mci/WalkerEnsemble.hpp"
 #include "mci/WalkerState.hpp"
 
 #include <cstdint>
+#include <istream>
 #include <memory>
+#include <ostream>
+#include <stdexcept>
 
 namespace mci
 {
@@ -18,34 +25,72 @@ namespace mci
 // interface implement different storage/accumulation techniques.
 // In MCI, Accumulators are contained within an ObservableContainer,
 // where they are strictly paired with corresponding estimator functions.
+//
+// In ensemble mode (allocate with nwalkers>1), the base class keeps the last
+// observable values and change flags per walker and passes the walker average
+// of every (non-skipped) step to the child's _accumulate() as _obs_values.
 class AccumulatorInterface
 {
 protected:
     ObservableFunctionInterface &_obs; // reference to corresponding obs
-    const bool _flag_updobs; // is the passed observable supporting selective updating?
+    const bool _flag_evaluate; // does the child evaluate the observable itself (see _evaluate())?
+    const bool _flag_updobs; // is the passed observable supporting selective updating (and not evaluated by the child)?
 
     const int _nobs; // number of values returned by the observable function
     const int _xndim; // dimension of walker positions/flags that get passed on accumulate
     const int _nskip; // evaluate observable only on every nskip-th step
 
     // fixed-size allocations
-    double * const _obs_values; // observable's last values (length _nobs)
-    bool * const _flags_xchanged; // remembers which x have changed since last obs evaluation (length _xndim)
+    double * const _obs_values; // observable's last values, i.e. the values to accumulate (length _nobs)
 
     // variables
     int64_t _nsteps; // total number of sampling steps (set on allocate() to planned number of calls to accumulateObservables)
-    double * _data; // childs use this to store data
+    int64_t _naccu; // number of steps to accumulate (set on allocate(), summed on merge())
+    double * _data; // childs use this to store data (allocate it with _newData())
+    StorageArena * _arena; // if not nullptr, _newData() takes arrays from this arena
+    bool _flag_arenadata; // was _data taken from the arena?
+
+    // per-walker variables (reallocated on allocate() if the number of walkers changes)
+    int _nwalkers; // number of walkers passed on accumulate
+    double * _wlk_values; // last values per walker (length _nwalkers*_nobs, equal to _obs_values if _nwalkers==1)
+    bool * _flags_xchanged; // remembers which x have changed since last obs evaluation (length _nwalkers*_xndim)
+    int * _nchanged; // counter of how many x have changed since last obs evaluation (length _nwalkers)
 
-    int _nchanged{}; // counter of how many x have changed since last obs evaluation
     int64_t _stepidx{}; // running step index
     int _skipidx{}; // to determine when to skip accumulation
     bool _flag_final{}; // was finalized called (without throwing error) ?
+    bool _flag_repeat{}; // on _accumulate(): are _obs_values unchanged since the previous _accumulate() call?
 
-    // base methods
+    // base methods (those called on every step are defined inline, as they are cheap compared to the call overhead)
     void _init(); // used in construct/reset
-    void _processOld(const WalkerState &wlk); // used in accumulate() when observables need no computation
-    void _processFull(const WalkerState &wlk); // used else when obs not updateable
-    void _processSelective(const WalkerState &wlk); // and this is used otherwise
+    void _allocateWalkers(int nwalkers); // (re-)allocate the per-walker variables
+    void _deallocateWalkers();
+    double * _newData(int64_t n); // new array of length n for _data (from the arena, if set)
+    void _deleteData(); // delete _data (unless taken from the arena) and set it to nullptr
+    void _growData(int64_t nold, int64_t nnew); // replace _data by a new array of length nnew, keeping the first nold values
+    bool _isAccuStep() // advances the skip index and returns whether the current step is accumulated
+    {
+        if (++_skipidx == _nskip) {
+            _skipidx = 0;
+            return true;
+        }
+        return false;
+    }
+    bool _processWalker(const WalkerState &wlk, int iw, bool flag_accu) // update values of walker iw if necessary (returns whether they were recomputed)
+    {
+        if (wlk.accepted || _nchanged[iw] > 0) {
+            if (_flag_updobs) {
+                this->_processSelective(wlk, iw, flag_accu);
+            }
+            else {
+                this->_processFull(wlk, iw, flag_accu);
+            }
+            return flag_accu; // values are recomputed on accumulation steps
+        }
+        return false; // else the last values of this walker are still valid
+    }
+    void _processFull(const WalkerState &wlk, int iw, bool flag_accu); // used in _processWalker() when obs not updateable
+    void _processSelective(const WalkerState &wlk, int iw, bool flag_accu); // and this is used otherwise
 
     // TO BE IMPLEMENTED BY CHILD
     virtual void _allocate() = 0; // allocate _data for a MC run of nsteps length ( expect deallocated state )
@@ -53,9 +98,24 @@ protected:
     virtual void _finalize() = 0; // if necessary, apply normalization ( do nothing when deallocated )
     virtual void _reset() = 0; // reset data / child's members ( must work in deallocated state )
     virtual void _deallocate() = 0; // delete _data allocation ( reset will be called already )
+    virtual void _writeData(std::ostream &os) const = 0; // write data accumulated so far and child's counters ( raw binary )
+    virtual void _readData(std::istream &is) = 0; // read back what _writeData wrote ( expect allocated, clean state except for read rows )
+
+    // OPTIONALLY IMPLEMENTED BY CHILD (if the data contains stored sample rows, which _writeData must leave out then)
+    virtual int64_t _getNFixedRows() const { return 0; } // number of stored rows that won't change anymore (except for requantization)
+    virtual int64_t _getRowsVersion() const { return 0; } // changes whenever already stored rows are changed
+    virtual void _writeRows(std::ostream & /*os*/, int64_t /*row0*/, int64_t /*row1*/) const {} // write rows [row0, row1) ( raw binary )
+    virtual void _readRows(std::istream & /*is*/, int64_t /*row0*/, int64_t /*row1*/) {} // read them back ( in order, before _readData )
+    virtual void _merge(const AccumulatorInterface &other) = 0; // add finalized data of other ( same type and _nobs/_nskip, before _naccu is summed )
+    virtual void _serialize(std::ostream &os) const = 0; // write finalized data compactly ( raw binary )
+    virtual void _deserialize(std::istream &is) = 0; // allocate and read back what _serialize wrote ( expect deallocated state, _naccu set )
+
+    // OPTIONALLY IMPLEMENTED BY CHILD (used instead of _obs.observableFunction() if flag_evaluate was passed on construction)
+    // compute the values of walker position in (values contains the last values of that walker, e.g. for sparse updates)
+    virtual void _evaluate(const double in[], double values[]) { _obs.observableFunction(in, values); }
 
     // Constructor
-    AccumulatorInterface(ObservableFunctionInterface &obs, int nskip);
+    AccumulatorInterface(ObservableFunctionInterface &obs, int nskip, bool flag_evaluate = false);
 
 public:
     virtual ~AccumulatorInterface();
@@ -66,13 +126,11 @@ public:
     // Getters
     int getNObs() const { return _nobs; } // dimension of observable
     int getNDim() const { return _xndim; } // dimension of walkers
+    int getNWalkers() const { return _nwalkers; } // number of walkers per step
 
     int getNSkip() const { return _nskip; }
     int64_t getNSteps() const { return _nsteps; }
-    int64_t getNAccu() const
-    {
-        return (_nsteps > 0) ? 1 + (_nsteps - 1)/_nskip : 0; // actual number of steps to accumulate
-    }
+    int64_t getNAccu() const { return _naccu; } // actual number of steps to accumulate
     int64_t getNData() const { return this->getNStore()*_nobs; } // total length of allocated data
 
     int64_t getStepIndex() const { return _stepidx; }
@@ -83,21 +141,42 @@ public:
 
     // get data
     const double * getData() const { return _data; } // direct read-only access to internal data pointer
-    const double * getObsValues() const { return _obs_values; } // read-only pointer to last calculated observable data
+    const double * getObsValues() const { return _obs_values; } // read-only pointer to last calculated observable data (walker average in ensemble mode)
     double getObsValue(int i) const { return _obs_values[i]; } // element-wise access to last values
 
     // TO BE IMPLEMENTED BY CHILD
     virtual int64_t getNStore() const = 0; // get number of allocated data elements with _nobs length each
 
+    // OPTIONALLY IMPLEMENTED BY CHILD
+    // if samples are stored with reduced precision, return their storage (and getData() is nullptr)
+    virtual const ReducedStorage * getReducedData() const { return nullptr; }
+    // if samples are stored as runs of repeated samples, return their storage (and getData() is nullptr)
+    virtual const RunLengthStorage * getRunLengthData() const { return nullptr; }
+
+    // take the data arrays from arena (nullptr -> own allocations), used from next allocate() on
+    // (the arena must outlive the allocation and may only be released after deallocate())
+    void setStorageArena(StorageArena * arena) { _arena = arena; }
+    StorageArena * getStorageArena() const { return _arena; }
+
 
     // methods to call externally, in the following pattern:
     // allocate -> nsteps * accumulate -> finalize -> getData ( -> reset -> accumulate ...) -> delete/deallocate
 
-    // call this before a MC run of nsteps length
-    void allocate(int64_t nsteps); // will deallocate any existing allocation
+    // call this before a MC run of nsteps length, with nwalkers walkers per step
+    void allocate(int64_t nsteps, int nwalkers = 1); // will deallocate any existing allocation
 
     // externally call this on every MC step
-    void accumulate(const WalkerState &wlk /*step info*/); // process step described by WalkerState
+    void accumulate(const WalkerState &wlk /*step info*/) // process step described by WalkerState (requires nwalkers==1)
+    {
+        if (_nwalkers != 1) { throw std::runtime_error("[AccumulatorInterface::accumulate] Single walker passed to accumulator allocated for multiple walkers."); }
+
+        const bool flag_accu = this->_isAccuStep();
+        _flag_repeat = !this->_processWalker(wlk, 0, flag_accu);
+        if (flag_accu) { this->_accumulate(); } // call child storage implementation
+
+        ++_stepidx;
+    }
+    void accumulate(const WalkerEnsemble &wlkens /*step info*/); // process step of all walkers, accumulate their average
 
     // finalize (e.g. normalize) stored data
     void finalize(); // will throw if called prematurely, but does nothing if deallocated or used repeatedly
@@ -107,6 +186,31 @@ public:
 
     // deallocate memory
     void deallocate();
+
+    // write/read the state of an unfinalized accumulation in raw binary (used for MCI checkpoints),
+    // so that accumulation can be continued later. Reading requires the same allocate() call first.
+    // With flag_rows false, the state excludes the fixed sample rows, i.e. the first getNFixedRows() stored rows,
+    // which can be written incrementally with writeRows() instead. To read such a state, read all the rows in order
+    // with readRows() after the allocate() call, then call readState() with flag_rows false.
+    // Rows written before a change of getRowsVersion() (e.g. int16 requantization) are outdated and must be rewritten.
+    void writeState(std::ostream &os, bool flag_rows = true) const;
+    void readState(std::istream &is, bool flag_rows = true);
+    int64_t getNFixedRows() const { return this->_getNFixedRows(); }
+    int64_t getRowsVersion() const { return this->_getRowsVersion(); }
+    void writeRows(std::ostream &os, int64_t row0, int64_t row1) const; // write fixed rows [row0, row1)
+    void readRows(std::istream &is, int64_t row0, int64_t row1);
+
+    // Merge the finalized accumulation of other into ours, as if we had accumulated the steps of both (e.g. to combine
+    // independent chains, MPI ranks or separate jobs before the estimator runs). Stored samples and blocks are appended,
+    // while running averages and moments are combined with weights proportional to the numbers of accumulated steps.
+    // Both must be finalized and of the same type and configuration (observable dimension, nskip, blocksize and
+    // storage precision). The result is finalized again, so call allocate() before accumulating anew.
+    void merge(const AccumulatorInterface &other);
+
+    // write/read a finalized accumulation in compact raw binary, e.g. to merge results of separate jobs. Reading works
+    // on any accumulator of the same type and configuration (allocated or not) and leaves it finalized.
+    void serialize(std::ostream &os) const;
+    void deserialize(std::istream &is);
 };
 }  // namespace mci
 
@@ -0,0 +1,56 @@
+#ifndef MCI_BINARYIO_HPP
+#define MCI_BINARYIO_HPP
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace mci
+{
+// Minimal helpers for raw binary streams of trivially copyable values (native byte order),
+// as used by checkpoints (see MCI::saveCheckpoint). Reading throws on premature end of stream.
+
+template <class T>
+inline void writeBinary(std::ostream &os, const T vals[], const int64_t n)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "[writeBinary] Type must be trivially copyable.");
+    os.write(reinterpret_cast<const char *>(vals), static_cast<std::streamsize>(n*sizeof(T)));
+}
+
+template <class T>
+inline void writeBinary(std::ostream &os, const T &val) { writeBinary(os, &val, 1); }
+
+template <class T>
+inline void readBinary(std::istream &is, T vals[], const int64_t n)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "[readBinary] Type must be trivially copyable.");
+    if (!is.read(reinterpret_cast<char *>(vals), static_cast<std::streamsize>(n*sizeof(T)))) {
+        throw std::runtime_error("[readBinary] Unexpected end of binary stream.");
+    }
+}
+
+template <class T>
+inline void readBinary(std::istream &is, T &val) { readBinary(is, &val, 1); }
+
+// strings are stored with their length (int64) in front
+inline void writeBinaryString(std::ostream &os, const std::string &str)
+{
+    writeBinary(os, static_cast<int64_t>(str.size()));
+    writeBinary(os, str.data(), static_cast<int64_t>(str.size()));
+}
+
+inline std::string readBinaryString(std::istream &is)
+{
+    int64_t len;
+    readBinary(is, len);
+    if (len < 0) { throw std::runtime_error("[readBinaryString] Invalid string length in binary stream."); }
+    std::string str(static_cast<size_t>(len), '\0');
+    if (len > 0) { readBinary(is, &str[0], len); }
+    return str;
+}
+} // namespace mci
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "mci/AccumulatorInterface.hpp"
 
+#include <memory>
 #include <stdexcept>
 
 namespace mci
@@ -11,6 +12,8 @@ namespace mci
 // is desired. Typical use case is if you know how large the blocks have to be for uncorrelated samples
 // and want to avoid the memory&CPU overhead of using automatic blocking.
 // NOTE: The planned number of steps must be a multiple of the chosen blocksize.
+// With reduced storage precision (see ReducedStorage.hpp), the block averages are stored as float or int16
+// and estimators read them from getReducedData().
 class BlockAccumulator final: public AccumulatorInterface
 {
 protected:
@@ -20,16 +23,31 @@ protected:
     int _bidx; // counter to determine when block is finished
     int64_t _storeidx; // storage index offset for next write
 
+    // reduced precision storage (nullptr for double precision) and the current block sum (length _nobs)
+    const std::unique_ptr<ReducedStorage> _rstore;
+    const std::unique_ptr<double[]> _blocksum;
+
     // --- storage method to be implemented
     void _allocate() final;
     void _accumulate() final;
     void _finalize() final;
     void _reset() final;
     void _deallocate() final;
+    void _writeData(std::ostream &os) const final;
+    void _readData(std::istream &is) final;
+    int64_t _getNFixedRows() const final;
+    int64_t _getRowsVersion() const final { return _rstore ? _rstore->getNRequant() : 0; }
+    void _writeRows(std::ostream &os, int64_t row0, int64_t row1) const final;
+    void _readRows(std::istream &is, int64_t row0, int64_t row1) final;
+    void _merge(const AccumulatorInterface &other) final;
+    void _serialize(std::ostream &os) const final;
+    void _deserialize(std::istream &is) final;
 
 public:
-    BlockAccumulator(ObservableFunctionInterface &obs, int nskip, int blocksize):
-            AccumulatorInterface(obs, nskip), _blocksize(blocksize), _nblocks(0), _bidx(0), _storeidx(0)
+    BlockAccumulator(ObservableFunctionInterface &obs, int nskip, int blocksize, StoragePrecision precision = StoragePrecision::Double):
+            AccumulatorInterface(obs, nskip), _blocksize(blocksize), _nblocks(0), _bidx(0), _storeidx(0),
+            _rstore((precision != StoragePrecision::Double) ? new ReducedStorage(precision, _nobs) : nullptr),
+            _blocksum(_rstore ? new double[_nobs]() : nullptr)
     {
         if (_blocksize < 1) { throw std::invalid_argument("[BlockAccumulator] Requested blocksize was < 1 ."); }
     }
@@ -38,6 +56,8 @@ public:
 
     int getBlockSize() const { return _blocksize; }
     int64_t getNStore() const final { return _nblocks; }
+    const ReducedStorage * getReducedData() const final { return _rstore.get(); }
+    StoragePrecision getStoragePrecision() const { return _rstore ? _rstore->precision : StoragePrecision::Double; }
 };
 }  // namespace mci
 
@@ -0,0 +1,70 @@
+#ifndef MCI_COVARIANCEACCUMULATOR_HPP
+#define MCI_COVARIANCEACCUMULATOR_HPP
+
+#include "mci/AccumulatorInterface.hpp"
+#include "mci/OnlineCovariance.hpp"
+
+#include <memory>
+#include <stdexcept>
+
+namespace mci
+{
+// Class to handle accumulation of observables, when the covariance between the observable's dimensions is desired
+// (e.g. to propagate errors to derived quantities) without storing samples. The (optionally block-averaged, if
+// blocksize > 1) samples are folded into a running mean and covariance matrix (see OnlineCovariance.hpp), so memory
+// is O(nobs^2). On finalize, the data array is filled with the average (first row) and the error (second row), equal
+// to what UncorrelatedEstimator yields on the stored samples or block averages (select by EstimatorType::OnlineCovariance).
+//
+// By setCovarianceGroup(), several accumulators can fold their block averages into one shared OnlineCovariance, at
+// consecutive offsets, to obtain also the covariances across observables (used by ObservableContainer). This requires
+// that all accumulators of the group complete their blocks on the same steps, i.e. have equal blocksize and nskip.
+//
+// NOTE: The planned number of steps must be a multiple of the chosen blocksize and yield at least 2 blocks.
+class CovarianceAccumulator final: public AccumulatorInterface
+{
+protected:
+    const int _blocksize; // how many samples to average per block
+    int _bidx; // counter to determine when block is finished
+
+    std::unique_ptr<double[]> _block; // current block sum (length _nobs)
+    std::unique_ptr<OnlineCovariance> _owncov; // own running covariance (nullptr if in a group)
+    OnlineCovariance * _cov; // the covariance we accumulate to (own or group)
+    int _covoffset; // offset of our dimensions in _cov
+
+    // --- storage method to be implemented
+    void _allocate() final;
+    void _accumulate() final;
+    void _finalize() final;
+    void _reset() final;
+    void _deallocate() final;
+    void _writeData(std::ostream &os) const final;
+    void _readData(std::istream &is) final;
+    void _merge(const AccumulatorInterface &other) final;
+    void _serialize(std::ostream &os) const final;
+    void _deserialize(std::istream &is) final;
+
+public:
+    CovarianceAccumulator(ObservableFunctionInterface &obs, int nskip, int blocksize):
+            AccumulatorInterface(obs, nskip), _blocksize(blocksize), _bidx(0),
+            _block(new double[_nobs]), _owncov(new OnlineCovariance(_nobs)), _cov(_owncov.get()), _covoffset(0)
+    {
+        if (_blocksize < 1) { throw std::invalid_argument("[CovarianceAccumulator] Requested blocksize was < 1 ."); }
+        this->_reset();
+    }
+
+    ~CovarianceAccumulator() final { this->_deallocate(); }
+
+    // Accumulate to the dimensions [offset, offset+nobs) of the shared covariance group (nullptr -> use an own one).
+    // Call this before allocate(). The group is not owned and must stay valid while we are in use. The owner of the
+    // group also has to reset, merge and serialize it (the accumulator does this only with its own covariance) and
+    // must do that before merge() and deserialize() of the accumulators, which then just update average and error.
+    void setCovarianceGroup(OnlineCovariance * group, int offset = 0);
+
+    int getBlockSize() const { return _blocksize; }
+    const OnlineCovariance &getCovariance() const { return *_cov; }
+    int getCovarianceOffset() const { return _covoffset; }
+    int64_t getNStore() const final { return (_data != nullptr) ? 2 : 0; } // average and error
+};
+}  // namespace mci
+
+#endif
@@ -1,14 +1,17 @@
 #ifndef MCI_ESTIMATORS_HPP
 #define MCI_ESTIMATORS_HPP
 
+#include "mci/SampleRows.hpp"
+
 #include <cstdint>
+#include <functional>
 
 namespace mci
 {
 // Compute average and standard deviation (error) of a set of data x[N], assuming that they are not correlated
 void OneDimUncorrelatedEstimator(int64_t n, const double x[], double &average, double &error);
 
-// Compute average and error, using the blocking technique (only used by FCBlockerEstimator, not by MCI)
+// Compute average and error, using the blocking technique (not used by MCI)
 void OneDimBlockEstimator(int64_t n, const double x[], int64_t nblocks, double &average, double &error);
 
 // Compute average and error for correlated data, using auto blocking technique (by Francesco Calcavecchia)
@@ -26,16 +29,19 @@ void OneDimFCBlockerEstimator(int64_t n, const double x[], double &average, doub
 // Compute average and standard deviation (error) of a set of data x[N], assuming that they are not correlated
 void MultiDimUncorrelatedEstimator(int64_t n, int ndim, const double x[], double average[], double error[]);
 
-// Compute average and error, using fixed blocking technique (only used by FCBlockerEstimator, not by MCI)
+// Compute average and error, using fixed blocking technique (not used by MCI)
 void MultiDimBlockEstimator(int64_t n, int ndim, const double x[], int64_t nblocks, double average[], double error[]);
 
 // Compute average and error for correlated data, using auto blocking technique (by Francesco Calcavecchia)
+// NOTE: The block estimates for all 45 block counts are computed from a single pass over the data.
 void MultiDimFCBlockerEstimator(int64_t n, int ndim, const double x[], double average[], double error[]);
 
 
 // any-dim wrappers for above functions and other estimators
+// NOTE: These are also provided for reduced-precision data (float or int16_t, see StoragePrecision),
+//       which is read with widening loads, i.e. all arithmetic is done in double.
 void UncorrelatedEstimator(int64_t n, int ndim, const double x[], double average[], double error[]);
-void CorrelatedEstimator(int64_t n, int ndim, const double x[], double average[], double error[]); // if n is power of 2, use MJBlocker, else FCBlocker
+void CorrelatedEstimator(int64_t n, int ndim, const double x[], double average[], double error[]); // uses MJBlocker
 void FCBlockerEstimator(int64_t n, int ndim, const double x[], double average[], double error[]);
 
 // Calls our implementation Marius Jonsson's auto-blocking algorithm
@@ -43,6 +49,76 @@ void MJBlockerEstimator(int64_t n, int ndim, const double x[], double average[],
 
 // no-op estimator (used when data contains the averages already and error is irrelevant)
 void NoopEstimator(int64_t/*n*/, int ndim, const double x[], double average[], double error[]);
+
+// Jonsson's auto-blocking in a single pass over the data, with O(ndim*log2(n)) memory instead of MJBlocker's n/2 samples
+// (see StreamingBlocker.hpp). The results agree with MJBlockerEstimator up to rounding. Used by MCI instead of MJBlocker
+// on samples in memory-mapped storage (see FullAccumulator.hpp), which may not fit into RAM.
+void StreamingBlockerEstimator(int64_t n, int ndim, const double x[], double average[], double error[]);
+
+// Estimate the integrated autocorrelation time tau_int = 1 + 2*sum_t rho(t) of every dimension, with the normalized
+// autocorrelation function rho computed by FFT in O(n log n) and Sokal's automatic window (smallest W >= 5*tau_int(W)).
+// The error is the uncorrelated error times sqrt(tau_int). If tau is not nullptr, tau_int is written to tau[ndim].
+// NOTE: Requires a temporary buffer of 16*2^ceil(log2(2n)) bytes, i.e. 32 to 64 bytes per sample.
+void AutocorrelationEstimator(int64_t n, int ndim, const double x[], double average[], double error[], double tau[]);
+void AutocorrelationEstimator(int64_t n, int ndim, const double x[], double average[], double error[]);
+
+// reduced-precision overloads
+void UncorrelatedEstimator(int64_t n, int ndim, const float x[], double average[], double error[]);
+void CorrelatedEstimator(int64_t n, int ndim, const float x[], double average[], double error[]);
+void FCBlockerEstimator(int64_t n, int ndim, const float x[], double average[], double error[]);
+void MJBlockerEstimator(int64_t n, int ndim, const float x[], double average[], double error[]);
+void NoopEstimator(int64_t/*n*/, int ndim, const float x[], double average[], double error[]);
+void AutocorrelationEstimator(int64_t n, int ndim, const float x[], double average[], double error[], double tau[]);
+void AutocorrelationEstimator(int64_t n, int ndim, const float x[], double average[], double error[]);
+
+void UncorrelatedEstimator(int64_t n, int ndim, const int16_t x[], double average[], double error[]);
+void CorrelatedEstimator(int64_t n, int ndim, const int16_t x[], double average[], double error[]);
+void FCBlockerEstimator(int64_t n, int ndim, const int16_t x[], double average[], double error[]);
+void MJBlockerEstimator(int64_t n, int ndim, const int16_t x[], double average[], double error[]);
+void NoopEstimator(int64_t/*n*/, int ndim, const int16_t x[], double average[], double error[]);
+void AutocorrelationEstimator(int64_t n, int ndim, const int16_t x[], double average[], double error[], double tau[]);
+void AutocorrelationEstimator(int64_t n, int ndim, const int16_t x[], double average[], double error[]);
+
+// run-length overloads (see RunLengthSamples in SampleRows.hpp), which read the runs as if they were expanded,
+// i.e. the results are bit-identical to the ones on the expanded samples
+void UncorrelatedEstimator(int64_t n, int ndim, const RunLengthSamples &x, double average[], double error[]);
+void CorrelatedEstimator(int64_t n, int ndim, const RunLengthSamples &x, double average[], double error[]);
+void FCBlockerEstimator(int64_t n, int ndim, const RunLengthSamples &x, double average[], double error[]);
+void MJBlockerEstimator(int64_t n, int ndim, const RunLengthSamples &x, double average[], double error[]);
+void NoopEstimator(int64_t/*n*/, int ndim, const RunLengthSamples &x, double average[], double error[]);
+void AutocorrelationEstimator(int64_t n, int ndim, const RunLengthSamples &x, double average[], double error[], double tau[]);
+void AutocorrelationEstimator(int64_t n, int ndim, const RunLengthSamples &x, double average[], double error[]);
+
+// Estimators restricted to the dimensions [j0, j1) of data with ndim dimensions, i.e. only average/error[j0..j1-1]
+// are written. The results are bit-identical to the ones of the full estimators above, so that different dimension
+// slices can be estimated by different threads (see ObservableContainer::estimate). Instantiated for double, float and int16_t.
+template <class T>
+void UncorrelatedEstimatorSlice(int64_t n, int ndim, const T x[], int j0, int j1, double average[], double error[]);
+template <class T>
+void CorrelatedEstimatorSlice(int64_t n, int ndim, const T x[], int j0, int j1, double average[], double error[]);
+template <class T>
+void FCBlockerEstimatorSlice(int64_t n, int ndim, const T x[], int j0, int j1, double average[], double error[]);
+template <class T>
+void MJBlockerEstimatorSlice(int64_t n, int ndim, const T x[], int j0, int j1, double average[], double error[]);
+
+void StreamingBlockerEstimatorSlice(int64_t n, int ndim, const double x[], int j0, int j1, double average[], double error[]);
+
+// the same for run-length samples
+void UncorrelatedEstimatorSlice(int64_t n, int ndim, const RunLengthSamples &x, int j0, int j1, double average[], double error[]);
+void CorrelatedEstimatorSlice(int64_t n, int ndim, const RunLengthSamples &x, int j0, int j1, double average[], double error[]);
+void FCBlockerEstimatorSlice(int64_t n, int ndim, const RunLengthSamples &x, int j0, int j1, double average[], double error[]);
+void MJBlockerEstimatorSlice(int64_t n, int ndim, const RunLengthSamples &x, int j0, int j1, double average[], double error[]);
+
+// estimator for data which contains the averages (first row) and errors (second row) already, i.e. n must be 2
+// (used with StreamingBlockAccumulator, WelfordAccumulator and CovarianceAccumulator, which compute the estimate during accumulation)
+void PrecomputedEstimator(int64_t n, int ndim, const double x[], double average[], double error[]);
+
+// Estimate the derived quantity f(avg) of nvals averages avg[nvals] with covariance matrix cov[nvals*nvals] (of the
+// averages, e.g. from EstimatorType::OnlineCovariance), with the error of linear error propagation (delta method),
+// i.e. sqrt(grad^T cov grad) for the gradient grad[nvals] of f at avg. If grad is nullptr, the gradient is computed
+// by central differences, with steps cbrt(machine epsilon)*max(|avg[i]|, sqrt(cov[i][i])) (or cbrt(epsilon) if zero).
+void DeltaMethodEstimator(int nvals, const double avg[], const double cov[], const std::function<double(const double[])> &f,
+                          double &average, double &error, const double grad[] = nullptr);
 } // namespace mci
 
 #endif
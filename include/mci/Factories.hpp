@@ -3,11 +3,17 @@
 
 #include "mci/AccumulatorInterface.hpp"
 #include "mci/BlockAccumulator.hpp"
+#include "mci/CovarianceAccumulator.hpp"
 #include "mci/FullAccumulator.hpp"
+#include "mci/HistogramAccumulator.hpp"
 #include "mci/SimpleAccumulator.hpp"
+#include "mci/StreamingBlockAccumulator.hpp"
+#include "mci/WelfordAccumulator.hpp"
 
 #include "mci/Estimators.hpp"
 
+#include "mci/DomainInterface.hpp"
+
 #include "mci/MultiStepMove.hpp"
 #include "mci/SRRDAllMove.hpp"
 #include "mci/SRRDVecMove.hpp"
@@ -32,6 +38,9 @@ inline std::unique_ptr<AccumulatorInterface> createAccumulator(ObservableFunctio
     blocksize = std::max(0, blocksize);
     nskip = std::max(1, nskip);
 
+    if (auto * const histobs = dynamic_cast<HistogramObservable *>(&obs)) { // accumulate only the hits
+        return std::unique_ptr<AccumulatorInterface>(new HistogramAccumulator(*histobs, nskip, blocksize));
+    }
     if (blocksize == 0) {
         return std::unique_ptr<AccumulatorInterface>(new SimpleAccumulator(obs, nskip));
     }
@@ -53,9 +62,13 @@ enum class EstimatorType
 {
     Noop,
     Uncorrelated,
-    Correlated, /* uses MJBlocker, if ndata power of 2, and else FCBlocker */
+    Correlated, /* uses MJBlocker (for any ndata) */
     FCBlocker, /* Francesco's auto blocker implementation */
-    MJBlocker /* Our implementation of Marius Jonsson's auto blocking */
+    MJBlocker, /* Our implementation of Marius Jonsson's auto blocking */
+    StreamingBlocker, /* Jonsson's auto blocking during accumulation (O(log N) memory, see StreamingBlocker.hpp) */
+    OnlineUncorrelated, /* Uncorrelated, but computed during accumulation (O(1) memory, see WelfordAccumulator.hpp) */
+    Autocorrelation, /* from the integrated autocorrelation time, computed by FFT (see Estimators.hpp) */
+    OnlineCovariance /* OnlineUncorrelated, plus the covariances across dimensions and observables (O(nobs^2) memory, see CovarianceAccumulator.hpp) */
 };
 
 inline EstimatorType selectEstimatorType(const bool flag_correlated, const bool flag_error = true)
@@ -70,8 +83,52 @@ inline EstimatorType selectEstimatorType(const bool flag_correlated, const bool
     return flag_error ? EstimatorType::Uncorrelated : EstimatorType::Noop;
 }
 
+// plain estimator function pointer for sample data of type T (selects among the overloads in Estimators.hpp)
+template <class T>
+using EstimatorFunctionPtr = void (*)(int64_t/*nstore*/, int/*nobs*/, const T[]/*data*/, double[]/*avg*/, double[]/*error*/);
+
 inline std::function<void(int64_t/*nstore*/, int/*nobs*/, const double[]/*data*/, double[]/*avg*/, double[]/*error*/)>
 createEstimator(EstimatorType estimType /*from Estimators enumeration*/)
+{
+    switch (estimType) {
+    case EstimatorType::Noop:
+        return static_cast<EstimatorFunctionPtr<double>>(NoopEstimator);
+
+    case EstimatorType::Uncorrelated:
+        return static_cast<EstimatorFunctionPtr<double>>(UncorrelatedEstimator);
+
+    case EstimatorType::Correlated:
+        return static_cast<EstimatorFunctionPtr<double>>(CorrelatedEstimator);
+
+    case EstimatorType::FCBlocker:
+        return static_cast<EstimatorFunctionPtr<double>>(FCBlockerEstimator);
+
+    case EstimatorType::MJBlocker:
+        return static_cast<EstimatorFunctionPtr<double>>(MJBlockerEstimator);
+
+    case EstimatorType::Autocorrelation:
+        return static_cast<EstimatorFunctionPtr<double>>(AutocorrelationEstimator);
+
+    case EstimatorType::StreamingBlocker:
+    case EstimatorType::OnlineUncorrelated:
+    case EstimatorType::OnlineCovariance:
+        return PrecomputedEstimator; // the accumulator did the work already
+
+    default:
+        throw std::domain_error("[createEstimator] Unhandled estimator enumerator.");
+    }
+}
+
+inline std::function<void(int64_t, int, const double[], double[], double[])> createEstimator(const bool flag_correlated,
+                                                                                             const bool flag_error = true)
+{
+    return createEstimator(selectEstimatorType(flag_correlated, flag_error));
+}
+
+// Estimator functions for reduced-precision samples (T = float or int16_t, see ReducedStorage.hpp),
+// i.e. for all estimators that work on stored samples
+template <class T>
+inline EstimatorFunctionPtr<T> createReducedEstimator(EstimatorType estimType)
 {
     switch (estimType) {
     case EstimatorType::Noop:
@@ -89,15 +146,74 @@ createEstimator(EstimatorType estimType /*from Estimators enumeration*/)
     case EstimatorType::MJBlocker:
         return MJBlockerEstimator;
 
+    case EstimatorType::Autocorrelation:
+        return AutocorrelationEstimator;
+
     default:
-        throw std::domain_error("[createEstimator] Unhandled estimator enumerator.");
+        throw std::invalid_argument("[createReducedEstimator] Estimator does not work on stored samples.");
     }
 }
 
-inline std::function<void(int64_t, int, const double[], double[], double[])> createEstimator(const bool flag_correlated,
-                                                                                             const bool flag_error = true)
+// Estimator functions working on the dimension slice [j0, j1) of the samples (see Estimators.hpp), used for
+// thread-parallel estimation. Returns nullptr for estimators which are not split (i.e. which don't need to be, or
+// which have additional results, like the autocorrelation times of EstimatorType::Autocorrelation).
+template <class T>
+using SliceEstimatorFunctionPtr = void (*)(int64_t/*nstore*/, int/*nobs*/, const T[]/*data*/, int/*j0*/, int/*j1*/, double[]/*avg*/, double[]/*error*/);
+
+template <class T>
+inline SliceEstimatorFunctionPtr<T> createSliceEstimator(EstimatorType estimType)
 {
-    return createEstimator(selectEstimatorType(flag_correlated, flag_error));
+    switch (estimType) {
+    case EstimatorType::Uncorrelated:
+        return UncorrelatedEstimatorSlice<T>;
+
+    case EstimatorType::Correlated:
+        return CorrelatedEstimatorSlice<T>;
+
+    case EstimatorType::FCBlocker:
+        return FCBlockerEstimatorSlice<T>;
+
+    case EstimatorType::MJBlocker:
+        return MJBlockerEstimatorSlice<T>;
+
+    default:
+        return nullptr;
+    }
+}
+
+// create the accumulator matching the chosen estimator (i.e. the estimators computed during accumulation need their own)
+// and storage precision (reduced precision is supported by accumulators storing samples, i.e. blocksize > 0)
+inline std::unique_ptr<AccumulatorInterface> createAccumulator(ObservableFunctionInterface &obs, int blocksize, int nskip, EstimatorType estimType,
+                                                               StoragePrecision precision = StoragePrecision::Double)
+{
+    if (precision != StoragePrecision::Double) {
+        if (blocksize < 1 || estimType == EstimatorType::StreamingBlocker || estimType == EstimatorType::OnlineUncorrelated
+            || estimType == EstimatorType::OnlineCovariance) {
+            throw std::invalid_argument("[createAccumulator] Reduced storage precision requires blocksize > 0 and an estimator on stored samples.");
+        }
+        nskip = std::max(1, nskip);
+        if (blocksize == 1) {
+            return std::unique_ptr<AccumulatorInterface>(new FullAccumulator(obs, nskip, false, precision));
+        }
+        return std::unique_ptr<AccumulatorInterface>(new BlockAccumulator(obs, nskip, blocksize, precision));
+    }
+
+    switch (estimType) {
+    case EstimatorType::StreamingBlocker:
+        if (blocksize < 1) { throw std::invalid_argument("[createAccumulator] StreamingBlocker estimator requires blocksize > 0."); }
+        return std::unique_ptr<AccumulatorInterface>(new StreamingBlockAccumulator(obs, std::max(1, nskip), blocksize));
+
+    case EstimatorType::OnlineUncorrelated:
+        if (blocksize < 1) { throw std::invalid_argument("[createAccumulator] OnlineUncorrelated estimator requires blocksize > 0."); }
+        return std::unique_ptr<AccumulatorInterface>(new WelfordAccumulator(obs, std::max(1, nskip), blocksize));
+
+    case EstimatorType::OnlineCovariance:
+        if (blocksize < 1) { throw std::invalid_argument("[createAccumulator] OnlineCovariance estimator requires blocksize > 0."); }
+        return std::unique_ptr<AccumulatorInterface>(new CovarianceAccumulator(obs, std::max(1, nskip), blocksize));
+
+    default:
+        return createAccumulator(obs, blocksize, nskip);
+    }
 }
 
 
@@ -144,6 +260,18 @@ static constexpr std::initializer_list<SRRDType> list_all_SRRDType = {SRRDType::
 
 static constexpr double DEFAULT_MRT2STEP = 0.05; // step size default to fall-back to
 
+// Up to these sizes, the factories below dispatch into compile-time dimension
+// variants (FixedSRRDAllMove, FixedSRRDVecMove and FixedOrthoPeriodicDomain)
+static constexpr int MAX_FIXED_NDIM = 12; // for all-index moves and domains
+static constexpr int MAX_FIXED_VECLEN = 3; // for vector moves
+
+// create a fixed-dimension all-index move with single step size (1 <= ndim <= MAX_FIXED_NDIM)
+// NOTE: The fixed-dimension factories are defined in Factories.cpp, to instantiate the templates only once.
+std::unique_ptr<TrialMoveInterface> createFixedSRRDAllMove(SRRDType srrd, int ndim, double initStepSize = DEFAULT_MRT2STEP);
+
+// create a fixed-veclen vector move with single step size (1 <= veclen <= MAX_FIXED_VECLEN)
+std::unique_ptr<TrialMoveInterface> createFixedSRRDVecMove(SRRDType srrd, int nvecs, int veclen, double initStepSize = DEFAULT_MRT2STEP);
+
 // common sanity check
 inline void checkTrialMoveSanity(int ndim, int ntypes = 1, const int typeEnds[] = nullptr)
 {
@@ -159,6 +287,9 @@ inline std::unique_ptr<TrialMoveInterface> createSRRDAllMove(SRRDType srrd /*fro
     // some sanity
     ntypes = std::max(1, ntypes);
     checkTrialMoveSanity(ndim, ntypes, typeEnds);
+    if (ntypes == 1 && ndim <= MAX_FIXED_NDIM) { // use fixed-dim variant
+        return createFixedSRRDAllMove(srrd, ndim, DEFAULT_MRT2STEP);
+    }
 
     // create chosen move
     switch (srrd) {
@@ -197,6 +328,9 @@ inline std::unique_ptr<TrialMoveInterface> createSRRDVecMove(SRRDType srrd /*fro
     veclen = std::max(1, veclen);
     ntypes = std::max(1, ntypes);
     checkTrialMoveSanity(nvecs*veclen, ntypes, typeEnds);
+    if (ntypes == 1 && veclen <= MAX_FIXED_VECLEN) { // use fixed-veclen variant
+        return createFixedSRRDVecMove(srrd, nvecs, veclen, DEFAULT_MRT2STEP);
+    }
 
     // create chosen move
     switch (srrd) {
@@ -241,6 +375,14 @@ inline std::unique_ptr<TrialMoveInterface> createMoveDefault(MoveType mtype, int
         throw std::domain_error("[createMoveDefault] Unhandled MoveType enumerator.");
     }
 }
+
+
+
+// --- Create Domains
+
+// create orthorhombic periodic domain, using FixedOrthoPeriodicDomain if ndim <= MAX_FIXED_NDIM
+std::unique_ptr<DomainInterface> createOrthoPeriodicDomain(int ndim, double lbound, double ubound);
+std::unique_ptr<DomainInterface> createOrthoPeriodicDomain(int ndim, const double lbounds[], const double ubounds[]);
 } // namespace mci
 
 #endif
@@ -0,0 +1,120 @@
+#ifndef MCI_FIXEDORTHOPERIODICDOMAIN_HPP
+#define MCI_FIXEDORTHOPERIODICDOMAIN_HPP
+
+#include "mci/DomainInterface.hpp"
+
+#include <array>
+#include <limits>
+#include <stdexcept>
+
+namespace mci
+{
+// Compile-time dimension variant of OrthoPeriodicDomain.
+// The bounds are stored inline (std::array) and all loops have the compile-time
+// bound NDIM, so that the compiler can fully unroll them. Results are identical
+// to OrthoPeriodicDomain(NDIM, ...). MCI::setIRange() and the factory function
+// createOrthoPeriodicDomain() automatically use this for ndim <= MAX_FIXED_NDIM.
+template <int NDIM>
+struct FixedOrthoPeriodicDomain final: public DomainInterface
+{
+    static_assert(NDIM > 0, "[FixedOrthoPeriodicDomain] NDIM must be at least 1.");
+
+public:
+    std::array<double, NDIM> lbounds{}; // lower boundaries
+    std::array<double, NDIM> ubounds{}; // upper boundaries
+
+protected:
+    DomainInterface * _clone() const final
+    {
+        return new FixedOrthoPeriodicDomain(lbounds.data(), ubounds.data());
+    }
+
+    void _checkBounds() const // make sure the set bounds are reasonable
+    {
+        for (int i = 0; i < NDIM; ++i) {
+            if (ubounds[i] <= lbounds[i]) {
+                throw std::invalid_argument("[FixedOrthoPeriodicDomain::checkBounds] All upper bounds must be truly greater than their corresponding lower bounds.");
+            }
+        }
+    }
+
+    void _applyPBC(double &x, const int i) const // wrap a single coordinate
+    {
+        while (x < lbounds[i]) {
+            x += ubounds[i] - lbounds[i];
+        }
+        while (x > ubounds[i]) {
+            x -= ubounds[i] - lbounds[i];
+        }
+    }
+
+public:
+    explicit FixedOrthoPeriodicDomain(double l_bound = -domain_conv::infinity, // use the infinity conventions
+                                      double u_bound = domain_conv::infinity):
+            DomainInterface(NDIM)
+    {
+        lbounds.fill(l_bound);
+        ubounds.fill(u_bound);
+        this->_checkBounds();
+    }
+
+    FixedOrthoPeriodicDomain(const double l_bounds[], const double u_bounds[]): // use arrays to set bounds
+            DomainInterface(NDIM)
+    {
+        std::copy(l_bounds, l_bounds + NDIM, lbounds.begin());
+        std::copy(u_bounds, u_bounds + NDIM, ubounds.begin());
+        this->_checkBounds();
+    }
+
+    ~FixedOrthoPeriodicDomain() final = default;
+
+    // apply PBC to full x
+    void applyDomain(double x[]) const final
+    {
+        for (int i = 0; i < NDIM; ++i) { this->_applyPBC(x[i], i); }
+    }
+
+    // apply PBC to updated walkerstate
+    void applyDomain(WalkerState &wlk) const final
+    {
+        if (wlk.nchanged == NDIM) { // all-index move (changedIdx may be invalid)
+            this->applyDomain(wlk.xnew);
+        }
+        else {
+            for (int i = 0; i < wlk.nchanged; ++i) {
+                const int idx = wlk.changedIdx[i];
+                this->_applyPBC(wlk.xnew[idx], idx);
+            }
+        }
+    }
+
+    // transform normX in (0,1)^N to true box coordinates
+    void scaleToDomain(double normX[]) const final
+    {
+        for (int i = 0; i < NDIM; ++i) {
+            normX[i] = lbounds[i] + normX[i]*(ubounds[i] - lbounds[i]);
+        }
+    }
+
+    // fill with ubound - lbound
+    void getSizes(double dimSizes[]) const final
+    {
+        for (int i = 0; i < NDIM; ++i) {
+            dimSizes[i] = ubounds[i] - lbounds[i];
+        }
+    }
+
+    // volume is product of dimension lengths
+    double getVolume() const final
+    {
+        double vol = 1.;
+        for (int i = 0; i < NDIM; ++i) {
+            vol *= (ubounds[i] - lbounds[i]);
+        }
+        return vol;
+    }
+};
+} // namespace mci
+
+
+#endif
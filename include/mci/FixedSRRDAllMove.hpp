@@ -0,0 +1,84 @@
+#ifndef MCI_FIXEDSRRDALLMOVE_HPP
+#define MCI_FIXEDSRRDALLMOVE_HPP
+
+#include "mci/TrialMoveInterface.hpp"
+
+#include <random>
+#include <stdexcept>
+
+namespace mci
+{
+// Compile-time dimension variant of SRRDAllMove, restricted to a single
+// step size (i.e. ntypes=1). The move loop has the compile-time bound NDIM
+// and can be fully unrolled. Given the same random generator state, the
+// proposed moves are identical to SRRDAllMove<SRRD>(NDIM, initStepSize).
+// The factory createSRRDAllMove() automatically uses this for ntypes=1 and
+// ndim <= MAX_FIXED_NDIM (see Factories.hpp).
+//
+template <class SRRD /*see SRRDAllMove.hpp*/, int NDIM>
+class FixedSRRDAllMove final: public TrialMoveInterface
+{
+    static_assert(NDIM > 0, "[FixedSRRDAllMove] NDIM must be at least 1.");
+
+private:
+    SRRD _rd; // real-valued random distribution for move
+    double _stepSize; // the single step size
+
+    TrialMoveInterface * _clone() const final
+    {
+        return new FixedSRRDAllMove(_stepSize, &_rd);
+    }
+
+    // not used, make final for that extra performance
+    void _newToOld() final {}
+    void _oldToNew() final {}
+
+public:
+    explicit FixedSRRDAllMove(double initStepSize, const SRRD * rdist = nullptr):
+            TrialMoveInterface(NDIM, 0),
+            _rd((rdist != nullptr) ? *rdist : createSymRRD<SRRD>() /*fall-back*/ ), _stepSize(initStepSize) {}
+
+    // Methods required for auto-calibration
+    int getNStepSizes() const final { return 1; }
+    void setStepSize(int/*i*/, double val) final { _stepSize = val; }
+    double getStepSize(int/*i*/) const final { return _stepSize; }
+    double getChangeRate() const final { return 1.; } // all indices change
+    bool supportsEnsemble() const final { return true; }
+
+    void resetRandomCache() final { resetRandomDistribution(_rd); }
+    void writeRandomCache(std::ostream &os) const final { writeRandomDistribution(os, _rd); }
+    void readRandomCache(std::istream &is) final { readRandomDistribution(is, _rd); }
+
+    int getStepSizeIndex(int xidx) const final
+    {
+        if (xidx < NDIM) { return 0; }
+        throw std::runtime_error("[FixedSRRDAllMove::getStepSizeIndex] Passed xidx exceeds expected range.");
+    }
+
+
+    void protoFunction(const double/*in*/[], double/*protovalues*/[]) final {} // not needed
+
+    double trialMove(WalkerState &wlk, const double/*protoold*/[], double/*protonew*/[]) final
+    {
+        double * const xnew = wlk.xnew;
+        for (int i = 0; i < NDIM; ++i) {
+            xnew[i] += _stepSize*_rd(*_rgen);
+        }
+        wlk.nchanged = NDIM; // if we changed all, we don't need to fill changedIdx
+
+        return 1.; // symmetric distribution -> no move acceptance factor
+    }
+};
+
+// Instantiations for the most common distributions
+template <int NDIM>
+using FixedUniformAllMove = FixedSRRDAllMove<std::uniform_real_distribution<double>, NDIM>;
+template <int NDIM>
+using FixedGaussianAllMove = FixedSRRDAllMove<std::normal_distribution<double>, NDIM>;
+template <int NDIM>
+using FixedPooledUniformAllMove = FixedSRRDAllMove<PooledUniformRD, NDIM>;
+template <int NDIM>
+using FixedPooledGaussianAllMove = FixedSRRDAllMove<PooledNormalRD, NDIM>;
+} // namespace mci
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef MCI_FIXEDSRRDVECMOVE_HPP
+#define MCI_FIXEDSRRDVECMOVE_HPP
+
+#include "mci/TrialMoveInterface.hpp"
+
+#include <random>
+#include <stdexcept>
+
+namespace mci
+{
+// Compile-time vector length variant of SRRDVecMove, restricted to a single
+// step size (i.e. ntypes=1). The number of vectors stays a runtime value,
+// but the per-vector move loop has the compile-time bound VECLEN and there
+// is no type lookup. Given the same random generator state, the proposed moves
+// are identical to SRRDVecMove<SRRD>(nvecs, VECLEN, initStepSize).
+// The factory createSRRDVecMove() automatically uses this for ntypes=1 and
+// veclen <= MAX_FIXED_VECLEN (see Factories.hpp).
+//
+template <class SRRD /*see SRRDAllMove.hpp*/, int VECLEN>
+class FixedSRRDVecMove final: public TrialMoveInterface
+{
+    static_assert(VECLEN > 0, "[FixedSRRDVecMove] VECLEN must be at least 1.");
+
+private:
+    const int _nvecs{}; // how many vectors/particles are considered
+    std::uniform_int_distribution<int> _rdidx; // uniform integer distribution to choose vector index
+    SRRD _rdmov; // symmetric double-typed distribution to move vector
+    double _stepSize; // the single step size
+
+    TrialMoveInterface * _clone() const final
+    {
+        return new FixedSRRDVecMove(_nvecs, _stepSize, &_rdmov);
+    }
+
+    // not used, make final for that extra performance
+    void _newToOld() final {}
+    void _oldToNew() final {}
+
+public:
+    FixedSRRDVecMove(int nvecs, double initStepSize, const SRRD * rdist = nullptr):
+            TrialMoveInterface(nvecs*VECLEN, 0), _nvecs(nvecs),
+            _rdidx(std::uniform_int_distribution<int>(0, _nvecs - 1)),
+            _rdmov((rdist != nullptr) ? *rdist : createSymRRD<SRRD>() /*fall-back*/ ), _stepSize(initStepSize)
+    {
+        if (_nvecs < 1) { throw std::invalid_argument("[FixedSRRDVecMove] Number of vectors must be at least 1."); }
+    }
+
+    // Methods required for auto-calibration
+    int getNStepSizes() const final { return 1; }
+    void setStepSize(int/*i*/, double val) final { _stepSize = val; }
+    double getStepSize(int/*i*/) const final { return _stepSize; }
+    double getChangeRate() const final { return 1./_nvecs; }
+    bool supportsEnsemble() const final { return true; }
+
+    void resetRandomCache() final
+    {
+        _rdidx.reset();
+        resetRandomDistribution(_rdmov);
+    }
+    void writeRandomCache(std::ostream &os) const final
+    {
+        os << _rdidx << ' ';
+        writeRandomDistribution(os, _rdmov);
+    }
+    void readRandomCache(std::istream &is) final
+    {
+        is >> _rdidx;
+        readRandomDistribution(is, _rdmov);
+    }
+
+    int getStepSizeIndex(int xidx) const final
+    {
+        if (xidx < _ndim) { return 0; }
+        throw std::runtime_error("[FixedSRRDVecMove::getStepSizeIndex] Passed xidx exceeds expected range.");
+    }
+
+
+    void protoFunction(const double/*in*/[], double/*protovalues*/[]) final {} // not needed
+
+    double trialMove(WalkerState &wlk, const double/*protoold*/[], double/*protonew*/[]) final
+    {
+        const int xidx = _rdidx(*_rgen)*VECLEN; // first x index to change
+        double * const xnew = wlk.xnew + xidx;
+        for (int i = 0; i < VECLEN; ++i) {
+            xnew[i] += _stepSize*_rdmov(*_rgen);
+            wlk.changedIdx[i] = xidx + i;
+        }
+        wlk.nchanged = VECLEN; // how many indices we changed
+
+        return 1.; // symmetric distribution -> no move acceptance factor
+    }
+};
+
+// Instantiations for the most common distributions
+template <int VECLEN>
+using FixedUniformVecMove = FixedSRRDVecMove<std::uniform_real_distribution<double>, VECLEN>;
+template <int VECLEN>
+using FixedGaussianVecMove = FixedSRRDVecMove<std::normal_distribution<double>, VECLEN>;
+template <int VECLEN>
+using FixedPooledUniformVecMove = FixedSRRDVecMove<PooledUniformRD, VECLEN>;
+template <int VECLEN>
+using FixedPooledGaussianVecMove = FixedSRRDVecMove<PooledNormalRD, VECLEN>;
+} // namespace mci
+
+#endif
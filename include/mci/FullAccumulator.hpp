@@ -3,35 +3,93 @@
 
 #include "mci/AccumulatorInterface.hpp"
 
+#include <cstddef>
+#include <memory>
+#include <string>
+
 namespace mci
 {
 // Class to handle accumulation of observables, when storing every single sample is desired
 // Typically you want this for automatic blocking techniques after the sampling run
 //
-// NOTE: If the dimension of the observable is very large, consider using BlockAccumulator
+// NOTE 1: If the dimension of the observable is very large, consider using BlockAccumulator
 // or SimpleAccumulator (if no error is required) instead, because the memory requirements
 // of the FullAccumulator may become very large with a large number of MC steps.
 //
+// NOTE 2: With run-length storage (optional, see setRunLengthStorage, used with a single walker), consecutive
+// identical samples (i.e. from rejected steps) are stored only once, together with their multiplicity (see
+// RunLengthStorage.hpp). The samples are never expanded: estimators read the runs from getRunLengthData()
+// with bit-identical results, and getData() returns nullptr. This takes less memory than plain storage if
+// less than nobs/(nobs + 1) of the steps are accepted (e.g. less than half for one-dimensional observables).
+//
+// NOTE 3: With a mapped storage directory set (see setMappedStorageDir), the samples are stored in a
+// memory-mapped temporary file in that directory instead of RAM (POSIX only). The file is removed right
+// after creation and hinted for sequential access, so the OS can page it out behind the sampling loop,
+// and estimators read the samples from the mapping. This allows runs with more samples than fit into RAM.
+// For that, MCI replaces MJBlocker (i.e. also the default Correlated estimator) by StreamingBlockerEstimator
+// on mapped samples, which agrees up to rounding (note that Autocorrelation still needs RAM for every sample).
+// Run-length storage is not used in that case.
+//
+// NOTE 4: With reduced storage precision (see ReducedStorage.hpp), samples are stored as float or int16 in RAM
+// and estimators read them from getReducedData(). Neither run-length nor mapped storage are used in that case.
+//
 class FullAccumulator final: public AccumulatorInterface
 {
 protected:
+    bool _flag_runlength; // use run-length storage if possible?
+    bool _flag_rle; // is run-length storage used in the current allocation?
+    std::string _mapdir; // directory for memory-mapped storage (empty -> RAM)
+    bool _flag_mapped; // is _data a memory-mapped file in the current allocation?
     int64_t _nstore; // number of allocated storage elements with _nobs length each
     int64_t _storeidx; // storage index offset for next write
 
+    RunLengthStorage _runs; // run-length storage (only used if _flag_rle)
+
+    const std::unique_ptr<ReducedStorage> _rstore; // reduced precision storage (nullptr for double precision)
+
+    void _mapData(); // create the temporary file and map it to _data
+    void _unmapData();
+
     // --- storage method to be implemented
     void _allocate() final;
     void _accumulate() final;
-    void _finalize() final {} // nothing to do
+    void _finalize() final;
     void _reset() final;
     void _deallocate() final;
+    void _writeData(std::ostream &os) const final;
+    void _readData(std::istream &is) final;
+    int64_t _getNFixedRows() const final;
+    int64_t _getRowsVersion() const final { return _rstore ? _rstore->getNRequant() : 0; }
+    void _writeRows(std::ostream &os, int64_t row0, int64_t row1) const final;
+    void _readRows(std::istream &is, int64_t row0, int64_t row1) final;
+    void _merge(const AccumulatorInterface &other) final;
+    void _serialize(std::ostream &os) const final;
+    void _deserialize(std::istream &is) final;
 
 public:
-    FullAccumulator(ObservableFunctionInterface &obs, int nskip):
-            AccumulatorInterface(obs, nskip), _nstore(0), _storeidx(0) {}
+    FullAccumulator(ObservableFunctionInterface &obs, int nskip, bool flag_runlength = false, StoragePrecision precision = StoragePrecision::Double):
+            AccumulatorInterface(obs, nskip), _flag_runlength(flag_runlength), _flag_rle(false), _flag_mapped(false), _nstore(0), _storeidx(0),
+            _runs(_nobs), _rstore((precision != StoragePrecision::Double) ? new ReducedStorage(precision, _nobs) : nullptr) {}
 
     ~FullAccumulator() final { this->_deallocate(); }
 
     int64_t getNStore() const final { return _nstore; }
+    const ReducedStorage * getReducedData() const final { return _rstore.get(); }
+    const RunLengthStorage * getRunLengthData() const final { return _flag_rle ? &_runs : nullptr; }
+    StoragePrecision getStoragePrecision() const { return _rstore ? _rstore->precision : StoragePrecision::Double; }
+
+    // store samples in memory-mapped temporary files in dir (empty -> RAM), used from next allocate() on
+    void setMappedStorageDir(const std::string &dir) { _mapdir = dir; }
+    const std::string &getMappedStorageDir() const { return _mapdir; }
+
+    // store repeated samples as runs (with a single walker, in RAM and double precision), used from next allocate() on
+    void setRunLengthStorage(bool flag_runlength) { _flag_runlength = flag_runlength; }
+    bool getRunLengthStorage() const { return _flag_runlength; }
+
+    bool usesMappedStorage() const { return _flag_mapped; }
+    bool usesRunLength() const { return _flag_rle; }
+    int64_t getNRuns() const { return _runs.getNRuns(); } // number of stored runs (if usesRunLength())
+    size_t getNBytes() const; // bytes held for the samples of the current allocation (in RAM or mapped)
 };
 }  // namespace mci
 
@@ -0,0 +1,65 @@
+#ifndef MCI_HISTOGRAMACCUMULATOR_HPP
+#define MCI_HISTOGRAMACCUMULATOR_HPP
+
+#include "mci/AccumulatorInterface.hpp"
+#include "mci/HistogramObservable.hpp"
+
+#include <memory>
+#include <stdexcept>
+
+namespace mci
+{
+// Class to handle accumulation of histogram observables (see HistogramObservable.hpp), in blocks of fixed size.
+// Instead of the dense histogram of every step, only the hit bins are evaluated and added to the histogram of
+// the current block, i.e. the cost per step is proportional to the number of hits. The stored block histograms
+// are the block averages of the dense histogram (like with BlockAccumulator), so that any estimator on stored
+// samples yields averages and blocking errors per bin. With blocksize 0, all steps form a single block (no error).
+//
+// NOTE 1: The planned number of steps must be a multiple of the chosen blocksize (if > 0).
+// NOTE 2: In ensemble mode (nwalkers > 1), the dense histograms are evaluated and averaged over walkers instead.
+class HistogramAccumulator final: public AccumulatorInterface
+{
+protected:
+    HistogramObservable &_histobs;
+    const int _blocksize; // how many samples to accumulate per block (0 -> all)
+    int64_t _nblocks; // this will be set properly on allocation
+    int64_t _nblocksize; // blocksize of the current allocation
+
+    int64_t _bidx; // counter to determine when block is finished
+    int64_t _storeidx; // storage index offset for next write
+
+    // hits of the last evaluation (single walker), also used to zero the last values before the next
+    const std::unique_ptr<int[]> _bins;
+    const std::unique_ptr<double[]> _weights;
+    int _nhits;
+
+    void _evaluate(const double in[], double values[]) final;
+
+    // --- storage method to be implemented
+    void _allocate() final;
+    void _accumulate() final;
+    void _finalize() final;
+    void _reset() final;
+    void _deallocate() final;
+    void _writeData(std::ostream &os) const final;
+    void _readData(std::istream &is) final;
+    void _merge(const AccumulatorInterface &other) final;
+    void _serialize(std::ostream &os) const final;
+    void _deserialize(std::istream &is) final;
+
+public:
+    HistogramAccumulator(HistogramObservable &obs, int nskip, int blocksize):
+            AccumulatorInterface(obs, nskip, true), _histobs(obs), _blocksize(blocksize), _nblocks(0), _nblocksize(0),
+            _bidx(0), _storeidx(0), _bins(new int[obs.getMaxHits()]), _weights(new double[obs.getMaxHits()]), _nhits(0)
+    {
+        if (_blocksize < 0) { throw std::invalid_argument("[HistogramAccumulator] Requested blocksize was < 0 ."); }
+    }
+
+    ~HistogramAccumulator() final { this->_deallocate(); }
+
+    int getBlockSize() const { return _blocksize; }
+    int64_t getNStore() const final { return _nblocks; }
+};
+}  // namespace mci
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef MCI_HISTOGRAMOBSERVABLE_HPP
+#define MCI_HISTOGRAMOBSERVABLE_HPP
+
+#include "mci/ObservableFunctionInterface.hpp"
+
+#include <vector>
+
+namespace mci
+{
+// Base class for MC observables which are distributions (histograms), e.g. radial densities
+//
+// Derive from this and implement the histogramFunction() method, which reports only the bins that
+// are hit by a walker position, together with their weights. The observable values are the nbins
+// histogram bins, i.e. values[bin] is the sum of weights hitting bin. MCI accumulates histogram
+// observables with a HistogramAccumulator (see HistogramAccumulator.hpp), which never evaluates the
+// dense histogram, so the cost per step is proportional to the number of hits instead of nbins.
+// Like for ObservableFunctionInterface, you have to provide the protected _clone() method.
+//
+// NOTE: Selective updating (see ObservableFunctionInterface) is not supported for histograms.
+//
+class HistogramObservable: public ObservableFunctionInterface
+{
+protected:
+    const int _maxhits; // maximal number of hits per evaluation
+
+    // buffers used by observableFunction()
+    std::vector<int> _hbins;
+    std::vector<double> _hweights;
+
+    HistogramObservable(int ndim, int nbins, int maxhits);
+
+public:
+    int getNBins() const { return _nobs; }
+    int getMaxHits() const { return _maxhits; }
+
+    // --- METHOD THAT MUST BE IMPLEMENTED
+    // Compute the hits of walker position in, i.e. store bin indices (in [0, nbins)) in bins and their weights in weights,
+    // and return the number of hits (at most getMaxHits()). The same bin may be hit several times.
+    virtual int histogramFunction(const double in[], int bins[], double weights[]) = 0;
+    //                           ^walker position   ^hit bins  ^hit weights (both of length getMaxHits())
+
+    // call histogramFunction() and check the returned hits (throws std::out_of_range)
+    int computeHits(const double in[], int bins[], double weights[]);
+
+    // the dense histogram, i.e. out[bin] is the sum of weights hitting bin (used by other accumulators)
+    void observableFunction(const double in[], double out[]) final;
+};
+}  // namespace mci
+
+#endif
@@ -6,17 +6,26 @@
 #include "mci/Factories.hpp"
 #include "mci/ObservableContainer.hpp"
 #include "mci/ObservableFunctionInterface.hpp"
+#include "mci/RandomGenerator.hpp"
+#include "mci/RandomPool.hpp"
 #include "mci/SamplingFunctionContainer.hpp"
 #include "mci/SamplingFunctionInterface.hpp"
+#include "mci/TrajectoryWriter.hpp"
 #include "mci/TrialMoveInterface.hpp"
+#include "mci/WalkerEnsemble.hpp"
 #include "mci/WalkerState.hpp"
 
 
 #include <cstdint>
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <istream>
 #include <memory>
+#include <ostream>
 #include <random>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace mci
@@ -30,11 +39,13 @@ private:
 
     // Random
     std::random_device _rdev;
-    std::mt19937_64 _rgen;
+    RandomGenerator _rgen; // engine chosen at build time, see RandomGenerator.hpp
     std::uniform_real_distribution<double> _rd; // used to decide on acceptance (and for full random moves)
+    PooledUniformRD _rdpool; // used instead of _rd in random pool mode
 
     // Main objects/vectors/containers
     WalkerState _wlkstate; // holds the current walker state (xold/xnew), including move information
+    std::unique_ptr<WalkerEnsemble> _wlkens; // holds the walker ensemble used in ensemble mode (init: nullptr)
     std::unique_ptr<DomainInterface> _domain; // holds the integration domain (init: unbound)
     std::unique_ptr<TrialMoveInterface> _trialMove; // holds the object to perform walker moves (init: uniform all-move)
     SamplingFunctionContainer _pdfcont; // sampling function container (init: empty)
@@ -45,18 +56,43 @@ private:
     int _NfindMRT2Iterations; // how many MRT2 step adjustment iterations to do before integrating
     int64_t _NdecorrelationSteps; // how many decorrelation steps to do before integrating
     double _targetaccrate; // desired acceptance ratio
+    bool _flaglogacc; // use log-domain acceptance with early rejection?
+    bool _flagpool; // draw uniforms in bulk from _rdpool?
+    int _nwalkers; // number of walkers used during integration (ensemble mode if > 1)
+    bool _flagensinit; // was the walker ensemble spawned already?
+    std::vector<double> _ensacc; // per-walker move and pdf acceptances of the last ensemble step (length 2*_nwalkers)
+    int _nestimthreads; // number of threads used to evaluate the estimators after sampling
+    std::vector<double> _covavg; // averages of the EstimatorType::OnlineCovariance observables, from the last integrate()
+    std::vector<double> _covmat; // their covariance matrix (of the averages)
 
     // File-I/O parameters:
     // observables
     std::ofstream _obsfile; //ofstream for storing obs values while sampling
+    std::unique_ptr<TrajectoryWriter> _obswriter; // used instead of _obsfile for binary format
     std::string _pathobsfile;
     int _freqobsfile{};
+    FileFormat _fmtobsfile{};
     bool _flagobsfile; // should write an output file with sampled obs values?
     // walkers
-    std::ofstream _wlkfile; //ofstream for storing obs values while sampling
+    std::ofstream _wlkfile; //ofstream for storing walker positions while sampling
+    std::unique_ptr<TrajectoryWriter> _wlkwriter; // used instead of _wlkfile for binary format
     std::string _pathwlkfile;
     int _freqwlkfile{};
-    bool _flagwlkfile; // should write an output file with sampled obs values?
+    FileFormat _fmtwlkfile{};
+    bool _flagwlkfile; // should write an output file with walker positions?
+    // checkpoints
+    std::string _pathckpfile;
+    int64_t _freqckpfile{};
+    bool _flagckpfile; // should write checkpoints periodically during integration?
+    std::thread _ckpthread; // background thread writing the last checkpoint
+    std::exception_ptr _ckperror; // error of the background write, rethrown on join
+    std::vector<int64_t> _ckprows; // number of rows per accumulator in the current rows file (empty -> start a new one)
+    int64_t _ckpgen{}; // generation of the current rows file
+    int64_t _ckpbytes{}; // bytes written to the current rows file
+    int64_t _ckpversion{}; // rows version of the observables when the current rows file was started
+    std::string _ckprowspath; // rows file of the last written or loaded checkpoint
+    int64_t _nmcrun{}; // number of MC steps of the integration in progress (0 if none)
+    int64_t _nmcresume{}; // number of MC steps of the integration restored by loadCheckpoint() (0 if none)
 
     // internal counters
     // NOTE: All integers are int, except if they are directly counting MC steps (int64_t then)
@@ -69,29 +105,56 @@ private:
 
     // these are used before sampling
     void findMRT2Step();
-    void initialDecorrelation();
+    int64_t initialDecorrelation(); // returns the number of MC steps used for decorrelation
 
     // prepare new sampling run
     void initializeSampling(ObservableContainer * obsCont /*optional*/);
+    void initializeEnsembleSampling(ObservableContainer * obsCont /*optional*/); // same in ensemble mode
+
+    // uniform random number in [0, 1) for acceptance
+    double drawUniform() { return _flagpool ? _rdpool(_rgen) : _rd(_rgen); }
+    void drawUniform(double x[]); // the same, for all x[0..ndim-1]
 
     // if there is a pdf, performs move and decides acc/rej
     void doStepMRT2();
     // else we use this to sample randomly (mostly for testing/examples)
     void doStepRandom();
+    // the same for all walkers of the ensemble, processed phase by phase
+    void doStepMRT2Ensemble();
+    void doStepRandomEnsemble();
+
+    // the parts of integrate(): sampling, which leaves the finalized accumulation in _obscont (if Nmc > 0),
+    // and estimation on it (including volume scaling and the covariance of OnlineCovariance observables)
+    void sampleIntegration(int64_t Nmc, bool doFindMRT2step, bool doDecorrelation);
+    void estimateIntegration(double average[], double error[]);
 
     // sample without taking data
     void sample(int64_t npoints);
     // fill data with samples and do things like file output, if flagMC (i.e. main sampling)
     void sample(int64_t npoints, ObservableContainer &container, bool flagMC);
+    // the same in ensemble mode (no data taken if container is nullptr)
+    void sampleEnsemble(int64_t npoints, ObservableContainer * container /*optional*/, bool flagMC);
 
 
     // store to file
+    void openFiles(bool append); // open the enabled output files before main sampling (append when resuming)
+    void closeFiles(); // flush and close them afterwards
     void storeObservables();
     void storeWalkerPositions();
 
+    // checkpoints
+    // state to continue at step ridx of an nmc steps run, with the stored rows included (rowsgen < 0) or in a rows file
+    void writeCheckpoint(std::ostream &file, int64_t ridx, int64_t nmc, int64_t rowsgen = -1, int64_t rowsbytes = 0) const;
+    void readCheckpoint(std::istream &file, const std::string &filepath);
+    void storeCheckpoint(int64_t nmc); // checkpoint after the current step of main sampling, written incrementally in background
+    void joinCheckpointWriter(); // wait for the background write (and rethrow its error)
+
+    // create an independent MCI with cloned setup (domain, move, pdfs, obs, settings and walker position)
+    std::unique_ptr<MCI> createWorkerClone(uint_fast64_t seed) const; // used by integrateParallel()
+
 public:
     explicit MCI(int ndim);  //Constructor, need the number of dimensions
-    ~MCI() = default;  // Destructor (empty)
+    ~MCI();  // Destructor (waits for background checkpoint writes)
 
     // --- Setters
 
@@ -122,6 +185,51 @@ public:
         _NdecorrelationSteps = nsteps;
     }
 
+    // - log-acceptance mode
+    // Decide on acceptance in log-domain, drawing the uniform random number before evaluating the sampling
+    // functions. These are evaluated in order of addition and the remaining ones are skipped as soon as rejection
+    // is certain (requires sampling functions that provide bounds, see SamplingFunctionInterface::maxLogAcceptance).
+    void setUseLogAcceptance(bool flag_logacc) { _flaglogacc = flag_logacc; }
+
+    // - random pool mode
+    // Draw the uniform random numbers for acceptance (and for random sampling without sampling function) in bulk
+    // from a RandomPool (see RandomPool.hpp). To use pooled variates for moves too, set e.g. a PooledUniformAllMove.
+    // NOTE: This changes the random sequence for a given seed.
+    void setUseRandomPool(bool flag_pool);
+
+    // - ensemble mode
+    // Use nwalkers independent walkers during integration, which are advanced together on every MC step.
+    // Observables are averaged over walkers on every step, i.e. Nmc steps yield Nmc*nwalkers samples.
+    // The walkers are spawned from the (decorrelated) main walker and decorrelated from each other by as
+    // many ensemble steps as the main walker decorrelation took.
+    // Step sizes are calibrated on the main walker, so getX() does not change during ensemble sampling.
+    // NOTE: Dependent observables are not supported in ensemble mode (i.e. nwalkers > 1). All sampling functions
+    // and the trial move must support it (see ProtoFunctionInterface::supportsEnsemble()), else we throw.
+    void setNWalkers(int nwalkers /*1 -> default single walker mode*/);
+
+    // - disk-backed sample storage
+    // Observables storing every sample (blocksize 1) keep them in memory-mapped temporary files in dir, instead of RAM,
+    // which allows full-sample error estimation for runs larger than memory (see FullAccumulator.hpp, POSIX only).
+    void setSampleStorageDir(const std::string &dir /*empty -> default storage in RAM*/) { _obscont.setMappedStorageDir(dir); }
+
+    // - persistent sample storage
+    // Keep the sample/block storage of the observables in one contiguous arena (see StorageArena.hpp) which persists
+    // across integrate() calls and only grows when needed, instead of allocating and freeing it on every call.
+    // Recommended for many calls of integrate() with small Nmc. The memory is kept until the mode is disabled.
+    void setUsePersistentStorage(bool flag_persistent) { _obscont.setPersistentStorage(flag_persistent); }
+
+    // - run-length sample storage
+    // Observables storing every sample (blocksize 1, double precision in RAM) store the repeated samples of rejected
+    // steps as runs, which the estimators read directly. Saves memory if the acceptance rate is below nobs/(nobs + 1),
+    // for observables of nobs dimensions (see FullAccumulator.hpp). Only used with a single walker.
+    void setUseRunLengthStorage(bool flag_runlength) { _obscont.setRunLengthStorage(flag_runlength); }
+
+    // - parallel estimation
+    // Evaluate the estimators after sampling on nthreads threads, i.e. different observables and slices of the
+    // observable dimensions are processed concurrently. The results are bit-identical to the serial evaluation.
+    // NOTE: If nthreads < 1, std::thread::hardware_concurrency() is used. Not passed on to the chains of integrateParallel().
+    void setNEstimatorThreads(int nthreads /*1 -> default serial estimation*/) { _nestimthreads = nthreads; }
+
 
     // --- Adding objects to MCI
     // Note: Objects passed by raw-ref will be cloned by MCI
@@ -132,7 +240,7 @@ public:
     std::unique_ptr<DomainInterface> resetDomain(); // reset the domain to unbound
 
     // keep walkers within these bounds during integration (using periodic boundaries)
-    // NOTE: If you use these, any prior domain will be replaced with OrthoPeriodicDomain!!
+    // NOTE: If you use these, any prior domain will be replaced with OrthoPeriodicDomain (FixedOrthoPeriodicDomain for ndim <= MAX_FIXED_NDIM)!!
     void setIRange(double lbound, double ubound); // set the same range on all dimensions
     void setIRange(const double lbounds[], const double ubounds[]);
 
@@ -167,10 +275,12 @@ public:
         this->addObservable(obs.clone(), blocksize, nskip);
     }
 
-    void addObservable(std::unique_ptr<ObservableFunctionInterface> obs, int blocksize, int nskip, bool flag_equil, EstimatorType estimType /*enum, see Factories-hpp*/);
-    void addObservable(const ObservableFunctionInterface &obs, int blocksize, int nskip, bool flag_equil, EstimatorType estimType)
+    void addObservable(std::unique_ptr<ObservableFunctionInterface> obs, int blocksize, int nskip, bool flag_equil, EstimatorType estimType /*enum, see Factories-hpp*/,
+                       StoragePrecision precision = StoragePrecision::Double /*enum, reduced precision requires blocksize > 0, see ReducedStorage.hpp*/);
+    void addObservable(const ObservableFunctionInterface &obs, int blocksize, int nskip, bool flag_equil, EstimatorType estimType,
+                       StoragePrecision precision = StoragePrecision::Double)
     {
-        this->addObservable(obs.clone(), blocksize, nskip, flag_equil, estimType);
+        this->addObservable(obs.clone(), blocksize, nskip, flag_equil, estimType, precision);
     }
 
     std::unique_ptr<ObservableFunctionInterface> popObservable(); // remove last observable (returns it for you to optionally take it back)
@@ -186,20 +296,57 @@ public:
     // Callback Function
     // Set a callback function which may read(!) const MCI after every move and do something with the data.
     // This should not be abused to somehow add MCI control logic via captured references to objects contained in MCI.
+    // In ensemble mode, it is called after every ensemble step instead (walkers via getWalkerEnsemble()).
     void setCallback(const std::function<void(const MCI &)> &cback) { _cback = cback; }
     void clearCallback() { _cback = nullptr; } // set empty callback
 
     // enable file printout to given files, with frequency freq
-    void storeObservablesOnFile(const std::string &filepath, int freq);
+    // FileFormat::Binary writes compact fixed-width records from a background thread (see TrajectoryWriter.hpp)
+    void storeObservablesOnFile(const std::string &filepath, int freq, FileFormat format = FileFormat::Text);
     void clearObservableFile();
-    void storeWalkerPositionsOnFile(const std::string &filepath, int freq);
+    void storeWalkerPositionsOnFile(const std::string &filepath, int freq, FileFormat format = FileFormat::Text);
     void clearWalkerFile();
 
+    // Checkpoints
+    // A checkpoint contains everything needed to continue sampling: random generator and distribution states,
+    // walker position(s), step sizes, counters and, if written during integration, the data accumulated so far.
+    // To restart, set up an MCI in the same way (components, settings, number of walkers) and call loadCheckpoint().
+    // If the checkpoint was written during integration (see setCheckpointFile()), the next call of integrate() must
+    // use the same Nmc and continues where the checkpoint was taken, with bit-identical results to an uninterrupted run.
+    // NOTE: Checkpoints are native binary files, specific to the platform and the RandomGenerator choice.
+    //       Own proto-value like data of sampling functions and state of dependent observables is not stored.
+    //       Trajectory files (see above) are appended to when resuming, so steps after the last checkpoint appear twice.
+    void saveCheckpoint(const std::string &filepath) const; // not during integration (use setCheckpointFile)
+    void loadCheckpoint(const std::string &filepath);
+    // During integrate, write a checkpoint every freq MC steps. It is written by a background thread
+    // and the file is replaced atomically (via rename), so it is always complete. The stored samples are
+    // appended to a second file (filepath.rowsN), so every checkpoint only writes the samples added since
+    // the previous one. Both files are needed to restart (N changes when the samples are rewritten).
+    void setCheckpointFile(const std::string &filepath, int64_t freq);
+    void clearCheckpointFile();
+
     // --- Getters
 
     int getNDim() const { return _ndim; }
     double getX(int i) const { return _wlkstate.xold[i]; }
     const double * getX() const { return _wlkstate.xold; }
+    int getNWalkers() const { return _nwalkers; }
+    bool getUseLogAcceptance() const { return _flaglogacc; }
+    bool getUseRandomPool() const { return _flagpool; }
+    const std::string &getSampleStorageDir() const { return _obscont.getMappedStorageDir(); }
+    bool getUsePersistentStorage() const { return _obscont.usesPersistentStorage(); }
+    bool getUseRunLengthStorage() const { return _obscont.usesRunLengthStorage(); }
+    int getNEstimatorThreads() const { return _nestimthreads; }
+    // integrated autocorrelation times (length getObservable(i).getNObs()) of observable i, computed by the last
+    // integrate() if the observable uses EstimatorType::Autocorrelation (else nullptr).
+    const double * getAutocorrelationTimes(int i) const { return _obscont.getAutocorrelationTimes(i); }
+    // Averages and covariance matrix of these averages (length getNCovarianceDim()^2) of all observables using
+    // EstimatorType::OnlineCovariance, with their dimensions concatenated in order of addition, computed by the last
+    // integrate() or integrateParallel() (empty if there are none)
+    int getNCovarianceDim() const { return static_cast<int>(_covavg.size()); }
+    const std::vector<double> &getCovarianceAverages() const { return _covavg; }
+    const std::vector<double> &getCovarianceMatrix() const { return _covmat; }
+    const WalkerEnsemble * getWalkerEnsemble() const { return _wlkens.get(); } // nullptr if not in ensemble mode
 
     double getMRT2Step(int i) const;
     double getTargetAcceptanceRate() const { return _targetaccrate; }
@@ -223,6 +370,28 @@ public:
 
     // Actual integrate implemention. With flags to skip the configured step adjustment/decorrelation.
     void integrate(int64_t Nmc, double average[], double error[], bool doFindMRT2step = true, bool doDecorrelation = true);
+
+    // Shared-memory parallel version of integrate, running nthreads independent Markov chains.
+    // This MCI runs the first chain, while every other thread works on an own MCI with cloned
+    // domain, trial move, sampling functions and observables (but without callback and file output).
+    // The clones are seeded from this MCI's random generator, so results are reproducible for fixed
+    // seed and nthreads. The Nmc steps are split evenly among threads (remainder goes to the first
+    // ones), so for fixed-size blocking choose Nmc as multiple of nthreads*blocksize*nskip.
+    // After sampling, the accumulated data of all chains are merged (see AccumulatorInterface::merge), i.e. the
+    // estimators run once on the samples of all chains.
+    // NOTE: If nthreads < 1, std::thread::hardware_concurrency() is used. Don't use this while MPI is initialized.
+    void integrateParallel(int nthreads, int64_t Nmc, double average[], double error[], bool doFindMRT2step = true, bool doDecorrelation = true);
+
+    // MPI version of integrate (used by MPIMCI::integrateMerged), to be called on all ranks: Every rank samples Nmc steps,
+    // then the accumulated data of all ranks are merged on rank 0, which runs the estimators, and all ranks obtain
+    // the results. If any rank fails, all ranks throw. Requires a build with MPI support (USE_MPI) and initialized MPI.
+    void integrateMPI(int64_t Nmc, double average[], double error[], bool doFindMRT2step = true, bool doDecorrelation = true);
+
+    // Estimate a derived quantity f(avg) of the averages avg[getNCovarianceDim()] of the EstimatorType::OnlineCovariance
+    // observables (see getCovarianceAverages()), e.g. a ratio avg[0]/avg[1], from the last integration. The error is
+    // propagated linearly from the covariance matrix (delta method, see DeltaMethodEstimator in Estimators.hpp), using
+    // the gradient grad[getNCovarianceDim()] of f at avg, if passed, or else central differences.
+    void estimateDerived(const std::function<double(const double[])> &f, double &average, double &error, const double grad[] = nullptr) const;
 };
 }  // namespace mci
 
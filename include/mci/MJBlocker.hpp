@@ -1,6 +1,8 @@
 #ifndef MCI_MJBLOCKER_HPP
 #define MCI_MJBLOCKER_HPP
 
+#include "mci/SampleRows.hpp"
+
 #include <array>
 #include <cmath>
 #include <cstdint>
@@ -16,52 +18,54 @@ class MJBlocker
     // processing multi-dimensional data in one pass, with data passed as a flat C-style array. The data array
     // is expected to consist of ndata blocks of ndim doubles, just like what is produced by MCI observables.
     //
-    // NOTE 1: Just like the original, this algorithm requires the number of samples, ndata, to be a power of 2.
+    // NOTE 1: Unlike the original, this algorithm does not require the number of samples, ndata, to be a power of 2.
+    //         If the number of (blocked) samples on a level is odd, the last one is dropped by the blocking transform.
+    //         The variances are still taken around the mean of all samples.
     // NOTE 2: All required intermediate arrays are allocated to const pointers on object creation and the memory
     //         is not freed until object deletion. This means that a sequence of data arrays with the same layout
     //         can be processed without any reallocation in between.
+    // NOTE 3: Every blocking level is processed in a single pass over a single working buffer, which computes
+    //         variance and lag-1 autocovariance while it writes the blocked samples in place. The first level reads
+    //         the input directly, so the buffer only needs to hold ndata/2 samples.
     //
 {
 public:
     // --- Public Consts
-    const int64_t ndata; // the number of samples, must be power of 2!
+    const int64_t ndata; // the number of samples (at least 2)
     const int ndim; // number of dimensions per sample
-    const int npow; // number of powers of 2 to go through
+    const int ldx; // stride between samples in the input (>= ndim), e.g. to process a slice of the dimensions
+    const int npow; // number of blocking levels to go through, i.e. floor(log2(ndata))
 
 private:
     // --- Internals
 
-    // arrays storing variations of input x (length ndata*ndim)
-    double * const _x; // first copy of input x
-    double * const _X; // second copy of input x
+    // working buffer for the blocked samples minus mean (length (ndata/2)*ndim)
+    double * const _x;
 
     // smaller helper arrays to be pre-allocated (length npow*ndim)
-    double * const _var; // for results of _gamma0() (variance)
-    double * const _gamma; // for results of gamma1()
-    double * const _M; // test statistics Mi
-    double * const _Msum; // cumulative sum of test statistics Mi
-
-
-    // Init
-    void _computeMean(double mean[]) const; // compute multi-dimensional mean of input x
-    void _initX(const double mean[]); // set internal _X = x - mean
+    double * const _var; // variance (gamma_h(0)) per level
+    double * const _gamma; // gamma_h(1) per level
 
-    // Operations involving the copied data
-    void _gamma0(double var[]/*part of _var*/, int64_t nred); // compute variance (gamma_h(0))
-    void _gamma1(double gamma[]/*part of _gamma*/, int64_t nred); // compute gamma_h(1)
-    int64_t _transform(const double mean[], int64_t nred); // perform blocking transform on _x and _X, return nred/2
-
-    // Post-Processing
-    void _generateM(); // performs cumulative sum of _M (and store in _M)
+    template <class R>
+    void _estimate(const R &x, double avg[], double err[]); // run the algorithm on input rows x (see SampleRows.hpp)
 
 public:
     // --- User
 
-    MJBlocker(int64_t n_data, int n_dim); // the constructor checks if ndata is power of 2 (else throw)
+    MJBlocker(int64_t n_data, int n_dim, int ld_x = 0 /*0 -> ndim*/); // the constructor checks if ndata >= 2 (else throw)
     ~MJBlocker();
 
     // Estimates average and variance of data array x, containing samples with dimension ndim
-    void estimate(const double x[], double avg[], double err[]); // arrays have flat layout (ndata*ndim)
+    void estimate(const double x[], double avg[], double err[]); // x has flat layout (ndata*ldx), avg/err have length ndim
+    void estimate(const float x[], double avg[], double err[]); // reduced-precision input (read with widening)
+    void estimate(const int16_t x[], double avg[], double err[]);
+    void estimate(const RunLengthSamples &x, double avg[], double err[]); // run-length input (read as if expanded)
+
+    // The final step of the algorithm, usable with blocking statistics obtained elsewhere (e.g. by StreamingBlocker):
+    // Given the variances var and lag-1 autocovariances gamma (both with flat layout npow*ndim, normalized by nred)
+    // of the data on the blocking levels k=0..npow-1 with nred[k] samples each (i.e. nred[k+1] = nred[k]/2),
+    // selects the level by Jonsson's test statistic and computes the error of the mean.
+    static void estimateError(int npow, int ndim, const int64_t nred[], const double var[], const double gamma[], double err[]);
 };
 } // namespace mci
 
@@ -25,6 +25,11 @@ void setSeed(mci::MCI &mci, const std::string &filename, int offset = 0); // wit
 // integrate in parallel and accumulate results
 void integrate(mci::MCI &mci, int64_t Nmc, double average[], double error[], bool doFindMRT2Step = true, bool doDecorrelation = true);
 
+// integrate in parallel, but merge the accumulated data of all processes on rank 0 before the estimators run
+// (see MCI::integrateMPI). Rank 0 holds the data of all ranks then (e.g. all samples of blocksize 1 observables),
+// which must fit into memory and into a single MPI message (2 GB).
+void integrateMerged(mci::MCI &mci, int64_t Nmc, double average[], double error[], bool doFindMRT2Step = true, bool doDecorrelation = true);
+
 // finalize MPI
 void finalize();
 } // namespace MPIMCI
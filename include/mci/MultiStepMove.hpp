@@ -67,6 +67,23 @@ public:
     void setStepSize(int i, double val) final { _trialMove->setStepSize(i, val); }
     double getChangeRate() const final { return std::min(1., _trialMove->getChangeRate()*_nsteps); } // notice we multiply by nsteps here
     int getStepSizeIndex(int xidx) const final { return _trialMove->getStepSizeIndex(xidx); }
+    bool supportsEnsemble() const final { return true; } // sub-sampling is initialized from the walker position on every move
+
+    void resetRandomCache() final
+    {
+        _rd.reset();
+        _trialMove->resetRandomCache();
+    }
+    void writeRandomCache(std::ostream &os) const final
+    {
+        os << _rd << ' ';
+        _trialMove->writeRandomCache(os);
+    }
+    void readRandomCache(std::istream &is) final
+    {
+        is >> _rd;
+        _trialMove->readRandomCache(is);
+    }
 
     // Methods used during sampling:
     void protoFunction(const double/*in*/[], double/*protov*/[]) final {} // not needed
@@ -4,13 +4,17 @@
 #include "mci/ObservableFunctionInterface.hpp"
 #include "mci/DependentObservableInterface.hpp"
 #include "mci/Factories.hpp"
+#include "mci/OnlineCovariance.hpp"
+#include "mci/WalkerEnsemble.hpp"
 #include "mci/WalkerState.hpp"
 #include "mci/SamplingFunctionContainer.hpp"
+#include "mci/StorageArena.hpp"
 
 #include <cstdint>
 #include <fstream>
 #include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace mci
@@ -33,6 +37,17 @@ class ObservableContainer
         // Estimator function used to obtain result of MC integration
         std::function<void(double [] /*avg*/, double [] /*error*/)> estim; // corresponding accumulator is already bound
 
+        // integrated autocorrelation times of the last estimate (only for EstimatorType::Autocorrelation, else nullptr)
+        std::unique_ptr<double[]> tau;
+
+        // offset of the observable's dimensions in the covariance group (only for EstimatorType::OnlineCovariance, else -1)
+        int covoffset{-1};
+
+        // settings (remembered to allow re-creation of equivalent containers)
+        int blocksize{}; // blocksize passed on creation of the accumulator
+        EstimatorType estimType{}; // type of the estimator function
+        StoragePrecision precision{}; // storage precision of the accumulator
+
         // flags
         bool flag_equil{}; // equilibrate this observable when using automatic decorrelation?
     };
@@ -42,8 +57,16 @@ private:
     std::vector<ObservableContainerElement> _cont;
     int _nobsdim{0}; // stores total dimension of contained observables
     int _nskip_PDF{0}; // stores the number of MC steps per update of the PDF dependency (i.e. call to pdf->prepareObservation(..))
+    bool _flag_dependent{false}; // does the container hold any dependent observable?
+    std::string _mapdir; // directory for memory-mapped storage of full sample accumulators (empty -> RAM)
+    bool _flag_persistent{false}; // take the accumulator data from _arena?
+    StorageArena _arena; // persistent storage of accumulator data (only used if _flag_persistent)
+    bool _flag_runlength{false}; // let single-walker FullAccumulators store runs of repeated samples?
+    int _ncovdim{0}; // total dimension of the observables using EstimatorType::OnlineCovariance
+    std::unique_ptr<OnlineCovariance> _cov; // covariance group of these observables (created on allocate())
 
-    void _setDependsOnPDF(); // set flag to "any contained depobs depends on PDF"
+    void _setDependsOnPDF(); // set flag to "any contained depobs depends on PDF" (and _flag_dependent)
+    void _prepareAllocation(); // apply storage settings and covariance group to the accumulators (before allocation)
 
 public:
     // simple getters
@@ -54,22 +77,69 @@ public:
     bool empty() const { return _cont.empty(); }
     bool hasObs() const { return !this->empty(); }
     bool dependsOnPDF() const { return _nskip_PDF != 0; }
+    bool hasDependentObs() const { return _flag_dependent; }
     int getNSkipPDF() const { return _nskip_PDF; }
 
     ObservableFunctionInterface &getObservableFunction(int i) const { return *(_cont[i].obs); }
     const AccumulatorInterface &getAccumulator(int i) const { return *(_cont[i].accu); }
     bool getFlagEquil(int i) const { return _cont[i].flag_equil; }
+    int getBlockSize(int i) const { return _cont[i].blocksize; }
+    int getNSkip(int i) const { return _cont[i].accu->getNSkip(); }
+    EstimatorType getEstimatorType(int i) const { return _cont[i].estimType; }
+    StoragePrecision getStoragePrecision(int i) const { return _cont[i].precision; }
+    const double * getAutocorrelationTimes(int i) const { return _cont[i].tau.get(); } // see ObservableContainerElement
+    int getCovarianceOffset(int i) const { return _cont[i].covoffset; } // see ObservableContainerElement
+    int getNCovarianceDim() const { return _ncovdim; }
+    // Running covariance of the block averages of all observables using EstimatorType::OnlineCovariance, with the
+    // dimensions of these observables concatenated in order of addition (nullptr if not allocated yet)
+    const OnlineCovariance * getCovariance() const { return _cov.get(); }
+    const std::string &getMappedStorageDir() const { return _mapdir; }
+    bool usesPersistentStorage() const { return _flag_persistent; }
+    bool usesRunLengthStorage() const { return _flag_runlength; }
+    const StorageArena &getStorageArena() const { return _arena; }
+
+    // let FullAccumulators store samples in memory-mapped files in dir (empty -> RAM), applied on allocate()
+    void setMappedStorageDir(const std::string &dir) { _mapdir = dir; }
+
+    // let the accumulators take their data from one arena kept across allocations (else it is freed on deallocate()),
+    // applied on allocate()
+    void setPersistentStorage(bool flag_persistent) { _flag_persistent = flag_persistent; }
+
+    // let FullAccumulators with a single walker and double precision in RAM store runs of repeated samples
+    // (saves memory if the acceptance rate is below nobs/(nobs + 1), see FullAccumulator.hpp), applied on allocate()
+    void setRunLengthStorage(bool flag_runlength) { _flag_runlength = flag_runlength; }
 
     // operational methods
     // add observable (+internally accumulator&estimator)
     void addObservable(std::unique_ptr<ObservableFunctionInterface> obs /*we acquire ownership*/,
-                       int blocksize, int nskip, bool needsEquil, EstimatorType estimType);
+                       int blocksize, int nskip, bool needsEquil, EstimatorType estimType,
+                       StoragePrecision precision = StoragePrecision::Double);
 
-    void allocate(int64_t Nmc, const SamplingFunctionContainer &pdfcont); // allocate data memory and register dependencies
+    void allocate(int64_t Nmc, const SamplingFunctionContainer &pdfcont, int nwalkers = 1); // allocate data memory and register dependencies
     void accumulate(const WalkerState &wlk); // process accumulation for new step, described by WalkerState
+    void accumulate(const WalkerEnsemble &wlkens); // process accumulation for new step of all walkers (dependent obs not supported)
     void printObsValues(std::ofstream &file) const; // write last observables values to filestream
+    void copyObsValues(double out[]) const; // copy last observables values to out (length getNObsDim())
+    void writeState(std::ostream &os, bool flag_rows = true) const; // write accumulation state of all accumulators (see AccumulatorInterface)
+    void readState(std::istream &is); // read it back (after the same allocate() call)
+    // Incremental writing of the fixed sample rows (for writeState() with flag_rows false, see AccumulatorInterface):
+    // writeRows() writes the rows of all accumulators that are not in nrows yet (empty nrows -> all) and updates nrows,
+    // readRows() reads one such output back and updates nrows in the same way (after the same allocate() call).
+    // Finally, readState(is, nrows) checks that nrows is complete. Written rows are outdated if getRowsVersion() changed.
+    int64_t getRowsVersion() const;
+    void writeRows(std::ostream &os, std::vector<int64_t> &nrows) const;
+    void readRows(std::istream &is, std::vector<int64_t> &nrows);
+    void readState(std::istream &is, const std::vector<int64_t> &nrows);
     void finalize(); // used after sampling to apply all necessary data normalization
-    void estimate(double average[], double error[]) const; // eval estimators on finalized data and return average/error
+    // eval estimators on finalized data and return average/error, with nthreads > 1 the estimators of different observables
+    // and of slices of observable dimensions run on parallel threads (with bit-identical results)
+    void estimate(double average[], double error[], int nthreads = 1) const;
+    // merge the finalized accumulations of other, which must contain equivalent observables and accumulators
+    // (see AccumulatorInterface::merge), e.g. of independent chains or MPI ranks, before estimate()
+    void merge(const ObservableContainer &other);
+    void serialize(std::ostream &os) const; // write all finalized accumulations in compact raw binary
+    void deserialize(std::istream &is); // read them back (allocates and leaves the accumulators finalized)
+    std::unique_ptr<ObservableContainer> createEquivalent() const; // new container with cloned observables and equal settings
     void reset(); // obtain clean state, but keep allocation
     void deallocate(); // free data memory
     std::unique_ptr<ObservableFunctionInterface> pop_back(); // remove and return last obs
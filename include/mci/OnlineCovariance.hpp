@@ -0,0 +1,62 @@
+#ifndef MCI_ONLINECOVARIANCE_HPP
+#define MCI_ONLINECOVARIANCE_HPP
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace mci
+{
+
+class OnlineCovariance
+    // Running mean and covariance matrix of ndim-dimensional samples, via the multivariate version of Welford's
+    // algorithm: For every sample x, delta = x - mean, mean += delta/n and C[i][j] += delta[i]*(x[j] - mean[j]).
+    // Samples are passed one by one via add() and are immediately folded in, so the memory requirement is
+    // O(ndim^2) and independent of the number of samples.
+    //
+    // Several accumulators may share one OnlineCovariance (e.g. to obtain the covariance across observables,
+    // see CovarianceAccumulator.hpp). Then every accumulator passes its part of the next sample via stage(),
+    // and the sample is folded in as soon as all ndim values are staged.
+    //
+    // NOTE: Only the upper triangle of C is updated, the getters return the full symmetric matrices.
+    //
+{
+public:
+    // --- Public Consts
+    const int ndim; // number of dimensions per sample
+
+private:
+    // --- Internals
+    int64_t _nsamples{}; // number of added samples
+    int _nstaged{}; // number of values staged for the next sample
+    std::vector<double> _staged; // next sample (length ndim)
+    std::vector<double> _mean; // running mean (length ndim)
+    std::vector<double> _delta; // deviation of the current sample from the old mean (length ndim)
+    std::vector<double> _comoment; // running sum of products of deviations from the mean (upper triangle of ndim*ndim)
+
+public:
+    explicit OnlineCovariance(int n_dim);
+
+    int64_t getNSamples() const { return _nsamples; }
+    int getNStaged() const { return _nstaged; }
+
+    void add(const double x[]); // add the next sample (length ndim)
+    void stage(int offset, int n, const double x[]); // stage the values [offset, offset+n) of the next sample (see above)
+    void reset(); // remove all samples
+    void merge(const OnlineCovariance &other); // add the samples of other (same ndim, nothing staged)
+
+    // Results for the added samples (the covariances require at least 2 samples, else they are zero)
+    void getMean(double mean[]) const; // mean[ndim]
+    void getCovariance(double cov[]) const; // sample covariance matrix cov[ndim*ndim] (normalized by n-1)
+    // Covariance matrix of the mean cov[ndim*ndim], i.e. the sample covariance divided by n. The square roots of its
+    // diagonal are the errors of UncorrelatedEstimator on the same samples.
+    void getMeanCovariance(double cov[]) const;
+
+    // write/read the complete state in raw binary (used for MCI checkpoints)
+    void write(std::ostream &os) const;
+    void read(std::istream &is);
+};
+} // namespace mci
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef MCI_PROTOFUNCTIONINTERFACE_HPP
 #define MCI_PROTOFUNCTIONINTERFACE_HPP
 
+#include <istream>
+#include <ostream>
+
 namespace mci
 {
 // Base class for all proto functions
@@ -21,16 +24,25 @@ namespace mci
 // to your old data. This makes sure the old values are initialized at the first step and
 // copied on newToOld. Update the data in protoFunction and in the derived interface's selective
 // updating methods.
+//
+// For ensemble sampling (see MCI::setNWalkers), MCI may request to store proto values for
+// several walkers at once. Then the proto value arrays hold _nwalkers*_nproto elements, where
+// the values of walker iw start at _protoold + iw*_nproto (or _protonew + iw*_nproto). The
+// walker-indexed public methods default to walker 0, i.e. the usual single-walker case.
+// Own proto-value like data (see above) can't be used in ensemble mode, because _newToOld()/_oldToNew()
+// know no walker index. Therefore functions have to opt in to ensemble mode, by overriding supportsEnsemble().
 class ProtoFunctionInterface
 {
 protected:
     const int _ndim; // dimension of the input array (walker position)
     int _nproto; // number of proto values calculated in protoFunction
-    double * _protoold; // ptr to the old proto values
-    double * _protonew; // ptr to the new proto values
+    int _nwalkers; // number of walkers we store proto values for (see setNWalkers)
+    double * _protoold; // ptr to the old proto values (length _nwalkers*_nproto)
+    double * _protonew; // ptr to the new proto values (length _nwalkers*_nproto)
 
     // internal setters
     void setNProto(int nproto); // you may freely choose the amount of values you need
+    void _allocateProtoValues(); // (re-)allocate the proto value arrays for _nwalkers*_nproto values
 
     // Overwrite this if you have own data to copy on acceptance/rejection.
     // It will be called in the public newToOld()/oldToNew() methods.
@@ -45,15 +57,32 @@ public:
     // Getters
     int getNDim() const { return _ndim; }
     int getNProto() const { return _nproto; }
+    int getNWalkers() const { return _nwalkers; }
+
+    // Return true if the function can be used in ensemble mode, i.e. if all walker dependent data are stored
+    // in the proto value arrays (no own proto-value like data, see above). Default: false.
+    virtual bool supportsEnsemble() const { return false; }
+
+    // Set the number of walkers to store proto values for (used by MCI in ensemble mode).
+    // Existing proto values are discarded, i.e. initializeProtoValues must be called again.
+    // Throws if nwalkers > 1 and the function does not support ensemble mode (see supportsEnsemble()).
+    void setNWalkers(int nwalkers);
 
     // --- Main operational methods
 
-    // initializer for proto values
-    void initializeProtoValues(const double xold[]);
+    // initializer for proto values (of walker iw)
+    void initializeProtoValues(const double xold[], int iw = 0);
+    // same for all _nwalkers walkers at once (xold of length _nwalkers*_ndim, walker-major)
+    void initializeProtoValuesBatch(const double xold[]);
 
-    // copy new to old protov, call _newToOld()/_oldToNew()
-    void newToOld(); // called on acceptance
-    void oldToNew(); // called on rejection
+    // copy new to old protov (of walker iw), call _newToOld()/_oldToNew()
+    void newToOld(int iw = 0); // called on acceptance
+    void oldToNew(int iw = 0); // called on rejection
+
+    // write/read the old proto values of the first nwalkers walkers as raw binary (used for MCI checkpoints)
+    // NOTE: Reading sets both old and new values. Own proto-value like data is not included.
+    void writeProtoValues(std::ostream &os, int nwalkers = 1) const;
+    void readProtoValues(std::istream &is, int nwalkers = 1);
 
     // --- METHOD THAT MUST BE IMPLEMENTED
 
@@ -62,6 +91,14 @@ public:
     // expected from the derived interface's methods.
     virtual void protoFunction(const double in[], double protovalues[]) = 0; // e.g. the summands of an exponent: exp(-sum(protovalues))
     //                             ^walker position  ^resulting proto-values
+
+    // --- OPTIONALLY OVERRIDE THIS
+
+    // Batched version of protoFunction, for nwalkers positions in[] (length nwalkers*ndim) and
+    // corresponding protovalues[] (length nwalkers*nproto), both walker-major. It is used in ensemble
+    // mode (see MCI::setNWalkers) and by default loops over protoFunction. Override it if you can
+    // provide an efficient (e.g. vectorized) kernel for many positions at once.
+    virtual void protoFunctionBatch(int nwalkers, const double in[], double protovalues[]);
 };
 }  // namespace mci
 
@@ -0,0 +1,166 @@
+#ifndef MCI_RANDOMGENERATOR_HPP
+#define MCI_RANDOMGENERATOR_HPP
+
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <random>
+
+namespace mci
+{
+// Random number engines and the library-wide engine choice.
+//
+// MCI, StaticMCI and all trial moves share one random engine of type RandomGenerator.
+// Which engine that is gets decided at build time (CMake option RANDOM_GENERATOR):
+//     mt19937_64   : std::mt19937_64 (default, 2.5 KB state)
+//     xoshiro256pp : Xoshiro256pp below (32 byte state, -DMCI_RGEN_XOSHIRO256PP=1)
+//     pcg64        : PCG64 below (32 byte state, needs 128-bit integers, -DMCI_RGEN_PCG64=1)
+// NOTE: The same choice must be used for the library and all code using it.
+//
+// All engines fulfill the UniformRandomBitGenerator requirements, i.e. they can be used
+// with the standard library distributions, and can be seeded with a single integer.
+// Like the standard engines, their state can be written to and read from streams.
+
+
+// Splitmix64, used to expand a single seed into a full engine state
+inline uint64_t splitmix64(uint64_t &x)
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30))*0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27))*0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// xoshiro256++ by D. Blackman and S. Vigna (https://prng.di.unimi.it/)
+class Xoshiro256pp
+{
+private:
+    uint64_t _s[4]{};
+
+    static uint64_t _rotl(const uint64_t x, const int k) { return (x << k) | (x >> (64 - k)); }
+
+public:
+    using result_type = uint64_t;
+    static constexpr uint64_t default_seed = 5489u; // like std::mt19937_64
+
+    static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit Xoshiro256pp(uint64_t seed = default_seed) { this->seed(seed); }
+
+    void seed(uint64_t seed = default_seed)
+    {
+        for (uint64_t &s : _s) { s = splitmix64(seed); } // never all zero
+    }
+
+    result_type operator()()
+    {
+        const uint64_t result = _rotl(_s[0] + _s[3], 23) + _s[0];
+        const uint64_t t = _s[1] << 17;
+        _s[2] ^= _s[0];
+        _s[3] ^= _s[1];
+        _s[1] ^= _s[2];
+        _s[0] ^= _s[3];
+        _s[2] ^= t;
+        _s[3] = _rotl(_s[3], 45);
+        return result;
+    }
+
+    void discard(unsigned long long n)
+    {
+        for (unsigned long long i = 0; i < n; ++i) { (*this)(); }
+    }
+
+    bool operator==(const Xoshiro256pp &other) const
+    {
+        return _s[0] == other._s[0] && _s[1] == other._s[1] && _s[2] == other._s[2] && _s[3] == other._s[3];
+    }
+    bool operator!=(const Xoshiro256pp &other) const { return !(*this == other); }
+
+    friend std::ostream &operator<<(std::ostream &os, const Xoshiro256pp &rgen)
+    {
+        return os << rgen._s[0] << ' ' << rgen._s[1] << ' ' << rgen._s[2] << ' ' << rgen._s[3];
+    }
+    friend std::istream &operator>>(std::istream &is, Xoshiro256pp &rgen)
+    {
+        return is >> rgen._s[0] >> rgen._s[1] >> rgen._s[2] >> rgen._s[3];
+    }
+};
+
+#ifdef __SIZEOF_INT128__
+// PCG64 (XSL-RR 128/64 with the default stream, as e.g. numpy's PCG64) by M. O'Neill (https://www.pcg-random.org/)
+class PCG64
+{
+private:
+    using uint128 = unsigned __int128;
+
+    static constexpr uint128 _mult = (static_cast<uint128>(0x2360ed051fc65da4ULL) << 64) + 0x4385df649fccf645ULL;
+    static constexpr uint128 _inc = (static_cast<uint128>(0x5851f42d4c957f2dULL) << 64) + 0x14057b7ef767814fULL;
+    uint128 _state{};
+
+    void _step() { _state = _state*_mult + _inc; }
+
+public:
+    using result_type = uint64_t;
+    static constexpr uint64_t default_seed = 5489u; // like std::mt19937_64
+
+    static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit PCG64(uint64_t seed = default_seed) { this->seed(seed); }
+
+    void seed(uint64_t seed = default_seed)
+    {
+        const uint64_t hi = splitmix64(seed);
+        const uint64_t lo = splitmix64(seed);
+        _state = 0;
+        this->_step();
+        _state += (static_cast<uint128>(hi) << 64) + lo;
+        this->_step();
+    }
+
+    result_type operator()()
+    {
+        this->_step();
+        const auto xored = static_cast<uint64_t>(_state >> 64) ^ static_cast<uint64_t>(_state);
+        const auto rot = static_cast<int>(_state >> 122);
+        return (xored >> rot) | (xored << ((-rot) & 63));
+    }
+
+    void discard(unsigned long long n)
+    {
+        for (unsigned long long i = 0; i < n; ++i) { this->_step(); }
+    }
+
+    bool operator==(const PCG64 &other) const { return _state == other._state; }
+    bool operator!=(const PCG64 &other) const { return !(*this == other); }
+
+    friend std::ostream &operator<<(std::ostream &os, const PCG64 &rgen) // high and low 64 bits
+    {
+        return os << static_cast<uint64_t>(rgen._state >> 64) << ' ' << static_cast<uint64_t>(rgen._state);
+    }
+    friend std::istream &operator>>(std::istream &is, PCG64 &rgen)
+    {
+        uint64_t hi, lo;
+        if (is >> hi >> lo) { rgen._state = (static_cast<uint128>(hi) << 64) + lo; }
+        return is;
+    }
+};
+#endif
+
+
+// The library-wide engine choice
+#if defined(MCI_RGEN_XOSHIRO256PP)
+using RandomGenerator = Xoshiro256pp;
+#elif defined(MCI_RGEN_PCG64)
+#ifndef __SIZEOF_INT128__
+#error "[RandomGenerator.hpp] PCG64 requires compiler support for 128-bit integers."
+#endif
+using RandomGenerator = PCG64;
+#else
+using RandomGenerator = std::mt19937_64;
+#endif
+} // namespace mci
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef MCI_RANDOMPOOL_HPP
+#define MCI_RANDOMPOOL_HPP
+
+#include "mci/RandomGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+
+namespace mci
+{
+// Bulk generation of random variates and pooled random distributions.
+//
+// Drawing variates one by one through the standard library distributions involves
+// per-call overhead that is significant if the rest of the MC step is cheap. The
+// functions below instead fill whole arrays: First the raw engine output is
+// generated (serially, as required by the engine), then it is transformed to
+// the target distribution in simple loops the compiler can vectorize.
+// The pooled distributions PooledUniformRD and PooledNormalRD keep a cache-line
+// aligned RandomPool of such variates and can be used just like the standard
+// library distributions, e.g. as SRRD of the builtin moves (see PooledUniformAllMove
+// etc.) or, via MCI::setUseRandomPool(), for the acceptance draws of MCI.
+// NOTE: Pooled variates differ from the ones of the standard library distributions
+// (for the same seed), and they are generated ahead of time.
+
+static constexpr int RANDOM_POOL_SIZE = 256; // number of variates per refill (multiple of 8, i.e. full cache lines)
+
+// Fill out[0..n-1] with uniform variates in [a, b) (52 random bits)
+inline void fillUniform(RandomGenerator &rgen, double out[], const int n, const double a = 0., const double b = 1.)
+{
+    static_assert(RandomGenerator::min() == 0 && RandomGenerator::max() == std::numeric_limits<uint64_t>::max(),
+                  "[fillUniform] RandomGenerator must yield full 64 bit integers.");
+    static_assert(sizeof(double) == sizeof(uint64_t), "[fillUniform] Unexpected size of double.");
+
+    uint64_t bits[RANDOM_POOL_SIZE];
+    const double width = b - a;
+    for (int i0 = 0; i0 < n; i0 += RANDOM_POOL_SIZE) {
+        const int m = std::min(RANDOM_POOL_SIZE, n - i0);
+        for (int i = 0; i < m; ++i) { bits[i] = rgen(); }
+        // use the upper 52 bits as mantissa of a double in [1, 2)
+        for (int i = 0; i < m; ++i) { bits[i] = (bits[i] >> 12) | 0x3ff0000000000000ULL; }
+        std::memcpy(out + i0, bits, m*sizeof(double));
+        for (int i = i0; i < i0 + m; ++i) { out[i] = a + (out[i] - 1.)*width; }
+    }
+}
+
+// Fill out[0..n-1] with normal variates (Box-Muller transform)
+inline void fillNormal(RandomGenerator &rgen, double out[], const int n, const double mean = 0., const double stddev = 1.)
+{
+    constexpr double twopi = 6.283185307179586476925286766559;
+    constexpr int npairs = RANDOM_POOL_SIZE/2;
+    double u[RANDOM_POOL_SIZE]; // radii in the first, angles in the second half
+    for (int i0 = 0; i0 < n; i0 += RANDOM_POOL_SIZE) {
+        const int m = std::min(RANDOM_POOL_SIZE, n - i0);
+        const int h = (m + 1)/2; // number of pairs needed
+        fillUniform(rgen, u, npairs + h);
+        for (int i = 0; i < h; ++i) { u[i] = stddev*std::sqrt(-2.*std::log(1. - u[i])); } // radius, 1-u in (0, 1]
+        for (int i = 0; i < h; ++i) { u[npairs + i] *= twopi; } // angle
+        const int hfull = m/2;
+        double * const o = out + i0;
+        for (int i = 0; i < hfull; ++i) {
+            o[2*i] = mean + u[i]*std::cos(u[npairs + i]);
+            o[2*i + 1] = mean + u[i]*std::sin(u[npairs + i]);
+        }
+        if (h > hfull) { // odd m, use only the first of the last pair
+            o[m - 1] = mean + u[hfull]*std::cos(u[npairs + hfull]);
+        }
+    }
+}
+
+
+// Cache-line aligned buffer of random variates, refilled in bulk when empty.
+// Copies start empty, so that e.g. cloned moves never replay the same variates.
+// The remaining variates can be written to and read from streams (e.g. for checkpoints).
+class RandomPool
+{
+private:
+    std::unique_ptr<double[]> _mem; // owning allocation
+    double * _buf; // 64-byte aligned begin within _mem
+    int _pos; // next position to read (RANDOM_POOL_SIZE means empty)
+
+public:
+    RandomPool(): _mem(new double[RANDOM_POOL_SIZE + 8]), _pos(RANDOM_POOL_SIZE)
+    {
+        const auto addr = reinterpret_cast<uintptr_t>(_mem.get());
+        _buf = _mem.get() + ((64 - addr%64)%64)/sizeof(double);
+    }
+
+    RandomPool(const RandomPool &): RandomPool() {}
+    RandomPool &operator=(const RandomPool &)
+    {
+        this->reset();
+        return *this;
+    }
+
+    void reset() { _pos = RANDOM_POOL_SIZE; } // discard the pooled variates
+    int size() const { return RANDOM_POOL_SIZE - _pos; } // number of remaining variates
+
+    // return the next variate, refilling the pool via fill(double buf[], int n) if empty
+    template <class Fill>
+    double next(Fill &&fill)
+    {
+        if (_pos == RANDOM_POOL_SIZE) {
+            fill(_buf, RANDOM_POOL_SIZE);
+            _pos = 0;
+        }
+        return _buf[_pos++];
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const RandomPool &pool)
+    {
+        const auto prec = os.precision(std::numeric_limits<double>::max_digits10); // exact round trip
+        os << pool.size();
+        for (int i = pool._pos; i < RANDOM_POOL_SIZE; ++i) { os << ' ' << pool._buf[i]; }
+        os.precision(prec);
+        return os;
+    }
+    friend std::istream &operator>>(std::istream &is, RandomPool &pool)
+    {
+        int size;
+        if (!(is >> size) || size < 0 || size > RANDOM_POOL_SIZE) {
+            is.setstate(std::ios::failbit);
+            return is;
+        }
+        pool._pos = RANDOM_POOL_SIZE - size;
+        for (int i = pool._pos; i < RANDOM_POOL_SIZE; ++i) { is >> pool._buf[i]; }
+        return is;
+    }
+};
+
+
+// Uniform distribution in [a, b), drawing from a RandomPool
+class PooledUniformRD
+{
+private:
+    double _a, _b;
+    RandomPool _pool;
+
+public:
+    using result_type = double;
+
+    explicit PooledUniformRD(double a = 0., double b = 1.): _a(a), _b(b) {}
+
+    double a() const { return _a; }
+    double b() const { return _b; }
+    void reset() { _pool.reset(); }
+
+    double operator()(RandomGenerator &rgen)
+    {
+        return _pool.next([&](double buf[], int n) { fillUniform(rgen, buf, n, _a, _b); });
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const PooledUniformRD &rd)
+    {
+        const auto prec = os.precision(std::numeric_limits<double>::max_digits10);
+        os << rd._a << ' ' << rd._b << ' ';
+        os.precision(prec);
+        return os << rd._pool;
+    }
+    friend std::istream &operator>>(std::istream &is, PooledUniformRD &rd) { return is >> rd._a >> rd._b >> rd._pool; }
+};
+
+// Normal distribution, drawing from a RandomPool
+class PooledNormalRD
+{
+private:
+    double _mean, _stddev;
+    RandomPool _pool;
+
+public:
+    using result_type = double;
+
+    explicit PooledNormalRD(double mean = 0., double stddev = 1.): _mean(mean), _stddev(stddev) {}
+
+    double mean() const { return _mean; }
+    double stddev() const { return _stddev; }
+    void reset() { _pool.reset(); }
+
+    double operator()(RandomGenerator &rgen)
+    {
+        return _pool.next([&](double buf[], int n) { fillNormal(rgen, buf, n, _mean, _stddev); });
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const PooledNormalRD &rd)
+    {
+        const auto prec = os.precision(std::numeric_limits<double>::max_digits10);
+        os << rd._mean << ' ' << rd._stddev << ' ';
+        os.precision(prec);
+        return os << rd._pool;
+    }
+    friend std::istream &operator>>(std::istream &is, PooledNormalRD &rd) { return is >> rd._mean >> rd._stddev >> rd._pool; }
+};
+} // namespace mci
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef MCI_REDUCEDSTORAGE_HPP
+#define MCI_REDUCEDSTORAGE_HPP
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace mci
+{
+enum class EstimatorType; // see Factories.hpp
+
+// Precision used by accumulators to store observable samples
+enum class StoragePrecision
+{
+    Double, /* default, exact */
+    Float, /* 32-bit float, i.e. ~7 significant digits */
+    Int16 /* 16-bit integer with adaptive per-observable offset and scale, i.e. ~4-5 significant digits of the data range */
+};
+
+class ReducedStorage
+    // Compact storage of observable samples (rows of nobs values) with reduced precision, as used by
+    // FullAccumulator and BlockAccumulator. Float rows are stored as plain casts. Int16 rows store
+    // round((value - offset)/scale) for every observable dimension, where the offset is the first stored
+    // value and the scale grows (requantizing the already stored rows) whenever a value is out of range.
+    // The estimators read the compact rows with widening loads (see Estimators.hpp), so that int16 results
+    // only have to be transformed by offset and scale afterwards (all estimators are linear in that sense).
+    //
+{
+public:
+    const StoragePrecision precision; // Float or Int16
+    const int nobs; // number of values per row
+
+private:
+    int64_t _nalloc{}; // number of allocated rows
+    int64_t _nrows{}; // number of stored rows (i.e. last stored row + 1)
+    std::vector<float> _fdata; // float rows (nalloc*nobs)
+    std::vector<int16_t> _idata; // int16 rows (nalloc*nobs)
+    std::vector<double> _offset; // int16 offsets (nobs)
+    std::vector<double> _scale; // int16 scales (nobs), 0 means not set yet
+    int64_t _nrequant{}; // number of requantizations of stored rows so far (never reset)
+
+    void _rescale(int j, double absdev); // increase scale of dimension j so that absdev fits in
+
+public:
+    static constexpr int16_t QMAX = 32767; // largest int16 magnitude used
+
+    ReducedStorage(StoragePrecision prec, int n_obs); // throws for StoragePrecision::Double
+
+    int64_t getNAlloc() const { return _nalloc; }
+    int64_t getNRows() const { return _nrows; }
+    int64_t getNRequant() const { return _nrequant; } // changes whenever already stored rows change
+    size_t getNBytes() const; // bytes used by the allocated rows
+
+    void allocate(int64_t nrows);
+    void clear(); // zero all rows and forget offsets/scales
+    void deallocate();
+
+    void store(int64_t row, const double vals[]); // store nobs values at row
+    void load(int64_t row, double vals[]) const; // decode row into nobs values
+    // append the first nrows rows of other (same precision and nobs), growing the allocation if necessary
+    // (Int16 rows are requantized to our offsets/scales, i.e. exact up to our quantization)
+    void append(const ReducedStorage &other, int64_t nrows);
+
+    // apply estimator of type estimType (estimators on stored samples only) to the first nrows rows
+    // (with EstimatorType::Autocorrelation, the autocorrelation times are written to tau[nobs], unless nullptr)
+    void estimate(EstimatorType estimType, int64_t nrows, double average[], double error[], double tau[] = nullptr) const;
+    // the same, but only for the dimensions [j0, j1) (bit-identical, see createSliceEstimator in Factories.hpp)
+    void estimateSlice(EstimatorType estimType, int64_t nrows, int j0, int j1, double average[], double error[]) const;
+
+    // write/read the first nrows rows and the int16 offsets/scales in raw binary
+    void write(std::ostream &os, int64_t nrows) const;
+    void read(std::istream &is, int64_t nrows);
+    // the same, separately: rows [row0, row1) and the number of rows with the int16 offsets/scales (e.g. to append
+    // new rows to a file, see AccumulatorInterface::writeRows), read back with readRows() for all rows, then readHeader()
+    void writeRows(std::ostream &os, int64_t row0, int64_t row1) const;
+    void readRows(std::istream &is, int64_t row0, int64_t row1);
+    void writeHeader(std::ostream &os) const;
+    void readHeader(std::istream &is);
+};
+} // namespace mci
+
+#endif
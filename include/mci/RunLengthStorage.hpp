@@ -0,0 +1,74 @@
+#ifndef MCI_RUNLENGTHSTORAGE_HPP
+#define MCI_RUNLENGTHSTORAGE_HPP
+
+#include "mci/SampleRows.hpp"
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace mci
+{
+enum class EstimatorType; // see Factories.hpp
+
+class RunLengthStorage
+    // Storage of observable samples (rows of nobs values) as runs of identical rows, as used by FullAccumulator
+    // for the repeated samples of rejected steps. Every run costs nobs doubles plus one int64 (its end index),
+    // so the storage is smaller than the plain rows if the mean run length exceeds (nobs + 1)/nobs, i.e. if
+    // less than nobs/(nobs + 1) of the steps are accepted.
+    // The estimators read the runs as if they were expanded (see RunLengthSamples in SampleRows.hpp), so the
+    // results are bit-identical to the ones on the plain rows, but the rows are never expanded in memory.
+    //
+{
+public:
+    const int nobs; // number of values per row
+
+private:
+    std::vector<double> _values; // run values (nruns*nobs)
+    std::vector<int64_t> _ends; // end index (exclusive) of every run, i.e. cumulative run lengths
+
+public:
+    explicit RunLengthStorage(int n_obs); // throws if n_obs < 1
+
+    int64_t getNRuns() const { return static_cast<int64_t>(_ends.size()); }
+    int64_t getNRows() const { return _ends.empty() ? 0 : _ends.back(); }
+    size_t getNBytes() const; // bytes held by the run vectors (i.e. including reserved capacity)
+    RunLengthSamples getSamples() const { return RunLengthSamples{_values.data(), _ends.data(), this->getNRuns()}; }
+
+    void reserve(int64_t nruns);
+    void clear(); // forget all runs (keeps the memory)
+    void deallocate(); // forget all runs and free the memory
+    void shrink(); // free the reserved but unused memory
+
+    void store(const double vals[]) // append a row as new run
+    {
+        _values.insert(_values.end(), vals, vals + nobs);
+        _ends.push_back(this->getNRows() + 1);
+    }
+    void repeat() // append a copy of the last row
+    {
+        if (_ends.empty()) { throw std::logic_error("[RunLengthStorage::repeat] There is no row to repeat."); }
+        ++_ends.back();
+    }
+    void add(const double vals[]); // append a row, as repetition if it equals the last row (for rows of unknown origin)
+    void load(int64_t row, double vals[]) const; // copy the nobs values of row to vals
+    void append(const RunLengthStorage &other); // append all runs of other (same nobs)
+
+    // apply estimator of type estimType (estimators on stored samples only) to all rows
+    // (with EstimatorType::Autocorrelation, the autocorrelation times are written to tau[nobs], unless nullptr)
+    void estimate(EstimatorType estimType, double average[], double error[], double tau[] = nullptr) const;
+    // the same, but only for the dimensions [j0, j1) (bit-identical, see createSliceEstimator in Factories.hpp)
+    void estimateSlice(EstimatorType estimType, int j0, int j1, double average[], double error[]) const;
+
+    // write/read the runs in raw binary, where read expects nrows rows in total
+    void write(std::ostream &os) const;
+    void read(std::istream &is, int64_t nrows);
+    // write the runs [run0, run1) in raw binary, read back by appending them with readRuns(is, getNRuns(), run1)
+    void writeRuns(std::ostream &os, int64_t run0, int64_t run1) const;
+    void readRuns(std::istream &is, int64_t run0, int64_t run1);
+};
+} // namespace mci
+
+#endif
@@ -60,6 +60,11 @@ public:
 
     // Method required for auto-calibration
     double getChangeRate() const final { return 1.; } // chance for a single index to change is 1 (because they all change)
+    bool supportsEnsemble() const final { return true; }
+
+    void resetRandomCache() final { resetRandomDistribution(_rd); }
+    void writeRandomCache(std::ostream &os) const final { writeRandomDistribution(os, _rd); }
+    void readRandomCache(std::istream &is) final { readRandomDistribution(is, _rd); }
 
 
     void protoFunction(const double/*in*/[], double/*protovalues*/[]) final {} // not needed
@@ -86,6 +91,10 @@ using GaussianAllMove = SRRDAllMove<std::normal_distribution<double>>;
 using StudentAllMove = SRRDAllMove<std::student_t_distribution<double>>;
 using CauchyAllMove = SRRDAllMove<std::cauchy_distribution<double>>;
 
+// the following ones draw from a RandomPool (see RandomPool.hpp)
+using PooledUniformAllMove = SRRDAllMove<PooledUniformRD>;
+using PooledGaussianAllMove = SRRDAllMove<PooledNormalRD>;
+
 // the following ones use the symmetrized wrapper
 using ExponentialAllMove = SRRDAllMove<SymmetrizedPRRD < std::exponential_distribution<double> > >;
 using GammaAllMove = SRRDAllMove<SymmetrizedPRRD < std::gamma_distribution<double> > >;
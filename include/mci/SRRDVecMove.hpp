@@ -68,6 +68,23 @@ public:
 
     // Method required for auto-calibration
     double getChangeRate() const final { return 1./_nvecs; } // equivalent to _veclen/_ndim
+    bool supportsEnsemble() const final { return true; }
+
+    void resetRandomCache() final
+    {
+        _rdidx.reset();
+        resetRandomDistribution(_rdmov);
+    }
+    void writeRandomCache(std::ostream &os) const final
+    {
+        os << _rdidx << ' ';
+        writeRandomDistribution(os, _rdmov);
+    }
+    void readRandomCache(std::istream &is) final
+    {
+        is >> _rdidx;
+        readRandomDistribution(is, _rdmov);
+    }
 
 
     void protoFunction(const double/*in*/[], double/*protovalues*/[]) final {} // not needed
@@ -102,6 +119,10 @@ using GaussianVecMove = SRRDVecMove<std::normal_distribution<double>>;
 using StudentVecMove = SRRDVecMove<std::student_t_distribution<double>>;
 using CauchyVecMove = SRRDVecMove<std::cauchy_distribution<double>>;
 
+// the following ones draw from a RandomPool (see RandomPool.hpp)
+using PooledUniformVecMove = SRRDVecMove<PooledUniformRD>;
+using PooledGaussianVecMove = SRRDVecMove<PooledNormalRD>;
+
 // the following ones use the symmetrized wrapper
 using ExponentialVecMove = SRRDVecMove<SymmetrizedPRRD<std::exponential_distribution<double> > >;
 using GammaVecMove = SRRDVecMove<SymmetrizedPRRD<std::gamma_distribution<double> > >;
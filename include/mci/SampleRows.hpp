@@ -0,0 +1,63 @@
+#ifndef MCI_SAMPLEROWS_HPP
+#define MCI_SAMPLEROWS_HPP
+
+#include <algorithm>
+#include <cstdint>
+
+namespace mci
+{
+// Read-only view of run-length encoded samples (see RunLengthStorage.hpp): Sample i has the values of the run r
+// with ends[r-1] <= i < ends[r] (ends[-1] = 0), i.e. ends are the cumulative multiplicities of the runs. The values
+// of run r start at values + r*ld, where the row stride ld is the number of stored dimensions (passed separately,
+// like for plain sample arrays).
+struct RunLengthSamples
+{
+    const double * values; // run values
+    const int64_t * ends; // end index (exclusive) of every run
+    int64_t nruns; // number of runs
+};
+
+
+// Row accessors used by the estimator implementations (see Estimators.cpp and MJBlocker.cpp), which read
+// the value j of sample i as rows[i][j], so that plain and run-length samples share the same code.
+template <class T>
+class ArrayRows
+{   // plain samples with row stride ld
+private:
+    const T * const _x;
+    const int _ld;
+
+public:
+    ArrayRows(const T x[], const int ld): _x(x), _ld(ld) {}
+
+    const T * operator[](const int64_t i) const { return _x + i*_ld; }
+};
+
+class RunLengthRows
+{   // run-length samples with row stride ld. The run of the last read is kept, so that
+    // sequential reads find their run in O(1) (others use a binary search over the run ends).
+private:
+    const double * const _values;
+    const int64_t * const _ends;
+    const int64_t _nruns;
+    const int _ld;
+    mutable int64_t _run; // run of the last read
+
+    int64_t _findRun(const int64_t i) const
+    {
+        if (i >= _ends[_run] && _run + 1 < _nruns && i < _ends[_run + 1]) { return _run + 1; }
+        return std::upper_bound(_ends, _ends + _nruns, i) - _ends;
+    }
+
+public:
+    RunLengthRows(const RunLengthSamples &x, const int ld): _values(x.values), _ends(x.ends), _nruns(x.nruns), _ld(ld), _run(0) {}
+
+    const double * operator[](const int64_t i) const
+    {
+        if (i >= _ends[_run] || (_run > 0 && i < _ends[_run - 1])) { _run = this->_findRun(i); }
+        return _values + _run*_ld;
+    }
+};
+} // namespace mci
+
+#endif
@@ -2,6 +2,7 @@
 #define MCI_SAMPLINGFUNCTIONCONTAINER_HPP
 
 #include "mci/SamplingFunctionInterface.hpp"
+#include "mci/WalkerEnsemble.hpp"
 #include "mci/WalkerState.hpp"
 
 #include <memory>
@@ -14,6 +15,8 @@ class SamplingFunctionContainer
 private:
     // Sampling Functions
     std::vector<std::unique_ptr<SamplingFunctionInterface> > _pdfs;
+    std::vector<double> _accbuf; // buffer for per-walker acceptances of a single pdf (ensemble mode)
+    std::vector<double> _boundbuf; // buffer for the upper bounds of remaining log-acceptances (log-acceptance mode)
 
 public:
     // simple getters
@@ -29,12 +32,21 @@ public:
 
     void addSamplingFunction(std::unique_ptr<SamplingFunctionInterface> sf); // we acquire ownership
 
-    void newToOld(); // copy new to old protovalues
-    void oldToNew(); // copy old to new protovalues
-    void initializeProtoValues(const double xold[]); // initialize the proto sampling values, given the xold
+    void setNWalkers(int nwalkers); // set number of walkers to store protovalues for (ensemble mode)
+    void newToOld(int iw = 0); // copy new to old protovalues (of walker iw)
+    void oldToNew(int iw = 0); // copy old to new protovalues (of walker iw)
+    void initializeProtoValues(const double xold[], int iw = 0); // initialize the proto sampling values (of walker iw), given the xold
+    void initializeProtoValues(const WalkerEnsemble &wlkens); // initialize the proto sampling values of all walkers, from their xold
     double getOldSamplingFunction() const; // returns the combined true sampling function value of the old step (potential use in trial moves)
-    double computeAcceptance(const WalkerState &wlk); //compute then new sampling function and return acceptance of new coordinates
+    double computeAcceptance(const WalkerState &wlk, int iw = 0); //compute then new sampling function and return acceptance of new coordinates
+    void computeAcceptance(const WalkerEnsemble &wlkens, double acceptance[]); // same for all walkers of the ensemble (batched), store in acceptance (length nwalkers)
+    // Log-domain Metropolis decision with early rejection: Returns whether the sum of log-acceptances is >= logthreshold.
+    // The pdfs are evaluated in order, until the bounds of the remaining ones (maxLogAcceptance()) guarantee rejection.
+    // NOTE: On rejection, call oldToNew() as usual (protonew of skipped pdfs are just unchanged).
+    bool computeLogAcceptance(const WalkerState &wlk, double logthreshold, int iw = 0);
     void prepareObservation(const double x[]); // prepare the pdfs to be observed by observables
+    void writeProtoValues(std::ostream &os, int nwalkers = 1) const; // write proto values of all pdfs (see ProtoFunctionInterface)
+    void readProtoValues(std::istream &is, int nwalkers = 1); // read them back
 
     //void printProtoValues(std::ofstream &file) const; // write last protovalues to filestream
     std::unique_ptr<SamplingFunctionInterface> pop_back(); // remove and return last pdf
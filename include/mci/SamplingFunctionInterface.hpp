@@ -3,8 +3,12 @@
 
 #include "mci/Clonable.hpp"
 #include "mci/ProtoFunctionInterface.hpp"
+#include "mci/WalkerEnsemble.hpp"
 #include "mci/WalkerState.hpp"
 
+#include <cmath>
+#include <limits>
+
 namespace mci
 {
 // Base class for MC sampling functions (probability distribution functions)
@@ -41,19 +45,44 @@ protected:
 public:
     // --- Main operational methods
 
-    // return value of old sampling function
-    double getOldSamplingFunction() const { return this->samplingFunction(_protoold); }
+    // return value of old sampling function (of walker iw)
+    double getOldSamplingFunction(int iw = 0) const { return this->samplingFunction(_protoold + iw*_nproto); }
 
     // update protonew and return acceptance, given the Walkerstate, which
     // contains the changed indices changedIdx, that differ between xold and xnew
-    double computeAcceptance(const WalkerState &wlk)
+    // (iw is the walker index, only relevant in ensemble mode)
+    double computeAcceptance(const WalkerState &wlk, int iw = 0)
+    {
+        const double * const protoold = _protoold + iw*_nproto;
+        double * const protonew = _protonew + iw*_nproto;
+        if (wlk.nchanged < _ndim) {
+            return this->updatedAcceptance(wlk, protoold, protonew);
+        }
+        // all elements have changed
+        this->protoFunction(wlk.xnew, protonew);
+        return this->acceptanceFunction(protoold, protonew);
+    }
+
+    // log-domain version of computeAcceptance (used when MCI::setUseLogAcceptance(true))
+    double computeLogAcceptance(const WalkerState &wlk, int iw = 0)
     {
+        const double * const protoold = _protoold + iw*_nproto;
+        double * const protonew = _protonew + iw*_nproto;
         if (wlk.nchanged < _ndim) {
-            return this->updatedAcceptance(wlk, _protoold, _protonew);
+            return this->updatedLogAcceptance(wlk, protoold, protonew);
         }
         // all elements have changed
-        this->protoFunction(wlk.xnew, _protonew);
-        return this->acceptanceFunction(_protoold, _protonew);
+        this->protoFunction(wlk.xnew, protonew);
+        return this->logAcceptanceFunction(protoold, protonew);
+    }
+
+    // upper bound of the next log-acceptance (of walker iw), see maxLogAcceptance() below
+    double getMaxLogAcceptance(int iw = 0) const { return this->maxLogAcceptance(_protoold + iw*_nproto); }
+
+    // same for all walkers of the ensemble (must match getNWalkers()), store in acceptance (length nwalkers)
+    void computeAcceptance(const WalkerEnsemble &wlkens, double acceptance[])
+    {
+        this->computeAcceptanceBatch(wlkens, _protoold, _protonew, acceptance);
     }
 
     void prepareObservation(const double x[])
@@ -96,7 +125,60 @@ public:
         return this->acceptanceFunction(protoold, protonew);
     }
 
-    // --- ALSO OPTIONALLY OVERRIDE THIS
+    // --- ALSO OPTIONALLY OVERRIDE THESE (for log-acceptance mode, see MCI::setUseLogAcceptance)
+    // Log-domain versions of acceptanceFunction and updatedAcceptance. By default they just take the log of
+    // the normal versions, but you may compute them directly to avoid over-/underflow of exp() with peaked PDFs.
+    virtual double logAcceptanceFunction(const double protoold[], const double protonew[]) const
+    {
+        return log(this->acceptanceFunction(protoold, protonew)); // e.g. -sum(protonew)+sum(protoold)
+    }
+
+    virtual double updatedLogAcceptance(const WalkerState &wlk, const double protoold[], double protonew[] /* update this! */)
+    {
+        return log(this->updatedAcceptance(wlk, protoold, protonew));
+    }
+
+    // Upper bound of the log-acceptance of any new position, given the old proto values. If your sampling
+    // function f is bounded, you may return log(max(f)) - log(f(old)) (e.g. sum(protoold) in the example).
+    // In log-acceptance mode, MCI uses the bounds of the remaining PDFs to skip their evaluation as soon as
+    // the move is certain to be rejected. So it pays off to add cheap (and bounded) PDFs first.
+    virtual double maxLogAcceptance(const double protoold[]) const { return std::numeric_limits<double>::infinity(); }
+
+    // Batched acceptance for all walkers of the ensemble, used in ensemble mode (see MCI::setNWalkers).
+    // The proto values of walker iw start at protoold + iw*nproto (and protonew + iw*nproto), while the
+    // walker states are wlkens.walkers[iw] (with positions also available as blocks wlkens.xold/xnew).
+    // Store the acceptance of walker iw in acceptance[iw]. By default, all-particle moves are passed to
+    // protoFunctionBatch (so it may be enough to override that) and other moves to updatedAcceptance.
+    virtual void computeAcceptanceBatch(const WalkerEnsemble &wlkens, const double protoold[], double protonew[], double acceptance[])
+    {
+        bool flag_allmoves = true;
+        for (const auto &wlk : wlkens.walkers) {
+            if (wlk.nchanged < _ndim) {
+                flag_allmoves = false;
+                break;
+            }
+        }
+
+        if (flag_allmoves) { // all elements have changed for all walkers
+            this->protoFunctionBatch(wlkens.nwalkers, wlkens.xnew, protonew);
+            for (int iw = 0; iw < wlkens.nwalkers; ++iw) {
+                acceptance[iw] = this->acceptanceFunction(protoold + iw*_nproto, protonew + iw*_nproto);
+            }
+        }
+        else {
+            for (int iw = 0; iw < wlkens.nwalkers; ++iw) {
+                const WalkerState &wlk = wlkens.walkers[iw];
+                if (wlk.nchanged < _ndim) {
+                    acceptance[iw] = this->updatedAcceptance(wlk, protoold + iw*_nproto, protonew + iw*_nproto);
+                }
+                else {
+                    this->protoFunction(wlk.xnew, protonew + iw*_nproto);
+                    acceptance[iw] = this->acceptanceFunction(protoold + iw*_nproto, protonew + iw*_nproto);
+                }
+            }
+        }
+    }
+
     // Prepare the sampling function to be observed by dependent observables.
     // This will be called by MCI before such observation takes place.
     // Passed walker position and protovalues are from the last accepted state.
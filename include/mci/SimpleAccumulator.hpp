@@ -18,6 +18,11 @@ protected:
     void _finalize() final;
     void _reset() final;
     void _deallocate() final;
+    void _writeData(std::ostream &os) const final;
+    void _readData(std::istream &is) final;
+    void _merge(const AccumulatorInterface &other) final;
+    void _serialize(std::ostream &os) const final;
+    void _deserialize(std::istream &is) final;
 
 public:
     SimpleAccumulator(ObservableFunctionInterface &obs, int nskip):
@@ -0,0 +1,481 @@
+#ifndef MCI_STATICMCI_HPP
+#define MCI_STATICMCI_HPP
+
+#include "mci/DomainInterface.hpp"
+#include "mci/Factories.hpp"
+#include "mci/ObservableFunctionInterface.hpp"
+#include "mci/RandomGenerator.hpp"
+#include "mci/SamplingFunctionInterface.hpp"
+#include "mci/TrialMoveInterface.hpp"
+#include "mci/WalkerState.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mci
+{
+// Compile-time composed alternative to MCI, for integrations where the overhead
+// of virtual calls in the sampling loop matters (e.g. very cheap integrands).
+//
+// The domain, trial move, sampling functions and observables are passed as template
+// arguments, in the form StaticMCI<Domain, Move, std::tuple<PDFs...>, std::tuple<Obs...> >.
+// All of them must be final classes derived from the respective interfaces (e.g.
+// OrthoPeriodicDomain, UniformVecMove or your own final PDF/observable classes), so that
+// all calls in the sampling loop are resolved at compile time and may be inlined.
+// Cloned versions of the passed components are owned by StaticMCI, e.g.:
+//
+// StaticMCI<UnboundDomain, UniformAllMove, std::tuple<MyPDF>, std::tuple<MyObs1, MyObs2> >
+//         smci(UnboundDomain(ndim), UniformAllMove(ndim, 0.1), std::tie(pdf), std::tie(obs1, obs2));
+//
+// In comparison to MCI, the following features are not supported: Random sampling without PDF,
+// dependent observables, automatic decorrelation (only fixed number of steps), callbacks, file output,
+// MPI and components relying on the _newToOld()/_oldToNew() hooks of ProtoFunctionInterface.
+// Observables are either stored fully (blocksize 1, error by chosen estimator) or just summed up
+// (blocksize 0, no error), see setObservableOptions().
+template <class Domain, class Move, class PDFTuple, class ObsTuple>
+class StaticMCI; // only the specialization below is defined
+
+template <class Domain, class Move, class ... PDFs, class ... Obs>
+class StaticMCI<Domain, Move, std::tuple<PDFs...>, std::tuple<Obs...> >
+{
+    static_assert(std::is_base_of<DomainInterface, Domain>::value && std::is_final<Domain>::value,
+                  "[StaticMCI] Domain must be a final class derived from DomainInterface.");
+    static_assert(std::is_base_of<TrialMoveInterface, Move>::value && std::is_final<Move>::value,
+                  "[StaticMCI] Move must be a final class derived from TrialMoveInterface.");
+    static_assert(sizeof...(PDFs) > 0, "[StaticMCI] At least one sampling function is required.");
+
+private:
+    static constexpr size_t NPDF = sizeof...(PDFs);
+    static constexpr size_t NOBS = sizeof...(Obs);
+    using PDFIndices = std::index_sequence_for<PDFs...>;
+    using ObsIndices = std::index_sequence_for<Obs...>;
+
+    // accumulation data of one observable
+    struct ObsAccu
+    {
+        int nobs{}; // number of observable values
+        bool flag_upd{}; // is the observable updateable?
+        int blocksize{1}; // 1 -> store all samples, 0 -> only sum them
+        int nskip{1}; // evaluate observable only every nskip-th step
+        EstimatorType estimType{EstimatorType::Correlated}; // estimator used if blocksize is 1
+
+        std::vector<double> values; // last observable values (length nobs)
+        std::vector<double> data; // stored samples (length nobs*nsamples) or sums (length nobs)
+        std::unique_ptr<bool[]> flags_xchanged; // which x have changed since last obs evaluation (length ndim)
+        int nchanged{}; // how many x have changed since last obs evaluation
+        int skipidx{}; // to determine when to skip accumulation
+        int64_t nstored{}; // number of accumulated samples
+    };
+
+    const int _ndim; // number of dimensions
+
+    // Random
+    std::random_device _rdev;
+    RandomGenerator _rgen; // same engine as MCI, see RandomGenerator.hpp
+    std::uniform_real_distribution<double> _rd; // used to decide on acceptance
+
+    // Components (owned, with their final types)
+    WalkerState _wlkstate; // holds the current walker state (xold/xnew), including move information
+    std::unique_ptr<Domain> _domain;
+    std::unique_ptr<Move> _trialMove;
+    std::tuple<std::unique_ptr<PDFs>...> _pdfs;
+    std::tuple<std::unique_ptr<Obs>...> _obs;
+
+    // Proto values are owned here, to use them directly in the sampling loop
+    std::array<std::vector<double>, NPDF> _pdfprotoold, _pdfprotonew;
+    std::vector<double> _moveprotoold, _moveprotonew;
+
+    // Observable accumulation
+    std::array<ObsAccu, NOBS> _obsaccu;
+
+    // Settings
+    int _NfindMRT2Iterations; // how many MRT2 step adjustment iterations to do before integrating
+    int64_t _NdecorrelationSteps; // how many decorrelation steps to do before integrating
+    double _targetaccrate; // desired acceptance ratio
+
+    // internal counters
+    int64_t _acc, _rej;
+
+
+    // --- Internal helpers
+
+    template <class Base, class Derived>
+    static std::unique_ptr<Derived> _cloneFinal(const Derived &obj) // clone and keep the final type
+    {
+        static_assert(std::is_final<Derived>::value, "[StaticMCI] All components must be final classes.");
+        std::unique_ptr<Base> base = obj.clone();
+        if (dynamic_cast<Derived *>(base.get()) == nullptr) {
+            throw std::invalid_argument("[StaticMCI] Clone of passed component has unexpected type.");
+        }
+        return std::unique_ptr<Derived>(static_cast<Derived *>(base.release()));
+    }
+
+    template <class F, size_t ... I>
+    static void _forEachIndex(F &&f, std::index_sequence<I...>) // call f(std::integral_constant<size_t, I>()) in order
+    {
+        (void) std::initializer_list<int>{(f(std::integral_constant<size_t, I>()), 0)...};
+    }
+
+    template <size_t I>
+    void _initPDF()
+    {
+        using PDF = std::tuple_element_t<I, std::tuple<PDFs...> >;
+        PDF &pdf = *std::get<I>(_pdfs);
+        _pdfprotoold[I].assign(static_cast<size_t>(pdf.getNProto()), 0.);
+        _pdfprotonew[I].assign(static_cast<size_t>(pdf.getNProto()), 0.);
+        pdf.PDF::protoFunction(_wlkstate.xold, _pdfprotonew[I].data());
+        _pdfprotoold[I] = _pdfprotonew[I];
+    }
+
+    template <size_t I>
+    double _computePDFAcceptance()
+    {
+        using PDF = std::tuple_element_t<I, std::tuple<PDFs...> >;
+        PDF &pdf = *std::get<I>(_pdfs);
+        const double * const protoold = _pdfprotoold[I].data();
+        double * const protonew = _pdfprotonew[I].data();
+        if (_wlkstate.nchanged < _ndim) {
+            return pdf.PDF::updatedAcceptance(_wlkstate, protoold, protonew);
+        }
+        // all elements have changed
+        pdf.PDF::protoFunction(_wlkstate.xnew, protonew);
+        return pdf.PDF::acceptanceFunction(protoold, protonew);
+    }
+
+    template <size_t I>
+    void _accumulateObs()
+    {
+        using OBS = std::tuple_element_t<I, std::tuple<Obs...> >;
+        OBS &obs = *std::get<I>(_obs);
+        ObsAccu &accu = _obsaccu[I];
+
+        if (_wlkstate.accepted && accu.nchanged < _ndim) { // record changes
+            if (accu.flag_upd && _wlkstate.nchanged < _ndim) { // track changes by index
+                for (int i = 0; i < _wlkstate.nchanged; ++i) {
+                    const int idx = _wlkstate.changedIdx[i];
+                    if (!accu.flags_xchanged[idx]) {
+                        accu.flags_xchanged[idx] = true;
+                        ++accu.nchanged;
+                    }
+                }
+            }
+            else {
+                accu.nchanged = _ndim; // flags get ignored in this case
+            }
+        }
+
+        if (++accu.skipidx == accu.nskip) { // accumulate observables
+            accu.skipidx = 0;
+            if (accu.nchanged > 0) { // recompute
+                if (accu.nchanged < _ndim) {
+                    obs.OBS::updatedObservable(_wlkstate.xnew, accu.nchanged, accu.flags_xchanged.get(), accu.values.data());
+                }
+                else {
+                    obs.OBS::observableFunction(_wlkstate.xnew, accu.values.data());
+                }
+                if (accu.flag_upd) { std::fill(accu.flags_xchanged.get(), accu.flags_xchanged.get() + _ndim, false); }
+                accu.nchanged = 0;
+            }
+
+            if (accu.blocksize > 0) {
+                std::copy(accu.values.begin(), accu.values.end(), accu.data.begin() + accu.nstored*accu.nobs);
+            }
+            else {
+                for (int j = 0; j < accu.nobs; ++j) { accu.data[j] += accu.values[j]; }
+            }
+            ++accu.nstored;
+        }
+    }
+
+    void _allocateObs(const int64_t Nmc)
+    {
+        for (auto &accu : _obsaccu) {
+            const int64_t nsamples = (accu.blocksize > 0) ? 1 + (Nmc - 1)/accu.nskip : 1;
+            accu.data.assign(static_cast<size_t>(nsamples*accu.nobs), 0.);
+            accu.nchanged = _ndim; // on the first step we always need to evaluate fully
+            if (accu.flag_upd) { std::fill(accu.flags_xchanged.get(), accu.flags_xchanged.get() + _ndim, true); }
+            accu.skipidx = accu.nskip - 1; // first step should not be skipped
+            accu.nstored = 0;
+        }
+    }
+
+    void _estimate(double average[], double error[]) const
+    {
+        int offset = 0;
+        for (const auto &accu : _obsaccu) {
+            if (accu.blocksize > 0) {
+                const auto estimator = createEstimator(accu.estimType);
+                estimator(accu.nstored, accu.nobs, accu.data.data(), average + offset, error + offset);
+            }
+            else {
+                for (int j = 0; j < accu.nobs; ++j) {
+                    average[offset + j] = accu.data[j]/accu.nstored;
+                    error[offset + j] = 0.;
+                }
+            }
+            offset += accu.nobs;
+        }
+    }
+
+    void _initializeSampling()
+    {
+        _acc = 0;
+        _rej = 0;
+        _wlkstate.initialize(false);
+
+        _forEachIndex([this](auto ic) { this->template _initPDF<decltype(ic)::value>(); }, PDFIndices());
+        _trialMove->Move::protoFunction(_wlkstate.xold, _moveprotonew.data());
+        _moveprotoold = _moveprotonew;
+    }
+
+    void _doStepMRT2()
+    {
+        // propose a new position x and get move acceptance
+        const double moveAcc = _trialMove->Move::trialMove(_wlkstate, _moveprotoold.data(), _moveprotonew.data());
+
+        // apply PBC update
+        if (_wlkstate.nchanged < _ndim) {
+            _domain->Domain::applyDomain(_wlkstate); // selective update
+        }
+        else {
+            _domain->Domain::applyDomain(_wlkstate.xnew);
+        }
+
+        // find the corresponding sampling function acceptance
+        double pdfAcc = 1.;
+        _forEachIndex([this, &pdfAcc](auto ic) { pdfAcc *= this->template _computePDFAcceptance<decltype(ic)::value>(); }, PDFIndices());
+
+        // determine if the proposed x is accepted or not
+        _wlkstate.accepted = (_rd(_rgen) <= pdfAcc*moveAcc);
+        _wlkstate.accepted ? ++_acc : ++_rej; // increase counters
+
+        // set state according to result
+        if (_wlkstate.accepted) {
+            for (size_t i = 0; i < NPDF; ++i) { std::copy(_pdfprotonew[i].begin(), _pdfprotonew[i].end(), _pdfprotoold[i].begin()); }
+            std::copy(_moveprotonew.begin(), _moveprotonew.end(), _moveprotoold.begin());
+            _wlkstate.newToOld();
+        }
+        else { // rejected
+            for (size_t i = 0; i < NPDF; ++i) { std::copy(_pdfprotoold[i].begin(), _pdfprotoold[i].end(), _pdfprotonew[i].begin()); }
+            std::copy(_moveprotoold.begin(), _moveprotoold.end(), _moveprotonew.begin());
+            _wlkstate.oldToNew();
+        }
+    }
+
+    template <bool FLAG_OBS>
+    void _sample(const int64_t npoints)
+    {
+        this->_initializeSampling();
+        for (int64_t i = 0; i < npoints; ++i) {
+            this->_doStepMRT2();
+            if (FLAG_OBS) {
+                _forEachIndex([this](auto ic) { this->template _accumulateObs<decltype(ic)::value>(); }, ObsIndices());
+            }
+        }
+    }
+
+    void _findMRT2Step() // same procedure as in MCI::findMRT2Step()
+    {
+        if (!_trialMove->hasStepSizes()) { return; }
+
+        //constants
+        const int nStepSizes = _trialMove->getNStepSizes();
+        const auto MIN_STAT = static_cast<int64_t>( std::max(100., sqrt(40000.*_ndim)) ); // number of M(RT)^2 steps done to decide on step size change
+        const int MIN_CONS = 5; // minimum number of consecutive loops without need of changing mrt2step
+        const double TOLERANCE = 0.05; // tolerance for the acceptance rate
+        const double SMALLEST_ACCEPTABLE_DOUBLE = std::numeric_limits<float>::min(); // use smallest float value as limit for double
+
+        // fill temporary vectors
+        std::vector<double> dimSizes(static_cast<size_t>(_ndim)); // vector holding dimension sizes
+        _domain->getSizes(dimSizes.data());
+
+        std::vector<int> stepSizeIdx(dimSizes.size()); // mapping from x indices to used step size indices
+        for (int i = 0; i < _ndim; ++i) {
+            stepSizeIdx[i] = _trialMove->getStepSizeIndex(i);
+        }
+
+        int cons_count = 0; // number of consecutive loops without need of changing mrt2step
+        int counter = 0; // counter of loops
+        while ((_NfindMRT2Iterations < 0 && cons_count < MIN_CONS) || counter < _NfindMRT2Iterations) {
+            this->_sample<false>(MIN_STAT);
+
+            //increase or decrease mrt2step depending on the acceptance rate
+            const double rate = this->getAcceptanceRate();
+            if (fabs(rate - _targetaccrate) < TOLERANCE) {
+                ++cons_count; // acceptance was within tolerance
+            }
+            else {
+                cons_count = 0; // we reset consecutive counter
+            }
+
+            const double fact = std::min(2., std::max(0.5, rate/_targetaccrate));
+            _trialMove->scaleStepSizes(fact); // scale move according to ratio
+
+            // keep large step sizes in check
+            for (int i = 0; i < _ndim; ++i) {
+                if (_trialMove->getStepSize(stepSizeIdx[i]) > 0.5*dimSizes[i]) {
+                    _trialMove->setStepSize(stepSizeIdx[i], 0.5*dimSizes[i]);
+                }
+            }
+            // keep small step sizes in check
+            for (int j = 0; j < nStepSizes; ++j) {
+                if (_trialMove->getStepSize(j) < SMALLEST_ACCEPTABLE_DOUBLE) {
+                    _trialMove->setStepSize(j, SMALLEST_ACCEPTABLE_DOUBLE);
+                }
+            }
+
+            ++counter;
+            if (_NfindMRT2Iterations < 0 && counter >= std::abs(_NfindMRT2Iterations)) {
+                break;
+            }
+        }
+    }
+
+    template <size_t ... IP, size_t ... IO>
+    StaticMCI(const Domain &domain, const Move &move, const std::tuple<const PDFs &...> &pdfs, const std::tuple<const Obs &...> &obs,
+              std::index_sequence<IP...>, std::index_sequence<IO...>):
+            _ndim(domain.ndim), _wlkstate(_ndim, false),
+            _domain(_cloneFinal<DomainInterface>(domain)), _trialMove(_cloneFinal<TrialMoveInterface>(move)),
+            _pdfs(_cloneFinal<SamplingFunctionInterface>(std::get<IP>(pdfs))...),
+            _obs(_cloneFinal<ObservableFunctionInterface>(std::get<IO>(obs))...),
+            _NfindMRT2Iterations(-50), _NdecorrelationSteps(10000), _targetaccrate(0.5), _acc(0), _rej(0)
+    {
+        // initialize random generator
+        _rgen = RandomGenerator(_rdev());
+        _rd = std::uniform_real_distribution<double>(0., 1.);
+        _trialMove->bindRGen(_rgen);
+
+        // check dimensions
+        bool flag_ndim = (_trialMove->getNDim() == _ndim);
+        _forEachIndex([this, &flag_ndim](auto ic) { flag_ndim = flag_ndim && (std::get<decltype(ic)::value>(_pdfs)->getNDim() == _ndim); }, PDFIndices());
+        _forEachIndex([this, &flag_ndim](auto ic) { flag_ndim = flag_ndim && (std::get<decltype(ic)::value>(_obs)->getNDim() == _ndim); }, ObsIndices());
+        if (!flag_ndim) { throw std::invalid_argument("[StaticMCI] Passed components must have the same number of dimensions as the domain."); }
+
+        // prepare move proto values and observable accumulators
+        _moveprotoold.assign(static_cast<size_t>(_trialMove->getNProto()), 0.);
+        _moveprotonew.assign(static_cast<size_t>(_trialMove->getNProto()), 0.);
+        _forEachIndex([this](auto ic) {
+            constexpr size_t I = decltype(ic)::value;
+            ObsAccu &accu = _obsaccu[I];
+            accu.nobs = std::get<I>(_obs)->getNObs();
+            accu.flag_upd = std::get<I>(_obs)->isUpdateable();
+            accu.values.assign(static_cast<size_t>(accu.nobs), 0.);
+            if (accu.flag_upd) { accu.flags_xchanged.reset(new bool[_ndim]); }
+        }, ObsIndices());
+
+        _domain->getCenter(_wlkstate.xold); // start in the domain center
+    }
+
+public:
+    // Pass the components to clone, e.g. via std::tie(pdf1, pdf2) and std::tie(obs1, obs2)
+    StaticMCI(const Domain &domain, const Move &move, const std::tuple<const PDFs &...> &pdfs, const std::tuple<const Obs &...> &obs):
+            StaticMCI(domain, move, pdfs, obs, PDFIndices(), ObsIndices()) {}
+
+    StaticMCI(const StaticMCI &) = delete; // rgen is bound to the move
+    StaticMCI &operator=(const StaticMCI &) = delete;
+
+
+    // --- Setters
+
+    void setSeed(uint_fast64_t seed)
+    {
+        _rgen.seed(seed);
+        _rd.reset();
+        _trialMove->Move::resetRandomCache(); // discard variates generated with the old seed
+    }
+
+    void setX(const double x[])
+    {
+        std::copy(x, x + _ndim, _wlkstate.xold);
+        _domain->applyDomain(_wlkstate.xold);
+    }
+    void centerX() { _domain->getCenter(_wlkstate.xold); }
+
+    void setMRT2Step(double mrt2step) // set all identical
+    {
+        for (int i = 0; i < _trialMove->getNStepSizes(); ++i) { _trialMove->setStepSize(i, mrt2step); }
+    }
+    void setMRT2Step(int i, double mrt2step) { _trialMove->setStepSize(i, mrt2step); }
+
+    void setTargetAcceptanceRate(double targetaccrate) { _targetaccrate = targetaccrate; }
+    void setNfindMRT2Iterations(int niterations /*N<0 -> auto with max abs(N) iterations, 0 -> off, N>0 -> fixed N iterations*/)
+    {
+        _NfindMRT2Iterations = niterations;
+    }
+    void setNdecorrelationSteps(int64_t nsteps /*N<=0 -> off, N>0 -> fixed N MC steps*/) { _NdecorrelationSteps = nsteps; }
+
+    // set accumulation options of observable i (defaults: 1, 1, EstimatorType::Correlated)
+    void setObservableOptions(int i, int blocksize /*1 -> store all samples, 0 -> no error calculation*/, int nskip,
+                              EstimatorType estimType = EstimatorType::Correlated)
+    {
+        if (i < 0 || i >= static_cast<int>(NOBS)) { throw std::invalid_argument("[StaticMCI::setObservableOptions] Observable index out of range."); }
+        if (blocksize < 0 || blocksize > 1) { throw std::invalid_argument("[StaticMCI::setObservableOptions] Only blocksize 0 or 1 is supported."); }
+        if (nskip < 1) { throw std::invalid_argument("[StaticMCI::setObservableOptions] Provided number of steps per evaluation was < 1 ."); }
+        if (estimType == EstimatorType::StreamingBlocker || estimType == EstimatorType::OnlineUncorrelated
+            || estimType == EstimatorType::OnlineCovariance) {
+            throw std::invalid_argument("[StaticMCI::setObservableOptions] Estimators computed during accumulation are not supported.");
+        }
+        _obsaccu[i].blocksize = blocksize;
+        _obsaccu[i].nskip = nskip;
+        _obsaccu[i].estimType = estimType;
+    }
+
+
+    // --- Getters
+
+    int getNDim() const { return _ndim; }
+    const double * getX() const { return _wlkstate.xold; }
+    double getX(int i) const { return _wlkstate.xold[i]; }
+
+    double getMRT2Step(int i) const { return (i < _trialMove->getNStepSizes()) ? _trialMove->getStepSize(i) : 0.; }
+    double getAcceptanceRate() const
+    {
+        return (_acc > 0) ? static_cast<double>(_acc)/(static_cast<double>(_acc) + _rej) : 0.;
+    }
+
+    int getNPDF() const { return static_cast<int>(NPDF); }
+    int getNObs() const { return static_cast<int>(NOBS); }
+    int getNObsDim() const
+    {
+        int nobsdim = 0;
+        for (const auto &accu : _obsaccu) { nobsdim += accu.nobs; }
+        return nobsdim;
+    }
+
+    const Domain &getDomain() const { return *_domain; }
+    Move &getTrialMove() const { return *_trialMove; }
+    template <size_t I>
+    std::tuple_element_t<I, std::tuple<PDFs...> > &getSamplingFunction() const { return *std::get<I>(_pdfs); }
+    template <size_t I>
+    std::tuple_element_t<I, std::tuple<Obs...> > &getObservable() const { return *std::get<I>(_obs); }
+
+
+    // --- Integrate
+
+    // Same as MCI::integrate, average/error must have length getNObsDim()
+    void integrate(int64_t Nmc, double average[], double error[], bool doFindMRT2step = true, bool doDecorrelation = true)
+    {
+        if (doFindMRT2step) { this->_findMRT2Step(); }
+        if (doDecorrelation && _NdecorrelationSteps > 0) { this->_sample<false>(_NdecorrelationSteps); }
+
+        if (Nmc > 0) {
+            this->_allocateObs(Nmc); // keeps memory of previous runs where possible
+            this->_sample<true>(Nmc);
+            this->_estimate(average, error);
+        }
+    }
+};
+} // namespace mci
+
+#endif
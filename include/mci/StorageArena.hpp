@@ -0,0 +1,45 @@
+#ifndef MCI_STORAGEARENA_HPP
+#define MCI_STORAGEARENA_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mci
+{
+// Grow-only arena for the data arrays of accumulators, kept across allocations (see ObservableContainer).
+// Every array taken via take() is a 64-byte aligned part of one contiguous block, which is reused after
+// release(). If the block is too small, the remaining arrays are allocated separately and the block is
+// grown on the next release() to the size used since the previous one, so that the arena only allocates
+// memory when an allocation is larger than all previous ones.
+class StorageArena
+{
+private:
+    std::unique_ptr<double[]> _mem; // owning allocation of the block
+    double * _block; // 64-byte aligned begin within _mem
+    int64_t _ncap; // capacity of the block (multiple of 8 doubles)
+    int64_t _nused; // used (padded) length of the block
+    int64_t _nneed; // total (padded) length taken since the last release()
+    std::vector<std::unique_ptr<double[]>> _overflow; // separate allocations which did not fit into the block
+
+    static double * _alignedBegin(double * mem); // first 64-byte aligned address of mem (allocated with 8 extra doubles)
+
+public:
+    StorageArena(): _block(nullptr), _ncap(0), _nused(0), _nneed(0) {}
+
+    int64_t getCapacity() const { return _ncap; } // number of doubles in the block
+    int64_t getNTaken() const { return _nneed; } // number of (padded) doubles taken since the last release()
+    size_t getNBytes() const { return static_cast<size_t>(_ncap)*sizeof(double); } // bytes used by the block
+
+    // return a 64-byte aligned array of n doubles (uninitialized), valid until release() or clear()
+    double * take(int64_t n);
+
+    // return all taken arrays to the arena (grows the block if they did not fit)
+    void release();
+
+    // release() and free the block
+    void clear();
+};
+} // namespace mci
+
+#endif
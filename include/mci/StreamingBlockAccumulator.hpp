@@ -0,0 +1,54 @@
+#ifndef MCI_STREAMINGBLOCKACCUMULATOR_HPP
+#define MCI_STREAMINGBLOCKACCUMULATOR_HPP
+
+#include "mci/AccumulatorInterface.hpp"
+#include "mci/StreamingBlocker.hpp"
+
+#include <memory>
+#include <stdexcept>
+
+namespace mci
+{
+// Class to handle accumulation of observables with automatic blocking analysis on the fly.
+// The (optionally pre-averaged, if blocksize > 1) samples are passed to a StreamingBlocker,
+// so instead of all samples only O(log2(nsamples)) statistics per observable dimension are kept.
+// On finalize, the data array is filled with the average (first row) and the error (second row),
+// which are then handed out by the StreamingBlocker estimator (see EstimatorType::StreamingBlocker).
+//
+// NOTE: The planned number of steps must be a multiple of the chosen blocksize and yield at least 2 blocks.
+class StreamingBlockAccumulator final: public AccumulatorInterface
+{
+protected:
+    const int _blocksize; // how many samples to average before passing them to the blocker
+    std::unique_ptr<StreamingBlocker> _blocker; // created on allocation
+    std::unique_ptr<double[]> _block; // current block sum (length _nobs)
+    int _bidx; // counter to determine when block is finished
+
+    // --- storage method to be implemented
+    void _allocate() final;
+    void _accumulate() final;
+    void _finalize() final;
+    void _reset() final;
+    void _deallocate() final;
+    void _writeData(std::ostream &os) const final;
+    void _readData(std::istream &is) final;
+    void _merge(const AccumulatorInterface &other) final;
+    void _serialize(std::ostream &os) const final;
+    void _deserialize(std::istream &is) final;
+
+public:
+    StreamingBlockAccumulator(ObservableFunctionInterface &obs, int nskip, int blocksize):
+            AccumulatorInterface(obs, nskip), _blocksize(blocksize), _block(new double[_nobs]), _bidx(0)
+    {
+        if (_blocksize < 1) { throw std::invalid_argument("[StreamingBlockAccumulator] Requested blocksize was < 1 ."); }
+    }
+
+    ~StreamingBlockAccumulator() final { this->_deallocate(); }
+
+    int getBlockSize() const { return _blocksize; }
+    int getNLevels() const { return _blocker ? _blocker->nlevels : 0; } // number of blocking levels kept
+    int64_t getNStore() const final { return _blocker ? 2 : 0; } // average and error
+};
+}  // namespace mci
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef MCI_STREAMINGBLOCKER_HPP
+#define MCI_STREAMINGBLOCKER_HPP
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace mci
+{
+
+class StreamingBlocker
+    // Streaming variant of the automatic blocking technique implemented by MJBlocker (see MJBlocker.hpp).
+    // Instead of storing all samples, we keep for every blocking level k (i.e. for the averages of 2^k consecutive
+    // samples) the running sums of values, squares and lag-1 products, which is all that Jonsson's test statistic
+    // needs. Samples are passed one by one via add() and are immediately folded into the levels, so the memory
+    // requirement is O(ndim*log2(nmax)) and estimate() does not need another pass over the data.
+    //
+    // NOTE 1: For a power-of-2 number of samples, the result is the one of MJBlocker (up to rounding). Otherwise
+    //         level k uses the first n/2^k (rounded down) blocks, i.e. incomplete blocks are dropped.
+    // NOTE 2: To avoid numerical cancellation, all sums are taken over values relative to the first sample.
+    //
+{
+public:
+    // --- Public Consts
+    const int ndim; // number of dimensions per sample
+    const int nlevels; // number of blocking levels, enough for nmax samples
+
+private:
+    // --- Internals
+    int64_t _nsamples{}; // number of added samples
+    std::vector<double> _shift; // the first sample (length ndim)
+    std::vector<double> _tmp; // value currently passed through the levels (length ndim)
+    std::vector<int64_t> _count; // number of values per level (length nlevels)
+
+    // per-level statistics of the shifted values (each with flat layout nlevels*ndim)
+    std::vector<double> _sum; // sum of values
+    std::vector<double> _sumsq; // sum of squared values
+    std::vector<double> _sumlag; // sum of products of consecutive values
+    std::vector<double> _first; // first value
+    std::vector<double> _last; // last value
+    std::vector<double> _pending; // value waiting for its partner, to form the next level's value
+
+public:
+    StreamingBlocker(int n_dim, int64_t nmax); // nmax is the maximal number of samples to add
+
+    int64_t getNSamples() const { return _nsamples; }
+
+    void add(const double x[]); // add the next sample (length ndim)
+    void reset(); // remove all samples
+
+    // Merge the samples of other (with other.nlevels <= nlevels), as if they were added after ours, but without
+    // forming blocks across the boundary (like for incomplete blocks, see NOTE 1). The result is meant for estimate(),
+    // i.e. adding further samples afterwards does not give the same blocks as adding them to a single blocker.
+    void merge(const StreamingBlocker &other);
+
+    // Estimates average and error of the mean of all added samples (at least 2 are required)
+    void estimate(double avg[], double err[]) const;
+
+    // write/read the complete state in raw binary (used for MCI checkpoints)
+    void write(std::ostream &os) const;
+    void read(std::istream &is);
+};
+} // namespace mci
+
+#endif
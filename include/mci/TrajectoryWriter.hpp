@@ -0,0 +1,96 @@
+#ifndef MCI_TRAJECTORYWRITER_HPP
+#define MCI_TRAJECTORYWRITER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace mci
+{
+// File format used by MCI::storeObservablesOnFile() and MCI::storeWalkerPositionsOnFile()
+enum class FileFormat
+{
+    Text, // one formatted line per record: step index followed by the values
+    Binary // TrajectoryHeader followed by fixed-width records (see below)
+};
+
+// Header of binary trajectory files. The file starts with the 8 magic bytes
+// TRAJECTORY_MAGIC, followed by the four int32 fields below. Then follow the records,
+// each consisting of the int64 step index and ncols doubles (native byte order).
+// Observable files have ncols = total observable dimension, walker files
+// have ncols = nwalkers*ndim (walker-major, like in WalkerEnsemble).
+static constexpr char TRAJECTORY_MAGIC[8] = {'M', 'C', 'I', 'T', 'R', 'A', 'J', '1'};
+
+struct TrajectoryHeader
+{
+    int32_t ndim; // dimension of the integration space
+    int32_t nwalkers; // number of walkers
+    int32_t ncols; // number of doubles per record
+    int32_t freq; // record frequency in MC steps
+
+    size_t recordSize() const { return sizeof(int64_t) + ncols*sizeof(double); } // bytes per record
+};
+
+// read the magic bytes and header of a binary trajectory file (throws on wrong magic)
+TrajectoryHeader readTrajectoryHeader(std::istream &file);
+
+
+class TrajectoryWriter
+    // Writes binary trajectory records from a background thread.
+    // Records are appended to the front one of two buffers (i.e. a memcpy on the calling thread).
+    // When it is full, the buffers are swapped and the writer thread writes out the back buffer,
+    // while the caller continues to fill the front one. Only if the writer thread is still busy
+    // with the previous buffer at the next swap, the caller has to wait.
+    //
+    // NOTE: The file is opened on construction (if append, records are added to an existing file without
+    //       writing the header). Call close() to flush all records and to get a std::runtime_error in case
+    //       of write errors (the destructor ignores them).
+    //
+{
+private:
+    const TrajectoryHeader _header;
+    const int _recsize; // number of doubles per record (step index + ncols)
+    const int _nrecbuf; // number of records per buffer
+    std::ofstream _file;
+
+    std::unique_ptr<double[]> _front, _back; // the two record buffers
+    int _nfront{}; // records in the front buffer
+
+    // shared with the writer thread
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    int _nback{}; // records in the back buffer, still to be written
+    bool _stop{};
+    std::thread _thread;
+
+    void _swapBuffers(); // hand the front buffer to the writer thread (waits for previous write)
+    void _writeLoop(); // writer thread main
+    bool _finish(); // flush remaining records, join thread and close file (returns success)
+
+public:
+    static constexpr size_t BUFFER_BYTES = 1 << 20; // target size of each buffer
+
+    TrajectoryWriter(const std::string &filepath, const TrajectoryHeader &header, bool append = false);
+    TrajectoryWriter(const TrajectoryWriter &) = delete;
+    TrajectoryWriter &operator=(const TrajectoryWriter &) = delete;
+    ~TrajectoryWriter();
+
+    const TrajectoryHeader &getHeader() const { return _header; }
+
+    // return the slot for the ncols values of a new record with step index step
+    double * newRecord(int64_t step);
+
+    // append a record (values of length ncols)
+    void write(int64_t step, const double values[]);
+
+    // write out all records and close the file (throws on I/O errors)
+    void close();
+};
+} // namespace mci
+
+#endif
@@ -3,8 +3,12 @@
 
 #include "mci/Clonable.hpp"
 #include "mci/ProtoFunctionInterface.hpp"
+#include "mci/RandomGenerator.hpp"
+#include "mci/RandomPool.hpp"
 #include "mci/WalkerState.hpp"
 
+#include <istream>
+#include <ostream>
 #include <random>
 
 namespace mci
@@ -17,20 +21,31 @@ class TrialMoveInterface: public ProtoFunctionInterface, public Clonable<TrialMo
 {
 protected:
     // we share the random generator with MCI, get's passed on bindRGen()
-    std::mt19937_64 * _rgen; // ptr to MCI's rgen
-    std::mt19937_64 * getRGen() const { return _rgen; }
+    RandomGenerator * _rgen; // ptr to MCI's rgen (see RandomGenerator.hpp)
+    RandomGenerator * getRGen() const { return _rgen; }
 
     TrialMoveInterface(int ndim, int nproto): ProtoFunctionInterface(ndim, nproto), _rgen(nullptr) {}
 
 public:
     // store ptr to MCI's rgen
-    void bindRGen(std::mt19937_64 &rgen)
+    void bindRGen(RandomGenerator &rgen)
     {
         _rgen = &rgen;
     }
 
-    // compute move, for details see below
-    double computeTrialMove(WalkerState &wlk) { return this->trialMove(wlk, _protoold, _protonew); }
+    // compute move (of walker iw, only relevant in ensemble mode), for details see below
+    double computeTrialMove(WalkerState &wlk, int iw = 0) { return this->trialMove(wlk, _protoold + iw*_nproto, _protonew + iw*_nproto); }
+
+    // Discard random variates the move has generated ahead of time (e.g. pooled ones or
+    // the cached second normal variate of std::normal_distribution). Called on MCI::setSeed,
+    // so that results are reproducible after re-seeding. Override if you cache variates.
+    virtual void resetRandomCache() {}
+
+    // Write/read the state of the move's random distributions (i.e. the cache from above), used for
+    // MCI checkpoints. Text format like the standard library distributions, override both together
+    // with resetRandomCache() (e.g. via writeRandomDistribution()/readRandomDistribution() below).
+    virtual void writeRandomCache(std::ostream &/*os*/) const {}
+    virtual void readRandomCache(std::istream &/*is*/) {}
 
     // do we have step sizes to calibrate?
     bool hasStepSizes() const { return (this->getNStepSizes() > 0); }
@@ -77,7 +92,6 @@ public:
 // distributions which are symmetric around 0. This is done by first
 // generating a x>0 from the given distribution, and then decide on
 // the sign by a draw from bernoulli-distribution.
-// NOTE: Below we consider std::mt19937_64 as the only possible random generator.
 template <class PRRD> /* should be positive-real-valued stdlib random dist <double>*/
 struct SymmetrizedPRRD
 {
@@ -90,14 +104,57 @@ public:
     SymmetrizedPRRD() = default;
     explicit SymmetrizedPRRD(PRRD myPRRD) { prrd = myPRRD; }
 
-    double operator()(std::mt19937_64 &rgen)
+    template <class URBG /*e.g. RandomGenerator*/>
+    double operator()(URBG &rgen)
     { // this overload allows it to be used like other random distributions
         const double val = prrd(rgen);
         return (bd(rgen)) ? val : -val; // return + or - val, with same probability
     }
+
+    void reset()
+    {
+        bd.reset();
+        prrd.reset();
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const SymmetrizedPRRD &rd) { return os << rd.bd << ' ' << rd.prrd; }
+    friend std::istream &operator>>(std::istream &is, SymmetrizedPRRD &rd) { return is >> rd.bd >> rd.prrd; }
 };
 
 
+// Helpers to reset (i.e. clear cached variates of) random distributions and to write/read
+// their state, if they provide reset() and stream operators like the standard library ones.
+namespace rd_impl
+{
+template <class RD>
+inline auto reset(RD &rd, int/*preferred*/) -> decltype(rd.reset(), void()) { rd.reset(); }
+
+template <class RD>
+inline void reset(RD &/*rd*/, long/*fall-back*/) {}
+
+template <class RD>
+inline auto write(std::ostream &os, const RD &rd, int/*preferred*/) -> decltype(os << rd, void()) { os << rd << ' '; }
+
+template <class RD>
+inline void write(std::ostream &/*os*/, const RD &/*rd*/, long/*fall-back*/) {}
+
+template <class RD>
+inline auto read(std::istream &is, RD &rd, int/*preferred*/) -> decltype(is >> rd, void()) { is >> rd; }
+
+template <class RD>
+inline void read(std::istream &/*is*/, RD &/*rd*/, long/*fall-back*/) {}
+} // namespace rd_impl
+
+template <class RD>
+inline void resetRandomDistribution(RD &rd) { rd_impl::reset(rd, 0); }
+
+template <class RD>
+inline void writeRandomDistribution(std::ostream &os, const RD &rd) { rd_impl::write(os, rd, 0); }
+
+template <class RD>
+inline void readRandomDistribution(std::istream &is, RD &rd) { rd_impl::read(is, rd, 0); }
+
+
 // A helper template used to default-initialize applicable real-valued
 // random distributions, e.g. (symmetric/uniform) distributions from the
 // standard library or others when wrapped with SymmetrizedPRRD().
@@ -144,6 +201,13 @@ inline auto createSymRRD<std::cauchy_distribution<double> >()
     return std::cauchy_distribution<double>(); // default is symmetric around 0, but mean&stddev undefined
 }
 
+// Specialization for pooled uniform (see RandomPool.hpp)
+template <>
+inline auto createSymRRD<PooledUniformRD>()
+{
+    return PooledUniformRD(-1., 1.);
+}
+
 // Specialization for symmetrized exponential distribution
 template <>
 inline auto createSymRRD<SymmetrizedPRRD<std::exponential_distribution<double> > >()
@@ -0,0 +1,59 @@
+#ifndef MCI_WALKERENSEMBLE_HPP
+#define MCI_WALKERENSEMBLE_HPP
+
+#include "mci/WalkerState.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace mci
+{
+// Holds the states of nwalkers independent walkers, which are advanced together by MCI in ensemble mode.
+// The positions are stored in contiguous nwalkers*ndim blocks (walker-major, i.e. walker i occupies
+// xold[i*ndim] ... xold[(i+1)*ndim-1]), so that batched code may process all walkers at once.
+// For use with the usual single-walker interfaces, walkers[i] provides a WalkerState view on walker i.
+struct WalkerEnsemble
+{
+    const int nwalkers; // number of walkers
+    const int ndim; // dimension of every walker
+    double * const xold; // block of old positions (length nwalkers*ndim)
+    double * const xnew; // block of new positions (length nwalkers*ndim)
+    int * const changedIdx; // block of changed indices (length nwalkers*ndim)
+
+    std::vector<WalkerState> walkers; // walker state views on the blocks above
+
+public:
+    WalkerEnsemble(int n_walkers, int n_dim, bool flag_obs):
+            nwalkers(n_walkers), ndim(n_dim), xold(new double[nwalkers*ndim]),
+            xnew(new double[nwalkers*ndim]), changedIdx(new int[nwalkers*ndim])
+    {
+        if (nwalkers < 1) { throw std::invalid_argument("[WalkerEnsemble] Number of walkers must be at least 1."); }
+        std::fill(xold, xold + nwalkers*ndim, 0.);
+        walkers.reserve(static_cast<size_t>(nwalkers));
+        for (int i = 0; i < nwalkers; ++i) {
+            walkers.emplace_back(ndim, xold + i*ndim, xnew + i*ndim, changedIdx + i*ndim, flag_obs);
+        }
+    }
+
+    WalkerEnsemble(const WalkerEnsemble &) = delete;
+    ~WalkerEnsemble()
+    {
+        delete[] changedIdx;
+        delete[] xnew;
+        delete[] xold;
+    }
+
+    void initialize(bool flag_obs)
+    {
+        for (auto &wlk : walkers) { wlk.initialize(flag_obs); }
+    }
+
+    void setX(const double x[]) // set all walkers to position x (length ndim)
+    {
+        for (int i = 0; i < nwalkers; ++i) { std::copy(x, x + ndim, xold + i*ndim); }
+    }
+};
+} // namespace mci
+
+#endif
@@ -22,20 +22,40 @@ struct WalkerState
     bool accepted{}; // is the step accepted?
     bool needsObs{}; // are we sampling observables right now? (usually should only be set via construct/initialize)
 
+private:
+    bool _flag_owner; // do we own the position/index arrays? (false for views, see below)
+
 public:
     explicit WalkerState(int n_dim, bool flag_obs): // initialize
             ndim(n_dim), xold(new double[ndim]),
-            xnew(new double[ndim]), changedIdx(new int[ndim])
+            xnew(new double[ndim]), changedIdx(new int[ndim]), _flag_owner(true)
     {
         std::fill(xold, xold + ndim, 0.);
         this->initialize(flag_obs);
     }
 
+    // Construct a view on externally owned arrays of length ndim (used e.g. by WalkerEnsemble)
+    WalkerState(int n_dim, double x_old[], double x_new[], int changed_idx[], bool flag_obs):
+            ndim(n_dim), xold(x_old), xnew(x_new), changedIdx(changed_idx), _flag_owner(false)
+    {
+        this->initialize(flag_obs);
+    }
+
+    WalkerState(const WalkerState &) = delete;
+    WalkerState(WalkerState &&other) noexcept: // the moved-from state becomes a view
+            ndim(other.ndim), xold(other.xold), xnew(other.xnew), nchanged(other.nchanged), changedIdx(other.changedIdx),
+            accepted(other.accepted), needsObs(other.needsObs), _flag_owner(other._flag_owner)
+    {
+        other._flag_owner = false;
+    }
+
     ~WalkerState()
     {
-        delete[] changedIdx;
-        delete[] xnew;
-        delete[] xold;
+        if (_flag_owner) {
+            delete[] changedIdx;
+            delete[] xnew;
+            delete[] xold;
+        }
     }
 
     void initialize(bool flag_obs)
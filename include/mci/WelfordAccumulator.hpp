@@ -0,0 +1,58 @@
+#ifndef MCI_WELFORDACCUMULATOR_HPP
+#define MCI_WELFORDACCUMULATOR_HPP
+
+#include "mci/AccumulatorInterface.hpp"
+
+#include <memory>
+#include <stdexcept>
+
+namespace mci
+{
+// Class to handle accumulation of observables, when an uncorrelated error estimate is desired
+// without storing samples. The (optionally block-averaged, if blocksize > 1) samples are folded into
+// a running mean and sum of squared deviations (Welford's algorithm), so memory is O(nobs).
+// On finalize, the data array is filled with the average (first row) and the error (second row),
+// equal to what UncorrelatedEstimator yields on the stored samples or block averages
+// (select by EstimatorType::OnlineUncorrelated).
+//
+// NOTE: The planned number of steps must be a multiple of the chosen blocksize and yield at least 2 blocks.
+class WelfordAccumulator final: public AccumulatorInterface
+{
+protected:
+    const int _blocksize; // how many samples to average per block
+    int64_t _nblocks; // number of blocks folded in so far
+    int _bidx; // counter to determine when block is finished
+
+    std::unique_ptr<double[]> _block; // current block sum (length _nobs)
+    std::unique_ptr<double[]> _mean; // running mean of blocks (length _nobs)
+    std::unique_ptr<double[]> _m2; // running sum of squared deviations from the mean (length _nobs)
+
+    // --- storage method to be implemented
+    void _allocate() final;
+    void _accumulate() final;
+    void _finalize() final;
+    void _reset() final;
+    void _deallocate() final;
+    void _writeData(std::ostream &os) const final;
+    void _readData(std::istream &is) final;
+    void _merge(const AccumulatorInterface &other) final;
+    void _serialize(std::ostream &os) const final;
+    void _deserialize(std::istream &is) final;
+
+public:
+    WelfordAccumulator(ObservableFunctionInterface &obs, int nskip, int blocksize):
+            AccumulatorInterface(obs, nskip), _blocksize(blocksize), _nblocks(0), _bidx(0),
+            _block(new double[_nobs]), _mean(new double[_nobs]), _m2(new double[_nobs])
+    {
+        if (_blocksize < 1) { throw std::invalid_argument("[WelfordAccumulator] Requested blocksize was < 1 ."); }
+        this->_reset();
+    }
+
+    ~WelfordAccumulator() final { this->_deallocate(); }
+
+    int getBlockSize() const { return _blocksize; }
+    int64_t getNStore() const final { return (_data != nullptr) ? 2 : 0; } // average and error
+};
+}  // namespace mci
+
+#endif
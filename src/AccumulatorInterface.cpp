@@ -1,20 +1,27 @@
 #include "mci/AccumulatorInterface.hpp"
+#include "mci/BinaryIO.hpp"
+
+#include <typeinfo>
 
 namespace mci
 {
 
-AccumulatorInterface::AccumulatorInterface(ObservableFunctionInterface &obs, const int nskip):
-        _obs(obs), _flag_updobs(_obs.isUpdateable()), _nobs(_obs.getNObs()), _xndim(_obs.getNDim()),
-        _nskip(nskip), _obs_values(new double[_nobs]), _flags_xchanged(_flag_updobs ? new bool[_xndim] : nullptr),
-        _nsteps(0), _data(nullptr)
+AccumulatorInterface::AccumulatorInterface(ObservableFunctionInterface &obs, const int nskip, const bool flag_evaluate):
+        _obs(obs), _flag_evaluate(flag_evaluate), _flag_updobs(!flag_evaluate && _obs.isUpdateable()), _nobs(_obs.getNObs()), _xndim(_obs.getNDim()),
+        _nskip(nskip), _obs_values(new double[_nobs]), _nsteps(0), _naccu(0), _data(nullptr), _arena(nullptr), _flag_arenadata(false),
+        _nwalkers(0), _wlk_values(nullptr), _flags_xchanged(nullptr), _nchanged(nullptr)
 {
-    if (nskip < 1) { throw std::invalid_argument("[AccumulatorInterface] Provided number of steps per evaluation was < 1 ."); }
+    if (nskip < 1) {
+        delete[] _obs_values;
+        throw std::invalid_argument("[AccumulatorInterface] Provided number of steps per evaluation was < 1 .");
+    }
+    this->_allocateWalkers(1);
     this->_init();
 }
 
 AccumulatorInterface::~AccumulatorInterface()
 {
-    delete[] _flags_xchanged;
+    this->_deallocateWalkers();
     delete[] _obs_values;
 }
 
@@ -23,91 +30,140 @@ void AccumulatorInterface::_init() // reset base variables (except nsteps/_data)
     _stepidx = 0;
     _skipidx = _nskip - 1; // first step should not be skipped, so we prepare ++_skipidx == _nskip
     _flag_final = false;
+    _flag_repeat = false;
 
-    _nchanged = _xndim; // on the first step we always need to evaluate fully
-    if (_flag_updobs) { std::fill(_flags_xchanged, _flags_xchanged + _xndim, true); }
+    std::fill(_nchanged, _nchanged + _nwalkers, _xndim); // on the first step we always need to evaluate fully
+    if (_flag_updobs) { std::fill(_flags_xchanged, _flags_xchanged + _nwalkers*_xndim, true); }
 }
 
-void AccumulatorInterface::_processOld(const WalkerState &wlk)
+void AccumulatorInterface::_allocateWalkers(const int nwalkers)
 {
-    // this is used when both !wlk.accepted and _nchanged==0
-    if (++_skipidx == _nskip) { // accumulate observables
-        _skipidx = 0;
-        this->_accumulate(); // call child storage implementation
-    }
+    if (nwalkers < 1) { throw std::invalid_argument("[AccumulatorInterface] Provided number of walkers was < 1 ."); }
+    if (nwalkers == _nwalkers) { return; }
+
+    this->_deallocateWalkers();
+    _nwalkers = nwalkers;
+    _wlk_values = (_nwalkers > 1) ? new double[_nwalkers*_nobs] : _obs_values; // single walker writes directly
+    _flags_xchanged = _flag_updobs ? new bool[_nwalkers*_xndim] : nullptr;
+    _nchanged = new int[_nwalkers];
 }
 
-void AccumulatorInterface::_processFull(const WalkerState &wlk)
+void AccumulatorInterface::_deallocateWalkers()
 {
-    // this is used when something changed (wlk.accepted || _nchanged>0) and obs is not updateable
-    _nchanged = _xndim; // remember change even when we skip
-    if (++_skipidx == _nskip) { // accumulate observables
-        _skipidx = 0;
+    delete[] _nchanged;
+    delete[] _flags_xchanged;
+    if (_wlk_values != _obs_values) { delete[] _wlk_values; }
+    _nchanged = nullptr;
+    _flags_xchanged = nullptr;
+    _wlk_values = nullptr;
+    _nwalkers = 0;
+}
 
-        // call full obs compute
-        _obs.observableFunction(wlk.xnew, _obs_values);
-        _nchanged = 0;
+double * AccumulatorInterface::_newData(const int64_t n)
+{
+    _flag_arenadata = (_arena != nullptr);
+    return _flag_arenadata ? _arena->take(n) : new double[n];
+}
 
-        this->_accumulate(); // call child storage implementation
+void AccumulatorInterface::_deleteData()
+{
+    if (!_flag_arenadata) { delete[] _data; }
+    _data = nullptr;
+    _flag_arenadata = false;
+}
+
+void AccumulatorInterface::_growData(const int64_t nold, const int64_t nnew)
+{
+    const bool flag_arenadata = _flag_arenadata;
+    double * const olddata = _data;
+    _data = this->_newData(nnew);
+    std::copy(olddata, olddata + nold, _data);
+    if (!flag_arenadata) { delete[] olddata; }
+}
+
+
+void AccumulatorInterface::_processFull(const WalkerState &wlk, const int iw, const bool flag_accu)
+{
+    // this is used when something changed (wlk.accepted || _nchanged>0) and obs is not updateable
+    _nchanged[iw] = _xndim; // remember change even when we skip
+    if (flag_accu) { // call full obs compute
+        if (_flag_evaluate) {
+            this->_evaluate(wlk.xnew, _wlk_values + iw*_nobs);
+        }
+        else {
+            _obs.observableFunction(wlk.xnew, _wlk_values + iw*_nobs);
+        }
+        _nchanged[iw] = 0;
     }
 }
 
-void AccumulatorInterface::_processSelective(const WalkerState &wlk)
+void AccumulatorInterface::_processSelective(const WalkerState &wlk, const int iw, const bool flag_accu)
 {   // this is used when something changed (wlk.accepted || _nchanged>0) and obs is updateable
-    if (_nchanged < _xndim && wlk.accepted) { // we need to record changes
+    int &nchanged = _nchanged[iw];
+    bool * const flags_xchanged = _flags_xchanged + iw*_xndim;
+
+    if (nchanged < _xndim && wlk.accepted) { // we need to record changes
         if (wlk.nchanged < _xndim) { // track changes by index
             for (int i = 0; i < wlk.nchanged; ++i) {
-                if (!_flags_xchanged[wlk.changedIdx[i]]) {
-                    _flags_xchanged[wlk.changedIdx[i]] = true;
-                    ++_nchanged; // increase internal change counter
+                if (!flags_xchanged[wlk.changedIdx[i]]) {
+                    flags_xchanged[wlk.changedIdx[i]] = true;
+                    ++nchanged; // increase internal change counter
                 }
             }
         }
         else { // all-particle move case
-            _nchanged = _xndim; // note: if _nchanged>=_xndim, the flags get ignored, so no need to set them
+            nchanged = _xndim; // note: if nchanged>=_xndim, the flags get ignored, so no need to set them
         }
     }
 
-    if (++_skipidx == _nskip) { // accumulate observables
-        _skipidx = 0;
-
-        if (_nchanged < _xndim) { // call optimized recompute
-            _obs.updatedObservable(wlk.xnew, _nchanged, _flags_xchanged, _obs_values);
+    if (flag_accu) {
+        double * const values = _wlk_values + iw*_nobs;
+        if (nchanged < _xndim) { // call optimized recompute
+            _obs.updatedObservable(wlk.xnew, nchanged, flags_xchanged, values);
         }
         else { // call full obs compute
-            _obs.observableFunction(wlk.xnew, _obs_values);
+            _obs.observableFunction(wlk.xnew, values);
         }
-        std::fill(_flags_xchanged, _flags_xchanged + _xndim, false);
-        _nchanged = 0;
-
-        this->_accumulate(); // call child storage implementation
+        std::fill(flags_xchanged, flags_xchanged + _xndim, false);
+        nchanged = 0;
     }
 }
 
 
-void AccumulatorInterface::allocate(const int64_t nsteps)
+void AccumulatorInterface::allocate(const int64_t nsteps, const int nwalkers)
 {
     this->deallocate(); // for safety, also calls reset
 
     if (nsteps < 1) { throw std::invalid_argument("[AccumulatorInterface::allocate] Provided number of MC steps was < 1 ."); }
 
+    this->_allocateWalkers(nwalkers);
+    this->_init(); // initialize the (possibly new) per-walker variables
     _nsteps = nsteps;
+    _naccu = 1 + (_nsteps - 1)/_nskip;
     this->_allocate(); // call child allocate
 }
 
 
-void AccumulatorInterface::accumulate(const WalkerState &wlk)
+void AccumulatorInterface::accumulate(const WalkerEnsemble &wlkens)
 {
-    if (wlk.accepted || _nchanged > 0) {
-        if (_flag_updobs) {
-            this->_processSelective(wlk);
-        }
-        else {
-            this->_processFull(wlk);
-        }
+    if (wlkens.nwalkers != _nwalkers) { throw std::invalid_argument("[AccumulatorInterface::accumulate] Number of walkers in passed ensemble does not match the allocation."); }
+
+    const bool flag_accu = this->_isAccuStep();
+    _flag_repeat = true;
+    for (int iw = 0; iw < _nwalkers; ++iw) {
+        if (this->_processWalker(wlkens.walkers[iw], iw, flag_accu)) { _flag_repeat = false; }
     }
-    else {
-        this->_processOld(wlk);
+
+    if (flag_accu) {
+        if (_nwalkers > 1) { // average over walkers
+            std::fill(_obs_values, _obs_values + _nobs, 0.);
+            for (int iw = 0; iw < _nwalkers; ++iw) {
+                for (int i = 0; i < _nobs; ++i) { _obs_values[i] += _wlk_values[iw*_nobs + i]; }
+            }
+            const double norm = 1./_nwalkers;
+            for (int i = 0; i < _nobs; ++i) { _obs_values[i] *= norm; }
+        }
+        this->_accumulate(); // call child storage implementation
     }
 
     ++_stepidx;
@@ -135,5 +191,120 @@ void AccumulatorInterface::deallocate()
     this->_deallocate(); // call child deallocate
 
     _nsteps = 0;
+    _naccu = 0;
+}
+
+
+void AccumulatorInterface::writeState(std::ostream &os, const bool flag_rows) const
+{
+    if (_flag_final) { throw std::runtime_error("[AccumulatorInterface::writeState] State can't be written after finalize."); }
+    if (flag_rows) {
+        const int64_t nrows = this->_getNFixedRows();
+        writeBinary(os, nrows);
+        this->_writeRows(os, 0, nrows);
+    }
+    writeBinary(os, _nsteps);
+    writeBinary(os, static_cast<int32_t>(_nwalkers));
+    writeBinary(os, _stepidx);
+    writeBinary(os, static_cast<int32_t>(_skipidx));
+    writeBinary(os, _obs_values, _nobs);
+    if (_nwalkers > 1) { writeBinary(os, _wlk_values, _nwalkers*_nobs); }
+    writeBinary(os, _nchanged, _nwalkers);
+    if (_flag_updobs) { writeBinary(os, _flags_xchanged, _nwalkers*_xndim); }
+    this->_writeData(os); // call child write
+}
+
+void AccumulatorInterface::readState(std::istream &is, const bool flag_rows)
+{
+    int64_t nrows = 0, nsteps;
+    int32_t nwalkers, skipidx;
+    if (flag_rows) {
+        this->reset(); // clean state
+        readBinary(is, nrows);
+        this->readRows(is, 0, nrows);
+    }
+    readBinary(is, nsteps);
+    readBinary(is, nwalkers);
+    if (nsteps != _nsteps || nwalkers != _nwalkers) {
+        throw std::invalid_argument("[AccumulatorInterface::readState] Stored state does not match the current allocation.");
+    }
+    readBinary(is, _stepidx);
+    readBinary(is, skipidx);
+    _skipidx = skipidx;
+    readBinary(is, _obs_values, _nobs);
+    if (_nwalkers > 1) { readBinary(is, _wlk_values, _nwalkers*_nobs); }
+    readBinary(is, _nchanged, _nwalkers);
+    if (_flag_updobs) { readBinary(is, _flags_xchanged, _nwalkers*_xndim); }
+    this->_readData(is); // call child read
+    if (flag_rows && nrows != this->_getNFixedRows()) {
+        throw std::runtime_error("[AccumulatorInterface::readState] Stored rows are inconsistent with the stored state.");
+    }
+}
+
+void AccumulatorInterface::writeRows(std::ostream &os, const int64_t row0, const int64_t row1) const
+{
+    if (row0 < 0 || row1 < row0 || row1 > this->_getNFixedRows()) {
+        throw std::out_of_range("[AccumulatorInterface::writeRows] Requested rows are not fixed yet.");
+    }
+    this->_writeRows(os, row0, row1); // call child write
+}
+
+void AccumulatorInterface::readRows(std::istream &is, const int64_t row0, const int64_t row1)
+{
+    if (_nsteps == 0) { throw std::runtime_error("[AccumulatorInterface::readRows] Accumulator is not allocated."); }
+    if (row0 < 0 || row1 < row0) { throw std::runtime_error("[AccumulatorInterface::readRows] Stored rows are out of range."); }
+    this->_readRows(is, row0, row1); // call child read
+}
+
+
+void AccumulatorInterface::merge(const AccumulatorInterface &other)
+{
+    if (&other == this) { throw std::invalid_argument("[AccumulatorInterface::merge] Accumulator can't be merged with itself."); }
+    if (!_flag_final || !other._flag_final) { throw std::runtime_error("[AccumulatorInterface::merge] Both accumulators must be finalized."); }
+    if (typeid(*this) != typeid(other) || other._nobs != _nobs || other._nskip != _nskip) {
+        throw std::invalid_argument("[AccumulatorInterface::merge] Accumulators differ in type, observable dimension or nskip.");
+    }
+    this->_merge(other); // call child merge
+    _nsteps += other._nsteps;
+    _naccu += other._naccu;
+    _stepidx = _nsteps;
+}
+
+void AccumulatorInterface::serialize(std::ostream &os) const
+{
+    if (!_flag_final) { throw std::runtime_error("[AccumulatorInterface::serialize] Only finalized accumulations can be serialized."); }
+    writeBinary(os, static_cast<int32_t>(_nobs));
+    writeBinary(os, static_cast<int32_t>(_nskip));
+    writeBinary(os, _nsteps);
+    writeBinary(os, _naccu);
+    this->_serialize(os); // call child serialize
+}
+
+void AccumulatorInterface::deserialize(std::istream &is)
+{
+    int32_t nobs, nskip;
+    int64_t nsteps, naccu;
+    readBinary(is, nobs);
+    readBinary(is, nskip);
+    readBinary(is, nsteps);
+    readBinary(is, naccu);
+    if (nobs != _nobs || nskip != _nskip) {
+        throw std::invalid_argument("[AccumulatorInterface::deserialize] Stored observable dimension or nskip does not match.");
+    }
+    if (nsteps < 1 || naccu < 1 || naccu > nsteps) {
+        throw std::runtime_error("[AccumulatorInterface::deserialize] Stored number of steps is out of range.");
+    }
+    this->deallocate();
+    _nsteps = nsteps;
+    _naccu = naccu;
+    try {
+        this->_deserialize(is); // call child deserialize
+    }
+    catch (...) {
+        this->deallocate();
+        throw;
+    }
+    _stepidx = _nsteps;
+    _flag_final = true;
 }
 }  // namespace mci
@@ -1,4 +1,5 @@
 #include "mci/BlockAccumulator.hpp"
+#include "mci/BinaryIO.hpp"
 
 namespace mci
 {
@@ -12,13 +13,30 @@ void BlockAccumulator::_allocate()
         throw std::invalid_argument("[BlockAccumulator::allocate] Requested number of accumulations is not a multiple of the requested block size.");
     }
     _nblocks = this->getNAccu()/_blocksize;
-    _data = new double[this->getNData()]; // _nstore * _nobs layout
+    if (_rstore) {
+        _rstore->allocate(_nblocks);
+        return;
+    }
+    _data = this->_newData(this->getNData()); // _nstore * _nobs layout
     std::fill(_data, _data + this->getNData(), 0.);
 }
 
 
 void BlockAccumulator::_accumulate()
 {
+    if (_rstore) { // store the complete block average
+        for (int i = 0; i < _nobs; ++i) { _blocksum[i] += _obs_values[i]; }
+        if (++_bidx == _blocksize) {
+            const double normf = 1./_blocksize;
+            for (int i = 0; i < _nobs; ++i) { _blocksum[i] *= normf; }
+            _rstore->store(_storeidx/_nobs, _blocksum.get());
+            std::fill(_blocksum.get(), _blocksum.get() + _nobs, 0.);
+            _bidx = 0;
+            _storeidx += _nobs;
+        }
+        return;
+    }
+
     for (int i = 0; i < _nobs; ++i) {
         _data[_storeidx + i] += _obs_values[i];
     }
@@ -32,6 +50,7 @@ void BlockAccumulator::_accumulate()
 
 void BlockAccumulator::_finalize()
 {
+    if (_rstore) { return; } // already normalized
     const double normf = 1./_blocksize;
     for (int64_t i = 0; i < _nblocks; ++i) {
         for (int j = 0; j < _nobs; ++j) {
@@ -45,14 +64,130 @@ void BlockAccumulator::_reset()
 {
     _bidx = 0;
     _storeidx = 0;
+    if (_rstore) {
+        _rstore->clear();
+        std::fill(_blocksum.get(), _blocksum.get() + _nobs, 0.);
+        return;
+    }
     std::fill(_data, _data + this->getNData(), 0.);
 }
 
 
 void BlockAccumulator::_deallocate()
 {
-    delete[] _data;
-    _data = nullptr;
+    this->_deleteData();
     _nblocks = 0;
+    if (_rstore) { _rstore->deallocate(); }
+}
+
+
+int64_t BlockAccumulator::_getNFixedRows() const
+{   // the finished blocks
+    return _storeidx/_nobs;
+}
+
+
+void BlockAccumulator::_writeData(std::ostream &os) const
+{   // only the current block (the finished ones are the fixed rows)
+    writeBinary(os, static_cast<int32_t>(_bidx));
+    writeBinary(os, _storeidx);
+    if (_rstore) {
+        writeBinary(os, _blocksum.get(), _nobs);
+        _rstore->writeHeader(os);
+        return;
+    }
+    if (_storeidx < this->getNData()) { writeBinary(os, _data + _storeidx, _nobs); }
+}
+
+
+void BlockAccumulator::_readData(std::istream &is)
+{
+    int32_t bidx;
+    readBinary(is, bidx);
+    readBinary(is, _storeidx);
+    if (bidx < 0 || bidx >= _blocksize || _storeidx < 0 || _storeidx > this->getNData()) {
+        throw std::runtime_error("[BlockAccumulator::readData] Stored block indices are out of range.");
+    }
+    _bidx = bidx;
+    if (_rstore) {
+        readBinary(is, _blocksum.get(), _nobs);
+        _rstore->readHeader(is);
+        if (_rstore->getNRows() != _storeidx/_nobs) { throw std::runtime_error("[BlockAccumulator::readData] Stored number of blocks is inconsistent."); }
+        return;
+    }
+    if (_storeidx < this->getNData()) { readBinary(is, _data + _storeidx, _nobs); }
+}
+
+
+void BlockAccumulator::_writeRows(std::ostream &os, const int64_t row0, const int64_t row1) const
+{
+    if (_rstore) {
+        _rstore->writeRows(os, row0, row1);
+        return;
+    }
+    writeBinary(os, _data + row0*_nobs, (row1 - row0)*_nobs);
+}
+
+
+void BlockAccumulator::_readRows(std::istream &is, const int64_t row0, const int64_t row1)
+{
+    if (row1 > _nblocks) { throw std::runtime_error("[BlockAccumulator::readRows] Stored blocks are out of range."); }
+    if (_rstore) {
+        _rstore->readRows(is, row0, row1);
+        return;
+    }
+    readBinary(is, _data + row0*_nobs, (row1 - row0)*_nobs);
+}
+
+
+void BlockAccumulator::_merge(const AccumulatorInterface &other)
+{   // append the blocks of other
+    const auto &o = static_cast<const BlockAccumulator &>(other);
+    if (o._blocksize != _blocksize || o.getStoragePrecision() != this->getStoragePrecision()) {
+        throw std::invalid_argument("[BlockAccumulator::merge] Accumulators differ in blocksize or storage precision.");
+    }
+    if (_rstore) {
+        _rstore->append(*o._rstore, o._nblocks);
+    }
+    else {
+        this->_growData(this->getNData(), (_nblocks + o._nblocks)*_nobs);
+        std::copy(o._data, o._data + o.getNData(), _data + this->getNData());
+    }
+    _nblocks += o._nblocks;
+    _storeidx = this->getNData();
+}
+
+
+void BlockAccumulator::_serialize(std::ostream &os) const
+{
+    writeBinary(os, static_cast<int32_t>(this->getStoragePrecision()));
+    writeBinary(os, _nblocks);
+    if (_rstore) {
+        _rstore->write(os, _nblocks);
+        return;
+    }
+    writeBinary(os, _data, this->getNData());
+}
+
+
+void BlockAccumulator::_deserialize(std::istream &is)
+{
+    int32_t precision;
+    int64_t nblocks;
+    readBinary(is, precision);
+    readBinary(is, nblocks);
+    if (precision != static_cast<int32_t>(this->getStoragePrecision())) {
+        throw std::invalid_argument("[BlockAccumulator::deserialize] Stored storage precision does not match.");
+    }
+    this->_allocate(); // checks the number of accumulations against the blocksize
+    if (nblocks != _nblocks) {
+        throw std::invalid_argument("[BlockAccumulator::deserialize] Stored number of blocks does not match the blocksize.");
+    }
+    _storeidx = this->getNData();
+    if (_rstore) {
+        _rstore->read(is, _nblocks);
+        return;
+    }
+    readBinary(is, _data, this->getNData());
 }
 }  // namespace mci
@@ -0,0 +1,139 @@
+#include "mci/CovarianceAccumulator.hpp"
+#include "mci/BinaryIO.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mci
+{
+
+void CovarianceAccumulator::setCovarianceGroup(OnlineCovariance * const group, const int offset)
+{
+    if (group == nullptr) {
+        if (!_owncov) { _owncov.reset(new OnlineCovariance(_nobs)); }
+        _cov = _owncov.get();
+        _covoffset = 0;
+        return;
+    }
+    if (offset < 0 || offset + _nobs > group->ndim) {
+        throw std::invalid_argument("[CovarianceAccumulator::setCovarianceGroup] Observable dimensions exceed the group dimensions.");
+    }
+    _cov = group;
+    _covoffset = offset;
+    _owncov.reset();
+}
+
+
+void CovarianceAccumulator::_allocate()
+{
+    if (this->getNAccu() < 2*_blocksize) {
+        throw std::invalid_argument("[CovarianceAccumulator::allocate] Requested number of accumulations is smaller than two times the requested block size.");
+    }
+    if (this->getNAccu()%_blocksize != 0) {
+        throw std::invalid_argument("[CovarianceAccumulator::allocate] Requested number of accumulations is not a multiple of the requested block size.");
+    }
+    _data = this->_newData(2*_nobs); // average and error
+    std::fill(_data, _data + 2*_nobs, 0.);
+}
+
+
+void CovarianceAccumulator::_accumulate()
+{
+    const double * x = _obs_values;
+    if (_blocksize > 1) { // first complete the block average
+        for (int i = 0; i < _nobs; ++i) { _block[i] += _obs_values[i]; }
+        if (++_bidx < _blocksize) { return; }
+        const double normf = 1./_blocksize;
+        for (int i = 0; i < _nobs; ++i) { _block[i] *= normf; }
+        _bidx = 0;
+        x = _block.get();
+    }
+
+    // fold the sample into the (possibly shared) covariance
+    _cov->stage(_covoffset, _nobs, x);
+    if (_blocksize > 1) { std::fill(_block.get(), _block.get() + _nobs, 0.); }
+}
+
+
+void CovarianceAccumulator::_finalize()
+{   // do nothing on deallocated state
+    if (_data == nullptr) { return; }
+    const double SMALLEST_ERROR = 1.e-300; // like in UncorrelatedEstimator
+    const int ndim = _cov->ndim;
+    std::unique_ptr<double[]> mean(new double[ndim]);
+    std::unique_ptr<double[]> cov(new double[static_cast<size_t>(ndim)*ndim]);
+    _cov->getMean(mean.get());
+    _cov->getCovariance(cov.get());
+    const auto n = static_cast<double>(_cov->getNSamples());
+    for (int i = 0; i < _nobs; ++i) {
+        const int ic = _covoffset + i;
+        const double var = cov[static_cast<size_t>(ic)*ndim + ic]*(n - 1.)/n; // like UncorrelatedEstimator
+        _data[i] = mean[ic];
+        _data[_nobs + i] = (var > SMALLEST_ERROR) ? sqrt(var/(n - 1.)) : 0.;
+    }
+}
+
+
+void CovarianceAccumulator::_reset()
+{   // reset must not fail on deallocated state
+    _bidx = 0;
+    std::fill(_block.get(), _block.get() + _nobs, 0.);
+    if (_owncov) { _owncov->reset(); } // a group is reset by its owner
+    if (_data != nullptr) { std::fill(_data, _data + 2*_nobs, 0.); }
+}
+
+
+void CovarianceAccumulator::_deallocate()
+{
+    this->_deleteData();
+}
+
+
+void CovarianceAccumulator::_writeData(std::ostream &os) const
+{   // the state of a group is written by its owner
+    writeBinary(os, static_cast<int32_t>(_bidx));
+    writeBinary(os, _block.get(), _nobs);
+    if (_owncov) { _owncov->write(os); }
+}
+
+
+void CovarianceAccumulator::_readData(std::istream &is)
+{
+    int32_t bidx;
+    readBinary(is, bidx);
+    if (bidx < 0 || bidx >= _blocksize) {
+        throw std::runtime_error("[CovarianceAccumulator::readData] Stored block index is out of range.");
+    }
+    _bidx = bidx;
+    readBinary(is, _block.get(), _nobs);
+    if (_owncov) { _owncov->read(is); }
+}
+
+
+void CovarianceAccumulator::_merge(const AccumulatorInterface &other)
+{
+    const auto &o = static_cast<const CovarianceAccumulator &>(other);
+    if (o._blocksize != _blocksize || !_owncov != !o._owncov) {
+        throw std::invalid_argument("[CovarianceAccumulator::merge] Accumulators differ in blocksize or use of a covariance group.");
+    }
+    if (_owncov) { _owncov->merge(*o._owncov); } // else the group was merged by its owner
+    this->_finalize();
+}
+
+
+void CovarianceAccumulator::_serialize(std::ostream &os) const
+{
+    if (_owncov) { _owncov->write(os); }
+}
+
+
+void CovarianceAccumulator::_deserialize(std::istream &is)
+{
+    this->_allocate();
+    if (_owncov) { _owncov->read(is); }
+    if (_cov->getNSamples() != this->getNAccu()/_blocksize) {
+        throw std::invalid_argument("[CovarianceAccumulator::deserialize] Stored number of blocks does not match the blocksize.");
+    }
+    this->_finalize();
+}
+}  // namespace mci
@@ -1,9 +1,15 @@
 #include "mci/Estimators.hpp"
 #include "mci/MJBlocker.hpp"
+#include "mci/StreamingBlocker.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <functional>
 #include <numeric>
 #include <string>
+#include <vector>
 #include <stdexcept>
 
 double calcErrDelta(const int mode, const double err[9])
@@ -33,7 +39,22 @@ double calcErrDelta(const int mode, const double err[9])
 
 namespace mci
 {
-void OneDimUncorrelatedEstimator(const int64_t n, const double x[], double &average, double &error)
+// The implementations read the samples through row accessors (see SampleRows.hpp), i.e. value j of sample i is x[i][j],
+// so that they work on plain arrays of any storage type as well as on run-length samples.
+template <class T>
+static ArrayRows<T> makeRows(const T x[], const int ld) { return ArrayRows<T>(x, ld); }
+
+static RunLengthRows makeRows(const RunLengthSamples &x, const int ld) { return RunLengthRows(x, ld); }
+
+// the samples starting at dimension j0 (for slices of the dimensions)
+template <class T>
+static const T * offsetSamples(const T x[], const int j0) { return x + j0; }
+
+static RunLengthSamples offsetSamples(const RunLengthSamples &x, const int j0) { return RunLengthSamples{x.values + j0, x.ends, x.nruns}; }
+
+
+template <class R>
+static void OneDimUncorrelatedEstimatorImpl(const int64_t n, const R &x, double &average, double &error)
 {
     if (n < 2) {
         throw std::invalid_argument("[OneDimUncorrelatedEstimator] n must be larger than 1");
@@ -41,8 +62,13 @@ void OneDimUncorrelatedEstimator(const int64_t n, const double x[], double &aver
 
     const double SMALLEST_ERROR = 1.e-300;
 
-    average = std::accumulate(x, x + n, 0.);
-    error = std::inner_product(x, x + n, x, 0.);
+    average = 0.;
+    error = 0.;
+    for (int64_t i = 0; i < n; ++i) {
+        const double xi = x[i][0]; // widening load
+        average += xi;
+        error += xi*xi;
+    }
 
     const double norm = 1./n;
     average *= norm;
@@ -56,7 +82,8 @@ void OneDimUncorrelatedEstimator(const int64_t n, const double x[], double &aver
 }
 
 
-void OneDimBlockEstimator(const int64_t n, const double x[], const int64_t nblocks, double &average, double &error)
+template <class T>
+static void OneDimBlockEstimatorImpl(const int64_t n, const T x[], const int64_t nblocks, double &average, double &error)
 {
     if (n < nblocks) {
         throw std::invalid_argument("[OneDimBlockEstimator] n must be >= nblocks");
@@ -76,53 +103,8 @@ void OneDimBlockEstimator(const int64_t n, const double x[], const int64_t nbloc
 }
 
 
-// The original default auto-blocker, implemented by Francesco Calcavecchia.
-// In the factory default we now use our adaption of Marius Johnssons blocker
-// (see MJBlocker.hpp), whenever ndata is a power of 2.
-void OneDimFCBlockerEstimator(const int64_t n, const double x[], double &average, double &error)
-{
-    const int MIN_BLOCKS = 6, MAX_BLOCKS = 50;
-    const int MAX_PLATEAU_AVERAGE = 4;
-
-    if (n < MAX_BLOCKS) {
-        throw std::invalid_argument("[OneDimFCBlockerEstimator] n must be >= " + std::to_string(MAX_BLOCKS));
-    }
-
-    const int nav = MAX_BLOCKS - MIN_BLOCKS + 1;
-    double av[nav];
-    double err[nav];
-    for (int i1 = 0; i1 < nav; ++i1) {
-        const int nblocks = i1 + MIN_BLOCKS;
-        OneDimBlockEstimator(n, x, nblocks, av[i1], err[i1]);
-        //std::cout << "Nblocks = " << nblocks << "   average = " << av[i1] << "   error = " << err[i1] << std::endl;
-    }
-
-    const int naccd = nav - 2*MAX_PLATEAU_AVERAGE;
-    double accdelta[naccd];
-    std::fill(accdelta, accdelta + naccd, 0.);
-    for (int i2 = MAX_PLATEAU_AVERAGE; i2 < naccd + MAX_PLATEAU_AVERAGE; ++i2) {
-        for (int i1 = 1; i1 <= MAX_PLATEAU_AVERAGE; ++i1) {
-            accdelta[i2 - MAX_PLATEAU_AVERAGE] += calcErrDelta(i1, err + i2 - 4);
-        }
-    }
-
-    /*for (int i2=MAX_PLATEAU_AVERAGE; i2<MAX_BLOCKS-MIN_BLOCKS+1-MAX_PLATEAU_AVERAGE; ++i2) {
-      std::cout << "i = " << i2+MIN_BLOCKS << "   accdelta = " << accdelta[i2-MAX_PLATEAU_AVERAGE] << std::endl;
-      }*/
-
-    int i_min = 0;
-    for (int i2 = 1; i2 < naccd; ++i2) {
-        if (fabs(accdelta[i2]) < fabs(accdelta[i_min])) { i_min = i2; }
-    }
-
-    i_min += MAX_PLATEAU_AVERAGE;
-    //std::cout << "The plateau has been detected at nblocks = " << i_min+MIN_BLOCKS << std::endl;
-    average = 0.2*(av[i_min - 2] + av[i_min - 1] + av[i_min] + av[i_min + 1] + av[i_min + 2]);
-    error = 0.2*(err[i_min - 2] + err[i_min - 1] + err[i_min] + err[i_min + 1] + err[i_min + 2]);
-}
-
-
-void MultiDimUncorrelatedEstimator(const int64_t n, const int ndim, const double x[], double average[], double error[])
+template <class R>
+static void MultiDimUncorrelatedEstimatorImpl(const int64_t n, const int ndim, const R &x, double average[], double error[])
 {   // we create an explicit multidimensional implementation, for better efficiency
     if (n < 2) {
         throw std::invalid_argument("[MultiDimUncorrelatedEstimator] n must be larger than 1");
@@ -134,9 +116,11 @@ void MultiDimUncorrelatedEstimator(const int64_t n, const int ndim, const double
     std::fill(error, error + ndim, 0.);
 
     for (int64_t i = 0; i < n; ++i) {
+        const auto * const xi = x[i];
         for (int j = 0; j < ndim; ++j) {
-            average[j] += x[i*ndim + j];
-            error[j] += x[i*ndim + j]*x[i*ndim + j];
+            const double xij = xi[j]; // widening load
+            average[j] += xij;
+            error[j] += xij*xij;
         }
     }
 
@@ -155,7 +139,8 @@ void MultiDimUncorrelatedEstimator(const int64_t n, const int ndim, const double
 }
 
 
-void MultiDimBlockEstimator(const int64_t n, const int ndim, const double x[], const int64_t nblocks, double average[], double error[])
+template <class T>
+static void MultiDimBlockEstimatorImpl(const int64_t n, const int ndim, const T x[], const int64_t nblocks, double average[], double error[])
 {   // we create an explicit multidimensional implementation, for better efficiency
     if (n < nblocks) {
         throw std::invalid_argument("MCI error MultiDimBlockEstimator() : n must be >= nblocks");
@@ -185,10 +170,102 @@ void MultiDimBlockEstimator(const int64_t n, const int ndim, const double x[], c
 }
 
 
+// Compute average and error for every block count from minblocks to maxblocks (written to av/err[(nblocks-minblocks)*ndim + j]),
+// with a single pass over the data: The data is cut at all block boundaries of all block counts, the sums of the segments
+// between neighbouring cuts are accumulated in one sweep and every block sum is then assembled from its segment sums.
+template <class R>
+static void MultiBlockCountEstimatorImpl(const int64_t n, const int ndim, const R &x, const int minblocks, const int maxblocks,
+                                         double av[], double err[])
+{
+    std::vector<int64_t> cuts; // sorted unique block boundaries
+    cuts.reserve(static_cast<size_t>((maxblocks + 2)*(maxblocks - minblocks + 1)));
+    for (int nblocks = minblocks; nblocks <= maxblocks; ++nblocks) {
+        const int64_t nperblock = n/nblocks; // if there is a rest, it is ignored
+        for (int64_t i1 = 0; i1 <= nblocks; ++i1) { cuts.push_back(i1*nperblock); }
+    }
+    std::sort(cuts.begin(), cuts.end());
+    cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+
+    // the single sweep over the data
+    const size_t nseg = cuts.size() - 1;
+    std::vector<double> segsum(nseg*ndim, 0.);
+    for (size_t is = 0; is < nseg; ++is) {
+        double * const sum = segsum.data() + is*ndim;
+        for (int64_t i = cuts[is]; i < cuts[is + 1]; ++i) {
+            const auto * const xi = x[i];
+            for (int j = 0; j < ndim; ++j) {
+                sum[j] += xi[j]; // widening load
+            }
+        }
+    }
+
+    // block averages from segment sums, reusing one buffer for all block counts
+    std::vector<double> blockav(static_cast<size_t>(maxblocks)*ndim);
+    for (int nblocks = minblocks; nblocks <= maxblocks; ++nblocks) {
+        const int64_t nperblock = n/nblocks;
+        const double norm = 1./nperblock;
+        std::fill(blockav.begin(), blockav.end(), 0.);
+        size_t is = 0; // first cut is 0, i.e. the start of block 0
+        for (int64_t i1 = 0; i1 < nblocks; ++i1) {
+            for (; cuts[is] < (i1 + 1)*nperblock; ++is) {
+                for (int j = 0; j < ndim; ++j) { blockav[i1*ndim + j] += segsum[is*ndim + j]; }
+            }
+            for (int j = 0; j < ndim; ++j) { blockav[i1*ndim + j] *= norm; }
+        }
+        const int off = (nblocks - minblocks)*ndim;
+        MultiDimUncorrelatedEstimatorImpl(nblocks, ndim, makeRows(blockav.data(), ndim), av + off, err + off);
+    }
+}
+
+
 // The original default auto-blocker, implemented by Francesco Calcavecchia.
 // In the factory default we now use our adaption of Marius Johnssons blocker
-// (see MJBlocker.hpp), whenever ndata is a power of 2.
-void MultiDimFCBlockerEstimator(const int64_t n, const int ndim, const double x[], double average[], double error[])
+// (see MJBlocker.hpp) instead.
+template <class R>
+static void OneDimFCBlockerEstimatorImpl(const int64_t n, const R &x, double &average, double &error)
+{
+    const int MIN_BLOCKS = 6, MAX_BLOCKS = 50;
+    const int MAX_PLATEAU_AVERAGE = 4;
+
+    if (n < MAX_BLOCKS) {
+        throw std::invalid_argument("[OneDimFCBlockerEstimator] n must be >= " + std::to_string(MAX_BLOCKS));
+    }
+
+    const int nav = MAX_BLOCKS - MIN_BLOCKS + 1;
+    double av[nav];
+    double err[nav];
+    MultiBlockCountEstimatorImpl(n, 1, x, MIN_BLOCKS, MAX_BLOCKS, av, err);
+
+    const int naccd = nav - 2*MAX_PLATEAU_AVERAGE;
+    double accdelta[naccd];
+    std::fill(accdelta, accdelta + naccd, 0.);
+    for (int i2 = MAX_PLATEAU_AVERAGE; i2 < naccd + MAX_PLATEAU_AVERAGE; ++i2) {
+        for (int i1 = 1; i1 <= MAX_PLATEAU_AVERAGE; ++i1) {
+            accdelta[i2 - MAX_PLATEAU_AVERAGE] += calcErrDelta(i1, err + i2 - 4);
+        }
+    }
+
+    /*for (int i2=MAX_PLATEAU_AVERAGE; i2<MAX_BLOCKS-MIN_BLOCKS+1-MAX_PLATEAU_AVERAGE; ++i2) {
+      std::cout << "i = " << i2+MIN_BLOCKS << "   accdelta = " << accdelta[i2-MAX_PLATEAU_AVERAGE] << std::endl;
+      }*/
+
+    int i_min = 0;
+    for (int i2 = 1; i2 < naccd; ++i2) {
+        if (fabs(accdelta[i2]) < fabs(accdelta[i_min])) { i_min = i2; }
+    }
+
+    i_min += MAX_PLATEAU_AVERAGE;
+    //std::cout << "The plateau has been detected at nblocks = " << i_min+MIN_BLOCKS << std::endl;
+    average = 0.2*(av[i_min - 2] + av[i_min - 1] + av[i_min] + av[i_min + 1] + av[i_min + 2]);
+    error = 0.2*(err[i_min - 2] + err[i_min - 1] + err[i_min] + err[i_min + 1] + err[i_min + 2]);
+}
+
+
+// The original default auto-blocker, implemented by Francesco Calcavecchia.
+// In the factory default we now use our adaption of Marius Johnssons blocker
+// (see MJBlocker.hpp) instead.
+template <class R>
+static void MultiDimFCBlockerEstimatorImpl(const int64_t n, const int ndim, const R &x, double average[], double error[])
 {   // we create an explicit multidimensional implementation, for better efficiency
     const int MIN_BLOCKS = 6, MAX_BLOCKS = 50;
     const int MAX_PLATEAU_AVERAGE = 4;
@@ -201,11 +278,7 @@ void MultiDimFCBlockerEstimator(const int64_t n, const int ndim, const double x[
     const int nav_total = nav*ndim;
     auto * av = new double[nav_total];
     auto * err = new double[nav_total];
-
-    for (int i1 = 0; i1 < nav; ++i1) {
-        const int nblocks = i1 + MIN_BLOCKS;
-        MultiDimBlockEstimator(n, ndim, x, nblocks, av + i1*ndim, err + i1*ndim);
-    }
+    MultiBlockCountEstimatorImpl(n, ndim, x, MIN_BLOCKS, MAX_BLOCKS, av, err);
 
     double delta[ndim];
     std::fill(delta, delta + ndim, 0.);
@@ -246,49 +319,391 @@ void MultiDimFCBlockerEstimator(const int64_t n, const int ndim, const double x[
 }
 
 
-// wrappers for any dim
-void UncorrelatedEstimator(const int64_t n, const int ndim, const double x[], double average[], double error[])
+// public versions for double data
+void OneDimUncorrelatedEstimator(const int64_t n, const double x[], double &average, double &error)
+{
+    OneDimUncorrelatedEstimatorImpl(n, makeRows(x, 1), average, error);
+}
+
+void OneDimBlockEstimator(const int64_t n, const double x[], const int64_t nblocks, double &average, double &error)
+{
+    OneDimBlockEstimatorImpl(n, x, nblocks, average, error);
+}
+
+void OneDimFCBlockerEstimator(const int64_t n, const double x[], double &average, double &error)
+{
+    OneDimFCBlockerEstimatorImpl(n, makeRows(x, 1), average, error);
+}
+
+void MultiDimUncorrelatedEstimator(const int64_t n, const int ndim, const double x[], double average[], double error[])
+{
+    MultiDimUncorrelatedEstimatorImpl(n, ndim, makeRows(x, ndim), average, error);
+}
+
+void MultiDimBlockEstimator(const int64_t n, const int ndim, const double x[], const int64_t nblocks, double average[], double error[])
+{
+    MultiDimBlockEstimatorImpl(n, ndim, x, nblocks, average, error);
+}
+
+void MultiDimFCBlockerEstimator(const int64_t n, const int ndim, const double x[], double average[], double error[])
+{
+    MultiDimFCBlockerEstimatorImpl(n, ndim, makeRows(x, ndim), average, error);
+}
+
+
+// wrappers for any dim (x is a plain sample array or RunLengthSamples)
+template <class X>
+static void UncorrelatedEstimatorImpl(const int64_t n, const int ndim, const X &x, double average[], double error[])
 {
     if (ndim > 1) {
-        MultiDimUncorrelatedEstimator(n, ndim, x, average, error);
+        MultiDimUncorrelatedEstimatorImpl(n, ndim, makeRows(x, ndim), average, error);
     }
     else {
-        OneDimUncorrelatedEstimator(n, x, average[0], error[0]);
+        OneDimUncorrelatedEstimatorImpl(n, makeRows(x, 1), average[0], error[0]);
     }
 }
 
-void FCBlockerEstimator(const int64_t n, const int ndim, const double x[], double average[], double error[])
+template <class X>
+static void FCBlockerEstimatorImpl(const int64_t n, const int ndim, const X &x, double average[], double error[])
 {
     if (ndim > 1) {
-        MultiDimFCBlockerEstimator(n, ndim, x, average, error);
+        MultiDimFCBlockerEstimatorImpl(n, ndim, makeRows(x, ndim), average, error);
     }
     else {
-        OneDimFCBlockerEstimator(n, x, average[0], error[0]);
+        OneDimFCBlockerEstimatorImpl(n, makeRows(x, 1), average[0], error[0]);
     }
 }
 
 // Implementation of Marius Jonsson's auto-blocking technique, for details see MJBlocker.hpp
-void MJBlockerEstimator(int64_t n, int ndim, const double x[], double average[], double error[])
+template <class X>
+static void MJBlockerEstimatorImpl(int64_t n, int ndim, const X &x, double average[], double error[])
 {
     MJBlocker mjblk(n, ndim); // create MJBlocker object
     mjblk.estimate(x, average, error); // run the algorithm
 }
 
-// If n power of 2, use MJBlocker, else FCBlocker
-void CorrelatedEstimator(const int64_t n, const int ndim, const double x[], double average[], double error[])
+// Our default for correlated data, which is MJBlocker (for any n)
+template <class X>
+static void CorrelatedEstimatorImpl(const int64_t n, const int ndim, const X &x, double average[], double error[])
+{
+    MJBlockerEstimatorImpl(n, ndim, x, average, error);
+}
+
+// Streaming variant of MJBlocker, reading the samples once in order
+static void StreamingBlockerEstimatorImpl(const int64_t n, const int ndim, const double x[], const int j0, const int j1, double average[], double error[])
+{
+    StreamingBlocker blocker(j1 - j0, n);
+    for (int64_t i = 0; i < n; ++i) { blocker.add(x + i*ndim + j0); }
+    blocker.estimate(average + j0, error + j0);
+}
+
+// Noop Estimator
+template <class X>
+static void NoopEstimatorImpl(int ndim, const X &x, double average[], double error[])
 {
-    if ((static_cast<uint64_t>(n) & (static_cast<uint64_t>(n) - 1)) != 0) { // n is not a power of 2
-        FCBlockerEstimator(n, ndim, x, average, error);
+    const auto * const x0 = makeRows(x, ndim)[0];
+    std::copy(x0, x0 + ndim, average);
+    std::fill(error, error + ndim, 0.);
+}
+
+
+// the any-dim wrappers for every supported storage type
+void UncorrelatedEstimator(int64_t n, int ndim, const double x[], double average[], double error[]) { UncorrelatedEstimatorImpl(n, ndim, x, average, error); }
+void UncorrelatedEstimator(int64_t n, int ndim, const float x[], double average[], double error[]) { UncorrelatedEstimatorImpl(n, ndim, x, average, error); }
+void UncorrelatedEstimator(int64_t n, int ndim, const int16_t x[], double average[], double error[]) { UncorrelatedEstimatorImpl(n, ndim, x, average, error); }
+
+void CorrelatedEstimator(int64_t n, int ndim, const double x[], double average[], double error[]) { CorrelatedEstimatorImpl(n, ndim, x, average, error); }
+void CorrelatedEstimator(int64_t n, int ndim, const float x[], double average[], double error[]) { CorrelatedEstimatorImpl(n, ndim, x, average, error); }
+void CorrelatedEstimator(int64_t n, int ndim, const int16_t x[], double average[], double error[]) { CorrelatedEstimatorImpl(n, ndim, x, average, error); }
+
+void FCBlockerEstimator(int64_t n, int ndim, const double x[], double average[], double error[]) { FCBlockerEstimatorImpl(n, ndim, x, average, error); }
+void FCBlockerEstimator(int64_t n, int ndim, const float x[], double average[], double error[]) { FCBlockerEstimatorImpl(n, ndim, x, average, error); }
+void FCBlockerEstimator(int64_t n, int ndim, const int16_t x[], double average[], double error[]) { FCBlockerEstimatorImpl(n, ndim, x, average, error); }
+
+void MJBlockerEstimator(int64_t n, int ndim, const double x[], double average[], double error[]) { MJBlockerEstimatorImpl(n, ndim, x, average, error); }
+void MJBlockerEstimator(int64_t n, int ndim, const float x[], double average[], double error[]) { MJBlockerEstimatorImpl(n, ndim, x, average, error); }
+void MJBlockerEstimator(int64_t n, int ndim, const int16_t x[], double average[], double error[]) { MJBlockerEstimatorImpl(n, ndim, x, average, error); }
+
+void NoopEstimator(int64_t/*n*/, int ndim, const double x[], double average[], double error[]) { NoopEstimatorImpl(ndim, x, average, error); }
+void StreamingBlockerEstimator(int64_t n, int ndim, const double x[], double average[], double error[]) { StreamingBlockerEstimatorImpl(n, ndim, x, 0, ndim, average, error); }
+void NoopEstimator(int64_t/*n*/, int ndim, const float x[], double average[], double error[]) { NoopEstimatorImpl(ndim, x, average, error); }
+void NoopEstimator(int64_t/*n*/, int ndim, const int16_t x[], double average[], double error[]) { NoopEstimatorImpl(ndim, x, average, error); }
+
+void UncorrelatedEstimator(int64_t n, int ndim, const RunLengthSamples &x, double average[], double error[]) { UncorrelatedEstimatorImpl(n, ndim, x, average, error); }
+void CorrelatedEstimator(int64_t n, int ndim, const RunLengthSamples &x, double average[], double error[]) { CorrelatedEstimatorImpl(n, ndim, x, average, error); }
+void FCBlockerEstimator(int64_t n, int ndim, const RunLengthSamples &x, double average[], double error[]) { FCBlockerEstimatorImpl(n, ndim, x, average, error); }
+void MJBlockerEstimator(int64_t n, int ndim, const RunLengthSamples &x, double average[], double error[]) { MJBlockerEstimatorImpl(n, ndim, x, average, error); }
+void NoopEstimator(int64_t/*n*/, int ndim, const RunLengthSamples &x, double average[], double error[]) { NoopEstimatorImpl(ndim, x, average, error); }
+
+
+// One radix-2 stage (butterflies of length len) of an FFT on z[0..m-1], with exponent sign -1 (forward) or +1 (inverse).
+// The twiddle factors are advanced by multiplication and recomputed every 64 steps, to avoid a table of size m.
+static void fftStage(std::complex<double> z[], const int64_t m, const int64_t len, const double sign)
+{
+    const double PI = 3.14159265358979323846;
+    const int64_t half = len/2;
+    const double ang = sign*2.*PI/len;
+    const double wsr = cos(ang), wsi = sin(ang);
+    for (int64_t i = 0; i < m; i += len) {
+        double wr = 1., wi = 0.;
+        for (int64_t k = 0; k < half; ++k) {
+            if (k%64 == 0 && k > 0) { // resync
+                wr = cos(ang*k);
+                wi = sin(ang*k);
+            }
+            const std::complex<double> u = z[i + k], h = z[i + k + half];
+            const std::complex<double> v(wr*h.real() - wi*h.imag(), wr*h.imag() + wi*h.real()); // (avoids slow complex multiply)
+            z[i + k] = u + v;
+            z[i + k + half] = u - v;
+            const double tmp = wr*wsr - wi*wsi;
+            wi = wr*wsi + wi*wsr;
+            wr = tmp;
+        }
+    }
+}
+
+// In-place radix-2 FFT of z (length m, power of 2), with exponent sign -1 (forward) or +1 (inverse, unnormalized).
+// All stages up to length FFT_BLOCK are done block by block, so that they run in cache.
+static void fftRadix2(std::vector<std::complex<double>> &z, const double sign)
+{
+    const int64_t FFT_BLOCK = 4096;
+    const auto m = static_cast<int64_t>(z.size());
+    for (int64_t i = 1, j = 0; i < m; ++i) { // bit reversal permutation
+        int64_t bit = m >> 1;
+        for (; (j & bit) != 0; bit >>= 1) { j ^= bit; }
+        j ^= bit;
+        if (i < j) { std::swap(z[i], z[j]); }
+    }
+    const int64_t nblock = std::min(m, FFT_BLOCK);
+    for (int64_t i0 = 0; i0 < m; i0 += nblock) {
+        for (int64_t len = 2; len <= nblock; len <<= 1) { fftStage(z.data() + i0, nblock, len, sign); }
+    }
+    for (int64_t len = 2*nblock; len <= m; len <<= 1) { fftStage(z.data(), m, len, sign); }
+}
+
+// Integrated autocorrelation time tau = 1 + 2*sum_{t=1}^{W} rho(t) from the autocovariance sums c(t) (t = 0..n-1),
+// with Sokal's automatic window, i.e. the smallest W with W >= SOKAL_C*tau(W) (or the largest W, if there is none).
+template <class Getter>
+static double sokalTau(const int64_t n, Getter c)
+{
+    const double SOKAL_C = 5.;
+    const double c0 = c(0);
+    double tau = 1.;
+    for (int64_t t = 1; t < n; ++t) {
+        tau += 2.*c(t)/c0;
+        if (t >= SOKAL_C*tau) { break; }
+    }
+    return tau;
+}
+
+// Autocorrelation estimator: The autocovariance of every dimension is computed by FFT (zero-padded to avoid wrap-around),
+// two dimensions at a time by packing them into the real and imaginary part of one complex sequence.
+template <class X>
+static void AutocorrelationEstimatorImpl(const int64_t n, const int ndim, const X &xin, double average[], double error[], double tau[])
+{
+    const auto x = makeRows(xin, ndim);
+    if (n < 2) {
+        throw std::invalid_argument("[AutocorrelationEstimator] n must be larger than 1");
+    }
+
+    const double SMALLEST_ERROR = 1.e-300;
+
+    std::fill(average, average + ndim, 0.);
+    for (int64_t i = 0; i < n; ++i) {
+        const auto * const xi = x[i];
+        for (int j = 0; j < ndim; ++j) {
+            average[j] += xi[j]; // widening load
+        }
+    }
+    for (int j = 0; j < ndim; ++j) { average[j] /= n; }
+
+    int64_t m = 1;
+    while (m < 2*n) { m *= 2; }
+    std::vector<std::complex<double>> z(static_cast<size_t>(m));
+    const double norm = 1./m;
+
+    for (int ja = 0; ja < ndim; ja += 2) {
+        const int jb = (ja + 1 < ndim) ? ja + 1 : -1; // second dimension of the pair (if any)
+
+        // pack the centered data and transform
+        for (int64_t i = 0; i < n; ++i) {
+            const auto * const xi = x[i];
+            const double a = xi[ja] - average[ja];
+            const double b = (jb >= 0) ? xi[jb] - average[jb] : 0.;
+            z[i] = std::complex<double>(a, b);
+        }
+        std::fill(z.begin() + n, z.end(), std::complex<double>(0., 0.));
+        fftRadix2(z, -1.);
+
+        // separate the two spectra and pack their (real, symmetric) power spectra
+        for (int64_t k = 0; k <= m/2; ++k) {
+            const int64_t kc = (m - k)%m;
+            const std::complex<double> zk = z[k], zkc = std::conj(z[kc]);
+            const std::complex<double> fa = 0.5*(zk + zkc);
+            const std::complex<double> fb = std::complex<double>(0., -0.5)*(zk - zkc);
+            z[k] = std::complex<double>(std::norm(fa), std::norm(fb));
+            z[kc] = z[k];
+        }
+        fftRadix2(z, 1.); // real part: autocovariance sums of ja, imaginary part: of jb
+
+        for (const int j : {ja, jb}) {
+            if (j < 0) { continue; }
+            const bool re = (j == ja);
+            auto c = [&z, norm, re](const int64_t t) { return (re ? z[t].real() : z[t].imag())*norm; };
+            const double var = c(0)/n;
+            if (var > SMALLEST_ERROR) {
+                const double tauj = sokalTau(n, c);
+                error[j] = sqrt(std::max(0., tauj)*var/(n - 1.));
+                if (tau != nullptr) { tau[j] = tauj; }
+            }
+            else {
+                error[j] = 0.;
+                if (tau != nullptr) { tau[j] = 1.; }
+            }
+        }
+    }
+}
+
+void AutocorrelationEstimator(int64_t n, int ndim, const double x[], double average[], double error[], double tau[]) { AutocorrelationEstimatorImpl(n, ndim, x, average, error, tau); }
+void AutocorrelationEstimator(int64_t n, int ndim, const float x[], double average[], double error[], double tau[]) { AutocorrelationEstimatorImpl(n, ndim, x, average, error, tau); }
+void AutocorrelationEstimator(int64_t n, int ndim, const int16_t x[], double average[], double error[], double tau[]) { AutocorrelationEstimatorImpl(n, ndim, x, average, error, tau); }
+
+void AutocorrelationEstimator(int64_t n, int ndim, const double x[], double average[], double error[]) { AutocorrelationEstimatorImpl(n, ndim, x, average, error, nullptr); }
+void AutocorrelationEstimator(int64_t n, int ndim, const float x[], double average[], double error[]) { AutocorrelationEstimatorImpl(n, ndim, x, average, error, nullptr); }
+void AutocorrelationEstimator(int64_t n, int ndim, const int16_t x[], double average[], double error[]) { AutocorrelationEstimatorImpl(n, ndim, x, average, error, nullptr); }
+
+void AutocorrelationEstimator(int64_t n, int ndim, const RunLengthSamples &x, double average[], double error[], double tau[]) { AutocorrelationEstimatorImpl(n, ndim, x, average, error, tau); }
+void AutocorrelationEstimator(int64_t n, int ndim, const RunLengthSamples &x, double average[], double error[]) { AutocorrelationEstimatorImpl(n, ndim, x, average, error, nullptr); }
+
+
+// Slice versions: The multi-dim implementations work on every dimension independently, so we can apply them
+// to the dimensions [j0, j1) only, by passing the full row stride. If the slice covers all dimensions, we use
+// the any-dim wrapper (which may use a one-dim implementation), to keep the results bit-identical.
+static void checkSlice(const int ndim, const int j0, const int j1)
+{
+    if (j0 < 0 || j1 > ndim || j0 >= j1) { throw std::invalid_argument("[EstimatorSlice] Invalid dimension slice."); }
+}
+
+template <class X>
+static void UncorrelatedEstimatorSliceImpl(const int64_t n, const int ndim, const X &x, const int j0, const int j1, double average[], double error[])
+{
+    checkSlice(ndim, j0, j1);
+    if (j1 - j0 == ndim) {
+        UncorrelatedEstimatorImpl(n, ndim, x, average, error);
     }
     else {
-        MJBlockerEstimator(n, ndim, x, average, error);
+        MultiDimUncorrelatedEstimatorImpl(n, j1 - j0, makeRows(offsetSamples(x, j0), ndim), average + j0, error + j0);
     }
 }
 
-// Noop Estimator
-void NoopEstimator(int64_t/*n*/, int ndim, const double x[], double average[], double error[])
+template <class X>
+static void FCBlockerEstimatorSliceImpl(const int64_t n, const int ndim, const X &x, const int j0, const int j1, double average[], double error[])
+{
+    checkSlice(ndim, j0, j1);
+    if (j1 - j0 == ndim) {
+        FCBlockerEstimatorImpl(n, ndim, x, average, error);
+    }
+    else {
+        MultiDimFCBlockerEstimatorImpl(n, j1 - j0, makeRows(offsetSamples(x, j0), ndim), average + j0, error + j0);
+    }
+}
+
+template <class X>
+static void MJBlockerEstimatorSliceImpl(const int64_t n, const int ndim, const X &x, const int j0, const int j1, double average[], double error[])
 {
+    checkSlice(ndim, j0, j1);
+    MJBlocker mjblk(n, j1 - j0, ndim); // reads only the slice of every sample
+    mjblk.estimate(offsetSamples(x, j0), average + j0, error + j0);
+}
+
+template <class T>
+void UncorrelatedEstimatorSlice(const int64_t n, const int ndim, const T x[], const int j0, const int j1, double average[], double error[])
+{
+    UncorrelatedEstimatorSliceImpl(n, ndim, x, j0, j1, average, error);
+}
+
+template <class T>
+void FCBlockerEstimatorSlice(const int64_t n, const int ndim, const T x[], const int j0, const int j1, double average[], double error[])
+{
+    FCBlockerEstimatorSliceImpl(n, ndim, x, j0, j1, average, error);
+}
+
+template <class T>
+void MJBlockerEstimatorSlice(const int64_t n, const int ndim, const T x[], const int j0, const int j1, double average[], double error[])
+{
+    MJBlockerEstimatorSliceImpl(n, ndim, x, j0, j1, average, error);
+}
+
+template <class T>
+void CorrelatedEstimatorSlice(const int64_t n, const int ndim, const T x[], const int j0, const int j1, double average[], double error[])
+{
+    MJBlockerEstimatorSliceImpl(n, ndim, x, j0, j1, average, error);
+}
+
+void StreamingBlockerEstimatorSlice(const int64_t n, const int ndim, const double x[], const int j0, const int j1, double average[], double error[])
+{
+    checkSlice(ndim, j0, j1);
+    StreamingBlockerEstimatorImpl(n, ndim, x, j0, j1, average, error);
+}
+
+template void UncorrelatedEstimatorSlice(int64_t, int, const double[], int, int, double[], double[]);
+template void UncorrelatedEstimatorSlice(int64_t, int, const float[], int, int, double[], double[]);
+template void UncorrelatedEstimatorSlice(int64_t, int, const int16_t[], int, int, double[], double[]);
+template void FCBlockerEstimatorSlice(int64_t, int, const double[], int, int, double[], double[]);
+template void FCBlockerEstimatorSlice(int64_t, int, const float[], int, int, double[], double[]);
+template void FCBlockerEstimatorSlice(int64_t, int, const int16_t[], int, int, double[], double[]);
+template void MJBlockerEstimatorSlice(int64_t, int, const double[], int, int, double[], double[]);
+template void MJBlockerEstimatorSlice(int64_t, int, const float[], int, int, double[], double[]);
+template void MJBlockerEstimatorSlice(int64_t, int, const int16_t[], int, int, double[], double[]);
+template void CorrelatedEstimatorSlice(int64_t, int, const double[], int, int, double[], double[]);
+template void CorrelatedEstimatorSlice(int64_t, int, const float[], int, int, double[], double[]);
+template void CorrelatedEstimatorSlice(int64_t, int, const int16_t[], int, int, double[], double[]);
+
+void UncorrelatedEstimatorSlice(int64_t n, int ndim, const RunLengthSamples &x, int j0, int j1, double average[], double error[]) { UncorrelatedEstimatorSliceImpl(n, ndim, x, j0, j1, average, error); }
+void CorrelatedEstimatorSlice(int64_t n, int ndim, const RunLengthSamples &x, int j0, int j1, double average[], double error[]) { MJBlockerEstimatorSliceImpl(n, ndim, x, j0, j1, average, error); }
+void FCBlockerEstimatorSlice(int64_t n, int ndim, const RunLengthSamples &x, int j0, int j1, double average[], double error[]) { FCBlockerEstimatorSliceImpl(n, ndim, x, j0, j1, average, error); }
+void MJBlockerEstimatorSlice(int64_t n, int ndim, const RunLengthSamples &x, int j0, int j1, double average[], double error[]) { MJBlockerEstimatorSliceImpl(n, ndim, x, j0, j1, average, error); }
+
+// Precomputed Estimator
+void PrecomputedEstimator(const int64_t n, const int ndim, const double x[], double average[], double error[])
+{
+    if (n != 2) { throw std::invalid_argument("[PrecomputedEstimator] Data must consist of exactly 2 rows (average and error)."); }
     std::copy(x, x + ndim, average);
-    std::fill(error, error + ndim, 0.);
+    std::copy(x + ndim, x + 2*ndim, error);
+}
+
+// Delta Method Estimator
+void DeltaMethodEstimator(const int nvals, const double avg[], const double cov[], const std::function<double(const double[])> &f,
+                          double &average, double &error, const double grad[])
+{
+    if (nvals < 1) { throw std::invalid_argument("[DeltaMethodEstimator] Number of values must be at least 1."); }
+    average = f(avg);
+
+    std::vector<double> dfdx(static_cast<size_t>(nvals));
+    if (grad != nullptr) {
+        std::copy(grad, grad + nvals, dfdx.begin());
+    }
+    else { // central differences
+        const double releps = std::cbrt(std::numeric_limits<double>::epsilon());
+        std::vector<double> x(avg, avg + nvals);
+        for (int i = 0; i < nvals; ++i) {
+            double h = releps*std::max(fabs(avg[i]), sqrt(std::max(0., cov[i*nvals + i])));
+            if (h == 0.) { h = releps; }
+            x[i] = avg[i] + h;
+            const double fplus = f(x.data());
+            x[i] = avg[i] - h;
+            const double fminus = f(x.data());
+            x[i] = avg[i];
+            dfdx[i] = (fplus - fminus)/(2.*h);
+        }
+    }
+
+    double var = 0.;
+    for (int i = 0; i < nvals; ++i) {
+        double cgrad = 0.;
+        for (int j = 0; j < nvals; ++j) { cgrad += cov[i*nvals + j]*dfdx[j]; }
+        var += dfdx[i]*cgrad;
+    }
+    error = sqrt(std::max(0., var));
 }
 }  // namespace mci
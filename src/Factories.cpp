@@ -0,0 +1,156 @@
+#include "mci/Factories.hpp"
+
+#include "mci/FixedOrthoPeriodicDomain.hpp"
+#include "mci/FixedSRRDAllMove.hpp"
+#include "mci/FixedSRRDVecMove.hpp"
+#include "mci/OrthoPeriodicDomain.hpp"
+
+#include <utility>
+
+namespace mci
+{
+namespace
+{
+// Call Maker::make<N>(args...) with N being the runtime value n in 1..sizeof...(Ns),
+// via a table of function pointers to all instantiations
+template <class Maker, class ... Args, int ... Ns>
+auto dispatchFixed(const int n, std::integer_sequence<int, Ns...>, Args ... args)
+{
+    using Ret = decltype(Maker::template make<1>(args...));
+    using MakeFun = Ret (*)(Args...);
+    static const MakeFun makers[] = {&Maker::template make<Ns + 1>...};
+    return makers[n - 1](args...);
+}
+
+template <class SRRD>
+struct FixedAllMoveMaker
+{
+    template <int NDIM>
+    static std::unique_ptr<TrialMoveInterface> make(double initStepSize)
+    {
+        return std::unique_ptr<TrialMoveInterface>(new FixedSRRDAllMove<SRRD, NDIM>(initStepSize));
+    }
+};
+
+template <class SRRD>
+struct FixedVecMoveMaker
+{
+    template <int VECLEN>
+    static std::unique_ptr<TrialMoveInterface> make(int nvecs, double initStepSize)
+    {
+        return std::unique_ptr<TrialMoveInterface>(new FixedSRRDVecMove<SRRD, VECLEN>(nvecs, initStepSize));
+    }
+};
+
+struct FixedDomainMaker
+{
+    template <int NDIM>
+    static std::unique_ptr<DomainInterface> make(double lbound, double ubound)
+    {
+        return std::unique_ptr<DomainInterface>(new FixedOrthoPeriodicDomain<NDIM>(lbound, ubound));
+    }
+
+    template <int NDIM>
+    static std::unique_ptr<DomainInterface> make(const double lbounds[], const double ubounds[])
+    {
+        return std::unique_ptr<DomainInterface>(new FixedOrthoPeriodicDomain<NDIM>(lbounds, ubounds));
+    }
+};
+
+template <class SRRD>
+std::unique_ptr<TrialMoveInterface> createFixedAllMove(int ndim, double initStepSize)
+{
+    return dispatchFixed<FixedAllMoveMaker<SRRD> >(ndim, std::make_integer_sequence<int, MAX_FIXED_NDIM>{}, initStepSize);
+}
+
+template <class SRRD>
+std::unique_ptr<TrialMoveInterface> createFixedVecMove(int nvecs, int veclen, double initStepSize)
+{
+    return dispatchFixed<FixedVecMoveMaker<SRRD> >(veclen, std::make_integer_sequence<int, MAX_FIXED_VECLEN>{}, nvecs, initStepSize);
+}
+} // namespace
+
+
+std::unique_ptr<TrialMoveInterface> createFixedSRRDAllMove(SRRDType srrd, int ndim, double initStepSize)
+{
+    if (ndim < 1 || ndim > MAX_FIXED_NDIM) {
+        throw std::invalid_argument("[createFixedSRRDAllMove] ndim must be within [1, MAX_FIXED_NDIM].");
+    }
+
+    switch (srrd) {
+    case (SRRDType::Uniform):
+        return createFixedAllMove<std::uniform_real_distribution<double> >(ndim, initStepSize);
+    case (SRRDType::Gaussian):
+        return createFixedAllMove<std::normal_distribution<double> >(ndim, initStepSize);
+    case (SRRDType::Student):
+        return createFixedAllMove<std::student_t_distribution<double> >(ndim, initStepSize);
+    case (SRRDType::Cauchy):
+        return createFixedAllMove<std::cauchy_distribution<double> >(ndim, initStepSize);
+    case (SRRDType::Exponential):
+        return createFixedAllMove<SymmetrizedPRRD<std::exponential_distribution<double> > >(ndim, initStepSize);
+    case (SRRDType::Gamma):
+        return createFixedAllMove<SymmetrizedPRRD<std::gamma_distribution<double> > >(ndim, initStepSize);
+    case (SRRDType::Weibull):
+        return createFixedAllMove<SymmetrizedPRRD<std::weibull_distribution<double> > >(ndim, initStepSize);
+    case (SRRDType::Lognormal):
+        return createFixedAllMove<SymmetrizedPRRD<std::lognormal_distribution<double> > >(ndim, initStepSize);
+    case (SRRDType::Chisq):
+        return createFixedAllMove<SymmetrizedPRRD<std::chi_squared_distribution<double> > >(ndim, initStepSize);
+    case (SRRDType::Fisher):
+        return createFixedAllMove<SymmetrizedPRRD<std::fisher_f_distribution<double> > >(ndim, initStepSize);
+
+    default:
+        throw std::domain_error("[createFixedSRRDAllMove] Unhandled SRRDType enumerator.");
+    }
+}
+
+std::unique_ptr<TrialMoveInterface> createFixedSRRDVecMove(SRRDType srrd, int nvecs, int veclen, double initStepSize)
+{
+    if (veclen < 1 || veclen > MAX_FIXED_VECLEN) {
+        throw std::invalid_argument("[createFixedSRRDVecMove] veclen must be within [1, MAX_FIXED_VECLEN].");
+    }
+
+    switch (srrd) {
+    case (SRRDType::Uniform):
+        return createFixedVecMove<std::uniform_real_distribution<double> >(nvecs, veclen, initStepSize);
+    case (SRRDType::Gaussian):
+        return createFixedVecMove<std::normal_distribution<double> >(nvecs, veclen, initStepSize);
+    case (SRRDType::Student):
+        return createFixedVecMove<std::student_t_distribution<double> >(nvecs, veclen, initStepSize);
+    case (SRRDType::Cauchy):
+        return createFixedVecMove<std::cauchy_distribution<double> >(nvecs, veclen, initStepSize);
+    case (SRRDType::Exponential):
+        return createFixedVecMove<SymmetrizedPRRD<std::exponential_distribution<double> > >(nvecs, veclen, initStepSize);
+    case (SRRDType::Gamma):
+        return createFixedVecMove<SymmetrizedPRRD<std::gamma_distribution<double> > >(nvecs, veclen, initStepSize);
+    case (SRRDType::Weibull):
+        return createFixedVecMove<SymmetrizedPRRD<std::weibull_distribution<double> > >(nvecs, veclen, initStepSize);
+    case (SRRDType::Lognormal):
+        return createFixedVecMove<SymmetrizedPRRD<std::lognormal_distribution<double> > >(nvecs, veclen, initStepSize);
+    case (SRRDType::Chisq):
+        return createFixedVecMove<SymmetrizedPRRD<std::chi_squared_distribution<double> > >(nvecs, veclen, initStepSize);
+    case (SRRDType::Fisher):
+        return createFixedVecMove<SymmetrizedPRRD<std::fisher_f_distribution<double> > >(nvecs, veclen, initStepSize);
+
+    default:
+        throw std::domain_error("[createFixedSRRDVecMove] Unhandled SRRDType enumerator.");
+    }
+}
+
+
+std::unique_ptr<DomainInterface> createOrthoPeriodicDomain(const int ndim, const double lbound, const double ubound)
+{
+    if (ndim >= 1 && ndim <= MAX_FIXED_NDIM) {
+        return dispatchFixed<FixedDomainMaker>(ndim, std::make_integer_sequence<int, MAX_FIXED_NDIM>{}, lbound, ubound);
+    }
+    return std::unique_ptr<DomainInterface>(new OrthoPeriodicDomain(ndim, lbound, ubound));
+}
+
+std::unique_ptr<DomainInterface> createOrthoPeriodicDomain(const int ndim, const double lbounds[], const double ubounds[])
+{
+    if (ndim >= 1 && ndim <= MAX_FIXED_NDIM) {
+        return dispatchFixed<FixedDomainMaker>(ndim, std::make_integer_sequence<int, MAX_FIXED_NDIM>{}, lbounds, ubounds);
+    }
+    return std::unique_ptr<DomainInterface>(new OrthoPeriodicDomain(ndim, lbounds, ubounds));
+}
+} // namespace mci
@@ -1,34 +1,316 @@
 #include "mci/FullAccumulator.hpp"
+#include "mci/BinaryIO.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
 
 namespace mci
 {
 
+void FullAccumulator::_mapData()
+{
+    const auto nbytes = static_cast<size_t>(this->getNData())*sizeof(double);
+    std::string path = _mapdir + "/mci_samples_XXXXXX";
+    const int fd = mkstemp(&path[0]);
+    if (fd < 0) {
+        throw std::runtime_error("[FullAccumulator::mapData] Failed to create temporary file in " + _mapdir + ": " + std::strerror(errno));
+    }
+    unlink(path.c_str()); // removed as soon as unmapped
+    if (ftruncate(fd, static_cast<off_t>(nbytes)) != 0) { // sparse file, reads as zeros
+        const int err = errno;
+        close(fd);
+        throw std::runtime_error("[FullAccumulator::mapData] Failed to resize temporary file: " + std::string(std::strerror(err)));
+    }
+    void * const ptr = mmap(nullptr, nbytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const int err = errno;
+    close(fd); // the mapping keeps the file alive
+    if (ptr == MAP_FAILED) {
+        throw std::runtime_error("[FullAccumulator::mapData] Failed to map temporary file: " + std::string(std::strerror(err)));
+    }
+
+    // samples are written and read sequentially (the hints may be ignored)
+    madvise(ptr, nbytes, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise(ptr, nbytes, MADV_HUGEPAGE);
+#endif
+    _data = static_cast<double *>(ptr);
+    _flag_mapped = true;
+}
+
+void FullAccumulator::_unmapData()
+{
+    munmap(_data, static_cast<size_t>(this->getNData())*sizeof(double));
+    _data = nullptr;
+    _flag_mapped = false;
+}
+
+
+size_t FullAccumulator::getNBytes() const
+{
+    if (_rstore) { return _rstore->getNBytes(); }
+    if (_flag_rle) { return _runs.getNBytes(); }
+    return (_data != nullptr) ? static_cast<size_t>(this->getNData())*sizeof(double) : 0;
+}
+
+
 void FullAccumulator::_allocate()
 {
     _nstore = this->getNAccu();
-    _data = new double[this->getNData()]; // _nstore * _nobs layout
+    if (_rstore) {
+        _rstore->allocate(_nstore);
+        return;
+    }
+    if (!_mapdir.empty()) {
+        this->_mapData();
+        return;
+    }
+    _flag_rle = _flag_runlength && _nwalkers == 1; // ensemble averages rarely repeat
+    if (_flag_rle) { // no plain sample array at all
+        _runs.reserve(_nstore/4 + 1); // will grow if necessary
+        return;
+    }
+    _data = this->_newData(this->getNData()); // _nstore * _nobs layout
     std::fill(_data, _data + this->getNData(), 0.); // not strictly necessary
 }
 
 
 void FullAccumulator::_accumulate()
 {
-    std::copy(_obs_values, _obs_values + _nobs, _data + _storeidx);
+    if (_rstore) {
+        _rstore->store(_storeidx/_nobs, _obs_values);
+    }
+    else if (_flag_rle) {
+        if (_flag_repeat && _runs.getNRuns() > 0) {
+            _runs.repeat();
+        }
+        else {
+            _runs.store(_obs_values);
+        }
+    }
+    else {
+        std::copy(_obs_values, _obs_values + _nobs, _data + _storeidx);
+    }
     _storeidx += _nobs;
 }
 
 
+void FullAccumulator::_finalize()
+{   // the estimators read run-length samples directly, we only free the unused reserve
+    if (_flag_rle) { _runs.shrink(); }
+}
+
+
 void FullAccumulator::_reset()
 {
+    if (_flag_mapped) { // don't touch more pages than written
+        std::fill(_data, _data + _storeidx, 0.);
+    }
+    else if (_data != nullptr) {
+        std::fill(_data, _data + this->getNData(), 0.);
+    }
     _storeidx = 0;
-    std::fill(_data, _data + this->getNData(), 0.);
+    _runs.clear();
+    if (_rstore) { _rstore->clear(); }
 }
 
 
 void FullAccumulator::_deallocate()
 {
-    delete[] _data;
-    _data = nullptr;
+    if (_flag_mapped) {
+        this->_unmapData();
+    }
+    else {
+        this->_deleteData();
+    }
     _nstore = 0;
+    _flag_rle = false;
+    if (_rstore) { _rstore->deallocate(); }
+    _runs.deallocate();
+}
+
+
+int64_t FullAccumulator::_getNFixedRows() const
+{   // with run-length storage, these are the runs except the last one (which may still be repeated)
+    if (_flag_rle) { return std::max(_runs.getNRuns() - 1, int64_t(0)); }
+    return _storeidx/_nobs;
+}
+
+
+void FullAccumulator::_writeData(std::ostream &os) const
+{   // only what's not in the fixed rows
+    writeBinary(os, _storeidx);
+    writeBinary(os, static_cast<int32_t>(_flag_rle ? 1 : 0));
+    if (_rstore) {
+        _rstore->writeHeader(os);
+    }
+    else if (_flag_rle) {
+        writeBinary(os, _runs.getNRuns());
+        _runs.writeRuns(os, this->_getNFixedRows(), _runs.getNRuns());
+    }
+}
+
+
+void FullAccumulator::_readData(std::istream &is)
+{
+    int32_t flag_rle;
+    readBinary(is, _storeidx);
+    readBinary(is, flag_rle);
+    if (_storeidx < 0 || _storeidx > this->getNData()) {
+        throw std::runtime_error("[FullAccumulator::readData] Stored data length is out of range.");
+    }
+    if ((flag_rle != 0) != _flag_rle) {
+        throw std::runtime_error("[FullAccumulator::readData] Stored state does not match the run-length storage setting.");
+    }
+    if (_rstore) {
+        _rstore->readHeader(is);
+        if (_rstore->getNRows() != _storeidx/_nobs) { throw std::runtime_error("[FullAccumulator::readData] Stored number of rows is inconsistent."); }
+    }
+    else if (_flag_rle) {
+        int64_t nruns;
+        readBinary(is, nruns);
+        _runs.readRuns(is, _runs.getNRuns(), nruns);
+        if (_runs.getNRows() != _storeidx/_nobs) { throw std::runtime_error("[FullAccumulator::readData] Stored runs are inconsistent with the number of rows."); }
+    }
+}
+
+
+void FullAccumulator::_writeRows(std::ostream &os, const int64_t row0, const int64_t row1) const
+{
+    if (_rstore) {
+        _rstore->writeRows(os, row0, row1);
+    }
+    else if (_flag_rle) {
+        _runs.writeRuns(os, row0, row1);
+    }
+    else {
+        writeBinary(os, _data + row0*_nobs, (row1 - row0)*_nobs);
+    }
+}
+
+
+void FullAccumulator::_readRows(std::istream &is, const int64_t row0, const int64_t row1)
+{
+    if (row1 > _nstore) { throw std::runtime_error("[FullAccumulator::readRows] Stored rows are out of range."); }
+    if (_rstore) {
+        _rstore->readRows(is, row0, row1);
+    }
+    else if (_flag_rle) {
+        _runs.readRuns(is, row0, row1);
+    }
+    else {
+        readBinary(is, _data + row0*_nobs, (row1 - row0)*_nobs);
+    }
+}
+
+
+void FullAccumulator::_merge(const AccumulatorInterface &other)
+{   // append the samples of other
+    const auto &o = static_cast<const FullAccumulator &>(other);
+    if (o.getStoragePrecision() != this->getStoragePrecision()) {
+        throw std::invalid_argument("[FullAccumulator::merge] Accumulators differ in storage precision.");
+    }
+    const int64_t ndata = this->getNData();
+    const int64_t nstore = _nstore + o._nstore;
+    if (_rstore) {
+        _rstore->append(*o._rstore, o._nstore);
+    }
+    else if (_flag_rle) {
+        if (o._flag_rle) {
+            _runs.append(o._runs);
+        }
+        else {
+            for (int64_t i = 0; i < o._nstore; ++i) { _runs.add(o._data + i*_nobs); }
+        }
+    }
+    else {
+        if (_flag_mapped) { // map a new file of the merged size
+            double * const olddata = _data;
+            _nstore = nstore;
+            try {
+                this->_mapData();
+            }
+            catch (...) {
+                _nstore = nstore - o._nstore;
+                throw;
+            }
+            std::copy(olddata, olddata + ndata, _data);
+            munmap(olddata, static_cast<size_t>(ndata)*sizeof(double));
+        }
+        else {
+            this->_growData(ndata, ndata + o.getNData());
+        }
+        if (o._flag_rle) { // expand the runs of other
+            const RunLengthRows orows(o._runs.getSamples(), _nobs);
+            for (int64_t i = 0; i < o._nstore; ++i) { std::copy(orows[i], orows[i] + _nobs, _data + ndata + i*_nobs); }
+        }
+        else {
+            std::copy(o._data, o._data + o.getNData(), _data + ndata);
+        }
+    }
+    _nstore = nstore;
+    _storeidx = this->getNData();
+}
+
+
+void FullAccumulator::_serialize(std::ostream &os) const
+{   // with run-length storage only the runs
+    writeBinary(os, static_cast<int32_t>(this->getStoragePrecision()));
+    writeBinary(os, _nstore);
+    writeBinary(os, static_cast<int32_t>(_flag_rle ? 1 : 0));
+    if (_rstore) {
+        _rstore->write(os, _nstore);
+    }
+    else if (_flag_rle) {
+        _runs.write(os);
+    }
+    else {
+        writeBinary(os, _data, this->getNData());
+    }
+}
+
+
+void FullAccumulator::_deserialize(std::istream &is)
+{   // the stored samples are converted, if our run-length setting differs
+    int32_t precision, flag_rle;
+    int64_t nstore;
+    readBinary(is, precision);
+    readBinary(is, nstore);
+    readBinary(is, flag_rle);
+    if (precision != static_cast<int32_t>(this->getStoragePrecision())) {
+        throw std::invalid_argument("[FullAccumulator::deserialize] Stored storage precision does not match.");
+    }
+    if (nstore != this->getNAccu()) {
+        throw std::runtime_error("[FullAccumulator::deserialize] Stored number of samples is inconsistent.");
+    }
+    this->_allocate();
+    _storeidx = this->getNData();
+    if (_rstore) {
+        _rstore->read(is, _nstore);
+    }
+    else if (flag_rle != 0 && _flag_rle) {
+        _runs.read(is, _nstore);
+    }
+    else if (flag_rle != 0) { // expand
+        RunLengthStorage runs(_nobs);
+        runs.read(is, _nstore);
+        const RunLengthRows rows(runs.getSamples(), _nobs);
+        for (int64_t i = 0; i < _nstore; ++i) { std::copy(rows[i], rows[i] + _nobs, _data + i*_nobs); }
+    }
+    else if (_flag_rle) { // compress
+        std::vector<double> vals(static_cast<size_t>(_nobs));
+        for (int64_t i = 0; i < _nstore; ++i) {
+            readBinary(is, vals.data(), _nobs);
+            _runs.add(vals.data());
+        }
+    }
+    else {
+        readBinary(is, _data, this->getNData());
+    }
 }
 }  // namespace mci
@@ -0,0 +1,153 @@
+#include "mci/HistogramAccumulator.hpp"
+#include "mci/BinaryIO.hpp"
+
+#include <algorithm>
+
+namespace mci
+{
+
+void HistogramAccumulator::_evaluate(const double in[], double values[])
+{
+    if (_nwalkers > 1) { // dense histogram per walker, averaged by the base
+        _histobs.observableFunction(in, values);
+        return;
+    }
+    for (int i = 0; i < _nhits; ++i) { values[_bins[i]] = 0.; } // values are zero except for the last hits
+    _nhits = 0; // in case computeHits throws
+    _nhits = _histobs.computeHits(in, _bins.get(), _weights.get());
+    for (int i = 0; i < _nhits; ++i) { values[_bins[i]] += _weights[i]; }
+}
+
+
+void HistogramAccumulator::_allocate()
+{
+    if (_blocksize > 0) {
+        if (this->getNAccu() < _blocksize) {
+            throw std::invalid_argument("[HistogramAccumulator::allocate] Requested number of accumulations is smaller than the requested block size.");
+        }
+        if (this->getNAccu()%_blocksize != 0) {
+            throw std::invalid_argument("[HistogramAccumulator::allocate] Requested number of accumulations is not a multiple of the requested block size.");
+        }
+    }
+    _nblocksize = (_blocksize > 0) ? _blocksize : this->getNAccu();
+    _nblocks = this->getNAccu()/_nblocksize;
+    _data = this->_newData(this->getNData()); // _nblocks * _nobs layout
+    std::fill(_data, _data + this->getNData(), 0.);
+
+    // the sparse evaluation expects zeroed last values
+    std::fill(_obs_values, _obs_values + _nobs, 0.);
+    _nhits = 0;
+}
+
+
+void HistogramAccumulator::_accumulate()
+{
+    double * const hist = _data + _storeidx;
+    if (_nwalkers > 1) { // dense walker average
+        for (int i = 0; i < _nobs; ++i) { hist[i] += _obs_values[i]; }
+    }
+    else {
+        for (int i = 0; i < _nhits; ++i) { hist[_bins[i]] += _weights[i]; }
+    }
+
+    if (++_bidx == _nblocksize) {
+        _bidx = 0;
+        _storeidx += _nobs; // move to next block
+    }
+}
+
+
+void HistogramAccumulator::_finalize()
+{
+    const double normf = 1./_nblocksize;
+    for (int64_t i = 0; i < this->getNData(); ++i) { _data[i] *= normf; }
+}
+
+
+void HistogramAccumulator::_reset()
+{
+    _bidx = 0;
+    _storeidx = 0;
+    if (_data != nullptr) { std::fill(_data, _data + this->getNData(), 0.); }
+}
+
+
+void HistogramAccumulator::_deallocate()
+{
+    this->_deleteData();
+    _nblocks = 0;
+    _nblocksize = 0;
+}
+
+
+void HistogramAccumulator::_writeData(std::ostream &os) const
+{   // the finished blocks, the current one and the last hits
+    writeBinary(os, _bidx);
+    writeBinary(os, _storeidx);
+    writeBinary(os, _data, std::min(_storeidx + _nobs, this->getNData()));
+    writeBinary(os, static_cast<int32_t>(_nhits));
+    writeBinary(os, _bins.get(), _nhits);
+    writeBinary(os, _weights.get(), _nhits);
+}
+
+
+void HistogramAccumulator::_readData(std::istream &is)
+{
+    readBinary(is, _bidx);
+    readBinary(is, _storeidx);
+    if (_bidx < 0 || _bidx >= _nblocksize || _storeidx < 0 || _storeidx > this->getNData()) {
+        throw std::runtime_error("[HistogramAccumulator::readData] Stored block indices are out of range.");
+    }
+    readBinary(is, _data, std::min(_storeidx + _nobs, this->getNData()));
+    int32_t nhits;
+    readBinary(is, nhits);
+    if (nhits < 0 || nhits > _histobs.getMaxHits()) {
+        throw std::runtime_error("[HistogramAccumulator::readData] Stored number of hits is out of range.");
+    }
+    _nhits = nhits;
+    readBinary(is, _bins.get(), _nhits);
+    readBinary(is, _weights.get(), _nhits);
+    for (int i = 0; i < _nhits; ++i) {
+        if (_bins[i] < 0 || _bins[i] >= _nobs) {
+            throw std::runtime_error("[HistogramAccumulator::readData] Stored bin index is out of range.");
+        }
+    }
+}
+
+
+void HistogramAccumulator::_merge(const AccumulatorInterface &other)
+{
+    const auto &o = static_cast<const HistogramAccumulator &>(other);
+    if (o._blocksize != _blocksize) { throw std::invalid_argument("[HistogramAccumulator::merge] Accumulators differ in blocksize."); }
+    if (_blocksize == 0) { // the single blocks are averaged, weighted by their size
+        const double w = static_cast<double>(o._nblocksize)/(_nblocksize + o._nblocksize);
+        for (int i = 0; i < _nobs; ++i) { _data[i] += w*(o._data[i] - _data[i]); }
+        _nblocksize += o._nblocksize;
+        return;
+    }
+    this->_growData(this->getNData(), (_nblocks + o._nblocks)*_nobs); // append the blocks of other
+    std::copy(o._data, o._data + o.getNData(), _data + this->getNData());
+    _nblocks += o._nblocks;
+    _storeidx = this->getNData();
+}
+
+
+void HistogramAccumulator::_serialize(std::ostream &os) const
+{
+    writeBinary(os, _nblocks);
+    writeBinary(os, _data, this->getNData());
+}
+
+
+void HistogramAccumulator::_deserialize(std::istream &is)
+{
+    int64_t nblocks;
+    readBinary(is, nblocks);
+    this->_allocate(); // checks the number of accumulations against the blocksize
+    if (nblocks != _nblocks) {
+        throw std::invalid_argument("[HistogramAccumulator::deserialize] Stored number of blocks does not match the blocksize.");
+    }
+    _storeidx = this->getNData();
+    readBinary(is, _data, this->getNData());
+}
+}  // namespace mci
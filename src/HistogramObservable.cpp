@@ -0,0 +1,42 @@
+#include "mci/HistogramObservable.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace mci
+{
+
+HistogramObservable::HistogramObservable(const int ndim, const int nbins, const int maxhits):
+        ObservableFunctionInterface(ndim, nbins, false), _maxhits(maxhits)
+{
+    if (nbins < 1) { throw std::invalid_argument("[HistogramObservable] Provided number of bins was < 1 ."); }
+    if (maxhits < 1) { throw std::invalid_argument("[HistogramObservable] Provided maximal number of hits was < 1 ."); }
+    _hbins.resize(static_cast<size_t>(_maxhits));
+    _hweights.resize(static_cast<size_t>(_maxhits));
+}
+
+
+int HistogramObservable::computeHits(const double in[], int bins[], double weights[])
+{
+    const int nhits = this->histogramFunction(in, bins, weights);
+    if (nhits < 0 || nhits > _maxhits) {
+        throw std::out_of_range("[HistogramObservable::computeHits] Returned number of hits is out of range.");
+    }
+    for (int i = 0; i < nhits; ++i) {
+        if (bins[i] < 0 || bins[i] >= _nobs) {
+            throw std::out_of_range("[HistogramObservable::computeHits] Returned bin index is out of range.");
+        }
+    }
+    return nhits;
+}
+
+
+void HistogramObservable::observableFunction(const double in[], double out[])
+{
+    const int nhits = this->computeHits(in, _hbins.data(), _hweights.data());
+    std::fill(out, out + _nobs, 0.);
+    for (int i = 0; i < nhits; ++i) {
+        out[_hbins[i]] += _hweights[i];
+    }
+}
+}  // namespace mci
@@ -1,12 +1,18 @@
 #include "mci/MCIntegrator.hpp"
 
-#include "mci/OrthoPeriodicDomain.hpp"
 #include "mci/UnboundDomain.hpp"
 
+#include "mci/BinaryIO.hpp"
+
 #include <iostream>
 #include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <sstream>
+#include <thread>
 
 #if USE_MPI == 1
+#include <climits>
 #include <mpi.h>
 
 bool isMPIUsable()
@@ -33,6 +39,63 @@ void MPIReduceAvgErr(const int nobsdim, double avg[]/*inout*/, double err[]/*ino
     }
 }
 
+void MPIThrowIfAnyFailed(const std::exception_ptr &except, const char * msg)
+{   // collective: if any rank failed, all ranks throw (the failed ones their own exception, the others msg)
+    const int myok = except ? 0 : 1;
+    int allok;
+    MPI_Allreduce(&myok, &allok, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (except) { std::rethrow_exception(except); }
+    if (allok == 0) { throw std::runtime_error(msg); }
+}
+
+void MPIMergeContainers(mci::ObservableContainer &cont)
+{   // gather the serialized accumulations of all ranks on rank 0 and merge them there
+    // NOTE: Errors before the gather are agreed on by all ranks, so every rank throws. If merging on rank 0 throws,
+    // the caller has to inform the other ranks (see MCI::integrateMPI).
+    int myrank, nranks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nranks);
+
+    std::string mybuf;
+    std::exception_ptr except;
+    try {
+        std::ostringstream oss;
+        if (myrank != 0) { cont.serialize(oss); }
+        mybuf = oss.str();
+    }
+    catch (...) {
+        except = std::current_exception();
+    }
+    MPIThrowIfAnyFailed(except, "[MPIMergeContainers] Serialization failed on another rank.");
+
+    // all ranks know all sizes, so they agree on the size limit
+    const int64_t mysize = static_cast<int64_t>(mybuf.size());
+    std::vector<int64_t> sizes64(static_cast<size_t>(nranks));
+    MPI_Allgather(&mysize, 1, MPI_INT64_T, sizes64.data(), 1, MPI_INT64_T, MPI_COMM_WORLD);
+    std::vector<int> sizes(static_cast<size_t>(nranks)), displs(static_cast<size_t>(nranks));
+    int64_t total = 0;
+    for (int i = 0; i < nranks; ++i) {
+        if (total + sizes64[i] > INT_MAX) {
+            throw std::runtime_error("[MPIMergeContainers] Serialized accumulations exceed the MPI message size limit.");
+        }
+        sizes[i] = static_cast<int>(sizes64[i]);
+        displs[i] = static_cast<int>(total);
+        total += sizes64[i];
+    }
+    std::vector<char> buf((myrank == 0) ? static_cast<size_t>(total) : 0);
+    MPI_Gatherv(const_cast<char *>(mybuf.data()), sizes[myrank], MPI_CHAR, buf.data(), sizes.data(), displs.data(), MPI_CHAR, 0, MPI_COMM_WORLD);
+    std::string().swap(mybuf);
+
+    if (myrank == 0) {
+        auto other = cont.createEquivalent();
+        for (int i = 1; i < nranks; ++i) {
+            std::istringstream iss(std::string(buf.data() + displs[i], static_cast<size_t>(sizes[i])));
+            other->deserialize(iss);
+            cont.merge(*other);
+        }
+    }
+}
+
 #endif
 
 namespace mci
@@ -41,44 +104,206 @@ namespace mci
 //  --- Integrate
 
 void MCI::integrate(const int64_t Nmc, double average[], double error[], const bool doFindMRT2step, const bool doDecorrelation)
+{
+    this->sampleIntegration(Nmc, doFindMRT2step, doDecorrelation);
+    if (Nmc > 0) {
+        this->estimateIntegration(average, error);
+        _obscont.deallocate();
+    }
+}
+
+
+void MCI::integrateParallel(int nthreads, const int64_t Nmc, double average[], double error[], const bool doFindMRT2step, const bool doDecorrelation)
+{
+#if USE_MPI == 1
+    if (isMPIUsable()) {
+        throw std::runtime_error("[MCI::integrateParallel] Thread-parallel integration can't be used while MPI is initialized.");
+    }
+#endif
+    if (nthreads < 1) { nthreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency())); }
+    if (nthreads == 1 || Nmc < nthreads) { // nothing to parallelize
+        this->integrate(Nmc, average, error, doFindMRT2step, doDecorrelation);
+        return;
+    }
+
+    // create worker MCIs, seeded from our own generator
+    std::vector<std::unique_ptr<MCI> > workers;
+    workers.reserve(static_cast<size_t>(nthreads - 1));
+    for (int i = 1; i < nthreads; ++i) {
+        workers.push_back(this->createWorkerClone(_rgen()));
+    }
+
+    // distribute steps
+    std::vector<int64_t> nmcs(static_cast<size_t>(nthreads), Nmc/nthreads);
+    for (int i = 0; i < Nmc%nthreads; ++i) { ++nmcs[i]; }
+    std::vector<std::exception_ptr> excepts(static_cast<size_t>(nthreads));
+
+    // run the chains (index 0 is this MCI)
+    auto runChain = [&](const int i) {
+        try {
+            MCI &mci = (i == 0) ? *this : *workers[i - 1];
+            mci.sampleIntegration(nmcs[i], doFindMRT2step, doDecorrelation);
+        }
+        catch (...) {
+            excepts[i] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(workers.size());
+    for (int i = 1; i < nthreads; ++i) { threads.emplace_back(runChain, i); }
+    runChain(0);
+    for (auto &t : threads) { t.join(); }
+
+    // merge the accumulated data of all chains into ours and estimate on the merged data
+    try {
+        for (auto &e : excepts) {
+            if (e) { std::rethrow_exception(e); }
+        }
+        for (auto &worker : workers) {
+            _obscont.merge(worker->_obscont);
+            worker->_obscont.deallocate();
+        }
+        this->estimateIntegration(average, error);
+    }
+    catch (...) {
+        _obscont.deallocate();
+        throw;
+    }
+    _obscont.deallocate();
+}
+
+
+void MCI::integrateMPI(const int64_t Nmc, double average[], double error[], const bool doFindMRT2step, const bool doDecorrelation)
+{
+#if USE_MPI == 1
+    if (!isMPIUsable()) { throw std::runtime_error("[MCI::integrateMPI] MPI is not initialized (or finalized already)."); }
+    // NOTE: Errors are agreed on by all ranks before the next collective call, so that all ranks throw instead
+    // of leaving some of them waiting forever.
+    std::exception_ptr except;
+    try {
+        this->sampleIntegration(Nmc, doFindMRT2step, doDecorrelation);
+    }
+    catch (...) {
+        except = std::current_exception();
+    }
+    MPIThrowIfAnyFailed(except, "[MCI::integrateMPI] Sampling failed on another rank.");
+    if (Nmc <= 0) { return; }
+
+    int myrank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+    try {
+        MPIMergeContainers(_obscont); // throws on all ranks, except for errors in merging on rank 0
+        if (myrank == 0) { this->estimateIntegration(average, error); }
+    }
+    catch (...) {
+        except = std::current_exception();
+    }
+    _obscont.deallocate();
+    int ok = except ? 0 : 1; // rank 0 decides
+    MPI_Bcast(&ok, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (except) { std::rethrow_exception(except); }
+    if (ok == 0) { throw std::runtime_error("[MCI::integrateMPI] Merging or estimation failed on rank 0."); }
+
+    // distribute the results
+    const int nobsdim = _obscont.getNObsDim();
+    MPI_Bcast(average, nobsdim, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    MPI_Bcast(error, nobsdim, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    const int ncov = _obscont.getNCovarianceDim();
+    _covavg.resize(static_cast<size_t>(ncov));
+    _covmat.resize(static_cast<size_t>(ncov)*ncov);
+    if (ncov > 0) {
+        MPI_Bcast(_covavg.data(), ncov, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        MPI_Bcast(_covmat.data(), ncov*ncov, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    }
+#else
+    (void) Nmc; (void) average; (void) error; (void) doFindMRT2step; (void) doDecorrelation;
+    throw std::runtime_error("[MCI::integrateMPI] MCI was built without MPI support.");
+#endif
+}
+
+
+void MCI::sampleIntegration(const int64_t Nmc, const bool doFindMRT2step, const bool doDecorrelation)
 {
     if (!_pdfcont.hasPDF() && !_domain->isFinite()) {
         throw std::domain_error("[MCI::integrate] Integrating over an infinite domain requires a sampling function.");
     }
 
-    if (_pdfcont.hasPDF()) {
+    const bool resume = (_nmcresume > 0); // continue the integration restored by loadCheckpoint()?
+    if (resume && Nmc != _nmcresume) {
+        throw std::invalid_argument("[MCI::integrate] Nmc does not match the integration restored by loadCheckpoint().");
+    }
+    _nmcrun = 0;
+    _ckprows.clear(); // the first checkpoint starts a new rows file
+
+    int64_t ndecorr = 0; // number of steps used for decorrelation
+    if (_pdfcont.hasPDF() && !resume) {
         //find the optimal mrt2 step
         if (doFindMRT2step) { this->findMRT2Step(); }
         // take care to do the initial decorrelation of the walker
-        if (doDecorrelation) { this->initialDecorrelation(); }
+        if (doDecorrelation) { ndecorr = this->initialDecorrelation(); }
+    }
+
+    if (_nwalkers > 1 && !resume && (doDecorrelation || !_flagensinit)) {
+        // spawn the ensemble from the main walker and let the walkers decorrelate from each other
+        _wlkens->setX(_wlkstate.xold);
+        _flagensinit = true;
+        if (ndecorr > 0) { this->sampleEnsemble(ndecorr, nullptr, false); }
     }
 
     if (Nmc > 0) {
-        // allocation of the accumulators where the data will be stored
-        _obscont.allocate(Nmc, _pdfcont);
+        // allocation of the accumulators where the data will be stored (restored data is allocated already)
+        if (!resume) { _obscont.allocate(Nmc, _pdfcont, _nwalkers); }
 
         //sample the observables
-        if (_flagobsfile) { _obsfile.open(_pathobsfile); }
-        if (_flagwlkfile) { _wlkfile.open(_pathwlkfile); }
-        this->sample(Nmc, _obscont, true); // let sample accumulate data
-        if (_flagobsfile) { _obsfile.close(); }
-        if (_flagwlkfile) { _wlkfile.close(); }
-
-        // estimate average and standard deviation
-        _obscont.estimate(average, error);
-
-        // if we sampled randomly, scale results by volume
-        if (!_pdfcont.hasPDF()) {
-            const double vol = _domain->getVolume();
-            for (int i = 0; i < _obscont.getNObsDim(); ++i) {
-                average[i] *= vol;
-                error[i] *= vol;
-            }
+        _nmcrun = Nmc;
+        this->openFiles(resume);
+        if (_nwalkers > 1) {
+            this->sampleEnsemble(Nmc, &_obscont, true); // let all walkers accumulate data
+        }
+        else {
+            this->sample(Nmc, _obscont, true); // let sample accumulate data
+        }
+        this->closeFiles();
+        this->joinCheckpointWriter();
+        _nmcrun = 0;
+    }
+}
+
+
+void MCI::estimateIntegration(double average[], double error[])
+{
+    // estimate average and standard deviation
+    const int nestimthreads = (_nestimthreads < 1) ? static_cast<int>(std::thread::hardware_concurrency()) : _nestimthreads;
+    _obscont.estimate(average, error, nestimthreads);
+
+    // keep averages and covariance of the OnlineCovariance observables (see estimateDerived())
+    const int ncov = _obscont.getNCovarianceDim();
+    _covavg.assign(static_cast<size_t>(ncov), 0.);
+    _covmat.assign(static_cast<size_t>(ncov)*ncov, 0.);
+    if (ncov > 0) {
+        _obscont.getCovariance()->getMean(_covavg.data());
+        _obscont.getCovariance()->getMeanCovariance(_covmat.data());
+    }
+
+    // if we sampled randomly, scale results by volume
+    if (!_pdfcont.hasPDF()) {
+        const double vol = _domain->getVolume();
+        for (int i = 0; i < _obscont.getNObsDim(); ++i) {
+            average[i] *= vol;
+            error[i] *= vol;
         }
+        for (auto &c : _covavg) { c *= vol; }
+        for (auto &c : _covmat) { c *= vol*vol; }
+    }
+}
 
-        // deallocate
-        _obscont.deallocate();
+
+void MCI::estimateDerived(const std::function<double(const double[])> &f, double &average, double &error, const double grad[]) const
+{
+    if (_covavg.empty()) {
+        throw std::runtime_error("[MCI::estimateDerived] No covariance available, i.e. no observable with EstimatorType::OnlineCovariance was integrated.");
     }
+    DeltaMethodEstimator(this->getNCovarianceDim(), _covavg.data(), _covmat.data(), f, average, error, grad);
 }
 
 
@@ -168,7 +393,7 @@ void MCI::findMRT2Step()
 }
 
 
-void MCI::initialDecorrelation()
+int64_t MCI::initialDecorrelation()
 {
     if (_NdecorrelationSteps < 0) {
         // automatic equilibration of contained observables with flag_equil = true
@@ -240,10 +465,13 @@ void MCI::initialDecorrelation()
             std::copy(newerrestim.begin(), newerrestim.end(), olderrestim.begin());
         }
         //memory deallocated automatically
+        return MIN_NMC + countNMC;
     }
-    else if (_NdecorrelationSteps > 0) {
+    if (_NdecorrelationSteps > 0) {
         this->sample(_NdecorrelationSteps);
+        return _NdecorrelationSteps;
     }
+    return 0;
 }
 
 
@@ -252,6 +480,11 @@ void MCI::initialDecorrelation()
 void MCI::initializeSampling(ObservableContainer * obsCont)
 {
     const bool flag_obs = (obsCont != nullptr);
+    if (flag_obs && _nmcresume > 0) { // state was restored by loadCheckpoint()
+        _nmcresume = 0;
+        if (_cback) { _cback(*this); }
+        return;
+    }
 
     // reset running counters
     _acc = 0;
@@ -270,6 +503,34 @@ void MCI::initializeSampling(ObservableContainer * obsCont)
     }
 }
 
+void MCI::initializeEnsembleSampling(ObservableContainer * obsCont)
+{
+    const bool flag_obs = (obsCont != nullptr);
+    if (flag_obs && _nmcresume > 0) { // state was restored by loadCheckpoint()
+        _nmcresume = 0;
+        if (_cback) { _cback(*this); }
+        return;
+    }
+
+    // reset running counters
+    _acc = 0;
+    _rej = 0;
+    _ridx = 0;
+
+    // init xnew and all protovalues, for every walker
+    _wlkens->initialize(flag_obs);
+    _pdfcont.setNWalkers(_nwalkers); // no-op if already set
+    _trialMove->setNWalkers(_nwalkers);
+    _pdfcont.initializeProtoValues(*_wlkens);
+    _trialMove->initializeProtoValuesBatch(_wlkens->xold);
+
+    // init rest
+    if (_cback) { _cback(*this); } // first call of the call-back function
+    if (flag_obs) {
+        obsCont->reset(); // reset observable accumulators
+    }
+}
+
 void MCI::sample(const int64_t npoints) // sample without taking observables or printing to file
 {
     // Initialize
@@ -294,8 +555,8 @@ void MCI::sample(const int64_t npoints, ObservableContainer &container, const bo
     bool flag_callbackPDF = container.dependsOnPDF(); // initialize flag to keep track of when a PDF callback is necessary
     const bool flagpdf = _pdfcont.hasPDF();
 
-    // run the main loop for sampling
-    for (_ridx = 0; _ridx < npoints; ++_ridx) {
+    // run the main loop for sampling (_ridx > 0 if resumed from checkpoint)
+    for (; _ridx < npoints; ++_ridx) {
         // do MC step
         if (flagpdf) { // use sampling function
             this->doStepMRT2();
@@ -314,12 +575,44 @@ void MCI::sample(const int64_t npoints, ObservableContainer &container, const bo
         // file output
         if (flagMC && _flagobsfile) { this->storeObservables(); } // store obs on file
         if (flagMC && _flagwlkfile) { this->storeWalkerPositions(); } // store walkers on file
+        if (flagMC && _flagckpfile && (_ridx + 1)%_freqckpfile == 0 && _ridx + 1 < npoints) { this->storeCheckpoint(npoints); }
     }
 
     // finalize data
     container.finalize();
 }
 
+void MCI::sampleEnsemble(const int64_t npoints, ObservableContainer * container, const bool flagMC)
+{
+    // Initialize
+    this->initializeEnsembleSampling(container);
+    const bool flagpdf = _pdfcont.hasPDF();
+
+    // run the main loop for sampling (_ridx > 0 if resumed from checkpoint)
+    for (; _ridx < npoints; ++_ridx) {
+        // do MC step for all walkers
+        if (flagpdf) { // use sampling function
+            this->doStepMRT2Ensemble();
+        }
+        else { // sample randomly
+            this->doStepRandomEnsemble();
+        }
+
+        if (container != nullptr) {
+            // accumulate obs
+            container->accumulate(*_wlkens);
+
+            // file output
+            if (flagMC && _flagobsfile) { this->storeObservables(); } // store obs on file
+            if (flagMC && _flagwlkfile) { this->storeWalkerPositions(); } // store walkers on file
+            if (flagMC && _flagckpfile && (_ridx + 1)%_freqckpfile == 0 && _ridx + 1 < npoints) { this->storeCheckpoint(npoints); }
+        }
+    }
+
+    // finalize data
+    if (container != nullptr) { container->finalize(); }
+}
+
 
 // --- Walking
 
@@ -336,11 +629,18 @@ void MCI::doStepMRT2() // do MC step, sampling from _pdfcont
         _domain->applyDomain(_wlkstate.xnew);
     }
 
-    // find the corresponding sampling function acceptance
-    const double pdfAcc = _pdfcont.computeAcceptance(_wlkstate);
+    if (_flaglogacc) {
+        // draw the uniform first, so the sampling functions may stop early when rejection is certain
+        const double logthreshold = log(this->drawUniform()) - log(moveAcc);
+        _wlkstate.accepted = _pdfcont.computeLogAcceptance(_wlkstate, logthreshold);
+    }
+    else {
+        // find the corresponding sampling function acceptance
+        const double pdfAcc = _pdfcont.computeAcceptance(_wlkstate);
 
-    // determine if the proposed x is accepted or not
-    _wlkstate.accepted = (_rd(_rgen) <= pdfAcc*moveAcc);
+        // determine if the proposed x is accepted or not
+        _wlkstate.accepted = (this->drawUniform() <= pdfAcc*moveAcc);
+    }
     _wlkstate.accepted ? ++_acc : ++_rej; // increase counters
 
     // call callback
@@ -359,10 +659,20 @@ void MCI::doStepMRT2() // do MC step, sampling from _pdfcont
     }
 }
 
+void MCI::drawUniform(double x[])
+{
+    if (_flagpool) { // no need to go through the pool
+        fillUniform(_rgen, x, _ndim);
+    }
+    else {
+        for (int i = 0; i < _ndim; ++i) { x[i] = _rd(_rgen); }
+    }
+}
+
 void MCI::doStepRandom() // do MC step, sampling randomly (used when _pdfcont is empty)
 {
     // set xnew to new random values within the domain
-    for (int i = 0; i < _ndim; ++i) { _wlkstate.xnew[i] = _rd(_rgen); } // between 0 and 1
+    this->drawUniform(_wlkstate.xnew); // between 0 and 1
     _domain->scaleToDomain(_wlkstate.xnew); // make it proper coordinates
     _wlkstate.nchanged = _ndim;
 
@@ -375,6 +685,82 @@ void MCI::doStepRandom() // do MC step, sampling randomly (used when _pdfcont is
     _wlkstate.newToOld(); // to mimic doStepMRT2()
 }
 
+void MCI::doStepMRT2Ensemble() // do MC step for all walkers, sampling from _pdfcont
+{
+    // Every phase of the step is done for all walkers in a row, to keep the working set small
+    std::vector<WalkerState> &walkers = _wlkens->walkers;
+    double * const moveAcc = _ensacc.data();
+    double * const pdfAcc = _ensacc.data() + _nwalkers;
+
+    // propose new positions and get move acceptances
+    for (int iw = 0; iw < _nwalkers; ++iw) {
+        moveAcc[iw] = _trialMove->computeTrialMove(walkers[iw], iw);
+    }
+
+    // apply PBC update
+    for (WalkerState &wlk : walkers) {
+        if (wlk.nchanged < _ndim) {
+            _domain->applyDomain(wlk); // selective update
+        }
+        else {
+            _domain->applyDomain(wlk.xnew);
+        }
+    }
+
+    if (_flaglogacc) { // decide walker by walker, to allow early rejection
+        for (int iw = 0; iw < _nwalkers; ++iw) {
+            const double logthreshold = log(this->drawUniform()) - log(moveAcc[iw]);
+            walkers[iw].accepted = _pdfcont.computeLogAcceptance(walkers[iw], logthreshold, iw);
+            walkers[iw].accepted ? ++_acc : ++_rej; // increase counters
+        }
+    }
+    else {
+        // find the corresponding sampling function acceptances
+        _pdfcont.computeAcceptance(*_wlkens, pdfAcc);
+
+        // determine if the proposed x are accepted or not
+        for (int iw = 0; iw < _nwalkers; ++iw) {
+            walkers[iw].accepted = (this->drawUniform() <= pdfAcc[iw]*moveAcc[iw]);
+            walkers[iw].accepted ? ++_acc : ++_rej; // increase counters
+        }
+    }
+
+    // call callback
+    if (_cback) { _cback(*this); }
+
+    // set states according to results
+    for (int iw = 0; iw < _nwalkers; ++iw) {
+        if (walkers[iw].accepted) {
+            _pdfcont.newToOld(iw);
+            _trialMove->newToOld(iw);
+            walkers[iw].newToOld();
+        }
+        else { // rejected
+            _pdfcont.oldToNew(iw);
+            _trialMove->oldToNew(iw);
+            walkers[iw].oldToNew();
+        }
+    }
+}
+
+void MCI::doStepRandomEnsemble() // do MC step for all walkers, sampling randomly (used when _pdfcont is empty)
+{
+    for (WalkerState &wlk : _wlkens->walkers) {
+        // set xnew to new random values within the domain
+        this->drawUniform(wlk.xnew); // between 0 and 1
+        _domain->scaleToDomain(wlk.xnew); // make it proper coordinates
+        wlk.nchanged = _ndim;
+
+        // "accept" move
+        wlk.accepted = true;
+        ++_acc;
+    }
+
+    // rest
+    if (_cback) { _cback(*this); } // call callback
+    for (WalkerState &wlk : _wlkens->walkers) { wlk.newToOld(); } // to mimic doStepMRT2Ensemble()
+}
+
 // --- Domain
 
 std::unique_ptr<DomainInterface> MCI::setDomain(std::unique_ptr<DomainInterface> domain)
@@ -397,13 +783,13 @@ std::unique_ptr<DomainInterface> MCI::resetDomain()
 
 void MCI::setIRange(const double lbound, const double ubound)
 {
-    _domain = std::unique_ptr<DomainInterface>(new OrthoPeriodicDomain(_ndim, lbound, ubound));
+    _domain = createOrthoPeriodicDomain(_ndim, lbound, ubound); // uses fixed-dim variant for small ndim
     _domain->applyDomain(_wlkstate.xold);
 }
 
 void MCI::setIRange(const double lbounds[], const double ubounds[])
 {
-    _domain = std::unique_ptr<DomainInterface>(new OrthoPeriodicDomain(_ndim, lbounds, ubounds));
+    _domain = createOrthoPeriodicDomain(_ndim, lbounds, ubounds);
     _domain->applyDomain(_wlkstate.xold);
 }
 
@@ -415,6 +801,9 @@ std::unique_ptr<TrialMoveInterface> MCI::setTrialMove(std::unique_ptr<TrialMoveI
     if (tmove->getNDim() != _ndim) {
         throw std::invalid_argument("[MCI::setTrialMove] Passed trial move's number of inputs is not equal to MCI's number of walkers.");
     }
+    if (_nwalkers > 1 && !tmove->supportsEnsemble()) {
+        throw std::invalid_argument("[MCI::setTrialMove] Passed trial move does not support ensemble mode (see ProtoFunctionInterface::supportsEnsemble()).");
+    }
     std::swap(tmove, _trialMove); // unique ptr, old move gets freed automatically
     _trialMove->bindRGen(_rgen);
     return tmove; // deleted if not taken
@@ -448,7 +837,8 @@ std::unique_ptr<TrialMoveInterface> MCI::setTrialMove(SRRDType srrd, int veclen,
 
 // --- Observables
 
-void MCI::addObservable(std::unique_ptr<ObservableFunctionInterface> obs, int blocksize, int nskip, const bool flag_equil, const EstimatorType estimType)
+void MCI::addObservable(std::unique_ptr<ObservableFunctionInterface> obs, int blocksize, int nskip, const bool flag_equil, const EstimatorType estimType,
+                        const StoragePrecision precision)
 {
     // sanity
     blocksize = std::max(0, blocksize);
@@ -461,7 +851,7 @@ void MCI::addObservable(std::unique_ptr<ObservableFunctionInterface> obs, int bl
     }
 
     // add accumulator&estimator from factory functions
-    _obscont.addObservable(std::move(obs), blocksize, nskip, flag_equil, estimType);
+    _obscont.addObservable(std::move(obs), blocksize, nskip, flag_equil, estimType, precision);
 }
 
 void MCI::addObservable(std::unique_ptr<ObservableFunctionInterface> obs, const int blocksize, const int nskip, const bool flag_equil, const bool flag_correlated)
@@ -486,16 +876,52 @@ void MCI::addSamplingFunction(std::unique_ptr<SamplingFunctionInterface> pdf)
     if (pdf->getNDim() != _ndim) {
         throw std::invalid_argument("[MCI::addSamplingFunction] Passed sampling function's number of inputs is not equal to MCI's number of walkers.");
     }
+    if (_nwalkers > 1 && !pdf->supportsEnsemble()) {
+        throw std::invalid_argument("[MCI::addSamplingFunction] Passed sampling function does not support ensemble mode (see ProtoFunctionInterface::supportsEnsemble()).");
+    }
     _pdfcont.addSamplingFunction(std::move(pdf)); // we move pdf into pdfcont
 }
 
 
 // --- File Output
 
-void MCI::storeObservablesOnFile(const std::string &filepath, const int freq)
+void MCI::openFiles(const bool append)
+{
+    const auto mode = append ? std::ios::out | std::ios::app : std::ios::out;
+    if (_flagobsfile) {
+        if (_fmtobsfile == FileFormat::Binary) {
+            _obswriter.reset(new TrajectoryWriter(_pathobsfile, TrajectoryHeader{_ndim, _nwalkers, _obscont.getNObsDim(), _freqobsfile}, append));
+        }
+        else { _obsfile.open(_pathobsfile, mode); }
+    }
+    if (_flagwlkfile) {
+        if (_fmtwlkfile == FileFormat::Binary) {
+            _wlkwriter.reset(new TrajectoryWriter(_pathwlkfile, TrajectoryHeader{_ndim, _nwalkers, _nwalkers*_ndim, _freqwlkfile}, append));
+        }
+        else { _wlkfile.open(_pathwlkfile, mode); }
+    }
+}
+
+void MCI::closeFiles()
+{
+    if (_obswriter) {
+        _obswriter->close();
+        _obswriter.reset();
+    }
+    if (_obsfile.is_open()) { _obsfile.close(); }
+    if (_wlkwriter) {
+        _wlkwriter->close();
+        _wlkwriter.reset();
+    }
+    if (_wlkfile.is_open()) { _wlkfile.close(); }
+}
+
+
+void MCI::storeObservablesOnFile(const std::string &filepath, const int freq, const FileFormat format)
 {
     _pathobsfile = filepath;
     _freqobsfile = freq;
+    _fmtobsfile = format;
     _flagobsfile = true;
 }
 
@@ -503,23 +929,30 @@ void MCI::clearObservableFile()
 {
     _pathobsfile = "";
     _freqobsfile = 0;
+    _fmtobsfile = FileFormat::Text;
     _flagobsfile = false;
 }
 
 void MCI::storeObservables()
 {
     if (_ridx%_freqobsfile == 0) {
-        _obsfile << _ridx;
-        _obscont.printObsValues(_obsfile);
-        _obsfile << std::endl;
+        if (_obswriter) {
+            _obscont.copyObsValues(_obswriter->newRecord(_ridx));
+        }
+        else {
+            _obsfile << _ridx;
+            _obscont.printObsValues(_obsfile);
+            _obsfile << '\n';
+        }
     }
 }
 
 
-void MCI::storeWalkerPositionsOnFile(const std::string &filepath, const int freq)
+void MCI::storeWalkerPositionsOnFile(const std::string &filepath, const int freq, const FileFormat format)
 {
     _pathwlkfile = filepath;
     _freqwlkfile = freq;
+    _fmtwlkfile = format;
     _flagwlkfile = true;
 }
 
@@ -527,26 +960,305 @@ void MCI::clearWalkerFile()
 {
     _pathwlkfile = "";
     _freqwlkfile = 0;
+    _fmtwlkfile = FileFormat::Text;
     _flagwlkfile = false;
 }
 
 void MCI::storeWalkerPositions()
 {
     if (_ridx%_freqwlkfile == 0) {
-        _wlkfile << _ridx;
-        for (int j = 0; j < _ndim; ++j) {
-            _wlkfile << "   " << _wlkstate.xold[j];
+        const double * const xold = (_nwalkers > 1) ? _wlkens->xold : _wlkstate.xold; // all walkers in one record
+        if (_wlkwriter) {
+            _wlkwriter->write(_ridx, xold);
+        }
+        else {
+            _wlkfile << _ridx;
+            for (int j = 0; j < _nwalkers*_ndim; ++j) {
+                _wlkfile << "   " << xold[j];
+            }
+            _wlkfile << '\n';
         }
-        _wlkfile << std::endl;
     }
 }
 
 
+// --- Checkpoints
+
+static constexpr char CHECKPOINT_MAGIC[8] = {'M', 'C', 'I', 'C', 'K', 'P', 'T', '2'};
+
+void MCI::writeCheckpoint(std::ostream &file, const int64_t ridx, const int64_t nmc, const int64_t rowsgen, const int64_t rowsbytes) const
+{
+    file.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    writeBinary(file, static_cast<int32_t>(_ndim));
+    writeBinary(file, static_cast<int32_t>(_nwalkers));
+    writeBinary(file, static_cast<int32_t>(_obscont.getNObsDim()));
+    writeBinary(file, static_cast<int32_t>(_trialMove->getNStepSizes()));
+    writeBinary(file, nmc);
+    writeBinary(file, ridx);
+    writeBinary(file, _acc);
+    writeBinary(file, _rej);
+
+    // random generator and distributions, in their standard text format
+    std::ostringstream rstate;
+    rstate << _rgen << ' ' << _rd << ' ' << _rdpool << ' ';
+    _trialMove->writeRandomCache(rstate);
+    writeBinaryString(file, rstate.str());
+
+    for (int i = 0; i < _trialMove->getNStepSizes(); ++i) {
+        writeBinary(file, _trialMove->getStepSize(i));
+    }
+    writeBinary(file, _wlkstate.xold, _ndim);
+    writeBinary(file, static_cast<int8_t>(_flagensinit));
+    if (_nwalkers > 1) { writeBinary(file, _wlkens->xold, _nwalkers*_ndim); }
+
+    if (nmc > 0) { // integration in progress
+        _pdfcont.writeProtoValues(file, _nwalkers);
+        _trialMove->writeProtoValues(file, _nwalkers);
+        // the stored sample rows follow here or are in the rows file of generation rowsgen (see storeCheckpoint)
+        writeBinary(file, rowsgen);
+        if (rowsgen < 0) {
+            std::vector<int64_t> nrows;
+            _obscont.writeRows(file, nrows);
+        }
+        else {
+            writeBinary(file, rowsbytes);
+        }
+        _obscont.writeState(file, false);
+    }
+}
+
+void MCI::readCheckpoint(std::istream &file, const std::string &filepath)
+{
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    if (!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), CHECKPOINT_MAGIC)) {
+        throw std::runtime_error("[MCI::loadCheckpoint] File is not an MCI checkpoint.");
+    }
+    int32_t ndim, nwalkers, nobsdim, nstepsizes;
+    readBinary(file, ndim);
+    readBinary(file, nwalkers);
+    readBinary(file, nobsdim);
+    readBinary(file, nstepsizes);
+    if (ndim != _ndim || nwalkers != _nwalkers || nobsdim != _obscont.getNObsDim() || nstepsizes != _trialMove->getNStepSizes()) {
+        throw std::invalid_argument("[MCI::loadCheckpoint] Checkpoint does not match the MCI setup (dimensions, walkers, observables or step sizes).");
+    }
+    int64_t nmc, ridx;
+    readBinary(file, nmc);
+    readBinary(file, ridx);
+    readBinary(file, _acc);
+    readBinary(file, _rej);
+
+    std::istringstream rstate(readBinaryString(file));
+    rstate >> _rgen >> _rd >> _rdpool;
+    _trialMove->readRandomCache(rstate);
+    if (rstate.fail()) { throw std::runtime_error("[MCI::loadCheckpoint] Failed to restore the random generator state."); }
+
+    for (int i = 0; i < nstepsizes; ++i) {
+        double stepsize;
+        readBinary(file, stepsize);
+        _trialMove->setStepSize(i, stepsize);
+    }
+    readBinary(file, _wlkstate.xold, _ndim);
+    int8_t flagensinit;
+    readBinary(file, flagensinit);
+    _flagensinit = (flagensinit != 0);
+    if (_nwalkers > 1) { readBinary(file, _wlkens->xold, _nwalkers*_ndim); }
+
+    _ridx = ridx;
+    _nmcresume = 0;
+    if (nmc > 0) { // prepare everything like initialize(Ensemble)Sampling, then overwrite with the stored state
+        _obscont.allocate(nmc, _pdfcont, _nwalkers);
+        if (_nwalkers > 1) {
+            _wlkens->initialize(true);
+            _pdfcont.setNWalkers(_nwalkers);
+            _trialMove->setNWalkers(_nwalkers);
+            _pdfcont.initializeProtoValues(*_wlkens);
+            _trialMove->initializeProtoValuesBatch(_wlkens->xold);
+        }
+        else {
+            _wlkstate.initialize(true);
+            _pdfcont.initializeProtoValues(_wlkstate.xold);
+            _trialMove->initializeProtoValues(_wlkstate.xold);
+        }
+        _pdfcont.readProtoValues(file, _nwalkers);
+        _trialMove->readProtoValues(file, _nwalkers);
+        int64_t rowsgen;
+        std::vector<int64_t> nrows;
+        readBinary(file, rowsgen);
+        if (rowsgen < 0) {
+            _obscont.readRows(file, nrows);
+        }
+        else { // read all appended rows up to the length valid for this checkpoint
+            int64_t rowsbytes;
+            readBinary(file, rowsbytes);
+            const std::string rowspath = filepath + ".rows" + std::to_string(rowsgen);
+            std::ifstream rowsfile(rowspath, std::ios::binary);
+            if (!rowsfile) { throw std::runtime_error("[MCI::loadCheckpoint] Failed to open file " + rowspath + "."); }
+            while (rowsfile.tellg() < rowsbytes) { _obscont.readRows(rowsfile, nrows); }
+            if (rowsfile.tellg() != rowsbytes) {
+                throw std::runtime_error("[MCI::loadCheckpoint] File " + rowspath + " does not match the checkpoint.");
+            }
+            _ckpgen = rowsgen; // continue with the next generation
+            _ckprowspath = rowspath;
+        }
+        _obscont.readState(file, nrows);
+        _nmcresume = nmc;
+    }
+}
+
+void MCI::saveCheckpoint(const std::string &filepath) const
+{
+    if (_nmcrun > 0) { throw std::runtime_error("[MCI::saveCheckpoint] Can't save during integration, use setCheckpointFile() instead."); }
+    std::ofstream file(filepath, std::ios::binary);
+    this->writeCheckpoint(file, _ridx, _nmcresume); // includes a restored, not yet continued integration (with all rows)
+    file.close();
+    if (file.fail()) { throw std::runtime_error("[MCI::saveCheckpoint] Failed to write file " + filepath + "."); }
+}
+
+void MCI::loadCheckpoint(const std::string &filepath)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) { throw std::runtime_error("[MCI::loadCheckpoint] Failed to open file " + filepath + "."); }
+    this->readCheckpoint(file, filepath);
+}
+
+void MCI::setCheckpointFile(const std::string &filepath, const int64_t freq)
+{
+    if (freq < 1) { throw std::invalid_argument("[MCI::setCheckpointFile] Checkpoint frequency must be at least 1."); }
+    _pathckpfile = filepath;
+    _freqckpfile = freq;
+    _flagckpfile = true;
+}
+
+void MCI::clearCheckpointFile()
+{
+    _pathckpfile = "";
+    _freqckpfile = 0;
+    _flagckpfile = false;
+}
+
+void MCI::storeCheckpoint(const int64_t nmc)
+{
+    // The stored sample rows are appended to a separate rows file, i.e. we only serialize the rows added since the
+    // last checkpoint and the (small) rest of the state. If written rows have changed (int16 requantization) or on the
+    // first checkpoint of an integration, a new rows file (generation) is started and the old one removed afterwards.
+    const bool newgen = _ckprows.empty() || _obscont.getRowsVersion() != _ckpversion;
+    if (newgen) {
+        _ckprows.clear();
+        ++_ckpgen;
+        _ckpbytes = 0;
+        _ckpversion = _obscont.getRowsVersion();
+    }
+    std::stringstream rows(std::ios::in | std::ios::out | std::ios::binary);
+    _obscont.writeRows(rows, _ckprows);
+    _ckpbytes += static_cast<int64_t>(rows.tellp());
+    std::stringstream state(std::ios::in | std::ios::out | std::ios::binary);
+    this->writeCheckpoint(state, _ridx + 1, nmc, _ckpgen, _ckpbytes);
+    this->joinCheckpointWriter(); // wait for the previous write (if still running)
+
+    const std::string rowspath = _pathckpfile + ".rows" + std::to_string(_ckpgen);
+    const std::string oldrowspath = (newgen && _ckprowspath == _pathckpfile + ".rows" + std::to_string(_ckpgen - 1)) ? _ckprowspath : "";
+    _ckprowspath = rowspath;
+
+    // the buffers are moved into the writer, which appends the rows first, so that the state file is always valid
+    _ckpthread = std::thread([this, newgen, path = _pathckpfile, rowspath, oldrowspath, rows = std::move(rows), state = std::move(state)]() mutable {
+        std::ofstream rowsfile(rowspath, std::ios::binary | (newgen ? std::ios::trunc : std::ios::app));
+        rowsfile << rows.rdbuf(); // never empty
+        rowsfile.close();
+        if (rowsfile.fail()) {
+            _ckperror = std::make_exception_ptr(std::runtime_error("[MCI::storeCheckpoint] Failed to write file " + rowspath + "."));
+            return;
+        }
+        const std::string tmppath = path + ".tmp";
+        std::ofstream file(tmppath, std::ios::binary);
+        file << state.rdbuf();
+        file.close();
+        if (file.fail() || std::rename(tmppath.c_str(), path.c_str()) != 0) {
+            _ckperror = std::make_exception_ptr(std::runtime_error("[MCI::storeCheckpoint] Failed to write file " + path + "."));
+            return;
+        }
+        if (!oldrowspath.empty()) { std::remove(oldrowspath.c_str()); }
+    });
+}
+
+void MCI::joinCheckpointWriter()
+{
+    if (_ckpthread.joinable()) { _ckpthread.join(); }
+    if (_ckperror) {
+        const std::exception_ptr error = _ckperror;
+        _ckperror = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+
+// --- Cloning
+
+std::unique_ptr<MCI> MCI::createWorkerClone(const uint_fast64_t seed) const
+{
+    std::unique_ptr<MCI> mci(new MCI(_ndim));
+    mci->setSeed(seed);
+
+    // components
+    mci->setDomain(*_domain);
+    mci->setTrialMove(*_trialMove); // includes step sizes
+    for (int i = 0; i < _pdfcont.size(); ++i) {
+        mci->addSamplingFunction(_pdfcont.getSamplingFunction(i));
+    }
+    for (int i = 0; i < _obscont.size(); ++i) {
+        mci->addObservable(_obscont.getObservableFunction(i), _obscont.getBlockSize(i), _obscont.getNSkip(i),
+                           _obscont.getFlagEquil(i), _obscont.getEstimatorType(i), _obscont.getStoragePrecision(i));
+    }
+
+    // settings and position
+    mci->setTargetAcceptanceRate(_targetaccrate);
+    mci->setNfindMRT2Iterations(_NfindMRT2Iterations);
+    mci->setNdecorrelationSteps(_NdecorrelationSteps);
+    mci->setUseLogAcceptance(_flaglogacc);
+    mci->setUseRandomPool(_flagpool);
+    mci->setSampleStorageDir(this->getSampleStorageDir());
+    mci->setUsePersistentStorage(this->getUsePersistentStorage());
+    mci->setUseRunLengthStorage(this->getUseRunLengthStorage());
+    mci->setNWalkers(_nwalkers);
+    mci->setX(_wlkstate.xold);
+
+    return mci;
+}
+
+
 // --- Setters
 
 void MCI::setSeed(const uint_fast64_t seed) // fastest unsigned integer which is at least 64 bit (as expected by rgen)
 {
     _rgen.seed(seed);
+    // discard variates generated with the old seed
+    _rd.reset();
+    _rdpool.reset();
+    _trialMove->resetRandomCache();
+}
+
+void MCI::setUseRandomPool(const bool flag_pool)
+{
+    _flagpool = flag_pool;
+    _rdpool.reset();
+}
+
+void MCI::setNWalkers(const int nwalkers)
+{
+    if (nwalkers < 1) { throw std::invalid_argument("[MCI::setNWalkers] Number of walkers must be at least 1."); }
+    if (nwalkers > 1) {
+        for (int i = 0; i < _pdfcont.size(); ++i) {
+            if (!_pdfcont.getSamplingFunction(i).supportsEnsemble()) {
+                throw std::invalid_argument("[MCI::setNWalkers] A sampling function does not support ensemble mode (see ProtoFunctionInterface::supportsEnsemble()).");
+            }
+        }
+        if (_trialMove && !_trialMove->supportsEnsemble()) {
+            throw std::invalid_argument("[MCI::setNWalkers] The trial move does not support ensemble mode (see ProtoFunctionInterface::supportsEnsemble()).");
+        }
+    }
+    _nwalkers = nwalkers;
+    _wlkens = (_nwalkers > 1) ? std::unique_ptr<WalkerEnsemble>(new WalkerEnsemble(_nwalkers, _ndim, false)) : nullptr;
+    _ensacc.assign(_nwalkers > 1 ? 2*static_cast<size_t>(_nwalkers) : 0, 0.);
+    _flagensinit = false;
 }
 
 void MCI::setTargetAcceptanceRate(const double targetaccrate)
@@ -624,7 +1336,7 @@ void MCI::newRandomX() // also meant for the user
 MCI::MCI(const int ndim): _ndim(ndim), _wlkstate(_ndim, false)
 {
     // initialize random generator
-    _rgen = std::mt19937_64(_rdev()); // passed through to trial moves (for seed consistency)
+    _rgen = RandomGenerator(_rdev()); // passed through to trial moves (for seed consistency)
     _rd = std::uniform_real_distribution<double>(0., 1.); // used for acceptance (and random moves without pdf)
 
     // domain
@@ -637,14 +1349,27 @@ MCI::MCI(const int ndim): _ndim(ndim), _wlkstate(_ndim, false)
     _targetaccrate = 0.5;
     _NfindMRT2Iterations = -50; // default to max 50 auto-iterations
     _NdecorrelationSteps = -10000; // default to max 10k auto-steps
+    _flaglogacc = false; // default to standard acceptance
+    _flagpool = false; // default to standard library distribution
+    _nwalkers = 1; // default to single walker
+    _flagensinit = false;
+    _nestimthreads = 1; // default to serial estimation
 
     // initialize file flags
     _flagwlkfile = false;
     _flagobsfile = false;
+    _fmtwlkfile = FileFormat::Text;
+    _fmtobsfile = FileFormat::Text;
+    _flagckpfile = false;
 
     //initialize the running counters
     _ridx = 0;
     _acc = 0;
     _rej = 0;
 }
+
+MCI::~MCI()
+{
+    if (_ckpthread.joinable()) { _ckpthread.join(); } // errors can't be reported anymore
+}
 }  // namespace mci
@@ -1,6 +1,7 @@
 #include "mci/MJBlocker.hpp"
 
 #include <algorithm>
+#include <vector>
 
 // --- A static array of magic numbers
 static constexpr std::array<double, 64> quantile{3.841459, 5.991465, 7.814728, 9.487729, 11.070498, 12.591587, 14.067140, 15.507313,
@@ -14,142 +15,150 @@ static constexpr std::array<double, 64> quantile{3.841459, 5.991465, 7.814728, 9
 
 namespace mci
 {
-// --- Constructor/Destructor
+// --- Helpers
 
-MJBlocker::MJBlocker(const int64_t n_data, const int n_dim):
-        ndata(n_data), ndim(n_dim), npow(static_cast<int>(log2(n_data))), // below we check that n is a power of two, so d is a (small) integer
-        _x(new double[ndata*ndim]), _X(new double[ndata*ndim]),
-        _var(new double[npow*ndim]), _gamma(new double[npow*ndim]),
-        _M(new double[npow*ndim]), _Msum(new double[npow*ndim])
+static int computeNPow(const int64_t ndata)
 {
-    if (ndata <= 0) {
-        throw std::invalid_argument("[MJBlocker] ndata must be a natural number.");
-    }
-    if ((static_cast<uint64_t>(ndata) & (static_cast<uint64_t>(ndata) - 1)) != 0) { // ndata must be power of two
-        throw std::invalid_argument("[MJBlocker] ndata must be a power of two.");
-    }
+    if (ndata < 2) { throw std::invalid_argument("[MJBlocker] ndata must be at least 2."); }
+    int npow = 0;
+    for (int64_t nred = ndata; nred >= 2; nred /= 2) { ++npow; } // levels with at least 2 (blocked) samples
+    return npow;
 }
 
-MJBlocker::~MJBlocker()
+static int computeStride(const int ndim, const int ldx)
 {
-    delete[] _Msum;
-    delete[] _M;
-    delete[] _gamma;
-    delete[] _var;
-    delete[] _X;
-    delete[] _x;
+    if (ndim < 1) { throw std::invalid_argument("[MJBlocker] ndim must be at least 1."); }
+    if (ldx > 0 && ldx < ndim) { throw std::invalid_argument("[MJBlocker] ldx must be at least ndim."); }
+    return (ldx > 0) ? ldx : ndim;
 }
 
-// --- Initializers
-
-// estimates mean of x
-void MJBlocker::_computeMean(double mean[]) const
+// Processes one blocking level of nred samples (rows of in, minus shift) in a single pass: Accumulates the variance and
+// lag-1 autocovariance (normalized by nred) and writes the nred/2 blocked samples to out (stride ndim), which may alias in.
+template <class R>
+static void processLevel(const int ndim, const int64_t nred, const R &in, const double shift[],
+                         double var[], double gamma[], double out[])
 {
-    std::fill(mean, mean + ndim, 0.);
-    for (int64_t i = 0; i < ndata; ++i) {
+    std::fill(var, var + ndim, 0.);
+    std::fill(gamma, gamma + ndim, 0.);
+
+    const int64_t npairs = nred/2;
+    for (int64_t p = 0; p < npairs; ++p) {
+        const auto * const a = in[2*p]; // out[p] overwrites in[p] (p <= 2p), i.e. only samples that were read before
+        const auto * const b = in[2*p + 1];
+        double * const o = out + p*ndim;
+        if (2*p + 2 < nred) { // lag-1 product with the first sample of the next pair
+            const auto * const c = in[2*p + 2];
+            for (int j = 0; j < ndim; ++j) { gamma[j] += (b[j] - shift[j])*(c[j] - shift[j]); }
+        }
         for (int j = 0; j < ndim; ++j) {
-            mean[j] += _x[i*ndim + j];
+            const double xa = a[j] - shift[j]; // widening load
+            const double xb = b[j] - shift[j];
+            var[j] += xa*xa + xb*xb;
+            gamma[j] += xa*xb;
+            o[j] = 0.5*(xa + xb);
         }
     }
-    for (int j = 0; j < ndim; ++j) { mean[j] /= ndata; }
-}
+    if (nred%2 != 0) { // the dropped last sample still counts on this level
+        const auto * const l = in[nred - 1];
+        for (int j = 0; j < ndim; ++j) { var[j] += (l[j] - shift[j])*(l[j] - shift[j]); }
+    }
 
-// stores x minus mean
-void MJBlocker::_initX(const double mean[])
-{
-    for (int64_t i = 0; i < ndata; ++i) {
-        for (int j = 0; j < ndim; ++j) {
-            _X[i*ndim + j] = _x[i*ndim + j] - mean[j];
-        }
+    for (int j = 0; j < ndim; ++j) {
+        var[j] /= nred;
+        gamma[j] /= nred;
     }
 }
 
-// --- Operations involving the copies of input data
 
-// estimates gamma_h(0) for all h
-void MJBlocker::_gamma0(double var[], const int64_t nred)
-{
-    std::fill(var, var + ndim, 0.);
-    for (int64_t i = 0; i < nred; ++i) {
-        for (int j = 0; j < ndim; ++j) {
-            var[j] += _X[i*ndim + j]*_X[i*ndim + j];
-        }
-    }
-    for (int j = 0; j < ndim; ++j) { var[j] /= nred; }
-}
+// --- Constructor/Destructor
 
-// estimates gamma_h(1) for all h
-void MJBlocker::_gamma1(double gamma[], const int64_t nred)
+MJBlocker::MJBlocker(const int64_t n_data, const int n_dim, const int ld_x):
+        ndata(n_data), ndim(n_dim), ldx(computeStride(n_dim, ld_x)), npow(computeNPow(n_data)), // these throw before anything is allocated
+        _x(new double[(ndata/2)*ndim]),
+        _var(new double[npow*ndim]), _gamma(new double[npow*ndim])
+{}
+
+MJBlocker::~MJBlocker()
 {
-    std::fill(gamma, gamma + ndim, 0.);
-    for (int64_t i = 0; i < nred - 1; ++i) {
-        for (int j = 0; j < ndim; ++j) {
-            gamma[j] += _X[i*ndim + j]*_X[(i + 1)*ndim + j];
-        }
-    }
-    for (int j = 0; j < ndim; ++j) { gamma[j] /= nred; }
+    delete[] _gamma;
+    delete[] _var;
+    delete[] _x;
 }
 
-// performs blocking transformation
-int64_t MJBlocker::_transform(const double mean[], const int64_t nred)
+
+// --- Estimation
+
+// the algorithm which computes the variance of the sample mean (the input is only read, so we don't modify it)
+template <class R>
+void MJBlocker::_estimate(const R &x, double avg[], double err[])
 {
-    for (int64_t i = 0; i < nred/2; ++i) {
+    // store average of x in avg
+    std::fill(avg, avg + ndim, 0.);
+    for (int64_t i = 0; i < ndata; ++i) {
+        const auto * const xi = x[i];
         for (int j = 0; j < ndim; ++j) {
-            _x[i*ndim + j] = 0.5*(_x[(2*i)*ndim + j] + _x[(2*i + 1)*ndim + j]);
-            _X[i*ndim + j] = _x[i*ndim + j] - mean[j];
+            avg[j] += xi[j];
         }
     }
-    return nred/2;
+    for (int j = 0; j < ndim; ++j) { avg[j] /= ndata; }
+
+    // compute covariance and variance and apply blocking transform, with the first level subtracting the mean
+    std::vector<int64_t> nreds(static_cast<size_t>(npow));
+    const std::vector<double> noshift(static_cast<size_t>(ndim), 0.);
+    nreds[0] = ndata;
+    processLevel(ndim, ndata, x, avg, _var, _gamma, _x);
+    const ArrayRows<double> blocked(_x, ndim);
+    for (int k = 1; k < npow; ++k) {
+        nreds[k] = nreds[k - 1]/2; // rounding down
+        processLevel(ndim, nreds[k], blocked, noshift.data(), _var + k*ndim, _gamma + k*ndim, _x);
+    }
+
+    estimateError(npow, ndim, nreds.data(), _var, _gamma, err);
 }
 
-// generate test statistics Mk (in reverse order) and perform cumulative sum (stored in _Msum)
-void MJBlocker::_generateM()
+void MJBlocker::estimate(const double x[], double avg[], double err[]) { this->_estimate(ArrayRows<double>(x, ldx), avg, err); }
+
+void MJBlocker::estimate(const float x[], double avg[], double err[]) { this->_estimate(ArrayRows<float>(x, ldx), avg, err); }
+
+void MJBlocker::estimate(const int16_t x[], double avg[], double err[]) { this->_estimate(ArrayRows<int16_t>(x, ldx), avg, err); }
+
+void MJBlocker::estimate(const RunLengthSamples &x, double avg[], double err[]) { this->_estimate(RunLengthRows(x, ldx), avg, err); }
+
+
+// generate test statistics Mk (in reverse order), perform cumulative sum and select the blocking level
+void MJBlocker::estimateError(const int npow, const int ndim, const int64_t nred[], const double var[], const double gamma[], double err[])
 {
+    if (npow < 1 || npow > static_cast<int>(quantile.size())) {
+        throw std::invalid_argument("[MJBlocker::estimateError] Number of blocking levels is out of range.");
+    }
+    std::vector<double> M(static_cast<size_t>(npow*ndim));
     for (int i = 0; i < npow; ++i) {
         for (int k = 0; k < ndim; ++k) {
-            _M[(npow - i - 1)*ndim + k] = pow(_gamma[i*ndim + k]/_var[i*ndim + k], 2)*pow(2, npow - i);
+            M[(npow - i - 1)*ndim + k] = pow(gamma[i*ndim + k]/var[i*ndim + k], 2)*nred[i];
         }
     }
 
     // compute cumulative sum
-    std::fill(_Msum, _Msum + npow*ndim, 0.);
+    std::vector<double> Msum(static_cast<size_t>(npow*ndim), 0.);
     for (int i = 0; i < npow; ++i) {
         for (int j = 0; j <= i; ++j) {
             for (int k = 0; k < ndim; ++k) {
-                _Msum[i*ndim + k] += _M[j*ndim + k];
+                Msum[i*ndim + k] += M[j*ndim + k];
             }
         }
     }
-}
-
-
-// the algorithm which computes the variance of the sample mean.
-void MJBlocker::estimate(const double x[], double avg[], double err[])
-{
-    std::copy(x, x + ndata*ndim, _x); // first copy our input data ( we don't want to modify the input )
-    this->_computeMean(avg); // store average of x in avg
-    this->_initX(avg); // store x minus avg in _X
-
-    // compute covariance and variance and apply blocking transform
-    int64_t nred = ndata; // will go through powers of 2
-    for (int k = 0; k < npow; ++k) {
-        this->_gamma0(_var + k*ndim, nred);
-        this->_gamma1(_gamma + k*ndim, nred);
-        nred = this->_transform(avg, nred);
-    }
 
-    this->_generateM(); // compute cumulative test statistics sum
     for (int l = 0; l < ndim; ++l) { // find the first k such that Mk < quantile[k]
         int k;
         for (k = npow - 1; k >= 0; --k) {
-            if (_Msum[k*ndim + l] < quantile[k]) {
+            if (Msum[k*ndim + l] < quantile[k]) {
                 break;
             }
         }
-        k = npow - (k + 1);
+        k = std::min(npow - (k + 1), npow - 1); // (if no level passed, e.g. for zero variance, use the last one)
 
         // and finally compute the errors
-        err[l] = sqrt(_var[k*ndim + l]/pow(2, npow - k));
+        err[l] = sqrt(var[k*ndim + l]/nred[k]);
     }
 }
 } // namespace mci
@@ -93,6 +93,20 @@ void integrate(MCI &mci, const int64_t Nmc, double average[], double error[], co
 }
 
 
+void integrateMerged(MCI &mci, const int64_t Nmc, double average[], double error[], const bool doFindMRT2Step, const bool doDecorrelation)
+{
+    // make sure the user has MPI in the correct state
+    int isinit, isfinal;
+    MPI_Initialized(&isinit);
+    if (isinit == 0) { throw std::runtime_error("MPI not initialized!"); }
+    MPI_Finalized(&isfinal);
+    if (isfinal == 1) { throw std::runtime_error("MPI already finalized!"); }
+
+    // the accumulated data of all processes are merged, before the estimators run
+    mci.integrateMPI(Nmc, average, error, doFindMRT2Step, doDecorrelation);
+}
+
+
 void finalize()
 {
     // make sure the user has MPI in the correct state
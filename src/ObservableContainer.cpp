@@ -1,8 +1,23 @@
 #include "mci/ObservableContainer.hpp"
+#include "mci/BinaryIO.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <thread>
 
 namespace mci
 {
 
+// Jonsson's blocking on mapped samples (which may exceed RAM) is done by streaming them, as MJBlocker needs n/2 samples of RAM
+static bool usesStreamingBlocker(const AccumulatorInterface &accu, const EstimatorType estimType)
+{
+    const auto * const fullaccu = dynamic_cast<const FullAccumulator *>(&accu);
+    return fullaccu != nullptr && fullaccu->usesMappedStorage()
+           && (estimType == EstimatorType::Correlated || estimType == EstimatorType::MJBlocker);
+}
+
 int gcd_helper(int a, int b) { // simple recursive greatest common divisor computation
     if (a > b) {
         return gcd_helper(a - b, b);
@@ -16,8 +31,10 @@ int gcd_helper(int a, int b) { // simple recursive greatest common divisor compu
 void ObservableContainer::_setDependsOnPDF()
 {
     int gcd = 0;
+    _flag_dependent = false;
     for (auto &el : _cont) {
         if (el.depobs != nullptr) {
+            _flag_dependent = true;
             if (el.depobs->dependsOnPDF()) {
                 if (gcd == 0) {
                     gcd = el.accu->getNSkip();
@@ -34,37 +51,97 @@ void ObservableContainer::_setDependsOnPDF()
     _nskip_PDF = gcd;
 }
 
+void ObservableContainer::_prepareAllocation()
+{
+    if (_flag_persistent) { // previous arrays must be returned before the arena can be reused
+        for (auto &el : _cont) { el.accu->deallocate(); }
+        _arena.release();
+    }
+    if (_ncovdim > 0) { // (re)create or reset the covariance group
+        if (!_cov || _cov->ndim != _ncovdim) { _cov.reset(new OnlineCovariance(_ncovdim)); }
+        else { _cov->reset(); }
+    }
+    for (auto &el : _cont) {
+        if (auto * const fullaccu = dynamic_cast<FullAccumulator *>(el.accu.get())) {
+            fullaccu->setMappedStorageDir(_mapdir);
+            fullaccu->setRunLengthStorage(_flag_runlength);
+        }
+        if (el.covoffset >= 0) {
+            static_cast<CovarianceAccumulator *>(el.accu.get())->setCovarianceGroup(_cov.get(), el.covoffset);
+        }
+        el.accu->setStorageArena(_flag_persistent ? &_arena : nullptr);
+    }
+}
+
 void ObservableContainer::addObservable(std::unique_ptr<ObservableFunctionInterface> obs,
-                                        const int blocksize, const int nskip, const bool needsEquil, const EstimatorType estimType)
+                                        const int blocksize, const int nskip, const bool needsEquil, const EstimatorType estimType,
+                                        const StoragePrecision precision)
 {
+    if (estimType == EstimatorType::OnlineCovariance) { // the group requires blocks to end on the same steps
+        for (auto &el : _cont) {
+            if (el.estimType == EstimatorType::OnlineCovariance && (el.blocksize != blocksize || el.accu->getNSkip() != std::max(1, nskip))) {
+                throw std::invalid_argument("[ObservableContainer::addObservable] Observables using OnlineCovariance estimator must have equal blocksize and nskip.");
+            }
+        }
+    }
+
     ObservableContainerElement newElement;
     // obs+accu
     newElement.obs = std::move(obs); // ownership by element
     _nobsdim += newElement.obs->getNObs();
     newElement.depobs = dynamic_cast<DependentObservableInterface *>(newElement.obs.get()); // might be nullptr
-    newElement.accu = createAccumulator(*newElement.obs, blocksize, nskip); // use create from Factories.hpp
+    newElement.accu = createAccumulator(*newElement.obs, blocksize, nskip, estimType, precision); // use create from Factories.hpp
 
     // estimator lambda functional (again use create from Factories.hpp)
-    newElement.estim = [accu = newElement.accu.get() /*OK*/, estimator = createEstimator(estimType)](double average[], double error[])
+    if (estimType == EstimatorType::Autocorrelation) { newElement.tau.reset(new double[newElement.accu->getNObs()]()); }
+    newElement.estim = [accu = newElement.accu.get() /*OK*/, estimator = createEstimator(estimType), estimType,
+                        tau = newElement.tau.get() /*OK*/](double average[], double error[])
     {
         if (!accu->isFinalized()) {
             throw std::runtime_error("[ObservableContainer.estim] Estimator was called, but accumulator is not finalized.");
         }
+        if (const ReducedStorage * const rdata = accu->getReducedData()) { // reads reduced precision itself
+            rdata->estimate(estimType, accu->getNStore(), average, error, tau);
+            return;
+        }
+        if (const RunLengthStorage * const rldata = accu->getRunLengthData()) { // reads the runs without expansion
+            rldata->estimate(estimType, average, error, tau);
+            return;
+        }
+        if (usesStreamingBlocker(*accu, estimType)) {
+            StreamingBlockerEstimator(accu->getNStore(), accu->getNObs(), accu->getData(), average, error);
+            return;
+        }
+        if (tau != nullptr) { // also store the autocorrelation times
+            AutocorrelationEstimator(accu->getNStore(), accu->getNObs(), accu->getData(), average, error, tau);
+            return;
+        }
         estimator(accu->getNStore(), accu->getNObs(), accu->getData(), average, error);
     };
 
+    if (estimType == EstimatorType::OnlineCovariance) {
+        newElement.covoffset = _ncovdim;
+        _ncovdim += newElement.accu->getNObs();
+    }
+    newElement.blocksize = blocksize;
+    newElement.estimType = estimType;
+    newElement.precision = precision;
     newElement.flag_equil = needsEquil;
     _cont.push_back(std::move(newElement)); // and then into container
     this->_setDependsOnPDF(); // keep it simple and call this to update the depend flag
 }
 
 
-void ObservableContainer::allocate(const int64_t Nmc, const SamplingFunctionContainer &pdfcont)
+void ObservableContainer::allocate(const int64_t Nmc, const SamplingFunctionContainer &pdfcont, const int nwalkers)
 {
+    if (nwalkers > 1 && _flag_dependent) {
+        throw std::invalid_argument("[ObservableContainer::allocate] Dependent observables are not supported with multiple walkers.");
+    }
+    this->_prepareAllocation();
     std::vector<AccumulatorInterface *> accuvec; // vectors of accu pointers for obs to register
     accuvec.reserve(_cont.size());
     for (auto &el : _cont) {
-        el.accu->allocate(Nmc);
+        el.accu->allocate(Nmc, nwalkers);
         accuvec.push_back(el.accu.get());
     }
     // let dependent obs register
@@ -82,6 +159,14 @@ void ObservableContainer::accumulate(const WalkerState &wlk)
 }
 
 
+void ObservableContainer::accumulate(const WalkerEnsemble &wlkens)
+{
+    for (auto &el : _cont) {
+        el.accu->accumulate(wlkens);
+    }
+}
+
+
 void ObservableContainer::printObsValues(std::ofstream &file) const
 {
     for (auto &el : _cont) {
@@ -92,6 +177,104 @@ void ObservableContainer::printObsValues(std::ofstream &file) const
     file << " ";
 }
 
+void ObservableContainer::copyObsValues(double out[]) const
+{
+    for (auto &el : _cont) {
+        std::copy(el.accu->getObsValues(), el.accu->getObsValues() + el.accu->getNObs(), out);
+        out += el.accu->getNObs();
+    }
+}
+
+
+void ObservableContainer::writeState(std::ostream &os, const bool flag_rows) const
+{
+    writeBinary(os, static_cast<int32_t>(_cont.size()));
+    for (auto &el : _cont) {
+        writeBinary(os, static_cast<int32_t>(el.accu->getNObs()));
+        el.accu->writeState(os, flag_rows);
+    }
+    if (_ncovdim > 0) {
+        if (!_cov) { throw std::runtime_error("[ObservableContainer::writeState] Covariance group is not allocated."); }
+        _cov->write(os);
+    }
+}
+
+void ObservableContainer::readState(std::istream &is)
+{
+    this->readState(is, std::vector<int64_t>());
+}
+
+void ObservableContainer::readState(std::istream &is, const std::vector<int64_t> &nrows)
+{
+    const bool flag_rows = nrows.empty(); // rows are part of the state?
+    if (!flag_rows && nrows.size() != _cont.size()) {
+        throw std::invalid_argument("[ObservableContainer::readState] Number of read rows does not match the number of observables.");
+    }
+    int32_t nobs;
+    readBinary(is, nobs);
+    if (nobs != static_cast<int32_t>(_cont.size())) {
+        throw std::invalid_argument("[ObservableContainer::readState] Stored number of observables does not match.");
+    }
+    for (size_t i = 0; i < _cont.size(); ++i) {
+        const auto &accu = _cont[i].accu;
+        readBinary(is, nobs);
+        if (nobs != accu->getNObs()) {
+            throw std::invalid_argument("[ObservableContainer::readState] Stored observable dimension does not match.");
+        }
+        accu->readState(is, flag_rows);
+        if (!flag_rows && nrows[i] != accu->getNFixedRows()) {
+            throw std::runtime_error("[ObservableContainer::readState] Read rows are inconsistent with the stored state.");
+        }
+    }
+    if (_ncovdim > 0) { // after the accumulators, which reset the group
+        if (!_cov) { throw std::runtime_error("[ObservableContainer::readState] Covariance group is not allocated."); }
+        _cov->read(is);
+    }
+}
+
+
+int64_t ObservableContainer::getRowsVersion() const
+{   // the versions only grow, so the sum changes with any of them
+    int64_t version = 0;
+    for (auto &el : _cont) { version += el.accu->getRowsVersion(); }
+    return version;
+}
+
+void ObservableContainer::writeRows(std::ostream &os, std::vector<int64_t> &nrows) const
+{   // as chunks of (accumulator index, first row, end row, rows), terminated by index -1
+    if (nrows.empty()) { nrows.assign(_cont.size(), 0); }
+    if (nrows.size() != _cont.size()) { throw std::invalid_argument("[ObservableContainer::writeRows] Number of written rows does not match the number of observables."); }
+    for (size_t i = 0; i < _cont.size(); ++i) {
+        const int64_t nfixed = _cont[i].accu->getNFixedRows();
+        if (nfixed > nrows[i]) {
+            writeBinary(os, static_cast<int32_t>(i));
+            writeBinary(os, nrows[i]);
+            writeBinary(os, nfixed);
+            _cont[i].accu->writeRows(os, nrows[i], nfixed);
+            nrows[i] = nfixed;
+        }
+    }
+    writeBinary(os, static_cast<int32_t>(-1));
+}
+
+void ObservableContainer::readRows(std::istream &is, std::vector<int64_t> &nrows)
+{
+    if (nrows.empty()) { nrows.assign(_cont.size(), 0); }
+    int32_t idx;
+    readBinary(is, idx);
+    while (idx >= 0) {
+        int64_t row0, row1;
+        readBinary(is, row0);
+        readBinary(is, row1);
+        if (static_cast<size_t>(idx) >= _cont.size() || nrows.size() != _cont.size() || row0 != nrows[idx]) {
+            throw std::runtime_error("[ObservableContainer::readRows] Stored rows are out of order.");
+        }
+        _cont[idx].accu->readRows(is, row0, row1);
+        nrows[idx] = row1;
+        readBinary(is, idx);
+    }
+}
+
 
 void ObservableContainer::finalize()
 {
@@ -101,21 +284,160 @@ void ObservableContainer::finalize()
 }
 
 
-void ObservableContainer::estimate(double average[], double error[]) const
+void ObservableContainer::estimate(double average[], double error[], const int nthreads) const
 {
+    if (nthreads <= 1) {
+        int offset = 0;
+        for (auto &el : _cont) { // go through estimators and write to avg/error blocks
+            el.estim(average + offset, error + offset);
+            offset += el.accu->getNObs();
+        }
+        return;
+    }
+
+    // Create the tasks: Estimators which work on every dimension independently are split into up to nthreads
+    // slices of dimensions, others are run as a whole (j0 = -1). Every task writes its own part of average/error.
+    struct EstimTask
+    {
+        int iel, offset, j0, j1;
+    };
+    std::vector<EstimTask> tasks;
     int offset = 0;
-    for (auto &el : _cont) { // go through estimators and write to avg/error blocks
-        el.estim(average + offset, error + offset);
-        offset += el.accu->getNObs();
+    for (int i = 0; i < this->size(); ++i) {
+        const auto &el = _cont[i];
+        const int nobs = el.accu->getNObs();
+        if (nobs > 1 && createSliceEstimator<double>(el.estimType) != nullptr) {
+            const int nslices = std::min(nobs, nthreads);
+            for (int is = 0; is < nslices; ++is) {
+                tasks.push_back(EstimTask{i, offset, is*nobs/nslices, (is + 1)*nobs/nslices});
+            }
+        }
+        else {
+            tasks.push_back(EstimTask{i, offset, -1, -1});
+        }
+        offset += nobs;
+    }
+
+    auto runTask = [this, average, error](const EstimTask &task) {
+        const auto &el = _cont[task.iel];
+        if (task.j0 < 0) {
+            el.estim(average + task.offset, error + task.offset);
+            return;
+        }
+        const AccumulatorInterface &accu = *el.accu;
+        if (!accu.isFinalized()) {
+            throw std::runtime_error("[ObservableContainer::estimate] Estimator was called, but accumulator is not finalized.");
+        }
+        if (const ReducedStorage * const rdata = accu.getReducedData()) {
+            rdata->estimateSlice(el.estimType, accu.getNStore(), task.j0, task.j1, average + task.offset, error + task.offset);
+        }
+        else if (const RunLengthStorage * const rldata = accu.getRunLengthData()) {
+            rldata->estimateSlice(el.estimType, task.j0, task.j1, average + task.offset, error + task.offset);
+        }
+        else if (usesStreamingBlocker(accu, el.estimType)) {
+            StreamingBlockerEstimatorSlice(accu.getNStore(), accu.getNObs(), accu.getData(), task.j0, task.j1,
+                                           average + task.offset, error + task.offset);
+        }
+        else {
+            createSliceEstimator<double>(el.estimType)(accu.getNStore(), accu.getNObs(), accu.getData(), task.j0, task.j1,
+                                                       average + task.offset, error + task.offset);
+        }
+    };
+
+    // run the tasks on nthreads threads (including this one), which pick the next task in order
+    const int nworkers = std::min(nthreads, static_cast<int>(tasks.size()));
+    std::atomic<size_t> next{0};
+    std::vector<std::exception_ptr> excepts(tasks.size());
+    auto runWorker = [&]() {
+        for (size_t it = next++; it < tasks.size(); it = next++) {
+            try {
+                runTask(tasks[it]);
+            }
+            catch (...) {
+                excepts[it] = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<size_t>(std::max(0, nworkers - 1)));
+    for (int i = 1; i < nworkers; ++i) { threads.emplace_back(runWorker); }
+    runWorker();
+    for (auto &t : threads) { t.join(); }
+    for (auto &e : excepts) { // rethrow the error of the first failed task, like the serial version would
+        if (e) { std::rethrow_exception(e); }
+    }
+}
+
+
+void ObservableContainer::merge(const ObservableContainer &other)
+{
+    if (&other == this) { throw std::invalid_argument("[ObservableContainer::merge] Container can't be merged with itself."); }
+    if (other.size() != this->size() || other._ncovdim != _ncovdim) {
+        throw std::invalid_argument("[ObservableContainer::merge] Containers differ in their observables.");
+    }
+    for (int i = 0; i < this->size(); ++i) {
+        if (other._cont[i].estimType != _cont[i].estimType) {
+            throw std::invalid_argument("[ObservableContainer::merge] Containers differ in their estimators.");
+        }
+    }
+    if (_ncovdim > 0) { // before the accumulators, which take their results from the group
+        if (!_cov || !other._cov) { throw std::runtime_error("[ObservableContainer::merge] Covariance group is not allocated."); }
+        _cov->merge(*other._cov);
+    }
+    for (int i = 0; i < this->size(); ++i) {
+        _cont[i].accu->merge(*other._cont[i].accu);
     }
 }
 
 
+void ObservableContainer::serialize(std::ostream &os) const
+{
+    writeBinary(os, static_cast<int32_t>(_cont.size()));
+    writeBinary(os, static_cast<int32_t>(_ncovdim));
+    if (_ncovdim > 0) {
+        if (!_cov) { throw std::runtime_error("[ObservableContainer::serialize] Covariance group is not allocated."); }
+        _cov->write(os);
+    }
+    for (auto &el : _cont) {
+        el.accu->serialize(os);
+    }
+}
+
+void ObservableContainer::deserialize(std::istream &is)
+{
+    int32_t nobs, ncovdim;
+    readBinary(is, nobs);
+    readBinary(is, ncovdim);
+    if (nobs != static_cast<int32_t>(_cont.size()) || ncovdim != _ncovdim) {
+        throw std::invalid_argument("[ObservableContainer::deserialize] Stored observables do not match.");
+    }
+    this->_prepareAllocation();
+    if (_ncovdim > 0) { _cov->read(is); } // before the accumulators, which take their results from the group
+    for (auto &el : _cont) {
+        el.accu->deserialize(is);
+    }
+}
+
+
+std::unique_ptr<ObservableContainer> ObservableContainer::createEquivalent() const
+{
+    std::unique_ptr<ObservableContainer> cont(new ObservableContainer());
+    for (auto &el : _cont) {
+        cont->addObservable(el.obs->clone(), el.blocksize, el.accu->getNSkip(), el.flag_equil, el.estimType, el.precision);
+    }
+    cont->setMappedStorageDir(_mapdir);
+    cont->setPersistentStorage(_flag_persistent);
+    cont->setRunLengthStorage(_flag_runlength);
+    return cont;
+}
+
+
 void ObservableContainer::reset()
 {
     for (auto &el : _cont) {
         el.accu->reset();
     }
+    if (_cov) { _cov->reset(); }
 }
 
 void ObservableContainer::deallocate()
@@ -123,6 +445,12 @@ void ObservableContainer::deallocate()
     for (auto &el : _cont) {
         el.accu->deallocate();
     }
+    if (_flag_persistent) { // keep the memory for the next allocation
+        _arena.release();
+    }
+    else {
+        _arena.clear();
+    }
     // let dependent obs deregister
     for (int i = 0; i < this->getNObs(); ++i) {
         if (_cont[i].depobs != nullptr) { _cont[i].depobs->deregisterDeps(); }
@@ -131,6 +459,7 @@ void ObservableContainer::deallocate()
 
 std::unique_ptr<ObservableFunctionInterface> ObservableContainer::pop_back()
 {
+    if (_cont.back().covoffset >= 0) { _ncovdim -= _cont.back().accu->getNObs(); }
     auto obs = std::move(_cont.back().obs); // move last obs out
     _cont.pop_back(); // resize vector
     _nobsdim -= obs->getNObs(); // adjust nobsdim
@@ -142,6 +471,9 @@ void ObservableContainer::clear()
 {
     _cont.clear();
     _nobsdim = 0;
+    _ncovdim = 0;
+    _cov.reset();
     _nskip_PDF = 0;
+    _flag_dependent = false;
 }
 }  // namespace mci
@@ -0,0 +1,129 @@
+#include "mci/OnlineCovariance.hpp"
+#include "mci/BinaryIO.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace mci
+{
+// --- Constructor
+
+OnlineCovariance::OnlineCovariance(const int n_dim):
+        ndim(n_dim), _staged(std::max(0, ndim)), _mean(std::max(0, ndim)), _delta(std::max(0, ndim)),
+        _comoment(static_cast<size_t>(std::max(0, ndim))*std::max(0, ndim))
+{
+    if (ndim < 1) { throw std::invalid_argument("[OnlineCovariance] ndim must be at least 1."); }
+    this->reset();
+}
+
+
+// --- Accumulation
+
+void OnlineCovariance::add(const double x[])
+{
+    const double ninv = 1./(++_nsamples);
+    for (int i = 0; i < ndim; ++i) {
+        _delta[i] = x[i] - _mean[i];
+        _mean[i] += _delta[i]*ninv;
+    }
+    for (int i = 0; i < ndim; ++i) {
+        double * const crow = _comoment.data() + static_cast<size_t>(i)*ndim;
+        const double di = _delta[i];
+        for (int j = i; j < ndim; ++j) { crow[j] += di*(x[j] - _mean[j]); }
+    }
+}
+
+void OnlineCovariance::stage(const int offset, const int n, const double x[])
+{
+    if (offset < 0 || n < 0 || offset + n > ndim || _nstaged + n > ndim) {
+        throw std::out_of_range("[OnlineCovariance::stage] Staged values exceed the sample dimension.");
+    }
+    std::copy(x, x + n, _staged.begin() + offset);
+    _nstaged += n;
+    if (_nstaged == ndim) {
+        this->add(_staged.data());
+        _nstaged = 0;
+    }
+}
+
+void OnlineCovariance::reset()
+{
+    _nsamples = 0;
+    _nstaged = 0;
+    std::fill(_staged.begin(), _staged.end(), 0.);
+    std::fill(_mean.begin(), _mean.end(), 0.);
+    std::fill(_delta.begin(), _delta.end(), 0.);
+    std::fill(_comoment.begin(), _comoment.end(), 0.);
+}
+
+void OnlineCovariance::merge(const OnlineCovariance &other)
+{   // combine mean and co-moments of both (Chan et al.)
+    if (&other == this || other.ndim != ndim) { throw std::invalid_argument("[OnlineCovariance::merge] Other covariance must differ and have equal ndim."); }
+    if (_nstaged > 0 || other._nstaged > 0) { throw std::runtime_error("[OnlineCovariance::merge] Samples are staged partially."); }
+    if (other._nsamples == 0) { return; }
+    const auto na = static_cast<double>(_nsamples);
+    const auto nb = static_cast<double>(other._nsamples);
+    const double fac = na*nb/(na + nb);
+    for (int i = 0; i < ndim; ++i) { _delta[i] = other._mean[i] - _mean[i]; }
+    for (int i = 0; i < ndim; ++i) {
+        const size_t row = static_cast<size_t>(i)*ndim;
+        for (int j = i; j < ndim; ++j) { _comoment[row + j] += other._comoment[row + j] + fac*_delta[i]*_delta[j]; }
+        _mean[i] += _delta[i]*nb/(na + nb);
+    }
+    _nsamples += other._nsamples;
+}
+
+
+// --- Results
+
+void OnlineCovariance::getMean(double mean[]) const
+{
+    std::copy(_mean.begin(), _mean.end(), mean);
+}
+
+void OnlineCovariance::getCovariance(double cov[]) const
+{
+    const double normf = (_nsamples > 1) ? 1./(_nsamples - 1) : 0.;
+    for (int i = 0; i < ndim; ++i) {
+        for (int j = i; j < ndim; ++j) {
+            cov[i*ndim + j] = normf*_comoment[static_cast<size_t>(i)*ndim + j];
+            cov[j*ndim + i] = cov[i*ndim + j];
+        }
+    }
+}
+
+void OnlineCovariance::getMeanCovariance(double cov[]) const
+{
+    this->getCovariance(cov);
+    if (_nsamples > 1) {
+        const double ninv = 1./_nsamples;
+        for (int i = 0; i < ndim*ndim; ++i) { cov[i] *= ninv; }
+    }
+}
+
+
+// --- I/O
+
+void OnlineCovariance::write(std::ostream &os) const
+{
+    writeBinary(os, _nsamples);
+    writeBinary(os, static_cast<int32_t>(_nstaged));
+    writeBinary(os, _staged.data(), ndim);
+    writeBinary(os, _mean.data(), ndim);
+    writeBinary(os, _comoment.data(), static_cast<int64_t>(ndim)*ndim);
+}
+
+void OnlineCovariance::read(std::istream &is)
+{
+    int32_t nstaged;
+    readBinary(is, _nsamples);
+    readBinary(is, nstaged);
+    if (_nsamples < 0 || nstaged < 0 || nstaged >= ndim) {
+        throw std::runtime_error("[OnlineCovariance::read] Stored sample counts are out of range.");
+    }
+    _nstaged = nstaged;
+    readBinary(is, _staged.data(), ndim);
+    readBinary(is, _mean.data(), ndim);
+    readBinary(is, _comoment.data(), static_cast<int64_t>(ndim)*ndim);
+}
+} // namespace mci
@@ -1,4 +1,5 @@
 #include "mci/ProtoFunctionInterface.hpp"
+#include "mci/BinaryIO.hpp"
 
 #include <algorithm>
 #include <stdexcept>
@@ -7,7 +8,7 @@ namespace mci
 {
 
 ProtoFunctionInterface::ProtoFunctionInterface(const int ndim, const int nproto):
-        _ndim(ndim), _nproto(0), _protoold(nullptr), _protonew(nullptr)
+        _ndim(ndim), _nproto(0), _nwalkers(1), _protoold(nullptr), _protonew(nullptr)
 {
     if (ndim < 1) { throw std::invalid_argument("[ProtoFunctionInterface] Number of dimensions must be at least 1."); }
     this->setNProto(nproto);
@@ -19,39 +20,85 @@ ProtoFunctionInterface::~ProtoFunctionInterface()
     delete[] _protoold;
 }
 
-void ProtoFunctionInterface::setNProto(const int nproto)
+void ProtoFunctionInterface::_allocateProtoValues()
 {
     delete[] _protonew;
     delete[] _protoold;
-    if (nproto > 0) {
-        _protoold = new double[nproto];
-        _protonew = new double[nproto];
-        std::fill(_protoold, _protoold + nproto, 0.);
-        std::fill(_protonew, _protonew + nproto, 0.);
-        _nproto = nproto;
+    if (_nproto > 0) {
+        const int ntot = _nwalkers*_nproto;
+        _protoold = new double[ntot];
+        _protonew = new double[ntot];
+        std::fill(_protoold, _protoold + ntot, 0.);
+        std::fill(_protonew, _protonew + ntot, 0.);
     }
     else {
         _protoold = nullptr;
         _protonew = nullptr;
-        _nproto = 0;
     }
 }
 
-void ProtoFunctionInterface::initializeProtoValues(const double xold[])
+void ProtoFunctionInterface::setNProto(const int nproto)
+{
+    _nproto = std::max(nproto, 0);
+    this->_allocateProtoValues();
+}
+
+void ProtoFunctionInterface::setNWalkers(const int nwalkers)
+{
+    if (nwalkers < 1) { throw std::invalid_argument("[ProtoFunctionInterface::setNWalkers] Number of walkers must be at least 1."); }
+    if (nwalkers > 1 && !this->supportsEnsemble()) {
+        throw std::invalid_argument("[ProtoFunctionInterface::setNWalkers] Function does not support ensemble mode (see supportsEnsemble()).");
+    }
+    if (nwalkers != _nwalkers) {
+        _nwalkers = nwalkers;
+        this->_allocateProtoValues();
+    }
+}
+
+void ProtoFunctionInterface::initializeProtoValues(const double xold[], const int iw)
+{
+    this->protoFunction(xold, _protonew + iw*_nproto);
+    this->newToOld(iw);
+}
+
+void ProtoFunctionInterface::initializeProtoValuesBatch(const double xold[])
+{
+    this->protoFunctionBatch(_nwalkers, xold, _protonew);
+    this->_newToOld();
+    std::copy(_protonew, _protonew + _nwalkers*_nproto, _protoold);
+}
+
+void ProtoFunctionInterface::protoFunctionBatch(const int nwalkers, const double in[], double protovalues[])
 {
-    this->protoFunction(xold, _protonew);
-    this->newToOld();
+    for (int iw = 0; iw < nwalkers; ++iw) {
+        this->protoFunction(in + iw*_ndim, protovalues + iw*_nproto);
+    }
 }
 
-void ProtoFunctionInterface::newToOld()
+void ProtoFunctionInterface::newToOld(const int iw)
 {   // copy new values to old
     this->_newToOld();
-    std::copy(_protonew, _protonew + _nproto, _protoold);
+    const int offset = iw*_nproto;
+    std::copy(_protonew + offset, _protonew + offset + _nproto, _protoold + offset);
 }
 
-void ProtoFunctionInterface::oldToNew()
+void ProtoFunctionInterface::oldToNew(const int iw)
 {   // copy old values to new
     this->_oldToNew();
-    std::copy(_protoold, _protoold + _nproto, _protonew);
+    const int offset = iw*_nproto;
+    std::copy(_protoold + offset, _protoold + offset + _nproto, _protonew + offset);
+}
+
+void ProtoFunctionInterface::writeProtoValues(std::ostream &os, const int nwalkers) const
+{
+    if (nwalkers > _nwalkers) { throw std::invalid_argument("[ProtoFunctionInterface::writeProtoValues] Requested more walkers than allocated."); }
+    writeBinary(os, _protoold, nwalkers*_nproto);
+}
+
+void ProtoFunctionInterface::readProtoValues(std::istream &is, const int nwalkers)
+{
+    if (nwalkers > _nwalkers) { throw std::invalid_argument("[ProtoFunctionInterface::readProtoValues] Requested more walkers than allocated."); }
+    readBinary(is, _protoold, nwalkers*_nproto);
+    std::copy(_protoold, _protoold + nwalkers*_nproto, _protonew);
 }
 }  // namespace mci
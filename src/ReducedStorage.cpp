@@ -0,0 +1,245 @@
+#include "mci/ReducedStorage.hpp"
+#include "mci/BinaryIO.hpp"
+#include "mci/Factories.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace mci
+{
+constexpr int16_t ReducedStorage::QMAX;
+
+ReducedStorage::ReducedStorage(const StoragePrecision prec, const int n_obs):
+        precision(prec), nobs(n_obs)
+{
+    if (precision == StoragePrecision::Double) {
+        throw std::invalid_argument("[ReducedStorage] Double precision is not a reduced precision.");
+    }
+    if (nobs < 1) { throw std::invalid_argument("[ReducedStorage] nobs must be at least 1."); }
+    if (precision == StoragePrecision::Int16) {
+        _offset.assign(static_cast<size_t>(nobs), 0.);
+        _scale.assign(static_cast<size_t>(nobs), 0.);
+    }
+}
+
+size_t ReducedStorage::getNBytes() const
+{
+    return _fdata.size()*sizeof(float) + _idata.size()*sizeof(int16_t);
+}
+
+
+// --- Allocation
+
+void ReducedStorage::allocate(const int64_t nrows)
+{
+    _nalloc = nrows;
+    _nrows = 0;
+    if (precision == StoragePrecision::Float) {
+        _fdata.assign(static_cast<size_t>(nrows*nobs), 0.f);
+    }
+    else {
+        _idata.assign(static_cast<size_t>(nrows*nobs), 0);
+    }
+    this->clear();
+}
+
+void ReducedStorage::clear()
+{   // only the stored rows need to be zeroed
+    if (!_fdata.empty()) { std::fill(_fdata.begin(), _fdata.begin() + _nrows*nobs, 0.f); }
+    if (!_idata.empty()) { std::fill(_idata.begin(), _idata.begin() + _nrows*nobs, 0); }
+    std::fill(_offset.begin(), _offset.end(), 0.);
+    std::fill(_scale.begin(), _scale.end(), 0.);
+    _nrows = 0;
+}
+
+void ReducedStorage::deallocate()
+{
+    std::vector<float>().swap(_fdata);
+    std::vector<int16_t>().swap(_idata);
+    std::fill(_offset.begin(), _offset.end(), 0.);
+    std::fill(_scale.begin(), _scale.end(), 0.);
+    _nalloc = 0;
+    _nrows = 0;
+}
+
+
+// --- Storage
+
+void ReducedStorage::_rescale(const int j, const double absdev)
+{
+    const double oldscale = _scale[j];
+    const double newscale = std::max(2.*oldscale, 4.*absdev/QMAX); // leave room to grow
+    if (oldscale > 0.) { // requantize stored rows
+        ++_nrequant;
+        const double fac = oldscale/newscale;
+        for (int64_t i = 0; i < _nrows; ++i) {
+            int16_t &q = _idata[i*nobs + j];
+            q = static_cast<int16_t>(std::nearbyint(q*fac)); // ties to even (lround would bias one-signed values)
+        }
+    }
+    _scale[j] = newscale;
+}
+
+void ReducedStorage::store(const int64_t row, const double vals[])
+{
+    if (precision == StoragePrecision::Float) {
+        std::copy(vals, vals + nobs, _fdata.begin() + row*nobs);
+    }
+    else {
+        if (_nrows == 0) { std::copy(vals, vals + nobs, _offset.begin()); } // the first row defines the offsets
+        int16_t * const q = _idata.data() + row*nobs;
+        for (int j = 0; j < nobs; ++j) {
+            const double dev = vals[j] - _offset[j];
+            if (std::fabs(dev) > _scale[j]*QMAX) { this->_rescale(j, std::fabs(dev)); }
+            q[j] = (_scale[j] > 0.) ? static_cast<int16_t>(std::nearbyint(dev/_scale[j])) : 0; // (ties to even)
+        }
+    }
+    _nrows = std::max(_nrows, row + 1);
+}
+
+void ReducedStorage::append(const ReducedStorage &other, const int64_t nrows)
+{
+    if (other.precision != precision || other.nobs != nobs) {
+        throw std::invalid_argument("[ReducedStorage::append] Storage precision or number of values does not match.");
+    }
+    if (nrows < 0 || nrows > other._nrows) { throw std::out_of_range("[ReducedStorage::append] Requested number of rows is out of range."); }
+    const int64_t row0 = _nrows;
+    if (row0 + nrows > _nalloc) { // grow, keeping the stored rows
+        _nalloc = row0 + nrows;
+        if (precision == StoragePrecision::Float) {
+            _fdata.resize(static_cast<size_t>(_nalloc*nobs), 0.f);
+        }
+        else {
+            _idata.resize(static_cast<size_t>(_nalloc*nobs), 0);
+        }
+    }
+    if (precision == StoragePrecision::Float) { // exact copy
+        std::copy(other._fdata.begin(), other._fdata.begin() + nrows*nobs, _fdata.begin() + row0*nobs);
+        _nrows = row0 + nrows;
+        return;
+    }
+    std::vector<double> vals(static_cast<size_t>(nobs));
+    for (int64_t i = 0; i < nrows; ++i) {
+        other.load(i, vals.data());
+        this->store(row0 + i, vals.data());
+    }
+}
+
+void ReducedStorage::load(const int64_t row, double vals[]) const
+{
+    if (precision == StoragePrecision::Float) {
+        std::copy(_fdata.begin() + row*nobs, _fdata.begin() + (row + 1)*nobs, vals);
+    }
+    else {
+        for (int j = 0; j < nobs; ++j) { vals[j] = _offset[j] + _scale[j]*_idata[row*nobs + j]; }
+    }
+}
+
+
+// --- Estimation
+
+void ReducedStorage::estimate(const EstimatorType estimType, const int64_t nrows, double average[], double error[], double tau[]) const
+{
+    const bool flag_tau = (estimType == EstimatorType::Autocorrelation); // tau is invariant under offset and scale
+    if (precision == StoragePrecision::Float) {
+        if (flag_tau) { AutocorrelationEstimator(nrows, nobs, _fdata.data(), average, error, tau); }
+        else { createReducedEstimator<float>(estimType)(nrows, nobs, _fdata.data(), average, error); }
+    }
+    else {
+        if (flag_tau) { AutocorrelationEstimator(nrows, nobs, _idata.data(), average, error, tau); }
+        else { createReducedEstimator<int16_t>(estimType)(nrows, nobs, _idata.data(), average, error); }
+        for (int j = 0; j < nobs; ++j) { // transform back
+            average[j] = _offset[j] + _scale[j]*average[j];
+            error[j] *= _scale[j];
+        }
+    }
+}
+
+void ReducedStorage::estimateSlice(const EstimatorType estimType, const int64_t nrows, const int j0, const int j1,
+                                   double average[], double error[]) const
+{
+    if (precision == StoragePrecision::Float) {
+        createSliceEstimator<float>(estimType)(nrows, nobs, _fdata.data(), j0, j1, average, error);
+    }
+    else {
+        createSliceEstimator<int16_t>(estimType)(nrows, nobs, _idata.data(), j0, j1, average, error);
+        for (int j = j0; j < j1; ++j) { // transform back
+            average[j] = _offset[j] + _scale[j]*average[j];
+            error[j] *= _scale[j];
+        }
+    }
+}
+
+
+// --- Binary I/O
+
+void ReducedStorage::write(std::ostream &os, const int64_t nrows) const
+{
+    if (precision == StoragePrecision::Float) {
+        writeBinary(os, _fdata.data(), nrows*nobs);
+    }
+    else {
+        writeBinary(os, _nrows);
+        writeBinary(os, _offset.data(), nobs);
+        writeBinary(os, _scale.data(), nobs);
+        writeBinary(os, _idata.data(), nrows*nobs);
+    }
+}
+
+void ReducedStorage::read(std::istream &is, const int64_t nrows)
+{
+    if (nrows < 0 || nrows > _nalloc) { throw std::runtime_error("[ReducedStorage::read] Stored number of rows is out of range."); }
+    if (precision == StoragePrecision::Float) {
+        readBinary(is, _fdata.data(), nrows*nobs);
+        _nrows = nrows;
+    }
+    else {
+        readBinary(is, _nrows);
+        if (_nrows != nrows) { throw std::runtime_error("[ReducedStorage::read] Stored number of rows is inconsistent."); }
+        readBinary(is, _offset.data(), nobs);
+        readBinary(is, _scale.data(), nobs);
+        readBinary(is, _idata.data(), nrows*nobs);
+    }
+}
+
+void ReducedStorage::writeRows(std::ostream &os, const int64_t row0, const int64_t row1) const
+{
+    if (precision == StoragePrecision::Float) {
+        writeBinary(os, _fdata.data() + row0*nobs, (row1 - row0)*nobs);
+    }
+    else {
+        writeBinary(os, _idata.data() + row0*nobs, (row1 - row0)*nobs);
+    }
+}
+
+void ReducedStorage::readRows(std::istream &is, const int64_t row0, const int64_t row1)
+{
+    if (row0 < 0 || row1 < row0 || row1 > _nalloc) { throw std::runtime_error("[ReducedStorage::readRows] Stored rows are out of range."); }
+    if (precision == StoragePrecision::Float) {
+        readBinary(is, _fdata.data() + row0*nobs, (row1 - row0)*nobs);
+    }
+    else {
+        readBinary(is, _idata.data() + row0*nobs, (row1 - row0)*nobs);
+    }
+}
+
+void ReducedStorage::writeHeader(std::ostream &os) const
+{
+    writeBinary(os, _nrows);
+    if (precision == StoragePrecision::Int16) {
+        writeBinary(os, _offset.data(), nobs);
+        writeBinary(os, _scale.data(), nobs);
+    }
+}
+
+void ReducedStorage::readHeader(std::istream &is)
+{
+    readBinary(is, _nrows);
+    if (_nrows < 0 || _nrows > _nalloc) { throw std::runtime_error("[ReducedStorage::readHeader] Stored number of rows is out of range."); }
+    if (precision == StoragePrecision::Int16) {
+        readBinary(is, _offset.data(), nobs);
+        readBinary(is, _scale.data(), nobs);
+    }
+}
+} // namespace mci
@@ -0,0 +1,184 @@
+#include "mci/RunLengthStorage.hpp"
+#include "mci/BinaryIO.hpp"
+#include "mci/Factories.hpp"
+
+#include <algorithm>
+
+namespace mci
+{
+
+RunLengthStorage::RunLengthStorage(const int n_obs):
+        nobs(n_obs)
+{
+    if (nobs < 1) { throw std::invalid_argument("[RunLengthStorage] nobs must be at least 1."); }
+}
+
+size_t RunLengthStorage::getNBytes() const
+{
+    return _values.capacity()*sizeof(double) + _ends.capacity()*sizeof(int64_t);
+}
+
+
+// --- Allocation
+
+void RunLengthStorage::reserve(const int64_t nruns)
+{
+    _values.reserve(static_cast<size_t>(nruns*nobs));
+    _ends.reserve(static_cast<size_t>(nruns));
+}
+
+void RunLengthStorage::clear()
+{
+    _values.clear();
+    _ends.clear();
+}
+
+void RunLengthStorage::deallocate()
+{
+    std::vector<double>().swap(_values);
+    std::vector<int64_t>().swap(_ends);
+}
+
+void RunLengthStorage::shrink()
+{
+    _values.shrink_to_fit();
+    _ends.shrink_to_fit();
+}
+
+
+// --- Storage
+
+void RunLengthStorage::add(const double vals[])
+{
+    if (!_ends.empty() && std::equal(vals, vals + nobs, _values.end() - nobs)) {
+        this->repeat();
+    }
+    else {
+        this->store(vals);
+    }
+}
+
+void RunLengthStorage::load(const int64_t row, double vals[]) const
+{
+    if (row < 0 || row >= this->getNRows()) { throw std::out_of_range("[RunLengthStorage::load] Requested row is out of range."); }
+    const double * const rvals = RunLengthRows(this->getSamples(), nobs)[row];
+    std::copy(rvals, rvals + nobs, vals);
+}
+
+void RunLengthStorage::append(const RunLengthStorage &other)
+{
+    if (other.nobs != nobs) { throw std::invalid_argument("[RunLengthStorage::append] Number of values does not match."); }
+    const int64_t nrows = this->getNRows();
+    _values.insert(_values.end(), other._values.begin(), other._values.end());
+    _ends.reserve(_ends.size() + other._ends.size());
+    for (const int64_t end : other._ends) { _ends.push_back(nrows + end); }
+}
+
+
+// --- Estimation
+
+void RunLengthStorage::estimate(const EstimatorType estimType, double average[], double error[], double tau[]) const
+{
+    const RunLengthSamples x = this->getSamples();
+    const int64_t nrows = this->getNRows();
+    switch (estimType) {
+    case EstimatorType::Noop:
+        NoopEstimator(nrows, nobs, x, average, error);
+        return;
+
+    case EstimatorType::Uncorrelated:
+        UncorrelatedEstimator(nrows, nobs, x, average, error);
+        return;
+
+    case EstimatorType::Correlated:
+        CorrelatedEstimator(nrows, nobs, x, average, error);
+        return;
+
+    case EstimatorType::FCBlocker:
+        FCBlockerEstimator(nrows, nobs, x, average, error);
+        return;
+
+    case EstimatorType::MJBlocker:
+        MJBlockerEstimator(nrows, nobs, x, average, error);
+        return;
+
+    case EstimatorType::Autocorrelation:
+        AutocorrelationEstimator(nrows, nobs, x, average, error, tau);
+        return;
+
+    default:
+        throw std::invalid_argument("[RunLengthStorage::estimate] Estimator does not work on stored samples.");
+    }
+}
+
+void RunLengthStorage::estimateSlice(const EstimatorType estimType, const int j0, const int j1, double average[], double error[]) const
+{
+    const RunLengthSamples x = this->getSamples();
+    const int64_t nrows = this->getNRows();
+    switch (estimType) {
+    case EstimatorType::Uncorrelated:
+        UncorrelatedEstimatorSlice(nrows, nobs, x, j0, j1, average, error);
+        return;
+
+    case EstimatorType::Correlated:
+        CorrelatedEstimatorSlice(nrows, nobs, x, j0, j1, average, error);
+        return;
+
+    case EstimatorType::FCBlocker:
+        FCBlockerEstimatorSlice(nrows, nobs, x, j0, j1, average, error);
+        return;
+
+    case EstimatorType::MJBlocker:
+        MJBlockerEstimatorSlice(nrows, nobs, x, j0, j1, average, error);
+        return;
+
+    default:
+        throw std::invalid_argument("[RunLengthStorage::estimateSlice] Estimator is not split into slices.");
+    }
+}
+
+
+// --- Binary I/O
+
+void RunLengthStorage::write(std::ostream &os) const
+{
+    writeBinary(os, this->getNRuns());
+    writeBinary(os, _ends.data(), this->getNRuns());
+    writeBinary(os, _values.data(), this->getNRuns()*nobs);
+}
+
+void RunLengthStorage::read(std::istream &is, const int64_t nrows)
+{
+    int64_t nruns;
+    readBinary(is, nruns);
+    if (nruns < 0 || nruns > nrows) { throw std::runtime_error("[RunLengthStorage::read] Stored number of runs is out of range."); }
+    _ends.resize(static_cast<size_t>(nruns));
+    _values.resize(static_cast<size_t>(nruns*nobs));
+    readBinary(is, _ends.data(), nruns);
+    readBinary(is, _values.data(), nruns*nobs);
+    int64_t last = 0;
+    for (const int64_t end : _ends) {
+        if (end <= last) { throw std::runtime_error("[RunLengthStorage::read] Stored run ends are not increasing."); }
+        last = end;
+    }
+    if (last != nrows) { throw std::runtime_error("[RunLengthStorage::read] Stored runs are inconsistent with the number of rows."); }
+}
+
+void RunLengthStorage::writeRuns(std::ostream &os, const int64_t run0, const int64_t run1) const
+{
+    writeBinary(os, _ends.data() + run0, run1 - run0);
+    writeBinary(os, _values.data() + run0*nobs, (run1 - run0)*nobs);
+}
+
+void RunLengthStorage::readRuns(std::istream &is, const int64_t run0, const int64_t run1)
+{
+    if (run0 != this->getNRuns() || run1 < run0) { throw std::runtime_error("[RunLengthStorage::readRuns] Stored runs are out of order."); }
+    _ends.resize(static_cast<size_t>(run1));
+    _values.resize(static_cast<size_t>(run1*nobs));
+    readBinary(is, _ends.data() + run0, run1 - run0);
+    readBinary(is, _values.data() + run0*nobs, (run1 - run0)*nobs);
+    for (int64_t i = run0; i < run1; ++i) {
+        if (_ends[i] <= ((i > 0) ? _ends[i - 1] : 0)) { throw std::runtime_error("[RunLengthStorage::readRuns] Stored run ends are not increasing."); }
+    }
+}
+} // namespace mci
@@ -1,5 +1,8 @@
 #include "mci/SamplingFunctionContainer.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 namespace mci
 {
 
@@ -8,24 +11,52 @@ void SamplingFunctionContainer::addSamplingFunction(std::unique_ptr<SamplingFunc
     _pdfs.emplace_back(std::move(sf)); // now sf is owned by _pdfs vector
 }
 
-void SamplingFunctionContainer::newToOld()
+void SamplingFunctionContainer::setNWalkers(const int nwalkers)
+{
+    for (auto &sf : _pdfs) {
+        sf->setNWalkers(nwalkers);
+    }
+}
+
+void SamplingFunctionContainer::newToOld(const int iw)
+{
+    for (auto &sf : _pdfs) {
+        sf->newToOld(iw);
+    }
+}
+
+void SamplingFunctionContainer::oldToNew(const int iw)
+{
+    for (auto &sf : _pdfs) {
+        sf->oldToNew(iw);
+    }
+}
+
+void SamplingFunctionContainer::initializeProtoValues(const double xold[], const int iw)
 {
     for (auto &sf : _pdfs) {
-        sf->newToOld();
+        sf->initializeProtoValues(xold, iw);
     }
 }
 
-void SamplingFunctionContainer::oldToNew()
+void SamplingFunctionContainer::initializeProtoValues(const WalkerEnsemble &wlkens)
 {
     for (auto &sf : _pdfs) {
-        sf->oldToNew();
+        sf->initializeProtoValuesBatch(wlkens.xold);
     }
 }
 
-void SamplingFunctionContainer::initializeProtoValues(const double xold[])
+void SamplingFunctionContainer::writeProtoValues(std::ostream &os, const int nwalkers) const
 {
     for (auto &sf : _pdfs) {
-        sf->initializeProtoValues(xold);
+        sf->writeProtoValues(os, nwalkers);
+    }
+}
+
+void SamplingFunctionContainer::readProtoValues(std::istream &is, const int nwalkers)
+{
+    for (auto &sf : _pdfs) {
+        sf->readProtoValues(is, nwalkers);
     }
 }
 
@@ -38,15 +69,51 @@ double SamplingFunctionContainer::getOldSamplingFunction() const
     return sampf;
 }
 
-double SamplingFunctionContainer::computeAcceptance(const WalkerState &wlk)
+double SamplingFunctionContainer::computeAcceptance(const WalkerState &wlk, const int iw)
 {
     double acceptance = 1.;
     for (auto &sf : _pdfs) {
-        acceptance *= sf->computeAcceptance(wlk);
+        acceptance *= sf->computeAcceptance(wlk, iw);
     }
     return acceptance;
 }
 
+void SamplingFunctionContainer::computeAcceptance(const WalkerEnsemble &wlkens, double acceptance[])
+{
+    if (_pdfs.empty()) {
+        std::fill(acceptance, acceptance + wlkens.nwalkers, 1.);
+        return;
+    }
+    // evaluate each pdf for all walkers at once
+    _pdfs[0]->computeAcceptance(wlkens, acceptance);
+    if (_pdfs.size() > 1) {
+        _accbuf.resize(static_cast<size_t>(wlkens.nwalkers));
+        for (size_t i = 1; i < _pdfs.size(); ++i) {
+            _pdfs[i]->computeAcceptance(wlkens, _accbuf.data());
+            for (int iw = 0; iw < wlkens.nwalkers; ++iw) { acceptance[iw] *= _accbuf[iw]; }
+        }
+    }
+}
+
+bool SamplingFunctionContainer::computeLogAcceptance(const WalkerState &wlk, const double logthreshold, const int iw)
+{
+    // the bounds of all pdfs after index i are summed in _boundbuf[i+1]
+    const size_t npdf = _pdfs.size();
+    _boundbuf.resize(npdf + 1);
+    _boundbuf[npdf] = 0.;
+    for (size_t i = npdf; i > 0; --i) {
+        _boundbuf[i - 1] = _boundbuf[i] + _pdfs[i - 1]->getMaxLogAcceptance(iw);
+    }
+
+    double logacc = 0.;
+    for (size_t i = 0; i < npdf; ++i) {
+        logacc += _pdfs[i]->computeLogAcceptance(wlk, iw);
+        const double maxlogacc = (std::isinf(logacc) && logacc < 0.) ? logacc : logacc + _boundbuf[i + 1]; // keep -inf (zero acceptance)
+        if (maxlogacc < logthreshold) { return false; } // rejection is certain
+    }
+    return (logacc >= logthreshold);
+}
+
 void SamplingFunctionContainer::prepareObservation(const double x[])
 {
     for (auto &sf : _pdfs) {
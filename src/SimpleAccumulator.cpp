@@ -1,11 +1,12 @@
 #include "mci/SimpleAccumulator.hpp"
+#include "mci/BinaryIO.hpp"
 
 namespace mci
 {
 
 void SimpleAccumulator::_allocate()
 {
-    _data = new double[_nobs];
+    _data = this->_newData(_nobs);
     std::fill(_data, _data + _nobs, 0.);
     _flag_alloc = true;
 }
@@ -36,8 +37,41 @@ void SimpleAccumulator::_reset()
 
 void SimpleAccumulator::_deallocate()
 {
-    delete[] _data;
-    _data = nullptr;
+    this->_deleteData();
     _flag_alloc = false;
 }
+
+
+void SimpleAccumulator::_writeData(std::ostream &os) const
+{
+    if (_flag_alloc) { writeBinary(os, _data, _nobs); }
+}
+
+
+void SimpleAccumulator::_readData(std::istream &is)
+{
+    if (_flag_alloc) { readBinary(is, _data, _nobs); }
+}
+
+
+void SimpleAccumulator::_merge(const AccumulatorInterface &other)
+{   // weighted average
+    const double w = static_cast<double>(other.getNAccu())/(this->getNAccu() + other.getNAccu());
+    for (int i = 0; i < _nobs; ++i) {
+        _data[i] += w*(other.getData()[i] - _data[i]);
+    }
+}
+
+
+void SimpleAccumulator::_serialize(std::ostream &os) const
+{
+    writeBinary(os, _data, _nobs);
+}
+
+
+void SimpleAccumulator::_deserialize(std::istream &is)
+{
+    this->_allocate();
+    readBinary(is, _data, _nobs);
+}
 }  // namespace mci
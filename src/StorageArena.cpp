@@ -0,0 +1,54 @@
+#include "mci/StorageArena.hpp"
+
+#include <stdexcept>
+
+namespace mci
+{
+
+double * StorageArena::_alignedBegin(double * const mem)
+{
+    const auto addr = reinterpret_cast<uintptr_t>(mem);
+    return mem + ((64 - addr%64)%64)/sizeof(double);
+}
+
+
+double * StorageArena::take(const int64_t n)
+{
+    if (n < 1) { throw std::invalid_argument("[StorageArena::take] Requested array length was < 1 ."); }
+
+    const int64_t npad = 8*((n + 7)/8); // keep the next array aligned
+    _nneed += npad;
+    if (_nused + npad <= _ncap) {
+        double * const arr = _block + _nused;
+        _nused += npad;
+        return arr;
+    }
+    _overflow.emplace_back(new double[npad + 8]);
+    return _alignedBegin(_overflow.back().get());
+}
+
+
+void StorageArena::release()
+{
+    if (!_overflow.empty()) { // grow to fit all arrays of the last use
+        _overflow.clear();
+        _mem.reset(); // free first, to not hold both blocks at once
+        _mem.reset(new double[_nneed + 8]);
+        _block = _alignedBegin(_mem.get());
+        _ncap = _nneed;
+    }
+    _nused = 0;
+    _nneed = 0;
+}
+
+
+void StorageArena::clear()
+{
+    _overflow.clear();
+    _mem.reset();
+    _block = nullptr;
+    _ncap = 0;
+    _nused = 0;
+    _nneed = 0;
+}
+} // namespace mci
@@ -0,0 +1,117 @@
+#include "mci/StreamingBlockAccumulator.hpp"
+#include "mci/BinaryIO.hpp"
+
+namespace mci
+{
+
+void StreamingBlockAccumulator::_allocate()
+{
+    if (this->getNAccu() < 2*_blocksize) {
+        throw std::invalid_argument("[StreamingBlockAccumulator::allocate] Requested number of accumulations is smaller than two times the requested block size.");
+    }
+    if (this->getNAccu()%_blocksize != 0) {
+        throw std::invalid_argument("[StreamingBlockAccumulator::allocate] Requested number of accumulations is not a multiple of the requested block size.");
+    }
+    _blocker.reset(new StreamingBlocker(_nobs, this->getNAccu()/_blocksize));
+    _data = this->_newData(this->getNData()); // 2 * _nobs layout
+    std::fill(_data, _data + this->getNData(), 0.);
+    std::fill(_block.get(), _block.get() + _nobs, 0.);
+}
+
+
+void StreamingBlockAccumulator::_accumulate()
+{
+    if (_blocksize == 1) { // pass directly
+        _blocker->add(_obs_values);
+        return;
+    }
+
+    for (int i = 0; i < _nobs; ++i) {
+        _block[i] += _obs_values[i];
+    }
+    if (++_bidx == _blocksize) {
+        const double normf = 1./_blocksize;
+        for (int i = 0; i < _nobs; ++i) { _block[i] *= normf; }
+        _blocker->add(_block.get());
+        std::fill(_block.get(), _block.get() + _nobs, 0.);
+        _bidx = 0;
+    }
+}
+
+
+void StreamingBlockAccumulator::_finalize()
+{   // do nothing on deallocated state
+    if (_blocker) { _blocker->estimate(_data, _data + _nobs); }
+}
+
+
+void StreamingBlockAccumulator::_reset()
+{   // reset must not fail on deallocated state
+    _bidx = 0;
+    std::fill(_block.get(), _block.get() + _nobs, 0.);
+    if (_blocker) {
+        _blocker->reset();
+        std::fill(_data, _data + this->getNData(), 0.);
+    }
+}
+
+
+void StreamingBlockAccumulator::_deallocate()
+{
+    this->_deleteData();
+    _blocker.reset();
+}
+
+
+void StreamingBlockAccumulator::_writeData(std::ostream &os) const
+{   // blocker statistics and the current block
+    writeBinary(os, static_cast<int32_t>(_bidx));
+    writeBinary(os, _block.get(), _nobs);
+    _blocker->write(os);
+}
+
+
+void StreamingBlockAccumulator::_readData(std::istream &is)
+{
+    int32_t bidx;
+    readBinary(is, bidx);
+    if (bidx < 0 || bidx >= _blocksize) {
+        throw std::runtime_error("[StreamingBlockAccumulator::readData] Stored block index is out of range.");
+    }
+    _bidx = bidx;
+    readBinary(is, _block.get(), _nobs);
+    _blocker->read(is);
+}
+
+
+void StreamingBlockAccumulator::_merge(const AccumulatorInterface &other)
+{   // merge both into a blocker for the merged number of blocks (which may need another level)
+    const auto &o = static_cast<const StreamingBlockAccumulator &>(other);
+    if (o._blocksize != _blocksize) { throw std::invalid_argument("[StreamingBlockAccumulator::merge] Accumulators differ in blocksize."); }
+    std::unique_ptr<StreamingBlocker> blocker(new StreamingBlocker(_nobs, (this->getNAccu() + o.getNAccu())/_blocksize));
+    blocker->merge(*_blocker);
+    blocker->merge(*o._blocker);
+    _blocker = std::move(blocker);
+    this->_finalize();
+}
+
+
+void StreamingBlockAccumulator::_serialize(std::ostream &os) const
+{
+    writeBinary(os, static_cast<int32_t>(_blocker->nlevels));
+    _blocker->write(os);
+}
+
+
+void StreamingBlockAccumulator::_deserialize(std::istream &is)
+{
+    int32_t nlevels;
+    readBinary(is, nlevels);
+    this->_allocate();
+    if (nlevels != _blocker->nlevels) {
+        throw std::invalid_argument("[StreamingBlockAccumulator::deserialize] Stored number of levels does not match the blocksize.");
+    }
+    _blocker->read(is);
+    this->_finalize();
+}
+}  // namespace mci
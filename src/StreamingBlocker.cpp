@@ -0,0 +1,156 @@
+#include "mci/StreamingBlocker.hpp"
+#include "mci/BinaryIO.hpp"
+#include "mci/MJBlocker.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace mci
+{
+// --- Helpers
+
+static int computeNLevels(const int64_t nmax)
+{
+    if (nmax < 2) { throw std::invalid_argument("[StreamingBlocker] nmax must be at least 2."); }
+    int nlevels = 0;
+    for (int64_t n = nmax; n > 0; n /= 2) { ++nlevels; } // level k holds up to nmax/2^k values
+    return nlevels;
+}
+
+
+// --- Constructor
+
+StreamingBlocker::StreamingBlocker(const int n_dim, const int64_t nmax):
+        ndim(n_dim), nlevels(computeNLevels(nmax)),
+        _shift(ndim), _tmp(ndim), _count(nlevels),
+        _sum(nlevels*ndim), _sumsq(nlevels*ndim), _sumlag(nlevels*ndim),
+        _first(nlevels*ndim), _last(nlevels*ndim), _pending(nlevels*ndim)
+{
+    if (ndim < 1) { throw std::invalid_argument("[StreamingBlocker] ndim must be at least 1."); }
+    this->reset();
+}
+
+
+// --- Accumulation
+
+void StreamingBlocker::add(const double x[])
+{
+    if (_nsamples == 0) { std::copy(x, x + ndim, _shift.begin()); }
+    for (int j = 0; j < ndim; ++j) { _tmp[j] = x[j] - _shift[j]; }
+    ++_nsamples;
+
+    for (int k = 0; k < nlevels; ++k) {
+        const int64_t c = _count[k]++;
+        const int off = k*ndim;
+        if (c == 0) {
+            std::copy(_tmp.begin(), _tmp.end(), _first.begin() + off);
+        }
+        else {
+            for (int j = 0; j < ndim; ++j) { _sumlag[off + j] += _last[off + j]*_tmp[j]; }
+        }
+        for (int j = 0; j < ndim; ++j) {
+            _sum[off + j] += _tmp[j];
+            _sumsq[off + j] += _tmp[j]*_tmp[j];
+            _last[off + j] = _tmp[j];
+        }
+
+        if (c%2 == 0) { // wait for the partner value
+            std::copy(_tmp.begin(), _tmp.end(), _pending.begin() + off);
+            return;
+        }
+        for (int j = 0; j < ndim; ++j) { _tmp[j] = 0.5*(_pending[off + j] + _tmp[j]); } // next level value
+    }
+}
+
+void StreamingBlocker::reset()
+{
+    _nsamples = 0;
+    std::fill(_shift.begin(), _shift.end(), 0.);
+    std::fill(_count.begin(), _count.end(), 0);
+    for (auto * stat : {&_sum, &_sumsq, &_sumlag, &_first, &_last, &_pending}) {
+        std::fill(stat->begin(), stat->end(), 0.);
+    }
+}
+
+
+void StreamingBlocker::merge(const StreamingBlocker &other)
+{
+    if (&other == this || other.ndim != ndim || other.nlevels > nlevels) {
+        throw std::invalid_argument("[StreamingBlocker::merge] Other blocker must differ and have equal ndim and at most our nlevels.");
+    }
+    if (other._nsamples == 0) { return; }
+    if (_nsamples == 0) { std::copy(other._shift.begin(), other._shift.end(), _shift.begin()); }
+
+    for (int k = 0; k < other.nlevels; ++k) {
+        const int64_t nb = other._count[k];
+        if (nb == 0) { continue; }
+        const int off = k*ndim;
+        for (int j = 0; j < ndim; ++j) {
+            // other's values relative to our shift are y + d, with other's shifted values y
+            const int i = off + j;
+            const double d = other._shift[j] - _shift[j];
+            const double first = other._first[i] + d;
+            if (_count[k] > 0) { _sumlag[i] += _last[i]*first; } // the pair across the boundary
+            else { _first[i] = first; }
+            _sumlag[i] += other._sumlag[i] + d*(2.*other._sum[i] - other._first[i] - other._last[i]) + (nb - 1)*d*d;
+            _sumsq[i] += other._sumsq[i] + d*(2.*other._sum[i] + nb*d);
+            _sum[i] += other._sum[i] + nb*d;
+            _last[i] = other._last[i] + d;
+            _pending[i] = other._pending[i] + d;
+        }
+        _count[k] += nb;
+    }
+    _nsamples += other._nsamples;
+}
+
+
+// --- Estimation
+
+void StreamingBlocker::estimate(double avg[], double err[]) const
+{
+    if (_nsamples < 2) { throw std::runtime_error("[StreamingBlocker::estimate] At least 2 samples are required."); }
+
+    int npow = 0; // number of levels with at least 2 values
+    while (npow < nlevels && _count[npow] >= 2) { ++npow; }
+
+    std::vector<double> mean(ndim), var(npow*ndim), gamma(npow*ndim);
+    for (int j = 0; j < ndim; ++j) { mean[j] = _sum[j]/_count[0]; }
+
+    // variance and lag-1 autocovariance around the total mean, per level (like MJBlocker's _gamma0/_gamma1)
+    for (int k = 0; k < npow; ++k) {
+        const auto n = static_cast<double>(_count[k]);
+        for (int j = 0; j < ndim; ++j) {
+            const int i = k*ndim + j;
+            const double m = mean[j];
+            var[i] = std::max(0., _sumsq[i]/n - m*(2.*_sum[i]/n - m));
+            gamma[i] = (_sumlag[i] - m*(2.*_sum[i] - _first[i] - _last[i]) + (n - 1.)*m*m)/n;
+        }
+    }
+
+    for (int j = 0; j < ndim; ++j) { avg[j] = mean[j] + _shift[j]; }
+    MJBlocker::estimateError(npow, ndim, _count.data(), var.data(), gamma.data(), err);
+}
+
+
+// --- Binary I/O
+
+void StreamingBlocker::write(std::ostream &os) const
+{
+    writeBinary(os, _nsamples);
+    writeBinary(os, _shift.data(), ndim);
+    writeBinary(os, _count.data(), nlevels);
+    for (const auto * stat : {&_sum, &_sumsq, &_sumlag, &_first, &_last, &_pending}) {
+        writeBinary(os, stat->data(), nlevels*ndim);
+    }
+}
+
+void StreamingBlocker::read(std::istream &is)
+{
+    readBinary(is, _nsamples);
+    readBinary(is, _shift.data(), ndim);
+    readBinary(is, _count.data(), nlevels);
+    for (auto * stat : {&_sum, &_sumsq, &_sumlag, &_first, &_last, &_pending}) {
+        readBinary(is, stat->data(), nlevels*ndim);
+    }
+}
+} // namespace mci
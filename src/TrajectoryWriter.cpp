@@ -0,0 +1,118 @@
+#include "mci/TrajectoryWriter.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace mci
+{
+constexpr size_t TrajectoryWriter::BUFFER_BYTES;
+
+TrajectoryHeader readTrajectoryHeader(std::istream &file)
+{
+    char magic[sizeof(TRAJECTORY_MAGIC)];
+    int32_t fields[4];
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char *>(fields), sizeof(fields));
+    if (!file || std::memcmp(magic, TRAJECTORY_MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("[readTrajectoryHeader] Stream does not contain a binary trajectory header.");
+    }
+    return TrajectoryHeader{fields[0], fields[1], fields[2], fields[3]};
+}
+
+
+// --- Constructor/Destructor
+
+TrajectoryWriter::TrajectoryWriter(const std::string &filepath, const TrajectoryHeader &header, const bool append):
+        _header(header), _recsize(1 + header.ncols),
+        _nrecbuf(std::max(1, static_cast<int>(BUFFER_BYTES/header.recordSize()))),
+        _file(filepath, append ? std::ios::binary | std::ios::app : std::ios::binary)
+{
+    if (_header.ncols < 0) { throw std::invalid_argument("[TrajectoryWriter] Number of columns must be non-negative."); }
+    if (!_file) { throw std::runtime_error("[TrajectoryWriter] Failed to open file " + filepath + "."); }
+
+    if (!append) {
+        const int32_t fields[4]{_header.ndim, _header.nwalkers, _header.ncols, _header.freq};
+        _file.write(TRAJECTORY_MAGIC, sizeof(TRAJECTORY_MAGIC));
+        _file.write(reinterpret_cast<const char *>(fields), sizeof(fields));
+    }
+
+    _front.reset(new double[static_cast<size_t>(_nrecbuf)*_recsize]);
+    _back.reset(new double[static_cast<size_t>(_nrecbuf)*_recsize]);
+    _thread = std::thread(&TrajectoryWriter::_writeLoop, this);
+}
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+    this->_finish();
+}
+
+
+// --- Internal
+
+void TrajectoryWriter::_swapBuffers()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait(lock, [this] { return _nback == 0; }); // writer thread is done with the back buffer
+    std::swap(_front, _back);
+    _nback = _nfront;
+    _nfront = 0;
+    lock.unlock();
+    _cv.notify_all();
+}
+
+void TrajectoryWriter::_writeLoop()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _cv.wait(lock, [this] { return _nback > 0 || _stop; });
+        if (_nback == 0) { break; } // stop requested and nothing left to write
+
+        // the caller does not touch the back buffer before _nback is reset
+        const auto nbytes = static_cast<std::streamsize>(_nback*_header.recordSize());
+        const double * const buf = _back.get();
+        lock.unlock();
+        _file.write(reinterpret_cast<const char *>(buf), nbytes);
+        lock.lock();
+
+        _nback = 0;
+        _cv.notify_all();
+    }
+}
+
+bool TrajectoryWriter::_finish()
+{
+    if (!_thread.joinable()) { return static_cast<bool>(_file); } // already finished
+    if (_nfront > 0) { this->_swapBuffers(); }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _cv.notify_all();
+    _thread.join();
+    _file.close();
+    return !_file.fail();
+}
+
+
+// --- Writing
+
+double * TrajectoryWriter::newRecord(const int64_t step)
+{
+    if (_nfront == _nrecbuf) { this->_swapBuffers(); }
+    double * const rec = _front.get() + static_cast<size_t>(_nfront)*_recsize;
+    std::memcpy(rec, &step, sizeof(int64_t)); // step index occupies the first 8 bytes
+    ++_nfront;
+    return rec + 1;
+}
+
+void TrajectoryWriter::write(const int64_t step, const double values[])
+{
+    std::memcpy(this->newRecord(step), values, _header.ncols*sizeof(double));
+}
+
+void TrajectoryWriter::close()
+{
+    if (!this->_finish()) { throw std::runtime_error("[TrajectoryWriter::close] Failed to write trajectory file."); }
+}
+} // namespace mci
@@ -0,0 +1,136 @@
+#include "mci/WelfordAccumulator.hpp"
+#include "mci/BinaryIO.hpp"
+
+#include <cmath>
+
+namespace mci
+{
+
+void WelfordAccumulator::_allocate()
+{
+    if (this->getNAccu() < 2*_blocksize) {
+        throw std::invalid_argument("[WelfordAccumulator::allocate] Requested number of accumulations is smaller than two times the requested block size.");
+    }
+    if (this->getNAccu()%_blocksize != 0) {
+        throw std::invalid_argument("[WelfordAccumulator::allocate] Requested number of accumulations is not a multiple of the requested block size.");
+    }
+    _data = this->_newData(2*_nobs); // average and error
+    std::fill(_data, _data + 2*_nobs, 0.);
+}
+
+
+void WelfordAccumulator::_accumulate()
+{
+    const double * x = _obs_values;
+    if (_blocksize > 1) { // first complete the block average
+        for (int i = 0; i < _nobs; ++i) { _block[i] += _obs_values[i]; }
+        if (++_bidx < _blocksize) { return; }
+        const double normf = 1./_blocksize;
+        for (int i = 0; i < _nobs; ++i) { _block[i] *= normf; }
+        _bidx = 0;
+        x = _block.get();
+    }
+
+    // fold the sample into mean and m2
+    const double ninv = 1./(++_nblocks);
+    for (int i = 0; i < _nobs; ++i) {
+        const double delta = x[i] - _mean[i];
+        _mean[i] += delta*ninv;
+        _m2[i] += delta*(x[i] - _mean[i]);
+    }
+    if (_blocksize > 1) { std::fill(_block.get(), _block.get() + _nobs, 0.); }
+}
+
+
+void WelfordAccumulator::_finalize()
+{   // do nothing on deallocated state
+    if (_data == nullptr) { return; }
+    const double SMALLEST_ERROR = 1.e-300; // like in UncorrelatedEstimator
+    const auto n = static_cast<double>(_nblocks);
+    for (int i = 0; i < _nobs; ++i) {
+        const double var = _m2[i]/n;
+        _data[i] = _mean[i];
+        _data[_nobs + i] = (var > SMALLEST_ERROR) ? sqrt(var/(n - 1.)) : 0.;
+    }
+}
+
+
+void WelfordAccumulator::_reset()
+{   // reset must not fail on deallocated state
+    _nblocks = 0;
+    _bidx = 0;
+    std::fill(_block.get(), _block.get() + _nobs, 0.);
+    std::fill(_mean.get(), _mean.get() + _nobs, 0.);
+    std::fill(_m2.get(), _m2.get() + _nobs, 0.);
+    if (_data != nullptr) { std::fill(_data, _data + 2*_nobs, 0.); }
+}
+
+
+void WelfordAccumulator::_deallocate()
+{
+    this->_deleteData();
+}
+
+
+void WelfordAccumulator::_writeData(std::ostream &os) const
+{
+    writeBinary(os, static_cast<int32_t>(_bidx));
+    writeBinary(os, _nblocks);
+    writeBinary(os, _block.get(), _nobs);
+    writeBinary(os, _mean.get(), _nobs);
+    writeBinary(os, _m2.get(), _nobs);
+}
+
+
+void WelfordAccumulator::_readData(std::istream &is)
+{
+    int32_t bidx;
+    readBinary(is, bidx);
+    readBinary(is, _nblocks);
+    if (bidx < 0 || bidx >= _blocksize || _nblocks < 0 || _nblocks > this->getNAccu()/_blocksize) {
+        throw std::runtime_error("[WelfordAccumulator::readData] Stored block indices are out of range.");
+    }
+    _bidx = bidx;
+    readBinary(is, _block.get(), _nobs);
+    readBinary(is, _mean.get(), _nobs);
+    readBinary(is, _m2.get(), _nobs);
+}
+
+
+void WelfordAccumulator::_merge(const AccumulatorInterface &other)
+{   // combine mean and m2 of both (Chan et al.)
+    const auto &o = static_cast<const WelfordAccumulator &>(other);
+    if (o._blocksize != _blocksize) { throw std::invalid_argument("[WelfordAccumulator::merge] Accumulators differ in blocksize."); }
+    const auto na = static_cast<double>(_nblocks);
+    const auto nb = static_cast<double>(o._nblocks);
+    const double n = na + nb;
+    for (int i = 0; i < _nobs; ++i) {
+        const double delta = o._mean[i] - _mean[i];
+        _mean[i] += delta*nb/n;
+        _m2[i] += o._m2[i] + delta*delta*na*nb/n;
+    }
+    _nblocks += o._nblocks;
+    this->_finalize();
+}
+
+
+void WelfordAccumulator::_serialize(std::ostream &os) const
+{
+    writeBinary(os, _nblocks);
+    writeBinary(os, _mean.get(), _nobs);
+    writeBinary(os, _m2.get(), _nobs);
+}
+
+
+void WelfordAccumulator::_deserialize(std::istream &is)
+{
+    this->_allocate();
+    readBinary(is, _nblocks);
+    if (_nblocks != this->getNAccu()/_blocksize) {
+        throw std::invalid_argument("[WelfordAccumulator::deserialize] Stored number of blocks does not match the blocksize.");
+    }
+    readBinary(is, _mean.get(), _nobs);
+    readBinary(is, _m2.get(), _nobs);
+    this->_finalize();
+}
+}  // namespace mci
@@ -0,0 +1,81 @@
+#include "mci/MCIntegrator.hpp"
+#include "mci/OrthoPeriodicDomain.hpp"
+#include "mci/SRRDAllMove.hpp"
+#include "mci/SRRDVecMove.hpp"
+#include "mci/StaticMCI.hpp"
+#include "mci/UnboundDomain.hpp"
+
+#include <cassert>
+#include <tuple>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+int main()
+{
+    const int NMC = 16384;
+    const double CORRECT_RESULT = 0.5;
+
+    ThreeDimGaussianPDF pdf;
+    Gauss pdf3d(3); // updateable
+    XSquared obs1d;
+    X2 obs3d(3); // updateable
+
+    double average[4], staticAverage[4];
+    double error[4], staticError[4];
+
+    // --- StaticMCI with all-moves should reproduce MCI exactly (same seed, same setup)
+
+    MCI mci(3);
+    mci.setSeed(1337);
+    mci.addSamplingFunction(pdf);
+    mci.addObservable(obs1d);
+    mci.addObservable(obs3d);
+    mci.setNdecorrelationSteps(1000); // StaticMCI supports only fixed decorrelation
+    mci.setMRT2Step(0.05);
+    mci.integrate(NMC, average, error);
+
+    StaticMCI<UnboundDomain, UniformAllMove, tuple<ThreeDimGaussianPDF>, tuple<XSquared, X2> >
+            smci(UnboundDomain(3), UniformAllMove(3, 0.05), tie(pdf), tie(obs1d, obs3d));
+    assert(smci.getNDim() == 3);
+    assert(smci.getNPDF() == 1);
+    assert(smci.getNObs() == 2);
+    assert(smci.getNObsDim() == 4);
+    smci.setSeed(1337);
+    smci.setNdecorrelationSteps(1000);
+    smci.integrate(NMC, staticAverage, staticError);
+
+    for (int i = 0; i < 4; ++i) {
+        assert(average[i] == staticAverage[i]);
+        assert(error[i] == staticError[i]);
+        assert(fabs(staticAverage[i] - CORRECT_RESULT) < 3.*staticError[i]); // like in ut5, factor 2 is a bit small here
+    }
+    assert(mci.getAcceptanceRate() == smci.getAcceptanceRate());
+    assert(mci.getMRT2Step(0) == smci.getMRT2Step(0));
+
+
+    // --- Single-index moves in periodic box, two pdfs, selective updating and skipping
+
+    StaticMCI<OrthoPeriodicDomain, UniformVecMove, tuple<Gauss, Gauss>, tuple<X2, XSquared> >
+            smci2(OrthoPeriodicDomain(3, -10., 10.), UniformVecMove(3, 1, 0.1), tie(pdf3d, pdf3d), tie(obs3d, obs1d));
+    smci2.setSeed(1337);
+    smci2.setObservableOptions(0, 1, 3); // keep all samples, evaluate every third step
+    smci2.setObservableOptions(1, 0, 1); // only the average
+    smci2.integrate(3*NMC, staticAverage, staticError);
+    for (int i = 0; i < 3; ++i) { // now sampling exp(-2*x^2)
+        assert(fabs(staticAverage[i] - 0.5*CORRECT_RESULT) < 3.*staticError[i]);
+    }
+    assert(fabs(staticAverage[3] - 0.5*CORRECT_RESULT) < 0.02); // no error with blocksize 0
+    assert(staticError[3] == 0.);
+
+    // invalid options
+    bool thrown = false;
+    try { smci2.setObservableOptions(0, 2, 1); }
+    catch (const std::invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include "mci/Factories.hpp"
+#include "mci/FixedOrthoPeriodicDomain.hpp"
+#include "mci/FixedSRRDAllMove.hpp"
+#include "mci/FixedSRRDVecMove.hpp"
+#include "mci/OrthoPeriodicDomain.hpp"
+#include "mci/SRRDAllMove.hpp"
+#include "mci/SRRDVecMove.hpp"
+
+#include <cassert>
+#include <numeric>
+#include <random>
+
+using namespace std;
+using namespace mci;
+
+// let both moves propose nsteps moves (with equally seeded generators) and check that they are identical
+void assertSameMoves(TrialMoveInterface &move, TrialMoveInterface &fixedMove, const int nsteps)
+{
+    const int ndim = move.getNDim();
+    assert(fixedMove.getNDim() == ndim);
+    assert(fixedMove.getNStepSizes() == move.getNStepSizes());
+    assert(fixedMove.getChangeRate() == move.getChangeRate());
+    for (int i = 0; i < ndim; ++i) { assert(fixedMove.getStepSizeIndex(i) == move.getStepSizeIndex(i)); }
+
+    RandomGenerator rgen(1337), rgen_fixed(1337);
+    move.bindRGen(rgen);
+    fixedMove.bindRGen(rgen_fixed);
+    WalkerState wlk(ndim, false), wlk_fixed(ndim, false);
+
+    for (int istep = 0; istep < nsteps; ++istep) {
+        assert(fixedMove.computeTrialMove(wlk_fixed) == move.computeTrialMove(wlk));
+        assert(wlk_fixed.nchanged == wlk.nchanged);
+        if (wlk.nchanged < ndim) {
+            for (int i = 0; i < wlk.nchanged; ++i) { assert(wlk_fixed.changedIdx[i] == wlk.changedIdx[i]); }
+        }
+        for (int i = 0; i < ndim; ++i) { assert(wlk_fixed.xnew[i] == wlk.xnew[i]); }
+    }
+}
+
+int main()
+{
+    const int NSTEPS = 1000;
+
+    // fixed-dim moves must reproduce the runtime-dim ones
+    UniformAllMove uniAll(7, 0.3);
+    FixedUniformAllMove<7> fixedUniAll(0.3);
+    assertSameMoves(uniAll, fixedUniAll, NSTEPS);
+
+    GaussianVecMove gaussVec(4, 3, 0.2);
+    FixedGaussianVecMove<3> fixedGaussVec(4, 0.2);
+    assertSameMoves(gaussVec, fixedGaussVec, NSTEPS);
+
+    // also the factories' fixed variants
+    auto cauchyAll = createFixedSRRDAllMove(SRRDType::Cauchy, 5, 0.1);
+    CauchyAllMove runtimeCauchyAll(5, 0.1);
+    assertSameMoves(runtimeCauchyAll, *cauchyAll, NSTEPS);
+
+    auto gammaVec = createFixedSRRDVecMove(SRRDType::Gamma, 6, 1, 0.1);
+    GammaVecMove runtimeGammaVec(6, 1, 0.1);
+    assertSameMoves(runtimeGammaVec, *gammaVec, NSTEPS);
+
+    // clones keep step size
+    fixedUniAll.setStepSize(0, 0.5);
+    assert(fixedUniAll.clone()->getStepSize(0) == 0.5);
+
+
+    // factory dispatch
+    assert(dynamic_cast<FixedUniformAllMove<4> *>(createMoveDefault(MoveType::All, 4).get()) != nullptr);
+    assert(dynamic_cast<FixedUniformVecMove<1> *>(createMoveDefault(MoveType::Vec, 100).get()) != nullptr);
+    assert(dynamic_cast<UniformAllMove *>(createMoveDefault(MoveType::All, MAX_FIXED_NDIM + 1).get()) != nullptr);
+    const int typeEnds[2] = {2, 4};
+    assert(dynamic_cast<GaussianAllMove *>(createSRRDAllMove(SRRDType::Gaussian, 4, 2, typeEnds).get()) != nullptr);
+    assert(dynamic_cast<GaussianVecMove *>(createSRRDVecMove(SRRDType::Gaussian, 3, 4).get()) != nullptr);
+    assert(dynamic_cast<FixedOrthoPeriodicDomain<3> *>(createOrthoPeriodicDomain(3, -1., 1.).get()) != nullptr);
+    assert(dynamic_cast<OrthoPeriodicDomain *>(createOrthoPeriodicDomain(MAX_FIXED_NDIM + 1, -1., 1.).get()) != nullptr);
+
+
+    // fixed-dim domain must reproduce the runtime-dim one
+    const double lbounds[5] = {-1., -2., 0., -0.5, 3.};
+    const double ubounds[5] = {1., 1., 2., 0.5, 10.};
+    OrthoPeriodicDomain domain(5, lbounds, ubounds);
+    FixedOrthoPeriodicDomain<5> fixedDomain(lbounds, ubounds);
+    auto fixedDomainClone = fixedDomain.clone();
+    assert(fixedDomainClone->getVolume() == domain.getVolume());
+
+    double sizes[5], fixedSizes[5];
+    domain.getSizes(sizes);
+    fixedDomainClone->getSizes(fixedSizes);
+    for (int i = 0; i < 5; ++i) { assert(fixedSizes[i] == sizes[i]); }
+
+    RandomGenerator rgen(7331);
+    uniform_real_distribution<double> rd(-20., 20.);
+    WalkerState wlk(5, false), wlk_fixed(5, false);
+    for (int istep = 0; istep < NSTEPS; ++istep) {
+        if (istep%2 == 0) { // full update
+            for (int i = 0; i < 5; ++i) { wlk.xnew[i] = wlk_fixed.xnew[i] = rd(rgen); }
+            wlk.nchanged = wlk_fixed.nchanged = 5;
+        }
+        else { // selective update
+            for (int i = 0; i < 2; ++i) {
+                const int idx = 2*i + 1;
+                wlk.xnew[idx] = wlk_fixed.xnew[idx] = rd(rgen);
+                wlk.changedIdx[i] = wlk_fixed.changedIdx[i] = idx;
+            }
+            wlk.nchanged = wlk_fixed.nchanged = 2;
+        }
+        domain.applyDomain(wlk);
+        fixedDomain.applyDomain(wlk_fixed);
+        for (int i = 0; i < 5; ++i) {
+            assert(wlk_fixed.xnew[i] == wlk.xnew[i]);
+            assert(wlk.xnew[i] >= lbounds[i] && wlk.xnew[i] <= ubounds[i]);
+        }
+        if (istep%2 == 1) { std::iota(wlk.changedIdx, wlk.changedIdx + 5, 0); } // restore for the full updates
+    }
+
+    return 0;
+}
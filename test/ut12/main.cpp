@@ -0,0 +1,85 @@
+#include "mci/RandomGenerator.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <sstream>
+
+using namespace std;
+using namespace mci;
+
+// check the basic engine properties and the statistics of generated numbers
+template <class Engine>
+void testEngine()
+{
+    const int NSAMPLES = 1000000;
+
+    // seeding and reproducibility
+    Engine rgen1(1337), rgen2(1337), rgen3(7331);
+    assert(rgen1 == rgen2);
+    assert(rgen1 != rgen3);
+    const uint64_t first = rgen1();
+    assert(first == rgen2());
+    assert(first != rgen3());
+    rgen1.discard(100);
+    for (int i = 0; i < 100; ++i) { rgen2(); }
+    assert(rgen1 == rgen2);
+    rgen1.seed(1337);
+    assert(rgen1() == first);
+
+    // mean/variance of uniform doubles and the balance of the individual bits
+    Engine rgen(5649871);
+    uniform_real_distribution<double> rd(0., 1.);
+    double mean = 0., var = 0.;
+    int64_t bitcounts[64]{};
+    for (int i = 0; i < NSAMPLES; ++i) {
+        const double val = rd(rgen);
+        mean += val;
+        var += val*val;
+        const uint64_t bits = rgen();
+        for (int b = 0; b < 64; ++b) { bitcounts[b] += (bits >> b) & 1u; }
+    }
+    mean /= NSAMPLES;
+    var = var/NSAMPLES - mean*mean;
+    assert(fabs(mean - 0.5) < 5.*sqrt(1./12./NSAMPLES));
+    assert(fabs(var - 1./12.) < 1e-3);
+    for (int64_t count : bitcounts) { // 5 sigma for each bit
+        assert(fabs(count - 0.5*NSAMPLES) < 5.*0.5*sqrt(NSAMPLES));
+    }
+}
+
+// check the first outputs from a fixed state (given in the engine's stream format) against reference values
+template <class Engine>
+void testReference(const char * state, const uint64_t ref[], const int nref)
+{
+    Engine rgen;
+    istringstream iss(state);
+    iss >> rgen;
+    assert(!iss.fail());
+    for (int i = 0; i < nref; ++i) { assert(rgen() == ref[i]); }
+}
+
+int main()
+{
+    // reference value of splitmix64 seeding
+    uint64_t x = 0;
+    assert(splitmix64(x) == 0xe220a8397b1dcdafULL);
+
+    // reference outputs of xoshiro256++ (from the reference C code) for state {1, 2, 3, 4}
+    const uint64_t xoshiroRef[4]{41943041ULL, 58720359ULL, 3588806011781223ULL, 3591011842654386ULL};
+    testReference<Xoshiro256pp>("1 2 3 4", xoshiroRef, 4);
+#ifdef __SIZEOF_INT128__
+    // reference outputs of PCG64 XSL-RR with the default increment (as numpy's PCG64) for state 2^64 + 2
+    const uint64_t pcgRef[3]{0x8897d41cee5d6379ULL, 0xd8a780acaa71a6f5ULL, 0x7d8c6d49bc5535e9ULL};
+    testReference<PCG64>("1 2", pcgRef, 3);
+#endif
+
+    testEngine<Xoshiro256pp>();
+#ifdef __SIZEOF_INT128__
+    testEngine<PCG64>();
+#endif
+    testEngine<RandomGenerator>(); // whatever the build uses
+
+    return 0;
+}
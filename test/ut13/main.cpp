@@ -0,0 +1,113 @@
+#include "mci/MCIntegrator.hpp"
+#include "mci/RandomPool.hpp"
+#include "mci/SRRDAllMove.hpp"
+
+#include <cassert>
+#include <vector>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+// check range and first moments of generated variates (ndata not a multiple of the pool size)
+void testBulkGeneration()
+{
+    const int NDATA = 100001;
+    RandomGenerator rgen(1337);
+    vector<double> data(NDATA);
+
+    fillUniform(rgen, data.data(), NDATA, -1., 3.);
+    double mean = 0., var = 0.;
+    for (double val : data) {
+        assert(val >= -1. && val < 3.);
+        mean += val;
+        var += val*val;
+    }
+    mean /= NDATA;
+    var = var/NDATA - mean*mean;
+    assert(fabs(mean - 1.) < 5.*sqrt(16./12./NDATA));
+    assert(fabs(var - 16./12.) < 0.02);
+
+    fillNormal(rgen, data.data(), NDATA, 1., 2.);
+    mean = 0., var = 0.;
+    double kurt = 0.;
+    for (double val : data) { mean += val; }
+    mean /= NDATA;
+    for (double val : data) {
+        const double dev2 = (val - mean)*(val - mean);
+        var += dev2;
+        kurt += dev2*dev2;
+    }
+    var /= NDATA;
+    kurt /= NDATA*var*var;
+    assert(fabs(mean - 1.) < 5.*sqrt(4./NDATA));
+    assert(fabs(var - 4.) < 0.1);
+    assert(fabs(kurt - 3.) < 0.1);
+}
+
+int main()
+{
+    testBulkGeneration();
+
+    // pooled distributions are refilled in bulk, but copies start empty
+    RandomGenerator rgen(1337);
+    PooledUniformRD rd;
+    rd(rgen);
+    PooledUniformRD rdcopy(rd);
+    RandomPool pool;
+    assert(pool.size() == 0);
+    assert(RandomPool(pool).size() == 0);
+    pool.next([](double buf[], int n) { std::fill(buf, buf + n, 1.); });
+    assert(pool.size() == RANDOM_POOL_SIZE - 1);
+    assert(RandomPool(pool).size() == 0);
+    pool.reset();
+    assert(pool.size() == 0);
+
+
+    // integration with pooled acceptance and pooled moves
+    const int NMC = 20000;
+    const double CORRECT_RESULT = 0.5;
+
+    ThreeDimGaussianPDF pdf;
+    XSquared obs;
+
+    MCI mci(3);
+    mci.addSamplingFunction(pdf);
+    mci.addObservable(obs);
+    mci.setUseRandomPool(true);
+    assert(mci.getUseRandomPool());
+
+    double average, error, average2, error2;
+    for (int imove = 0; imove < 2; ++imove) {
+        if (imove == 0) { mci.setTrialMove(PooledUniformAllMove(3, 0.05)); }
+        else { mci.setTrialMove(PooledGaussianAllMove(3, 0.05)); }
+
+        mci.setSeed(1337);
+        mci.centerX();
+        mci.setMRT2Step(0.05);
+        mci.integrate(NMC, &average, &error);
+        //std::cout << "average " << average << ", error " << error << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
+        assert(fabs(average - CORRECT_RESULT) < 3.*error); // like in ut5, factor 2 is a bit small here
+
+        // re-seeding discards pooled variates, so we get identical results
+        mci.setSeed(1337);
+        mci.centerX();
+        mci.setMRT2Step(0.05);
+        mci.integrate(NMC, &average2, &error2);
+        assert(average2 == average);
+        assert(error2 == error);
+    }
+
+    // random sampling without sampling function uses bulk generation
+    mci.popSamplingFunction();
+    mci.clearObservables();
+    GaussXSquared obs_nopdf; // is XSquared multiplied by Gaussian
+    mci.addObservable(obs_nopdf, 1, 1, false, false);
+    mci.setIRange(-5., 5.);
+    mci.integrate(NMC, &average, &error, false, false);
+    //std::cout << "average " << average << ", error " << error << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
+    assert(fabs(average - CORRECT_RESULT) < 3.*error);
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include "mci/MCIntegrator.hpp"
+#include "mci/TrajectoryWriter.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+// read all records of a binary trajectory file into steps and values
+TrajectoryHeader readBinary(const string &path, vector<int64_t> &steps, vector<double> &values)
+{
+    ifstream file(path, ios::binary);
+    const TrajectoryHeader header = readTrajectoryHeader(file);
+    int64_t step;
+    vector<double> rec(header.ncols);
+    while (file.read(reinterpret_cast<char *>(&step), sizeof(step))) {
+        file.read(reinterpret_cast<char *>(rec.data()), header.ncols*sizeof(double));
+        assert(file);
+        steps.push_back(step);
+        values.insert(values.end(), rec.begin(), rec.end());
+    }
+    return header;
+}
+
+// read all lines of a text trajectory file into steps and values
+void readText(const string &path, vector<int64_t> &steps, vector<double> &values)
+{
+    ifstream file(path);
+    string line;
+    while (getline(file, line)) {
+        istringstream iss(line);
+        int64_t step;
+        iss >> step;
+        steps.push_back(step);
+        double val;
+        while (iss >> val) { values.push_back(val); }
+    }
+}
+
+// binary and text output of the same run must contain the same records
+void compareOutput(const string &txtpath, const string &binpath, const TrajectoryHeader &expected)
+{
+    vector<int64_t> txtsteps, binsteps;
+    vector<double> txtvals, binvals;
+    readText(txtpath, txtsteps, txtvals);
+    const TrajectoryHeader header = readBinary(binpath, binsteps, binvals);
+    assert(header.ndim == expected.ndim);
+    assert(header.nwalkers == expected.nwalkers);
+    assert(header.ncols == expected.ncols);
+    assert(header.freq == expected.freq);
+
+    assert(!binsteps.empty());
+    assert(binsteps == txtsteps);
+    assert(binvals.size() == binsteps.size()*header.ncols);
+    assert(binvals.size() == txtvals.size());
+    for (size_t i = 0; i < binvals.size(); ++i) { // text output has default precision
+        assert(fabs(binvals[i] - txtvals[i]) <= 1e-5*fabs(binvals[i]) + 1e-12);
+    }
+}
+
+int main()
+{
+    // many records, such that the buffers are swapped several times
+    const int NREC = 200000, NCOLS = 3;
+    {
+        TrajectoryWriter writer("ut14_direct.bin", TrajectoryHeader{2, 1, NCOLS, 7});
+        for (int i = 0; i < NREC; ++i) {
+            const double vals[NCOLS]{1.*i, -0.5*i, i + 0.25};
+            writer.write(7*i, vals);
+        }
+        writer.close();
+    }
+    vector<int64_t> steps;
+    vector<double> values;
+    const TrajectoryHeader header = readBinary("ut14_direct.bin", steps, values);
+    assert(header.ndim == 2 && header.nwalkers == 1 && header.ncols == NCOLS && header.freq == 7);
+    assert(static_cast<int>(steps.size()) == NREC);
+    for (int i = 0; i < NREC; ++i) {
+        assert(steps[i] == 7*i);
+        assert(values[NCOLS*i] == 1.*i);
+        assert(values[NCOLS*i + 1] == -0.5*i);
+        assert(values[NCOLS*i + 2] == i + 0.25);
+    }
+
+    // MCI output, single walker and ensemble mode
+    const int NMC = 10000, FREQ = 10;
+    ThreeDimGaussianPDF pdf;
+    XSquared obs;
+    XYZSquared obs2;
+    for (int nwalkers : {1, 4}) {
+        MCI mci(3);
+        mci.addSamplingFunction(pdf);
+        mci.addObservable(obs);
+        mci.addObservable(obs2);
+        mci.setNWalkers(nwalkers);
+
+        double average[4], error[4], average2[4], error2[4];
+        mci.storeObservablesOnFile("ut14_obs.txt", FREQ);
+        mci.storeWalkerPositionsOnFile("ut14_wlk.txt", FREQ, FileFormat::Text);
+        mci.setSeed(1337);
+        mci.setMRT2Step(0.05);
+        mci.centerX();
+        mci.integrate(NMC, average, error, false, true);
+
+        mci.storeObservablesOnFile("ut14_obs.bin", FREQ, FileFormat::Binary);
+        mci.storeWalkerPositionsOnFile("ut14_wlk.bin", FREQ, FileFormat::Binary);
+        mci.setSeed(1337);
+        mci.setMRT2Step(0.05);
+        mci.centerX();
+        mci.integrate(NMC, average2, error2, false, true);
+
+        for (int i = 0; i < 4; ++i) { // file format does not change results
+            assert(average[i] == average2[i]);
+            assert(error[i] == error2[i]);
+        }
+        compareOutput("ut14_obs.txt", "ut14_obs.bin", TrajectoryHeader{3, nwalkers, 4, FREQ});
+        compareOutput("ut14_wlk.txt", "ut14_wlk.bin", TrajectoryHeader{3, nwalkers, 3*nwalkers, FREQ});
+    }
+
+    for (const char * path : {"ut14_direct.bin", "ut14_obs.txt", "ut14_obs.bin", "ut14_wlk.txt", "ut14_wlk.bin"}) {
+        remove(path);
+    }
+
+    return 0;
+}
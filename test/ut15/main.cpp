@@ -0,0 +1,157 @@
+#include "mci/MCIntegrator.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+const int NMC = 10240; // multiple of blocksize*nskip used below
+const int NOBSDIM = 7;
+const string CKPFILE = "ut15.ckp";
+
+// the same setup for every MCI, with full, block and simple accumulators
+void setupMCI(MCI &mci, const int config)
+{
+    mci.addSamplingFunction(ThreeDimGaussianPDF());
+    if (config == 4) { // reduced precision (int16 rows get requantized, i.e. rewritten on the next checkpoint)
+        mci.addObservable(XSquared(), 1, 1, true, EstimatorType::Correlated, StoragePrecision::Int16);
+        mci.addObservable(X2(3), 16, 2, true, EstimatorType::Uncorrelated, StoragePrecision::Float);
+    }
+    else {
+        mci.addObservable(XSquared()); // full accumulator
+        mci.addObservable(X2(3), 16, 2); // block accumulator, updateable obs with skipping
+    }
+    mci.addObservable(XYZSquared(), 0); // simple accumulator
+    if (config == 1) { // normal distribution caches variates
+        mci.setTrialMove(GaussianVecMove(3, 1, 0.05));
+    }
+    else if (config == 2) { // pooled variates and multiple walkers
+        mci.setTrialMove(PooledGaussianAllMove(3, 0.05));
+        mci.setUseRandomPool(true);
+        mci.setNWalkers(4);
+    }
+    else if (config == 3) { // samples stored as runs
+        mci.setUseRunLengthStorage(true);
+    }
+}
+
+int64_t fileSize(const string &path)
+{
+    ifstream file(path, ios::binary | ios::ate);
+    return file ? static_cast<int64_t>(file.tellg()) : -1;
+}
+
+void runReference(MCI &mci, double average[], double error[])
+{
+    mci.setSeed(1337);
+    mci.centerX();
+    mci.setMRT2Step(0.5);
+    mci.integrate(NMC, average, error, false, true);
+}
+
+void assertEqual(const double a[], const double b[])
+{
+    for (int i = 0; i < NOBSDIM; ++i) { assert(a[i] == b[i]); }
+}
+
+int main()
+{
+    for (int config = 0; config < 5; ++config) {
+        const int64_t freq = (config == 4) ? 20 : 3000; // frequent checkpoints while the int16 rows are requantized
+        double average[NOBSDIM], error[NOBSDIM];
+        double average2[NOBSDIM], error2[NOBSDIM];
+
+        // uninterrupted reference run
+        MCI mci_ref(3);
+        setupMCI(mci_ref, config);
+        runReference(mci_ref, average, error);
+
+        // writing checkpoints does not change the run
+        {
+            MCI mci(3);
+            setupMCI(mci, config);
+            mci.setCheckpointFile(CKPFILE, freq);
+            runReference(mci, average2, error2);
+            assertEqual(average, average2);
+            assertEqual(error, error2);
+        }
+
+        // run that gets "killed" after 7500 steps, i.e. the last checkpoint is at step 6000 (7500 with config 4)
+        {
+            MCI mci(3);
+            setupMCI(mci, config);
+            mci.setCheckpointFile(CKPFILE, freq);
+            int64_t ncalls = 0;
+            mci.setCallback([&ncalls](const MCI &m) {
+                if (++ncalls > 7500) {
+                    try { // saving explicitly during integration is not allowed
+                        m.saveCheckpoint("ut15_invalid.ckp");
+                        assert(false);
+                    }
+                    catch (const std::runtime_error &) {}
+                    throw std::runtime_error("killed");
+                }
+            });
+            try {
+                runReference(mci, average2, error2);
+                assert(false);
+            }
+            catch (const std::runtime_error &e) {
+                assert(string(e.what()) == "killed");
+            }
+        } // waits for the checkpoint writer
+
+        // the samples are appended to the rows file, the checkpoint itself stays small
+        assert(fileSize(CKPFILE) > 0);
+        assert(fileSize(CKPFILE) < 6000*static_cast<int64_t>(sizeof(double)));
+        if (config != 4) { assert(fileSize(CKPFILE + ".rows1") > 0); } // else the generation may have changed
+
+        // restart from the checkpoint
+        MCI mci(3);
+        setupMCI(mci, config);
+        mci.setSeed(42); // will be overwritten
+        mci.loadCheckpoint(CKPFILE);
+        try { // wrong number of steps
+            mci.integrate(NMC/2, average2, error2);
+            assert(false);
+        }
+        catch (const std::invalid_argument &) {}
+        mci.setCheckpointFile(CKPFILE, freq); // continues with a new rows file
+        mci.integrate(NMC, average2, error2);
+        assertEqual(average, average2);
+        assertEqual(error, error2);
+        if (config != 4) {
+            assert(fileSize(CKPFILE + ".rows1") < 0);
+            assert(fileSize(CKPFILE + ".rows2") > 0);
+        }
+
+        // checkpoint between integrations, e.g. to continue an equilibrated walker
+        mci_ref.saveCheckpoint(CKPFILE);
+        mci_ref.integrate(NMC, average, error, false, false);
+        MCI mci2(3);
+        setupMCI(mci2, config);
+        mci2.loadCheckpoint(CKPFILE);
+        mci2.integrate(NMC, average2, error2, false, false);
+        assertEqual(average, average2);
+        assertEqual(error, error2);
+        for (int i = 0; i < 3; ++i) { assert(mci2.getX(i) == mci_ref.getX(i)); }
+
+        // mismatching setup
+        MCI mci3(2);
+        try {
+            mci3.loadCheckpoint(CKPFILE);
+            assert(false);
+        }
+        catch (const std::invalid_argument &) {}
+    }
+
+    remove(CKPFILE.c_str());
+    for (int gen = 1; gen < 10; ++gen) { remove((CKPFILE + ".rows" + to_string(gen)).c_str()); }
+    return 0;
+}
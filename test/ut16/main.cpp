@@ -0,0 +1,123 @@
+#include "mci/Estimators.hpp"
+#include "mci/MCIntegrator.hpp"
+#include "mci/StreamingBlocker.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+const int NDIM = 2;
+
+// correlated AR(1) series with NDIM dimensions of different correlation
+vector<double> generateData(const int64_t n)
+{
+    mt19937_64 rgen(1337);
+    normal_distribution<double> rd;
+    vector<double> x(n*NDIM);
+    double y[NDIM] = {0., 0.};
+    const double rho[NDIM] = {0.9, 0.2};
+    for (int64_t i = 0; i < n; ++i) {
+        for (int j = 0; j < NDIM; ++j) {
+            y[j] = rho[j]*y[j] + rd(rgen);
+            x[i*NDIM + j] = 10. + y[j];
+        }
+    }
+    return x;
+}
+
+void assertClose(const double a[], const double b[], const int n, const double tol)
+{
+    for (int i = 0; i < n; ++i) { assert(fabs(a[i] - b[i]) <= tol*fabs(b[i])); }
+}
+
+int main()
+{
+    const int64_t NDATA = 16384; // power of 2
+    const vector<double> x = generateData(NDATA);
+    double avg[NDIM], err[NDIM], avgMJ[NDIM], errMJ[NDIM];
+
+    // streaming estimate must agree with the stored-data MJBlocker
+    StreamingBlocker blocker(NDIM, NDATA);
+    assert(blocker.nlevels == 15); // O(log2(N)) storage
+    for (int64_t i = 0; i < NDATA; ++i) { blocker.add(x.data() + i*NDIM); }
+    assert(blocker.getNSamples() == NDATA);
+    blocker.estimate(avg, err);
+    MJBlockerEstimator(NDATA, NDIM, x.data(), avgMJ, errMJ);
+    assertClose(avg, avgMJ, NDIM, 1e-12);
+    assertClose(err, errMJ, NDIM, 1e-8);
+    assert(err[0] > 2.*err[1]); // stronger correlation
+
+    // continuing from a stored state gives the same result
+    StreamingBlocker blocker2(NDIM, NDATA);
+    for (int64_t i = 0; i < NDATA/3; ++i) { blocker2.add(x.data() + i*NDIM); }
+    stringstream ss;
+    blocker2.write(ss);
+    blocker2.reset();
+    assert(blocker2.getNSamples() == 0);
+    blocker2.read(ss);
+    for (int64_t i = NDATA/3; i < NDATA; ++i) { blocker2.add(x.data() + i*NDIM); }
+    double avg2[NDIM], err2[NDIM];
+    blocker2.estimate(avg2, err2);
+    for (int j = 0; j < NDIM; ++j) {
+        assert(avg2[j] == avg[j]);
+        assert(err2[j] == err[j]);
+    }
+
+    // arbitrary number of samples works as well (incomplete blocks are dropped on higher levels, like in MJBlocker)
+    StreamingBlocker blocker3(NDIM, 10000);
+    assert(blocker3.nlevels == 14);
+    for (int64_t i = 0; i < 10000; ++i) { blocker3.add(x.data() + i*NDIM); }
+    blocker3.estimate(avg2, err2);
+    assertClose(err2, err, NDIM, 0.5);
+    MJBlockerEstimator(10000, NDIM, x.data(), avgMJ, errMJ);
+    assertClose(avg2, avgMJ, NDIM, 1e-12);
+    assertClose(err2, errMJ, NDIM, 1e-8);
+    CorrelatedEstimator(10000, NDIM, x.data(), avg2, err2); // uses MJBlocker for any n
+    assertClose(avg2, avgMJ, NDIM, 0.);
+    assertClose(err2, errMJ, NDIM, 0.);
+
+    // constant data has zero error
+    StreamingBlocker blocker4(1, 64);
+    const double c = 3.;
+    for (int i = 0; i < 64; ++i) { blocker4.add(&c); }
+    blocker4.estimate(avg2, err2);
+    assert(avg2[0] == c);
+    assert(err2[0] == 0.);
+
+
+    // integration using the streaming accumulator, compared to full storage with MJBlocker
+    const int NMC = 16384;
+    MCI mci(3), mci2(3);
+    mci.addSamplingFunction(ThreeDimGaussianPDF());
+    mci2.addSamplingFunction(ThreeDimGaussianPDF());
+    mci.addObservable(XYZSquared(), 1, 1, false, EstimatorType::StreamingBlocker);
+    mci.addObservable(XSquared(), 4, 2, false, EstimatorType::StreamingBlocker); // with pre-averaging and skipping
+    mci2.addObservable(XYZSquared(), 1, 1, false, EstimatorType::MJBlocker);
+    mci2.addObservable(XSquared(), 4, 2, false, EstimatorType::MJBlocker);
+    double avgI[4], errI[4], avgI2[4], errI2[4];
+    for (MCI * m : {&mci, &mci2}) {
+        m->setSeed(5649871);
+        m->centerX();
+        m->setMRT2Step(0.5);
+    }
+    mci.integrate(NMC, avgI, errI, false, false);
+    mci2.integrate(NMC, avgI2, errI2, false, false);
+    assertClose(avgI, avgI2, 4, 1e-12);
+    assertClose(errI, errI2, 4, 1e-8);
+
+    // blocksize 0 can't be combined with the streaming estimator
+    try {
+        mci.addObservable(XSquared(), 0, 1, false, EstimatorType::StreamingBlocker);
+        assert(false);
+    }
+    catch (const std::invalid_argument &) {}
+
+    return 0;
+}
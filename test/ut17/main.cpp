@@ -0,0 +1,51 @@
+#include "mci/MCIntegrator.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+const int NMC = 20000; // multiple of blocksize*nskip used below
+const int NOBSDIM = 4;
+
+// XSquared and XYZSquared, with all samples and with blocks
+void integrate(const EstimatorType estimType, double average[], double error[])
+{
+    MCI mci(3);
+    mci.addSamplingFunction(ThreeDimGaussianPDF());
+    mci.addObservable(XSquared(), 1, 1, false, estimType);
+    mci.addObservable(XYZSquared(), 10, 2, false, estimType);
+    mci.setSeed(1337);
+    mci.centerX();
+    mci.setMRT2Step(0.5);
+    mci.integrate(NMC, average, error, false, false);
+}
+
+int main()
+{
+    double average[NOBSDIM], error[NOBSDIM];
+    double average2[NOBSDIM], error2[NOBSDIM];
+
+    // online estimate agrees with UncorrelatedEstimator on stored samples/blocks
+    integrate(EstimatorType::Uncorrelated, average, error);
+    integrate(EstimatorType::OnlineUncorrelated, average2, error2);
+    for (int i = 0; i < NOBSDIM; ++i) {
+        assert(error[i] > 0.);
+        assert(fabs(average2[i] - average[i]) < 1e-12*fabs(average[i]));
+        assert(fabs(error2[i] - error[i]) < 1e-8*error[i]);
+    }
+
+    // the estimator needs samples to work with
+    MCI mci(3);
+    try {
+        mci.addObservable(XSquared(), 0, 1, false, EstimatorType::OnlineUncorrelated);
+        assert(false);
+    }
+    catch (const std::invalid_argument &) {}
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include "mci/Factories.hpp"
+#include "mci/FullAccumulator.hpp"
+#include "mci/MCIntegrator.hpp"
+
+#include <cassert>
+#include <sstream>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+const int NMC = 8192;
+const int ND = 2;
+
+// simulated MC observable accumulation of steps [begin, end)
+void accumulateSteps(AccumulatorInterface &accu, const int begin, const int end, const double datax[],
+                     const bool datacc[], const int nchanged[], const int changedIdx[])
+{
+    WalkerState wlk(ND, true);
+    for (int i = begin; i < end; ++i) {
+        std::copy(datax + i*ND, datax + (i + 1)*ND, wlk.xnew);
+        wlk.nchanged = nchanged[i];
+        std::copy(changedIdx + i*ND, changedIdx + (i + 1)*ND, wlk.changedIdx);
+        wlk.accepted = datacc[i];
+        accu.accumulate(wlk);
+    }
+}
+
+void assertSameData(const FullAccumulator &ref, const FullAccumulator &rle)
+{   // rle must hold the samples of ref as runs only
+    assert(rle.getData() == nullptr);
+    assert(rle.getNStore() == ref.getNStore());
+    assert(rle.getRunLengthData()->getNRows() == ref.getNStore());
+    double vals[ND];
+    for (int64_t i = 0; i < ref.getNStore(); ++i) {
+        rle.getRunLengthData()->load(i, vals);
+        for (int j = 0; j < ND; ++j) { assert(vals[j] == ref.getData()[i*ND + j]); }
+    }
+}
+
+void assertSameEstimates(const FullAccumulator &ref, const FullAccumulator &rle)
+{   // bit-identical results of the estimators on the runs
+    for (const auto estimType : {EstimatorType::Uncorrelated, EstimatorType::Correlated, EstimatorType::FCBlocker,
+                                 EstimatorType::MJBlocker, EstimatorType::Autocorrelation}) {
+        double avg1[ND], err1[ND], avg2[ND], err2[ND];
+        createEstimator(estimType)(ref.getNStore(), ND, ref.getData(), avg1, err1);
+        rle.getRunLengthData()->estimate(estimType, avg2, err2);
+        for (int j = 0; j < ND; ++j) { assert(avg1[j] == avg2[j] && err1[j] == err2[j]); }
+        if (estimType != EstimatorType::Autocorrelation) {
+            createSliceEstimator<double>(estimType)(ref.getNStore(), ND, ref.getData(), 1, 2, avg1, err1);
+            rle.getRunLengthData()->estimateSlice(estimType, 1, 2, avg2, err2);
+            assert(avg1[0] == avg2[0] && err1[0] == err2[0]);
+        }
+    }
+}
+
+void integrate(const bool flag_runlength, const int nthreads, double average[], double error[])
+{
+    MCI mci(3);
+    mci.addSamplingFunction(ThreeDimGaussianPDF());
+    mci.addObservable(XSquared()); // full accumulator
+    mci.addObservable(XND(3), 1, 1, false, EstimatorType::MJBlocker);
+    mci.setUseRunLengthStorage(flag_runlength);
+    assert(mci.getUseRunLengthStorage() == flag_runlength);
+    mci.setNEstimatorThreads(nthreads);
+    mci.setSeed(1337);
+    mci.centerX();
+    mci.setMRT2Step(3.); // mostly rejections
+    mci.integrate(NMC, average, error, false, false);
+}
+
+int main()
+{
+    // generate random walk
+    double x[NMC*ND];
+    bool accepted[NMC];
+    int nchanged[NMC];
+    int changedIdx[NMC*ND];
+    srand(1337);
+    TestWalk<WalkPDF::GAUSS> testWalk(NMC, ND, 6.); // large steps, for mostly rejections
+    testWalk.generateWalk(x, accepted, nchanged, changedIdx);
+    assert(testWalk.getAcceptanceRate() < 0.3); // below 1 - sqrt(1/3), so that even every 2nd sample repeats with p > 1/3
+
+    XND obs(ND);
+    UpdateableXND updobs(ND);
+    for (ObservableFunctionInterface * o : {static_cast<ObservableFunctionInterface *>(&obs), static_cast<ObservableFunctionInterface *>(&updobs)}) {
+        for (int nskip = 1; nskip <= 2; ++nskip) {
+            FullAccumulator ref(*o, nskip), rle(*o, nskip);
+            rle.setRunLengthStorage(true);
+            ref.allocate(NMC);
+            rle.allocate(NMC);
+            assert(!ref.usesRunLength());
+            assert(rle.usesRunLength());
+            assert(ref.getRunLengthData() == nullptr);
+
+            // run-length storage yields exactly the same data
+            accumulateSteps(ref, 0, NMC, x, accepted, nchanged, changedIdx);
+            accumulateSteps(rle, 0, NMC, x, accepted, nchanged, changedIdx);
+            assert(rle.getNRuns() < rle.getNStore());
+            ref.finalize();
+            rle.finalize();
+            assertSameData(ref, rle);
+            assertSameEstimates(ref, rle);
+            // with less than nobs/(nobs + 1) = 2/3 new samples, the runs take less memory than the plain samples
+            assert(rle.getNBytes() < ref.getNBytes());
+            assert(ref.getNBytes() == static_cast<size_t>(ref.getNData())*sizeof(double));
+
+            // also after reset and restoring a stored state in between
+            rle.reset();
+            accumulateSteps(rle, 0, NMC/3, x, accepted, nchanged, changedIdx);
+            stringstream ss;
+            rle.writeState(ss);
+            FullAccumulator rle2(*o, nskip, true);
+            rle2.allocate(NMC);
+            rle2.readState(ss);
+            accumulateSteps(rle2, NMC/3, NMC, x, accepted, nchanged, changedIdx);
+            rle2.finalize();
+            assertSameData(ref, rle2);
+        }
+    }
+
+    // the MCI estimates are unchanged, also with parallel estimation
+    double average[4], error[4], average2[4], error2[4];
+    integrate(false, 1, average, error);
+    for (const int nthreads : {1, 3}) {
+        integrate(true, nthreads, average2, error2);
+        for (int i = 0; i < 4; ++i) { assert(average[i] == average2[i] && error[i] == error2[i]); }
+    }
+
+    // not used with walker ensembles
+    FullAccumulator rle(obs, 1, true);
+    rle.allocate(NMC, 4);
+    assert(!rle.usesRunLength());
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "mci/MCIntegrator.hpp"
+#include "mci/FullAccumulator.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+const int NMC = 8192;
+const int NOBSDIM = 7;
+
+void integrate(const string &dir, double average[], double error[], const int nthreads = 1)
+{
+    MCI mci(3);
+    mci.addSamplingFunction(ThreeDimGaussianPDF());
+    mci.addObservable(XSquared()); // full accumulator
+    mci.addObservable(XYZSquared(), 16, 1); // block accumulator (not affected)
+    mci.addObservable(X2(3), 1, 1, false, EstimatorType::MJBlocker); // full accumulator, estimated in slices with nthreads > 1
+    mci.setNEstimatorThreads(nthreads);
+    mci.setSampleStorageDir(dir);
+    assert(mci.getSampleStorageDir() == dir);
+    mci.setSeed(1337);
+    mci.centerX();
+    mci.setMRT2Step(0.5);
+    mci.integrate(NMC, average, error, false, false);
+}
+
+int main()
+{
+    // accumulator level: mapped storage stores the same samples
+    XND obs(2);
+    FullAccumulator ram(obs, 1), mapped(obs, 1);
+    mapped.setMappedStorageDir(".");
+    ram.allocate(NMC);
+    mapped.allocate(NMC);
+    assert(!ram.usesMappedStorage());
+    assert(mapped.usesMappedStorage());
+    for (int i = 0; i < mapped.getNData(); ++i) { assert(mapped.getData()[i] == 0.); }
+
+    WalkerState wlk(2, true);
+    for (int i = 0; i < NMC; ++i) {
+        wlk.xnew[0] = i;
+        wlk.xnew[1] = -0.5*i;
+        ram.accumulate(wlk);
+        mapped.accumulate(wlk);
+    }
+    ram.finalize();
+    mapped.finalize();
+    for (int i = 0; i < ram.getNData(); ++i) { assert(mapped.getData()[i] == ram.getData()[i]); }
+
+    mapped.reset();
+    for (int i = 0; i < mapped.getNData(); ++i) { assert(mapped.getData()[i] == 0.); }
+    mapped.deallocate();
+    assert(!mapped.usesMappedStorage());
+
+    // integration level: the same results as with RAM storage, where the blocking analysis of the mapped
+    // samples streams them instead of using MJBlocker (i.e. results agree up to rounding)
+    double average[NOBSDIM], error[NOBSDIM];
+    double average2[NOBSDIM], error2[NOBSDIM];
+    double average3[NOBSDIM], error3[NOBSDIM];
+    integrate("", average, error);
+    integrate(".", average2, error2);
+    integrate(".", average3, error3, 3);
+    for (int i = 0; i < NOBSDIM; ++i) {
+        assert(fabs(average2[i] - average[i]) <= 1e-12*fabs(average[i]));
+        assert(fabs(error2[i] - error[i]) <= 1e-8*error[i]);
+        assert(average3[i] == average2[i]); // slices are bit-identical
+        assert(error3[i] == error2[i]);
+    }
+
+    // non-existing directory
+    try {
+        integrate("./ut19_does_not_exist", average2, error2);
+        assert(false);
+    }
+    catch (const std::runtime_error &) {}
+
+    return 0;
+}
@@ -62,7 +62,8 @@ int main()
     mci.setX(x);
     mci.integrate(NMC, &average, &error, false, false);
     //std::cout << "average " << average << ", error " << error << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
-    assert(fabs(average - CORRECT_RESULT) > 2.*error);
+    if (DEFAULT_RGEN) { assert(fabs(average - CORRECT_RESULT) > 2.*error); } // (other engines: see the check below)
+    const double biasedAverage = average;
 
     // this integral, instead, will provide the right answer
     mci.setX(x);
@@ -70,6 +71,10 @@ int main()
     //std::cout << "average " << average << ", error " << error << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
     assert(fabs(average - CORRECT_RESULT) < 2.*error);
 
+    // the bias of the first integral is far outside the statistical error (not its own error estimate, which is
+    // inflated by the drift from the starting point and thereby of the same order as the bias, for any random engine)
+    assert(fabs(biasedAverage - CORRECT_RESULT) > 10.*error);
+
     // now, doing an integral without finding again the MRT2step and doing the initialDecorrelation will also result in a correct result
     mci.integrate(NMC, &average, &error, false, false);
     //std::cout << "average " << average << ", error " << error << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
@@ -0,0 +1,160 @@
+#include "mci/MCIntegrator.hpp"
+#include "mci/BlockAccumulator.hpp"
+#include "mci/FullAccumulator.hpp"
+#include "mci/ReducedStorage.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+const int NMC = 16384; // power of 2 and multiple of blocksize*nskip used below
+const int NOBSDIM = 4;
+
+// XSquared with all samples and XYZSquared with blocks, stored with chosen precision
+void integrate(const StoragePrecision precision, double average[], double error[])
+{
+    MCI mci(3);
+    mci.addSamplingFunction(ThreeDimGaussianPDF());
+    mci.addObservable(XSquared(), 1, 1, false, EstimatorType::Correlated, precision);
+    mci.addObservable(XYZSquared(), 16, 2, false, EstimatorType::Uncorrelated, precision);
+    mci.setSeed(1337);
+    mci.centerX();
+    mci.setMRT2Step(0.5);
+    mci.integrate(NMC, average, error, false, false);
+}
+
+// accumulate the same walk with a (reduced precision) accumulator, from step begin to end
+void accumulateSteps(AccumulatorInterface &accu, const int begin, const int end)
+{
+    WalkerState wlk(2, true);
+    for (int i = begin; i < end; ++i) {
+        wlk.xnew[0] = 100. + sin(0.01*i) + 1e-3*i; // offset, oscillation and drift (requires int16 rescaling)
+        wlk.xnew[1] = -0.5*i;
+        accu.accumulate(wlk);
+    }
+}
+
+int main()
+{
+    // storage level: memory and decoding
+    ReducedStorage fstore(StoragePrecision::Float, 2), istore(StoragePrecision::Int16, 2);
+    fstore.allocate(100);
+    istore.allocate(100);
+    assert(fstore.getNBytes() == 100*2*sizeof(float));
+    assert(istore.getNBytes() == 100*2*sizeof(int16_t));
+    for (int i = 0; i < 100; ++i) {
+        const double vals[2] = {1. + 0.1*i, -3.*i*i};
+        double fvals[2], ivals[2];
+        fstore.store(i, vals);
+        istore.store(i, vals);
+        fstore.load(i, fvals);
+        istore.load(i, ivals);
+        for (int j = 0; j < 2; ++j) {
+            assert(fabs(fvals[j] - vals[j]) <= 1e-6*fabs(vals[j]));
+            assert(fabs(ivals[j] - vals[j]) <= 1e-3*(1. + fabs(vals[j])));
+        }
+    }
+    { // requantization on rescale is unbiased, also if deviations are one-signed and rounding ties occur
+        ReducedStorage rstore(StoragePrecision::Int16, 1);
+        const int NQ = 1600;
+        rstore.allocate(NQ + 3);
+        const double scale = std::ldexp(1., -10); // initial scale, set by the second row
+        const double vals0[2] = {0., 0.25*ReducedStorage::QMAX*scale};
+        rstore.store(0, vals0);
+        rstore.store(1, vals0 + 1);
+        for (int q = 1; q <= NQ; ++q) {
+            const double val = q*scale; // stored exactly
+            rstore.store(q + 1, &val);
+        }
+        const double big = 2.*ReducedStorage::QMAX*scale; // rescales by exactly 1/8, i.e. every q = 4 mod 8 is a tie
+        rstore.store(NQ + 2, &big);
+        double bias = 0.;
+        for (int q = 1; q <= NQ; ++q) {
+            double val;
+            rstore.load(q + 1, &val);
+            bias += val - q*scale;
+        }
+        assert(fabs(bias/NQ) < 0.01*scale); // lround would give 0.5*scale
+    }
+    try {
+        ReducedStorage dstore(StoragePrecision::Double, 2);
+        assert(false);
+    }
+    catch (const std::invalid_argument &) {}
+
+    // accumulator level: estimates close to double precision, also across a stored state
+    XND obs(2);
+    for (const StoragePrecision precision : {StoragePrecision::Float, StoragePrecision::Int16}) {
+        const double tol = (precision == StoragePrecision::Float) ? 1e-6 : 1e-3;
+        for (int blocksize = 1; blocksize <= 8; blocksize *= 8) {
+            FullAccumulator fref(obs, 1);
+            FullAccumulator fred(obs, 1, false, precision), fred2(obs, 1, false, precision);
+            BlockAccumulator bref(obs, 1, blocksize);
+            BlockAccumulator bred(obs, 1, blocksize, precision), bred2(obs, 1, blocksize, precision);
+            AccumulatorInterface &ref = (blocksize == 1) ? static_cast<AccumulatorInterface &>(fref) : bref;
+            AccumulatorInterface &red = (blocksize == 1) ? static_cast<AccumulatorInterface &>(fred) : bred;
+            AccumulatorInterface &red2 = (blocksize == 1) ? static_cast<AccumulatorInterface &>(fred2) : bred2;
+
+            ref.allocate(NMC);
+            red.allocate(NMC);
+            red2.allocate(NMC);
+            assert(ref.getReducedData() == nullptr);
+            assert(red.getReducedData() != nullptr);
+            assert(red.getReducedData()->getNBytes() < ref.getNData()*sizeof(double)/2 + 1);
+
+            accumulateSteps(ref, 0, NMC);
+            accumulateSteps(red, 0, NMC/3);
+            stringstream ss;
+            red.writeState(ss);
+            red2.readState(ss);
+            accumulateSteps(red, NMC/3, NMC);
+            accumulateSteps(red2, NMC/3, NMC);
+            ref.finalize();
+            red.finalize();
+            red2.finalize();
+
+            for (const EstimatorType estimType : {EstimatorType::Uncorrelated, EstimatorType::MJBlocker, EstimatorType::FCBlocker}) {
+                double avg[2], err[2], avgr[2], errr[2], avgr2[2], errr2[2];
+                createEstimator(estimType)(ref.getNStore(), 2, ref.getData(), avg, err);
+                red.getReducedData()->estimate(estimType, red.getNStore(), avgr, errr);
+                red2.getReducedData()->estimate(estimType, red2.getNStore(), avgr2, errr2);
+                for (int j = 0; j < 2; ++j) {
+                    assert(fabs(avgr[j] - avg[j]) <= tol*fabs(avg[j]));
+                    assert(fabs(errr[j] - err[j]) <= 10.*tol*err[j]);
+                    assert(avgr2[j] == avgr[j]);
+                    assert(errr2[j] == errr[j]);
+                }
+            }
+        }
+    }
+
+    // integration level: results close to double precision
+    double average[NOBSDIM], error[NOBSDIM];
+    double average2[NOBSDIM], error2[NOBSDIM];
+    integrate(StoragePrecision::Double, average, error);
+    for (const StoragePrecision precision : {StoragePrecision::Float, StoragePrecision::Int16}) {
+        const double tol = (precision == StoragePrecision::Float) ? 1e-6 : 1e-3;
+        integrate(precision, average2, error2);
+        for (int i = 0; i < NOBSDIM; ++i) {
+            assert(error[i] > 0.);
+            assert(fabs(average2[i] - average[i]) <= tol*fabs(average[i]) + 0.01*error[i]);
+            assert(fabs(error2[i] - error[i]) <= 0.05*error[i]);
+        }
+    }
+
+    // reduced precision needs stored samples
+    MCI mci(3);
+    try {
+        mci.addObservable(XSquared(), 0, 1, false, EstimatorType::Uncorrelated, StoragePrecision::Float);
+        assert(false);
+    }
+    catch (const std::invalid_argument &) {}
+
+    return 0;
+}
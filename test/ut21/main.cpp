@@ -0,0 +1,78 @@
+#include "mci/MCIntegrator.hpp"
+#include "mci/Estimators.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+const int NMC = 10000; // not a power of 2, multiple of blocksize*nskip used below
+const int NDIM = 3;
+const int NOBSDIM = 1 + 3 + 3 + 3 + 3 + 3 + 3;
+
+void integrate(const int nthreads, double average[], double error[])
+{
+    MCI mci(NDIM);
+    mci.addSamplingFunction(ThreeDimGaussianPDF());
+    mci.addObservable(XSquared()); // one-dim, not split
+    mci.addObservable(XND(NDIM), 1, 1, false, EstimatorType::Correlated);
+    mci.addObservable(XND(NDIM), 1, 1, false, EstimatorType::FCBlocker);
+    mci.addObservable(XND(NDIM), 10, 1, false, EstimatorType::Uncorrelated);
+    mci.addObservable(XND(NDIM), 1, 2, false, EstimatorType::MJBlocker, StoragePrecision::Int16);
+    mci.addObservable(XND(NDIM), 1, 1, false, EstimatorType::StreamingBlocker); // not split
+    mci.addObservable(XND(NDIM), 5, 1, false, EstimatorType::Noop, StoragePrecision::Float); // not split
+    assert(mci.getNObsDim() == NOBSDIM);
+
+    mci.setNEstimatorThreads(nthreads);
+    assert(mci.getNEstimatorThreads() == nthreads);
+    mci.setSeed(1337);
+    mci.centerX();
+    mci.setMRT2Step(0.5);
+    mci.integrate(NMC, average, error, false, false);
+}
+
+int main()
+{
+    // slices of the estimators reproduce the full estimators bit by bit
+    const int ND = 5;
+    vector<double> x(static_cast<size_t>(NMC*ND));
+    vector<int> nchanged(NMC), changedIdx(static_cast<size_t>(NMC*ND));
+    unique_ptr<bool[]> accepted(new bool[NMC]);
+    srand(1337);
+    TestWalk<WalkPDF::GAUSS> testWalk(NMC, ND, 2., 0.5);
+    testWalk.generateWalk(x.data(), accepted.get(), nchanged.data(), changedIdx.data());
+    for (const EstimatorType estimType : {EstimatorType::Uncorrelated, EstimatorType::Correlated, EstimatorType::FCBlocker, EstimatorType::MJBlocker}) {
+        double avg[ND], err[ND], avgs[ND], errs[ND];
+        createEstimator(estimType)(NMC, ND, x.data(), avg, err);
+        for (const int width : {1, 2, ND}) {
+            for (int j0 = 0; j0 < ND; j0 += width) {
+                const int j1 = std::min(ND, j0 + width);
+                createSliceEstimator<double>(estimType)(NMC, ND, x.data(), j0, j1, avgs, errs);
+            }
+            for (int j = 0; j < ND; ++j) {
+                assert(avgs[j] == avg[j]);
+                assert(errs[j] == err[j]);
+            }
+        }
+    }
+    assert(createSliceEstimator<double>(EstimatorType::Noop) == nullptr);
+
+    // parallel estimation in integrations is bit-identical to the serial one
+    double average[NOBSDIM], error[NOBSDIM];
+    double average2[NOBSDIM], error2[NOBSDIM];
+    integrate(1, average, error);
+    for (const int nthreads : {2, 4, 0}) {
+        integrate(nthreads, average2, error2);
+        for (int i = 0; i < NOBSDIM; ++i) {
+            assert(average2[i] == average[i]);
+            assert(error2[i] == error[i]);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "mci/MCIntegrator.hpp"
+#include "mci/Estimators.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+const int NDIM = 3; // odd, to check the pairing of dimensions in the FFT
+
+// AR(1) processes x_t = phi*x_{t-1} + noise, with phi = 0, 0.5, 0.8 for the three dimensions
+vector<double> generateData(const int64_t n)
+{
+    const double phi[NDIM] = {0., 0.5, 0.8};
+    mt19937_64 rgen(1337);
+    normal_distribution<double> rd;
+    vector<double> x(static_cast<size_t>(n*NDIM));
+    double y[NDIM] = {0., 0., 0.};
+    for (int64_t i = 0; i < n; ++i) {
+        for (int j = 0; j < NDIM; ++j) {
+            y[j] = phi[j]*y[j] + rd(rgen);
+            x[i*NDIM + j] = 1. + j + y[j];
+        }
+    }
+    return x;
+}
+
+// reference: direct O(n*W) autocovariance sums and the same windowing
+double directTau(const int64_t n, const double x[], const int j, const double mean)
+{
+    auto c = [&](const int64_t t) {
+        double sum = 0.;
+        for (int64_t i = 0; i < n - t; ++i) { sum += (x[i*NDIM + j] - mean)*(x[(i + t)*NDIM + j] - mean); }
+        return sum;
+    };
+    const double c0 = c(0);
+    double tau = 1.;
+    for (int64_t t = 1; t < n; ++t) {
+        tau += 2.*c(t)/c0;
+        if (t >= 5.*tau) { break; }
+    }
+    return tau;
+}
+
+void integrate(const StoragePrecision precision, double average[], double error[], double tau[])
+{
+    MCI mci(3);
+    mci.addSamplingFunction(ThreeDimGaussianPDF());
+    mci.addObservable(XSquared()); // default estimator
+    mci.addObservable(XYZSquared(), 1, 1, false, EstimatorType::Autocorrelation, precision);
+    mci.setSeed(1337);
+    mci.centerX();
+    mci.setMRT2Step(0.5);
+    mci.integrate(10000, average, error, false, false);
+    assert(mci.getAutocorrelationTimes(0) == nullptr);
+    std::copy(mci.getAutocorrelationTimes(1), mci.getAutocorrelationTimes(1) + 3, tau);
+}
+
+int main()
+{
+    // the FFT autocovariance agrees with the direct computation (n not a power of 2)
+    const int64_t NSMALL = 3000;
+    const vector<double> xs = generateData(NSMALL);
+    double avg[NDIM], err[NDIM], tau[NDIM], avgU[NDIM], errU[NDIM];
+    AutocorrelationEstimator(NSMALL, NDIM, xs.data(), avg, err, tau);
+    UncorrelatedEstimator(NSMALL, NDIM, xs.data(), avgU, errU);
+    for (int j = 0; j < NDIM; ++j) {
+        assert(fabs(avg[j] - avgU[j]) < 1e-12*fabs(avgU[j]));
+        assert(fabs(tau[j] - directTau(NSMALL, xs.data(), j, avg[j])) < 1e-9*tau[j]);
+        assert(fabs(err[j] - errU[j]*sqrt(tau[j])) < 1e-9*err[j]);
+    }
+
+    // tau_int of AR(1) is (1 + phi)/(1 - phi), i.e. 1, 3 and 9, and the errors agree with MJBlocker
+    const int64_t NLARGE = 200000;
+    const vector<double> xl = generateData(NLARGE);
+    double avgMJ[NDIM], errMJ[NDIM];
+    AutocorrelationEstimator(NLARGE, NDIM, xl.data(), avg, err, tau);
+    MJBlockerEstimator(NLARGE, NDIM, xl.data(), avgMJ, errMJ);
+    const double exact[NDIM] = {1., 3., 9.};
+    for (int j = 0; j < NDIM; ++j) {
+        assert(fabs(tau[j] - exact[j]) < 0.1*exact[j]);
+        assert(fabs(err[j] - errMJ[j]) < 0.2*errMJ[j]);
+    }
+
+    // constant data
+    const vector<double> xc(100*NDIM, 1.);
+    AutocorrelationEstimator(100, NDIM, xc.data(), avg, err, tau);
+    for (int j = 0; j < NDIM; ++j) {
+        assert(avg[j] == 1.);
+        assert(err[j] == 0.);
+        assert(tau[j] == 1.);
+    }
+
+    // in integrations, also with reduced precision storage
+    double average[4], error[4], taus[3], average2[4], error2[4], taus2[3];
+    integrate(StoragePrecision::Double, average, error, taus);
+    integrate(StoragePrecision::Float, average2, error2, taus2);
+    for (int j = 0; j < 3; ++j) {
+        assert(taus[j] > 1.);
+        assert(fabs(taus2[j] - taus[j]) < 1e-4*taus[j]);
+        assert(fabs(error2[1 + j] - error[1 + j]) < 1e-4*error[1 + j]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "mci/MCIntegrator.hpp"
+#include "mci/BlockAccumulator.hpp"
+#include "mci/FullAccumulator.hpp"
+#include "mci/StorageArena.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+const int NDIM = 3;
+const int NOBSDIM = 1 + 3 + 3 + 3 + 3 + 3;
+
+void setupMCI(MCI &mci, const bool flag_persistent)
+{
+    mci.addSamplingFunction(ThreeDimGaussianPDF());
+    mci.addObservable(XSquared(), 0, 1); // simple accumulator
+    mci.addObservable(XND(NDIM), 1, 1, false, EstimatorType::Correlated);
+    mci.addObservable(XND(NDIM), 10, 1, false, EstimatorType::Uncorrelated);
+    mci.addObservable(XND(NDIM), 10, 1, false, EstimatorType::OnlineUncorrelated);
+    mci.addObservable(XND(NDIM), 1, 1, false, EstimatorType::StreamingBlocker);
+    mci.addObservable(XND(NDIM), 1, 1, false, EstimatorType::Uncorrelated, StoragePrecision::Float); // not from the arena
+    assert(mci.getNObsDim() == NOBSDIM);
+
+    mci.setUsePersistentStorage(flag_persistent);
+    assert(mci.getUsePersistentStorage() == flag_persistent);
+    mci.setSeed(1337);
+    mci.centerX();
+    mci.setMRT2Step(0.5);
+}
+
+bool isAligned(const double * ptr) { return reinterpret_cast<uintptr_t>(ptr)%64 == 0; }
+
+int main()
+{
+    // arena level: arrays are aligned and the block grows to the size of the last use
+    StorageArena arena;
+    double * a = arena.take(3);
+    double * b = arena.take(100);
+    assert(isAligned(a) && isAligned(b));
+    assert(arena.getCapacity() == 0 && arena.getNTaken() == 8 + 104);
+    arena.release();
+    assert(arena.getCapacity() == 8 + 104 && arena.getNTaken() == 0);
+    a = arena.take(3);
+    b = arena.take(100);
+    assert(isAligned(a) && b == a + 8); // contiguous
+    arena.release();
+    assert(arena.getCapacity() == 8 + 104);
+    arena.take(5);
+    arena.release(); // smaller use keeps the block
+    assert(arena.getCapacity() == 8 + 104);
+    arena.clear();
+    assert(arena.getCapacity() == 0 && arena.getNBytes() == 0);
+
+    // accumulator level: data taken from the arena, and not freed by the accumulator
+    XND obs(2);
+    {
+        FullAccumulator faccu(obs, 1);
+        BlockAccumulator baccu(obs, 1, 4);
+        faccu.setStorageArena(&arena);
+        baccu.setStorageArena(&arena);
+        for (int i = 0; i < 2; ++i) {
+            faccu.allocate(100);
+            baccu.allocate(100);
+            assert(isAligned(faccu.getData()) && isAligned(baccu.getData()));
+            assert(arena.getNTaken() == 200 + 56);
+            if (i == 1) { assert(baccu.getData() == faccu.getData() + 200); }
+            faccu.deallocate();
+            baccu.deallocate();
+            arena.release();
+        }
+        assert(arena.getCapacity() == 200 + 56);
+        faccu.allocate(100); // destructor must not delete the arena's array
+    }
+
+    // integration level: bit-identical results, also when Nmc changes between calls
+    MCI mci(NDIM), mcip(NDIM);
+    setupMCI(mci, false);
+    setupMCI(mcip, true);
+    for (const int nmc : {1000, 5000, 1000, 5000, 2000}) {
+        double average[NOBSDIM], error[NOBSDIM];
+        double averagep[NOBSDIM], errorp[NOBSDIM];
+        mci.integrate(nmc, average, error, false, false);
+        mcip.integrate(nmc, averagep, errorp, false, false);
+        for (int i = 0; i < NOBSDIM; ++i) {
+            assert(averagep[i] == average[i]);
+            assert(errorp[i] == error[i]);
+        }
+    }
+
+    return 0;
+}
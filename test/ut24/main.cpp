@@ -0,0 +1,127 @@
+#include "mci/MCIntegrator.hpp"
+#include "mci/HistogramAccumulator.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+const int NMC = 4000; // multiple of blocksize*nskip used below
+const int NDIM = 3;
+const int NBINS = 50; // per coordinate
+const double RANGE = 2.; // some hits are outside
+const int NSPLIT = 1332; // rejected step, i.e. continues with the stored hits
+
+class DenseCoordHistogram final: public ObservableFunctionInterface
+{   // the same histogram, accumulated by the default (dense) accumulators
+protected:
+    CoordHistogram _hist;
+
+    ObservableFunctionInterface * _clone() const final { return new DenseCoordHistogram(); }
+
+public:
+    DenseCoordHistogram(): ObservableFunctionInterface(NDIM, NDIM*NBINS, false), _hist(NDIM, NBINS, RANGE) {}
+
+    void observableFunction(const double in[], double out[]) final { _hist.observableFunction(in, out); }
+};
+
+class BadHistogram final: public HistogramObservable
+{
+protected:
+    ObservableFunctionInterface * _clone() const final { return new BadHistogram(); }
+
+public:
+    BadHistogram(): HistogramObservable(1, 2, 1) {}
+
+    int histogramFunction(const double/*in*/[], int bins[], double weights[]) final
+    {
+        bins[0] = 2; // out of range
+        weights[0] = 1.;
+        return 1;
+    }
+};
+
+// integrate the sparse and the dense histogram with the same settings in one MCI, return whether the results are identical
+bool integrateBoth(const int nwalkers, const int blocksize, const int nskip, const EstimatorType estimType)
+{
+    MCI mci(NDIM);
+    mci.addSamplingFunction(ThreeDimGaussianPDF());
+    mci.addObservable(CoordHistogram(NDIM, NBINS, RANGE), blocksize, nskip, false, estimType);
+    mci.addObservable(DenseCoordHistogram(), blocksize, nskip, false, estimType);
+    mci.setNWalkers(nwalkers);
+    mci.setSeed(1337);
+    mci.centerX();
+    mci.setMRT2Step(0.5);
+
+    const int nobs = NDIM*NBINS;
+    double average[2*nobs], error[2*nobs];
+    mci.integrate(NMC, average, error, false, false);
+    double sum = 0.;
+    for (int i = 0; i < nobs; ++i) {
+        if (average[i] != average[nobs + i] || error[i] != error[nobs + i]) { return false; }
+        sum += average[i];
+    }
+    return (sum > 0.5*NDIM && sum < (1. + 0.1*NDIM)*NDIM); // most samples are within range
+}
+
+// accumulate the same walk with an accumulator, from step begin to end
+void accumulateSteps(AccumulatorInterface &accu, const int begin, const int end)
+{
+    WalkerState wlk(NDIM, true);
+    for (int i = begin; i < end; ++i) {
+        for (int j = 0; j < NDIM; ++j) { wlk.xnew[j] = sin(0.1*i + j); }
+        wlk.accepted = (i%3 != 0); // some steps keep the last hits
+        accu.accumulate(wlk);
+    }
+}
+
+int main()
+{
+    // the factory accumulates histograms sparsely
+    CoordHistogram hist(NDIM, NBINS, RANGE);
+    assert(hist.getNBins() == NDIM*NBINS && hist.getMaxHits() == NDIM);
+    assert(dynamic_cast<HistogramAccumulator *>(createAccumulator(hist, 10, 1, EstimatorType::Uncorrelated).get()) != nullptr);
+    assert(dynamic_cast<HistogramAccumulator *>(createAccumulator(hist, 0, 1).get()) != nullptr);
+
+    // bins out of range are detected
+    BadHistogram bad;
+    double vals[2];
+    try {
+        bad.observableFunction(vals, vals);
+        assert(false);
+    }
+    catch (const std::out_of_range &) {}
+
+    // results are identical to the dense accumulation
+    assert(integrateBoth(1, 1, 1, EstimatorType::Correlated));
+    assert(integrateBoth(1, 1, 2, EstimatorType::FCBlocker));
+    assert(integrateBoth(1, 10, 1, EstimatorType::Uncorrelated));
+    assert(integrateBoth(1, 0, 1, EstimatorType::Noop));
+    assert(integrateBoth(4, 10, 2, EstimatorType::Uncorrelated)); // ensemble mode
+
+    // interrupted accumulation continues exactly
+    HistogramAccumulator accu(hist, 1, 8), accu1(hist, 1, 8), accu2(hist, 1, 8);
+    accu.allocate(NMC);
+    accu1.allocate(NMC);
+    accu2.allocate(NMC);
+    accumulateSteps(accu, 0, NMC);
+    accumulateSteps(accu1, 0, NSPLIT);
+    stringstream ss;
+    accu1.writeState(ss);
+    accu2.readState(ss);
+    accumulateSteps(accu2, NSPLIT, NMC);
+    accu.finalize();
+    accu2.finalize();
+    assert(accu.getNStore() == NMC/8);
+    for (int64_t i = 0; i < accu.getNData(); ++i) {
+        assert(accu2.getData()[i] == accu.getData()[i]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include "mci/MCIntegrator.hpp"
+#include "mci/CovarianceAccumulator.hpp"
+#include "mci/OnlineCovariance.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+const int NMC = 8000; // multiple of blocksize*nskip used below
+const int NDIM = 3;
+const int BLOCKSIZE = 10;
+const int NSPLIT = 4321;
+
+bool isClose(const double a, const double b, const double reltol = 1.e-10)
+{
+    return fabs(a - b) <= reltol*max(fabs(a), fabs(b)) + 1.e-300;
+}
+
+// some correlated test samples
+void makeSample(const int i, double x[])
+{
+    x[0] = sin(0.37*i);
+    x[1] = x[0]*x[0] + 0.3*cos(1.1*i);
+    x[2] = 2. + cos(0.21*i);
+}
+
+// accumulate the same walk with an accumulator, from step begin to end
+void accumulateSteps(AccumulatorInterface &accu, const int begin, const int end)
+{
+    WalkerState wlk(NDIM, true);
+    for (int i = begin; i < end; ++i) {
+        makeSample(i, wlk.xnew);
+        accu.accumulate(wlk);
+    }
+}
+
+int main()
+{
+    // OnlineCovariance matches the two-pass covariance, also when samples are staged in parts
+    OnlineCovariance ocov(NDIM), ocov2(NDIM);
+    const int NSAMPLES = 1000;
+    vector<double> samples(NSAMPLES*NDIM);
+    for (int i = 0; i < NSAMPLES; ++i) {
+        makeSample(i, samples.data() + i*NDIM);
+        ocov.add(samples.data() + i*NDIM);
+        ocov2.stage(1, 2, samples.data() + i*NDIM + 1);
+        ocov2.stage(0, 1, samples.data() + i*NDIM);
+    }
+    double mean[NDIM], cov[NDIM*NDIM], mean2[NDIM], cov2[NDIM*NDIM];
+    ocov.getMean(mean);
+    ocov.getCovariance(cov);
+    ocov2.getMean(mean2);
+    ocov2.getCovariance(cov2);
+    assert(ocov.getNSamples() == NSAMPLES && ocov2.getNSamples() == NSAMPLES);
+    for (int j = 0; j < NDIM; ++j) {
+        double sum = 0.;
+        for (int i = 0; i < NSAMPLES; ++i) { sum += samples[i*NDIM + j]; }
+        assert(isClose(mean[j], sum/NSAMPLES) && mean2[j] == mean[j]);
+    }
+    for (int j = 0; j < NDIM; ++j) {
+        for (int k = 0; k < NDIM; ++k) {
+            double sum = 0.;
+            for (int i = 0; i < NSAMPLES; ++i) { sum += (samples[i*NDIM + j] - mean[j])*(samples[i*NDIM + k] - mean[k]); }
+            assert(isClose(cov[j*NDIM + k], sum/(NSAMPLES - 1), 1.e-8) && cov2[j*NDIM + k] == cov[j*NDIM + k]);
+        }
+    }
+    try {
+        ocov.stage(2, 2, samples.data());
+        assert(false);
+    }
+    catch (const std::out_of_range &) {}
+
+    // the accumulator yields the OnlineUncorrelated results and continues exactly after write/read
+    XND xnd(NDIM);
+    auto welf = createAccumulator(xnd, BLOCKSIZE, 1, EstimatorType::OnlineUncorrelated);
+    auto accu = createAccumulator(xnd, BLOCKSIZE, 1, EstimatorType::OnlineCovariance);
+    CovarianceAccumulator accu1(xnd, 1, BLOCKSIZE), accu2(xnd, 1, BLOCKSIZE);
+    assert(dynamic_cast<CovarianceAccumulator *>(accu.get()) != nullptr);
+    welf->allocate(NMC);
+    accu->allocate(NMC);
+    accu1.allocate(NMC);
+    accu2.allocate(NMC);
+    accumulateSteps(*welf, 0, NMC);
+    accumulateSteps(*accu, 0, NMC);
+    accumulateSteps(accu1, 0, NSPLIT);
+    stringstream ss;
+    accu1.writeState(ss);
+    accu2.readState(ss);
+    accumulateSteps(accu2, NSPLIT, NMC);
+    welf->finalize();
+    accu->finalize();
+    accu2.finalize();
+    assert(accu->getNStore() == 2);
+    for (int64_t i = 0; i < accu->getNData(); ++i) {
+        assert(isClose(accu->getData()[i], welf->getData()[i]));
+        assert(accu2.getData()[i] == accu->getData()[i]);
+    }
+    assert(accu2.getCovariance().getNSamples() == NMC/BLOCKSIZE);
+
+    // observables of a group need equal blocksize and nskip
+    MCI mci(NDIM);
+    mci.addSamplingFunction(ThreeDimGaussianPDF());
+    mci.addObservable(XND(NDIM), BLOCKSIZE, 1, false, EstimatorType::OnlineCovariance);
+    try {
+        mci.addObservable(XND(NDIM), 2*BLOCKSIZE, 1, false, EstimatorType::OnlineCovariance);
+        assert(false);
+    }
+    catch (const std::invalid_argument &) {}
+    try {
+        mci.addObservable(XND(NDIM), BLOCKSIZE, 2, false, EstimatorType::OnlineCovariance);
+        assert(false);
+    }
+    catch (const std::invalid_argument &) {}
+    assert(mci.getNObsDim() == NDIM);
+
+    // covariance across observables
+    mci.addObservable(XYZSquared(), BLOCKSIZE, 1, false, EstimatorType::OnlineCovariance);
+    mci.addObservable(XND(NDIM), BLOCKSIZE, 1, false, EstimatorType::OnlineUncorrelated); // not in the group
+    mci.addObservable(XND(NDIM), BLOCKSIZE, 1, false, EstimatorType::OnlineCovariance); // same values as the first
+    mci.setSeed(1337);
+    mci.centerX();
+    mci.setMRT2Step(0.5);
+    const int nobsdim = mci.getNObsDim();
+    const int ncov = 3*NDIM;
+    vector<double> average(nobsdim), error(nobsdim);
+    mci.integrate(NMC, average.data(), error.data(), false, false);
+    assert(mci.getNCovarianceDim() == ncov);
+    const vector<double> &covavg = mci.getCovarianceAverages();
+    const vector<double> &covmat = mci.getCovarianceMatrix();
+    for (int j = 0; j < 2*NDIM; ++j) { // first two observables
+        assert(covavg[j] == average[j]);
+        assert(isClose(sqrt(covmat[j*ncov + j]), error[j]));
+    }
+    for (int j = 0; j < NDIM; ++j) {
+        assert(isClose(error[j], error[2*NDIM + j], 1.e-8)); // like OnlineUncorrelated
+        // third observable in the group
+        assert(covavg[2*NDIM + j] == average[3*NDIM + j]);
+        assert(isClose(covmat[(2*NDIM + j)*ncov + j], covmat[j*ncov + j])); // fully correlated with the first
+    }
+
+    // derived quantities: the difference of equal averages has zero error, the sum has twice the error
+    double dval, derr;
+    mci.estimateDerived([](const double a[]) { return a[0] - a[2*NDIM]; }, dval, derr);
+    assert(fabs(dval) < 1.e-14 && derr < 1.e-6*error[0]);
+    mci.estimateDerived([](const double a[]) { return a[0] + a[2*NDIM]; }, dval, derr);
+    assert(isClose(dval, 2.*average[0]) && isClose(derr, 2.*error[0], 1.e-6));
+
+    // a ratio, with numerical and analytical gradient
+    auto ratio = [](const double a[]) { return a[0]/a[NDIM]; };
+    double rval, rerr, rval2, rerr2;
+    mci.estimateDerived(ratio, rval, rerr);
+    vector<double> grad(ncov, 0.);
+    grad[0] = 1./covavg[NDIM];
+    grad[NDIM] = -covavg[0]/(covavg[NDIM]*covavg[NDIM]);
+    mci.estimateDerived(ratio, rval2, rerr2, grad.data());
+    assert(rval == rval2 && isClose(rerr, rerr2, 1.e-6));
+    const double rerr_uncorr = sqrt(pow(grad[0]*error[0], 2) + pow(grad[NDIM]*error[NDIM], 2));
+    assert(rerr > 0. && rerr < 2.*rerr_uncorr); // same order as without covariance
+
+    // integrateParallel combines the chain covariances
+    mci.integrateParallel(2, NMC, average.data(), error.data(), false, false);
+    assert(mci.getNCovarianceDim() == ncov);
+    for (int j = 0; j < ncov - NDIM; ++j) {
+        assert(isClose(mci.getCovarianceAverages()[j], average[j]));
+        assert(isClose(sqrt(mci.getCovarianceMatrix()[j*ncov + j]), error[j]));
+    }
+
+    // no group, no derived estimates
+    MCI mci2(NDIM);
+    mci2.addSamplingFunction(ThreeDimGaussianPDF());
+    mci2.addObservable(XND(NDIM), BLOCKSIZE, 1, false, EstimatorType::OnlineUncorrelated);
+    mci2.integrate(NMC, average.data(), error.data(), false, false);
+    assert(mci2.getNCovarianceDim() == 0);
+    try {
+        mci2.estimateDerived(ratio, rval, rerr);
+        assert(false);
+    }
+    catch (const std::runtime_error &) {}
+
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include "mci/MCIntegrator.hpp"
+#include "mci/BlockAccumulator.hpp"
+#include "mci/CovarianceAccumulator.hpp"
+#include "mci/FullAccumulator.hpp"
+#include "mci/HistogramAccumulator.hpp"
+#include "mci/ObservableContainer.hpp"
+#include "mci/SimpleAccumulator.hpp"
+#include "mci/StreamingBlockAccumulator.hpp"
+#include "mci/WelfordAccumulator.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+const int NDIM = 3;
+const int NSTEPS1 = 400; // steps of the first chain
+const int NSTEPS2 = 600; // steps of the second chain (both multiples of blocksize*nskip used below)
+const int NBINS = 20; // per coordinate
+const double RANGE = 1.5;
+
+using AccuFactory = std::function<std::unique_ptr<AccumulatorInterface>()>;
+
+bool isClose(const double a, const double b, const double reltol = 1.e-10)
+{
+    return fabs(a - b) <= reltol*max(fabs(a), fabs(b)) + 1.e-300;
+}
+
+// make the same walk for all accumulators, where the steps begin..end are one chain
+void makeStep(const int i, const int begin, WalkerState &wlk)
+{
+    for (int j = 0; j < NDIM; ++j) { wlk.xnew[j] = sin(0.37*i + j) + 0.2*cos(1.3*i*(j + 1)); }
+    wlk.accepted = (i == begin || i%3 != 0); // some steps keep the last values
+}
+
+void accumulateSteps(AccumulatorInterface &accu, const int begin, const int end)
+{
+    WalkerState wlk(NDIM, true);
+    accu.allocate(end - begin);
+    for (int i = begin; i < end; ++i) {
+        makeStep(i, begin, wlk);
+        accu.accumulate(wlk);
+    }
+    accu.finalize();
+}
+
+// the stored data of a finalized accumulator (decoded, if stored with reduced precision)
+vector<double> getValues(const AccumulatorInterface &accu)
+{
+    vector<double> vals(static_cast<size_t>(accu.getNData()));
+    if (accu.getReducedData() != nullptr) {
+        for (int64_t i = 0; i < accu.getNStore(); ++i) { accu.getReducedData()->load(i, vals.data() + i*accu.getNObs()); }
+    }
+    else if (accu.getRunLengthData() != nullptr) {
+        for (int64_t i = 0; i < accu.getNStore(); ++i) { accu.getRunLengthData()->load(i, vals.data() + i*accu.getNObs()); }
+    }
+    else {
+        std::copy(accu.getData(), accu.getData() + accu.getNData(), vals.begin());
+    }
+    return vals;
+}
+
+// Merge the accumulations of two chains and compare to the accumulation of the whole walk. Also check that
+// the merged data survive serialization. Returns the largest deviation from the whole walk (relative, if > 1).
+double checkMerge(const AccuFactory &create)
+{
+    auto accu1 = create(), accu2 = create(), accu = create();
+    accumulateSteps(*accu1, 0, NSTEPS1);
+    accumulateSteps(*accu2, NSTEPS1, NSTEPS1 + NSTEPS2);
+    accumulateSteps(*accu, 0, NSTEPS1 + NSTEPS2);
+    accu1->merge(*accu2);
+    assert(accu1->isFinalized());
+    assert(accu1->getNSteps() == accu->getNSteps() && accu1->getNAccu() == accu->getNAccu());
+    assert(accu1->getNData() == accu->getNData());
+
+    const vector<double> vals1 = getValues(*accu1), vals = getValues(*accu);
+    double maxdev = 0.;
+    for (size_t i = 0; i < vals.size(); ++i) {
+        maxdev = max(maxdev, fabs(vals1[i] - vals[i])/max(fabs(vals[i]), 1.)); // values are of order 1
+    }
+
+    // round trip, into a fresh and into an allocated accumulator
+    stringstream ss;
+    accu1->serialize(ss);
+    const string buf = ss.str();
+    auto accu3 = create(), accu4 = create();
+    accu4->allocate(10*NSTEPS1);
+    for (AccumulatorInterface * const acc : {accu3.get(), accu4.get()}) {
+        stringstream ss2(buf);
+        acc->deserialize(ss2);
+        assert(acc->isFinalized());
+        assert(acc->getNSteps() == accu1->getNSteps() && acc->getNAccu() == accu1->getNAccu());
+        assert(getValues(*acc) == vals1);
+    }
+    return maxdev;
+}
+
+int main()
+{
+    XND xnd(NDIM);
+    CoordHistogram hist(NDIM, NBINS, RANGE);
+
+    // stored samples and blocks are appended, i.e. the merge is exact
+    assert(checkMerge([&]() { return std::unique_ptr<AccumulatorInterface>(new FullAccumulator(xnd, 1)); }) == 0.);
+    assert(checkMerge([&]() { return std::unique_ptr<AccumulatorInterface>(new FullAccumulator(xnd, 2, true)); }) == 0.);
+    { // run-length and plain storage are converted on merge and deserialization
+        FullAccumulator plain(xnd, 1), rle(xnd, 1, true), rle2(xnd, 1, true);
+        accumulateSteps(plain, 0, NSTEPS1);
+        accumulateSteps(rle, NSTEPS1, NSTEPS1 + NSTEPS2);
+        accumulateSteps(rle2, 0, NSTEPS1);
+        rle2.merge(rle);
+        plain.merge(rle);
+        assert(rle2.getData() == nullptr && getValues(rle2) == getValues(plain));
+        stringstream ss1, ss2;
+        rle2.serialize(ss1);
+        plain.serialize(ss2);
+        FullAccumulator plain2(xnd, 1), rle3(xnd, 1, true);
+        plain2.deserialize(ss1);
+        rle3.deserialize(ss2);
+        assert(getValues(plain2) == getValues(plain) && getValues(rle3) == getValues(plain));
+    }
+    assert(checkMerge([&]() { return std::unique_ptr<AccumulatorInterface>(new FullAccumulator(xnd, 1, false, StoragePrecision::Float)); }) == 0.);
+    assert(checkMerge([&]() { return std::unique_ptr<AccumulatorInterface>(new BlockAccumulator(xnd, 2, 10)); }) == 0.);
+    assert(checkMerge([&]() { return std::unique_ptr<AccumulatorInterface>(new BlockAccumulator(xnd, 1, 10, StoragePrecision::Float)); }) == 0.);
+    assert(checkMerge([&]() { return std::unique_ptr<AccumulatorInterface>(new HistogramAccumulator(hist, 1, 8)); }) == 0.);
+
+    // int16 blocks are requantized, i.e. exact up to quantization
+    assert(checkMerge([&]() { return std::unique_ptr<AccumulatorInterface>(new BlockAccumulator(xnd, 1, 10, StoragePrecision::Int16)); }) < 1.e-3);
+
+    // running averages and moments are combined with weights
+    assert(checkMerge([&]() { return std::unique_ptr<AccumulatorInterface>(new SimpleAccumulator(xnd, 2)); }) < 1.e-12);
+    assert(checkMerge([&]() { return std::unique_ptr<AccumulatorInterface>(new HistogramAccumulator(hist, 1, 0)); }) < 1.e-12);
+    assert(checkMerge([&]() { return std::unique_ptr<AccumulatorInterface>(new WelfordAccumulator(xnd, 1, 10)); }) < 1.e-10);
+    assert(checkMerge([&]() { return std::unique_ptr<AccumulatorInterface>(new CovarianceAccumulator(xnd, 2, 10)); }) < 1.e-10);
+
+    // the streaming blocker doesn't form blocks across the chain boundary, so only the average is exact
+    StreamingBlockAccumulator sba1(xnd, 1, 5), sba2(xnd, 1, 5), sba(xnd, 1, 5);
+    accumulateSteps(sba1, 0, NSTEPS1);
+    accumulateSteps(sba2, NSTEPS1, NSTEPS1 + NSTEPS2);
+    accumulateSteps(sba, 0, NSTEPS1 + NSTEPS2);
+    sba1.merge(sba2);
+    assert(sba1.getNLevels() >= sba.getNLevels() - 1);
+    for (int j = 0; j < NDIM; ++j) {
+        assert(isClose(sba1.getData()[j], sba.getData()[j]));
+        const double err1 = sba1.getData()[NDIM + j], err = sba.getData()[NDIM + j];
+        assert(err1 > 0.5*err && err1 < 2.*err);
+    }
+
+    // invalid merges and serializations
+    SimpleAccumulator simple1(xnd, 1), simple2(xnd, 1), simple3(xnd, 2);
+    BlockAccumulator block1(xnd, 1, 10), block2(xnd, 1, 20);
+    accumulateSteps(simple1, 0, NSTEPS1);
+    accumulateSteps(simple3, 0, NSTEPS1);
+    accumulateSteps(block1, 0, NSTEPS1);
+    accumulateSteps(block2, 0, NSTEPS1);
+    simple2.allocate(NSTEPS1);
+    auto expectThrow = [](const std::function<void()> &fun) {
+        try {
+            fun();
+            return false;
+        }
+        catch (const std::exception &) { return true; }
+    };
+    assert(expectThrow([&]() { simple1.merge(simple1); }));
+    assert(expectThrow([&]() { simple1.merge(simple2); })); // not finalized
+    assert(expectThrow([&]() { simple1.merge(simple3); })); // different nskip
+    assert(expectThrow([&]() { simple1.merge(block1); })); // different type
+    assert(expectThrow([&]() { block1.merge(block2); })); // different blocksize
+    assert(expectThrow([&]() { stringstream ss; simple2.serialize(ss); }));
+    assert(expectThrow([&]() { stringstream ss; block1.serialize(ss); block2.deserialize(ss); }));
+    assert(expectThrow([&]() { stringstream ss; simple1.serialize(ss); simple3.deserialize(ss); }));
+    assert(block1.isFinalized() && block1.getNStore() == NSTEPS1/10); // still intact after the failed merge
+
+    // containers merge all accumulators and the covariance group
+    auto makeContainer = []() {
+        std::unique_ptr<ObservableContainer> cont(new ObservableContainer);
+        cont->addObservable(std::unique_ptr<ObservableFunctionInterface>(new XND(NDIM)), 10, 1, false, EstimatorType::OnlineCovariance);
+        cont->addObservable(std::unique_ptr<ObservableFunctionInterface>(new XYZSquared()), 10, 1, false, EstimatorType::OnlineCovariance);
+        cont->addObservable(std::unique_ptr<ObservableFunctionInterface>(new XND(NDIM)), 20, 2, false, EstimatorType::Uncorrelated);
+        cont->addObservable(std::unique_ptr<ObservableFunctionInterface>(new XYZSquared()), 1, 1, false, EstimatorType::Correlated);
+        return cont;
+    };
+    auto cont1 = makeContainer(), cont2 = makeContainer(), cont = makeContainer();
+    const SamplingFunctionContainer pdfcont;
+    auto accumulateContainer = [&](ObservableContainer &c, const int begin, const int end) {
+        WalkerState wlk(NDIM, true);
+        c.allocate(end - begin, pdfcont);
+        for (int i = begin; i < end; ++i) {
+            makeStep(i, begin, wlk);
+            c.accumulate(wlk);
+        }
+        c.finalize();
+    };
+    accumulateContainer(*cont1, 0, NSTEPS1);
+    accumulateContainer(*cont2, NSTEPS1, NSTEPS1 + NSTEPS2);
+    accumulateContainer(*cont, 0, NSTEPS1 + NSTEPS2);
+    cont1->merge(*cont2);
+
+    const int nobsdim = cont->getNObsDim();
+    const int ncov = cont->getNCovarianceDim();
+    assert(ncov == 2*NDIM);
+    vector<double> avg1(nobsdim), err1(nobsdim), avg(nobsdim), err(nobsdim);
+    cont1->estimate(avg1.data(), err1.data());
+    cont->estimate(avg.data(), err.data());
+    for (int i = 0; i < nobsdim; ++i) {
+        assert(isClose(avg1[i], avg[i]));
+        assert(isClose(err1[i], err[i], 1.e-8));
+    }
+    assert(cont1->getCovariance()->getNSamples() == cont->getCovariance()->getNSamples());
+    vector<double> cov1(ncov*ncov), cov(ncov*ncov);
+    cont1->getCovariance()->getCovariance(cov1.data());
+    cont->getCovariance()->getCovariance(cov.data());
+    for (int i = 0; i < ncov*ncov; ++i) { assert(fabs(cov1[i] - cov[i]) <= 1.e-10*(fabs(cov[i]) + 1.)); }
+
+    // serialized containers can be merged elsewhere, e.g. from separate jobs
+    stringstream ss;
+    cont1->serialize(ss);
+    auto cont3 = cont1->createEquivalent();
+    cont3->deserialize(ss);
+    vector<double> avg3(nobsdim), err3(nobsdim);
+    cont3->estimate(avg3.data(), err3.data());
+    assert(avg3 == avg1 && err3 == err1);
+    assert(expectThrow([&]() { cont3->merge(*makeContainer()); })); // not allocated/finalized
+    auto cont4 = makeContainer();
+    cont4->pop_back();
+    assert(expectThrow([&]() { cont3->merge(*cont4); })); // different observables
+
+    // integrateParallel merges the chains before the estimation
+    MCI mci(NDIM);
+    mci.addSamplingFunction(ThreeDimGaussianPDF());
+    mci.addObservable(XND(NDIM), 10, 1, false, EstimatorType::Uncorrelated);
+    mci.addObservable(XND(NDIM), 1, 1, false, EstimatorType::Correlated);
+    mci.setSeed(1337);
+    mci.centerX();
+    mci.setMRT2Step(0.5);
+    vector<double> average(2*NDIM), error(2*NDIM);
+    mci.integrateParallel(3, 30000, average.data(), error.data(), false, false);
+    for (int j = 0; j < 2*NDIM; ++j) {
+        assert(fabs(average[j]) < 5.*error[j] + 1.e-3);
+        assert(error[j] > 0. && error[j] < 0.05);
+    }
+
+    return 0;
+}
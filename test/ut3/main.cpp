@@ -33,11 +33,12 @@ int main()
     double error[4];
 
     // this integral will give a wrong answer! This is because the starting point is very bad and initialDecorrelation is skipped (as well as the MRT2step automatic setting)
+    // (the auto-blocking error partially captures the initial drift, so we only check for a deviation of more than one error)
     mci.setX(x);
     mci.integrate(NMC, average, error, false, false);
     for (int i = 0; i < mci.getNObsDim(); ++i) {
         //std::cout << "i " << i << ", average[i] " << average[i] << ", error[i] " << error[i] << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
-        assert(fabs(average[i] - CORRECT_RESULT) > 2.*error[i]);
+        assert(fabs(average[i] - CORRECT_RESULT) > error[i]);
     }
     //std::cout << std::endl;
 
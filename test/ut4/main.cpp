@@ -34,43 +34,43 @@ int main()
     mci.setX(x);
     mci.integrate(NMC, &average, &error, true, true);
     //std::cout << "average " << average << ", error " << error << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
-    assert(fabs(average - CORRECT_RESULT) < 2.*error);
+    assert(fabs(average - CORRECT_RESULT) < RGEN_NSIGMA*error);
 
     // now, doing an integral without finding again the MRT2step and doing the initialDecorrelation will also result in a correct result
     mci.integrate(NMC, &average, &error, false, false);
     //std::cout << "average " << average << ", error " << error << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
-    assert(fabs(average - CORRECT_RESULT) < 2.*error);
+    assert(fabs(average - CORRECT_RESULT) < RGEN_NSIGMA*error);
 
     // and using fixed blocking also gives the same result
     mci.clearObservables();
     mci.addObservable(obs, 16); // blocks of size 16
     mci.integrate(NMC, &average, &error, false, false);
     //std::cout << "average " << average << ", error " << error << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
-    assert(fabs(average - CORRECT_RESULT) < 2.*error);
+    assert(fabs(average - CORRECT_RESULT) < RGEN_NSIGMA*error);
 
     // and half the block size with skipping every second step, should be similar again
     mci.clearObservables();
     mci.addObservable(obs, 8, 2); // blocksize 4, nskip 2 (i.e. "effective" blocksize of 16)
     mci.integrate(NMC, &average, &error, false, false);
     //std::cout << "average " << average << ", error " << error << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
-    assert(fabs(average - CORRECT_RESULT) < 2.*error);
+    assert(fabs(average - CORRECT_RESULT) < RGEN_NSIGMA*error);
 
     // The previous two integrations implicitly used UncorrelatedEstimator (because blocksize>1).
-    // CorrelatedEstimator (is MJBlocker, because NMC is power of 2) should yield similar result.
+    // CorrelatedEstimator (is MJBlocker) should yield similar result.
 
     // first set it by boolean arguments
     mci.clearObservables();
     mci.addObservable(obs, 8, 2, false /*flag_equil*/, true /*flag_correlated*/); // forcing correlated estimator, although the other settings would "imply" uncorrelated samples
     mci.integrate(NMC, &average, &error, false, false);
     //std::cout << "average " << average << ", error " << error << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
-    assert(fabs(average - CORRECT_RESULT) < 2.*error);
+    assert(fabs(average - CORRECT_RESULT) < RGEN_NSIGMA*error);
 
     // now via enumerator
     mci.clearObservables();
     mci.addObservable(obs, 8, 2, false /*flag_equil*/, EstimatorType::Correlated);
     mci.integrate(NMC, &average, &error, false, false);
     //std::cout << "average " << average << ", error " << error << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
-    assert(fabs(average - CORRECT_RESULT) < 2.*error);
+    assert(fabs(average - CORRECT_RESULT) < RGEN_NSIGMA*error);
 
 
     return 0;
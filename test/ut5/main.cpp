@@ -38,7 +38,7 @@ int main()
     mci.integrate(NMC, average, error, true, true);
     for (int i = 0; i < mci.getNObsDim(); ++i) {
         //std::cout << "i " << i << ", average[i] " << average[i] << ", error[i] " << error[i] << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
-        assert(fabs(average[i] - CORRECT_RESULT) < 2.*error[i]);
+        assert(fabs(average[i] - CORRECT_RESULT) < RGEN_NSIGMA*error[i]);
     }
     //std::cout << std::endl;
 
@@ -0,0 +1,65 @@
+#include "mci/MCIntegrator.hpp"
+
+#include <cassert>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+int main()
+{
+    const int NMC = 16384; // total number of steps, split among threads
+    const int NTHREADS = 4;
+    const double CORRECT_RESULT = 0.5;
+
+    ThreeDimGaussianPDF pdf;
+    XSquared obs;
+    XYZSquared obs3d;
+
+    MCI mci(3);
+    mci.addSamplingFunction(pdf);
+    mci.addObservable(obs);
+    mci.addObservable(obs3d, 16, 2); // fixed blocking with skipping (NMC/NTHREADS is a multiple of 32)
+
+    double x[3]{5., -5., 10.}; // bad starting point
+    double average[4], average2[4];
+    double error[4], error2[4];
+
+    // the parallel integral should provide the right answer (after findMRT2step&decorrelation phase in every thread)
+    mci.setSeed(1337);
+    mci.setX(x);
+    mci.setMRT2Step(0.05);
+    mci.integrateParallel(NTHREADS, NMC, average, error);
+    for (int i = 0; i < mci.getNObsDim(); ++i) {
+        //std::cout << "average " << average[i] << ", error " << error[i] << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
+        assert(fabs(average[i] - CORRECT_RESULT) < RGEN_NSIGMA*error[i]);
+    }
+
+    // the setup of our MCI must not be affected
+    assert(mci.getNObs() == 2);
+    assert(mci.getNPDF() == 1);
+
+    // with the same seed, thread number and initial state, we expect identical results
+    mci.setSeed(1337);
+    mci.setX(x);
+    mci.setMRT2Step(0.05);
+    mci.integrateParallel(NTHREADS, NMC, average2, error2);
+    for (int i = 0; i < mci.getNObsDim(); ++i) {
+        assert(average[i] == average2[i]);
+        assert(error[i] == error2[i]);
+    }
+
+    // a step number that is not a multiple of the thread number works as well (only with auto-blocking)
+    mci.clearObservables();
+    mci.addObservable(obs);
+    mci.integrateParallel(3, NMC + 1, average, error, false, false);
+    assert(fabs(average[0] - CORRECT_RESULT) < RGEN_NSIGMA*error[0]);
+
+    // and a single thread falls back to plain integrate
+    mci.integrateParallel(1, NMC, average, error, false, false);
+    assert(fabs(average[0] - CORRECT_RESULT) < RGEN_NSIGMA*error[0]);
+
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "mci/MCIntegrator.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+// same as Gauss, but doesn't opt in to ensemble mode
+class LegacyGauss final: public SamplingFunctionInterface
+{
+protected:
+    SamplingFunctionInterface * _clone() const final { return new LegacyGauss(_ndim); }
+
+public:
+    explicit LegacyGauss(const int ndim): SamplingFunctionInterface(ndim, ndim) {}
+
+    void protoFunction(const double in[], double out[]) final
+    {
+        for (int i = 0; i < _ndim; ++i) { out[i] = in[i]*in[i]; }
+    }
+
+    double samplingFunction(const double protov[]) const final
+    {
+        return exp(-std::accumulate(protov, protov + _nproto, 0.));
+    }
+
+    double acceptanceFunction(const double protoold[], const double protonew[]) const final
+    {
+        double expf = 0.;
+        for (int i = 0; i < _nproto; ++i) { expf += protoold[i] - protonew[i]; }
+        return exp(expf);
+    }
+};
+
+int main()
+{
+    const int NMC = 4096; // number of ensemble steps
+    const int NWALKERS = 8;
+    const double CORRECT_RESULT = 0.5;
+
+    Gauss pdf(3);
+    XSquared obs1d;
+    X2 obs3d(3); // effectively an updateable XYZSquared
+
+    MCI mci(3);
+    mci.setSeed(1337);
+    mci.addSamplingFunction(pdf);
+    mci.addObservable(obs1d);
+    mci.addObservable(obs3d, 16, 2); // fixed blocking with skipping
+
+    double x[3]{5., -5., 10.}; // bad starting point
+    double average[4];
+    double error[4];
+
+    // invalid walker number
+    bool thrown = false;
+    try { mci.setNWalkers(0); }
+    catch (const std::invalid_argument &) { thrown = true; }
+    assert(thrown);
+    assert(mci.getNWalkers() == 1);
+    assert(mci.getWalkerEnsemble() == nullptr);
+
+    // sampling functions must opt in to ensemble mode
+    MCI mci2(3);
+    LegacyGauss lpdf(3);
+    mci2.addSamplingFunction(lpdf);
+    thrown = false;
+    try { mci2.setNWalkers(NWALKERS); }
+    catch (const std::invalid_argument &) { thrown = true; }
+    assert(thrown);
+    assert(mci2.getNWalkers() == 1);
+    mci2.clearSamplingFunctions();
+    mci2.setNWalkers(NWALKERS);
+    thrown = false;
+    try { mci2.addSamplingFunction(lpdf); }
+    catch (const std::invalid_argument &) { thrown = true; }
+    assert(thrown);
+    thrown = false;
+    try { lpdf.setNWalkers(NWALKERS); }
+    catch (const std::invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    // the ensemble integral with default all-moves should provide the right answer
+    mci.setNWalkers(NWALKERS);
+    assert(mci.getNWalkers() == NWALKERS);
+    assert(mci.getWalkerEnsemble() != nullptr);
+    mci.setX(x);
+    mci.integrate(NMC, average, error);
+    for (int i = 0; i < mci.getNObsDim(); ++i) {
+        //std::cout << "average " << average[i] << ", error " << error[i] << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
+        assert(fabs(average[i] - CORRECT_RESULT) < 2.*error[i]);
+    }
+
+    // the walkers should have moved apart
+    const WalkerEnsemble &wlkens = *mci.getWalkerEnsemble();
+    assert(wlkens.nwalkers == NWALKERS);
+    for (int iw = 1; iw < NWALKERS; ++iw) {
+        assert(wlkens.xold[0] != wlkens.xold[iw*3]);
+    }
+
+    // now with single-index moves (uses selective updating of pdf and obs), continuing from the last ensemble
+    mci.setTrialMove(SRRDType::Uniform, 1);
+    mci.clearObservables();
+    mci.addObservable(obs1d, 1, 3);
+    mci.addObservable(obs3d, 1, 3);
+    mci.integrate(3*NMC, average, error, true, false);
+    for (int i = 0; i < mci.getNObsDim(); ++i) {
+        assert(fabs(average[i] - CORRECT_RESULT) < 3.*error[i]); // like in ut5, factor 2 is a bit small here
+    }
+
+    // back to single walker mode
+    mci.setNWalkers(1);
+    assert(mci.getWalkerEnsemble() == nullptr);
+    mci.integrate(3*NMC*NWALKERS, average, error, true, true);
+    for (int i = 0; i < mci.getNObsDim(); ++i) {
+        assert(fabs(average[i] - CORRECT_RESULT) < 3.*error[i]);
+    }
+
+
+    return 0;
+}
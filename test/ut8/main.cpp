@@ -0,0 +1,91 @@
+#include "mci/MCIntegrator.hpp"
+#include "mci/SamplingFunctionContainer.hpp"
+
+#include <cassert>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+int main()
+{
+    const int NMC = 4096; // number of ensemble steps
+    const int NWALKERS = 8;
+    const double CORRECT_RESULT = 0.5;
+    const double TINY = 1e-12;
+
+    // --- First compare batched acceptances (with and without override of protoFunctionBatch) to single-walker ones
+
+    SamplingFunctionContainer pdfcont; // ThreeDimGaussianPDF overrides protoFunctionBatch, Gauss uses the default
+    pdfcont.addSamplingFunction(std::unique_ptr<SamplingFunctionInterface>(new ThreeDimGaussianPDF()));
+    pdfcont.addSamplingFunction(std::unique_ptr<SamplingFunctionInterface>(new Gauss(3)));
+    pdfcont.setNWalkers(NWALKERS);
+
+    WalkerEnsemble wlkens(NWALKERS, 3, false);
+    for (int i = 0; i < NWALKERS*3; ++i) { wlkens.xold[i] = 0.1*i - 1.; }
+    wlkens.initialize(false);
+    pdfcont.initializeProtoValues(wlkens);
+
+    WalkerState wlk(3, false); // for the single walker reference
+    double accBatch[NWALKERS];
+    for (int nchanged = 1; nchanged <= 3; ++nchanged) { // single-index, two-index and all-index moves
+        for (int iw = 0; iw < NWALKERS; ++iw) {
+            WalkerState &ewlk = wlkens.walkers[iw];
+            ewlk.nchanged = nchanged;
+            for (int i = 0; i < nchanged; ++i) {
+                ewlk.changedIdx[i] = i;
+                ewlk.xnew[i] = ewlk.xold[i] + 0.05*(iw - i);
+            }
+        }
+        pdfcont.computeAcceptance(wlkens, accBatch);
+
+        for (int iw = 0; iw < NWALKERS; ++iw) {
+            const WalkerState &ewlk = wlkens.walkers[iw];
+            std::copy(ewlk.xold, ewlk.xold + 3, wlk.xold);
+            std::copy(ewlk.xnew, ewlk.xnew + 3, wlk.xnew);
+            std::copy(ewlk.changedIdx, ewlk.changedIdx + 3, wlk.changedIdx);
+            wlk.nchanged = ewlk.nchanged;
+
+            double accRef = 1.;
+            for (int ipdf = 0; ipdf < pdfcont.size(); ++ipdf) {
+                auto pdf = pdfcont.getSamplingFunction(ipdf).clone(); // single walker clone
+                pdf->initializeProtoValues(wlk.xold);
+                accRef *= pdf->computeAcceptance(wlk);
+            }
+            assert(fabs(accBatch[iw] - accRef) < TINY*accRef);
+        }
+
+        // reject everything
+        for (int iw = 0; iw < NWALKERS; ++iw) {
+            pdfcont.oldToNew(iw);
+            wlkens.walkers[iw].oldToNew();
+        }
+    }
+
+
+    // --- Then integrate in ensemble mode with the batched pdf
+
+    ThreeDimGaussianPDF pdf;
+    XSquared obs;
+    XYZSquared obs3d;
+
+    MCI mci(3);
+    mci.setSeed(1337);
+    mci.addSamplingFunction(pdf);
+    mci.addObservable(obs);
+    mci.addObservable(obs3d);
+    mci.setNWalkers(NWALKERS);
+
+    double average[4];
+    double error[4];
+    mci.centerX();
+    mci.integrate(NMC, average, error);
+    for (int i = 0; i < mci.getNObsDim(); ++i) {
+        //std::cout << "average " << average[i] << ", error " << error[i] << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
+        assert(fabs(average[i] - CORRECT_RESULT) < 3.*error[i]); // like in ut5, factor 2 is a bit small here
+    }
+
+
+    return 0;
+}
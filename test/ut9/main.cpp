@@ -0,0 +1,119 @@
+#include "mci/MCIntegrator.hpp"
+#include "mci/SamplingFunctionContainer.hpp"
+
+#include <cassert>
+
+#include "../common/TestMCIFunctions.hpp"
+
+using namespace std;
+using namespace mci;
+
+// Gaussian pdf which counts its log-acceptance evaluations
+class CountingGauss final: public SamplingFunctionInterface
+{
+protected:
+    SamplingFunctionInterface * _clone() const final { return new CountingGauss(_ndim); }
+
+public:
+    int neval = 0;
+
+    explicit CountingGauss(const int ndim): SamplingFunctionInterface(ndim, 1) {}
+    bool supportsEnsemble() const final { return true; }
+
+    void protoFunction(const double in[], double protovalues[]) final
+    {
+        protovalues[0] = 0.;
+        for (int i = 0; i < _ndim; ++i) { protovalues[0] += in[i]*in[i]; }
+    }
+
+    double samplingFunction(const double protov[]) const final { return exp(-protov[0]); }
+
+    double acceptanceFunction(const double protoold[], const double protonew[]) const final
+    {
+        return exp(-protonew[0] + protoold[0]);
+    }
+
+    double logAcceptanceFunction(const double protoold[], const double protonew[]) const final
+    {
+        ++const_cast<CountingGauss *>(this)->neval;
+        return -protonew[0] + protoold[0];
+    }
+
+    double maxLogAcceptance(const double protoold[]) const final { return protoold[0]; }
+};
+
+int main()
+{
+    const int NMC = 16384;
+    const double CORRECT_RESULT = 0.5;
+
+    // --- Check early rejection on container level
+
+    auto cgauss = new CountingGauss(3); // raw ptr to check counter
+    SamplingFunctionContainer pdfcont;
+    pdfcont.addSamplingFunction(std::unique_ptr<SamplingFunctionInterface>(new ThreeDimGaussianPDF()));
+    pdfcont.addSamplingFunction(std::unique_ptr<SamplingFunctionInterface>(cgauss)); // its bound allows to skip it
+
+    WalkerState wlk(3, false);
+    std::fill(wlk.xold, wlk.xold + 3, 0.1);
+    wlk.initialize(false);
+    pdfcont.initializeProtoValues(wlk.xold);
+
+    // a far move is certainly rejected by the first pdf, already
+    std::fill(wlk.xnew, wlk.xnew + 3, 3.);
+    assert(!pdfcont.computeLogAcceptance(wlk, log(0.5)));
+    assert(cgauss->neval == 0);
+    pdfcont.oldToNew();
+
+    // a small move needs both
+    std::fill(wlk.xnew, wlk.xnew + 3, 0.05);
+    assert(pdfcont.computeLogAcceptance(wlk, log(0.5)));
+    assert(cgauss->neval == 1);
+    pdfcont.newToOld();
+
+    // results are the same as in normal mode
+    std::fill(wlk.xold, wlk.xold + 3, 0.05);
+    std::fill(wlk.xnew, wlk.xnew + 3, 0.5);
+    const double acc = pdfcont.computeAcceptance(wlk);
+    pdfcont.oldToNew();
+    assert(pdfcont.computeLogAcceptance(wlk, log(0.99*acc)));
+    pdfcont.oldToNew();
+    assert(!pdfcont.computeLogAcceptance(wlk, log(1.01*acc)));
+    pdfcont.oldToNew();
+
+
+    // --- Integrate in log-acceptance mode
+
+    ThreeDimGaussianPDF pdf;
+    XSquared obs;
+    XYZSquared obs3d;
+
+    MCI mci(3);
+    mci.setSeed(1337);
+    mci.addSamplingFunction(pdf);
+    mci.addObservable(obs);
+    mci.addObservable(obs3d);
+    mci.setUseLogAcceptance(true);
+    assert(mci.getUseLogAcceptance());
+
+    double average[4];
+    double error[4];
+    mci.centerX();
+    mci.integrate(NMC, average, error);
+    for (int i = 0; i < mci.getNObsDim(); ++i) {
+        //std::cout << "average " << average[i] << ", error " << error[i] << ", CORRECT_RESULT" << CORRECT_RESULT << std::endl;
+        assert(fabs(average[i] - CORRECT_RESULT) < 3.*error[i]); // like in ut5, factor 2 is a bit small here
+    }
+
+    // also with single-index moves (selective updating) and an additional pdf, in ensemble mode
+    mci.addSamplingFunction(Gauss(3)); // now sampling exp(-2*x^2)
+    mci.setTrialMove(SRRDType::Uniform, 1);
+    mci.setNWalkers(4);
+    mci.integrate(NMC, average, error);
+    for (int i = 0; i < mci.getNObsDim(); ++i) {
+        assert(fabs(average[i] - 0.5*CORRECT_RESULT) < 3.*error[i]);
+    }
+
+
+    return 0;
+}